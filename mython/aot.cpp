@@ -0,0 +1,1105 @@
+#include "aot.h"
+
+#include "statement.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <map>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <typeinfo>
+#include <unordered_map>
+#include <unordered_set>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define MYTHON_AOT_DLOPEN 1
+#include <dlfcn.h>
+#endif
+
+using namespace std;
+
+// Метка, по которой CanLoadModules проверяет, что символы исполняемого файла видны загружаемым модулям
+extern "C" int mython_aot_host() {
+    return 1;
+}
+
+namespace aot {
+
+    using runtime::Executable;
+    using runtime::Symbol;
+
+    namespace {
+
+        // Имя функции модуля, выполняющей программу
+        const char* const __MODULE_ENTRY__ = "mython_main";
+
+        // Начало каждого модуля: функции, которыми пользуется выпущенный код. Сообщения об ошибках
+        // совпадают с сообщениями узлов дерева и виртуальных машин
+        const char* const __MODULE_PRELUDE__ = R"(// Модуль Mython, выпущенный aot::TranslateProgram
+#include "bytecode.h"
+#include "runtime.h"
+#include "statement.h"
+
+#include <cstdint>
+#include <limits>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+    using runtime::Closure;
+    using runtime::Context;
+    using runtime::ObjectHolder;
+
+    const ObjectHolder none;
+
+    [[noreturn]] void ThrowUndefined() {
+        throw std::runtime_error(runtime::__UNDEFINED_VARIABLE_ERROR__);
+    }
+
+    // Переменная программы. hint - ячейка таблицы, в которой переменная нашлась в прошлый раз
+    const ObjectHolder& Load(Closure& closure, runtime::Symbol name, uint32_t& hint) {
+        if (ObjectHolder* value = closure.FindHinted(name, hint)) {
+            return *value;
+        }
+        ThrowUndefined();
+    }
+
+    void Store(Closure& closure, runtime::Symbol name, uint32_t& hint, ObjectHolder value) {
+        runtime::CycleCollector::WriteBarrier(value);
+        if (ObjectHolder* slot = closure.FindHinted(name, hint)) {
+            *slot = std::move(value);
+        }
+        else {
+            closure[name] = std::move(value);
+        }
+    }
+
+    // Локальная переменная метода, которой присваивается значение не на всех путях
+    const ObjectHolder& Defined(const ObjectHolder& value, bool defined) {
+        if (!defined) {
+            ThrowUndefined();
+        }
+        return value;
+    }
+
+    // Имя, которого нет среди параметров и локальных переменных метода
+    const ObjectHolder& Undefined() {
+        ThrowUndefined();
+    }
+
+    void Assign(ObjectHolder& variable, ObjectHolder value) {
+        runtime::CycleCollector::WriteBarrier(value);
+        variable = std::move(value);
+    }
+
+    void StoreField(const ObjectHolder& object, runtime::Symbol field, ObjectHolder value) {
+        if (object.Kind() != runtime::ObjectKind::Instance) {
+            throw std::runtime_error("Only object fields can be assigned");
+        }
+        runtime::CycleCollector::WriteBarrier(value);
+        static_cast<runtime::ClassInstance*>(object.Get())->Fields()[field] = std::move(value);
+    }
+
+    int64_t NumberValue(const ObjectHolder& object) {
+        return static_cast<const runtime::Number*>(object.Get())->GetValue();
+    }
+
+    // lhs op rhs, где rhs - числовая константа со значением rhs_value
+    template <runtime::ArithmeticOp op>
+    ObjectHolder ArithmeticNumber(const ObjectHolder& lhs, const ObjectHolder& rhs, int64_t rhs_value,
+        Context& context) {
+        if (lhs.Kind() == runtime::ObjectKind::Number) {
+            if constexpr (op == runtime::ArithmeticOp::Add) {
+                return runtime::NumberAdd(NumberValue(lhs), rhs_value);
+            }
+            else if constexpr (op == runtime::ArithmeticOp::Sub) {
+                return runtime::NumberSub(NumberValue(lhs), rhs_value);
+            }
+            else if constexpr (op == runtime::ArithmeticOp::Mult) {
+                return runtime::NumberMul(NumberValue(lhs), rhs_value);
+            }
+            else {
+                return runtime::NumberDiv(NumberValue(lhs), rhs_value);
+            }
+        }
+        return bytecode::ArithmeticValues(op, lhs, rhs, context);
+    }
+
+    // lhs + rhs, где хотя бы один аргумент - заведомо строка
+    ObjectHolder ConcatStrings(const ObjectHolder& lhs, const ObjectHolder& rhs, Context& context) {
+        if (lhs.Kind() == runtime::ObjectKind::String && rhs.Kind() == runtime::ObjectKind::String) {
+            return ObjectHolder::Own(runtime::String::Concat(static_cast<const runtime::String&>(*lhs),
+                static_cast<const runtime::String&>(*rhs)));
+        }
+        return runtime::Arithmetic(runtime::ArithmeticOp::Add, lhs, rhs, context);
+    }
+
+    template <runtime::CompareOp op>
+    bool CompareNumber(const ObjectHolder& lhs, const ObjectHolder& rhs, int64_t rhs_value, Context& context) {
+        if (lhs.Kind() == runtime::ObjectKind::Number) {
+            const int64_t lhs_value = NumberValue(lhs);
+            if constexpr (op == runtime::CompareOp::Less) {
+                return lhs_value < rhs_value;
+            }
+            else if constexpr (op == runtime::CompareOp::LessOrEqual) {
+                return lhs_value <= rhs_value;
+            }
+            else if constexpr (op == runtime::CompareOp::Greater) {
+                return lhs_value > rhs_value;
+            }
+            else if constexpr (op == runtime::CompareOp::GreaterOrEqual) {
+                return lhs_value >= rhs_value;
+            }
+            else if constexpr (op == runtime::CompareOp::Equal) {
+                return lhs_value == rhs_value;
+            }
+            else {
+                return lhs_value != rhs_value;
+            }
+        }
+        return bytecode::CompareValues(op, lhs, rhs, context);
+    }
+
+    // Возвращает true, если вызов выполнится. Как и в дереве, у экземпляра без подходящего метода
+    // аргументы не вычисляются, а результат - None
+    bool CallsMethod(const ObjectHolder& object, runtime::Symbol method, size_t count) {
+        if (object.Kind() == runtime::ObjectKind::Instance) {
+            return static_cast<const runtime::ClassInstance*>(object.Get())->HasMethod(method, count);
+        }
+        if (object.TryAs<runtime::List>() || object.TryAs<runtime::Dict>() || object.TryAs<runtime::IntArray>()
+            || object.TryAs<runtime::FloatArray>()) {
+            return true;
+        }
+        throw std::runtime_error("Method \"" + method.Name() + "\" called on non-object value");
+    }
+
+    void PrintItem(std::ostream& out, const ObjectHolder& item, bool first, Context& context) {
+        if (!first) {
+            out << ' ';
+        }
+        if (item) {
+            item->Print(out, context);
+        }
+        else {
+            out << "None";
+        }
+    }
+
+    // Тело метода - функция модуля
+    class NativeBody : public runtime::Executable {
+    public:
+        using Function = ObjectHolder (*)(Closure& frame, Context& context);
+
+        explicit NativeBody(Function function)
+            : function_(function) {
+        }
+
+        ObjectHolder Execute(Closure& frame, Context& context) override {
+            return function_(frame, context);
+        }
+
+    private:
+        Function function_;
+    };
+
+    runtime::Method MakeMethod(runtime::Symbol name, std::vector<runtime::Symbol> params,
+        NativeBody::Function function) {
+        runtime::Method method;
+        method.name = name;
+        method.formal_params = std::move(params);
+        method.body = std::make_unique<NativeBody>(function);
+        return method;
+    }
+)";
+
+        // Записывает text литералом C++. Все символы вне печатных ASCII, кавычки, обратная косая черта
+        // и '?' передаются восьмеричными последовательностями из трёх цифр, поэтому следующий символ
+        // не продолжает последовательность
+        string Quote(string_view text) {
+            string result = "\"";
+            for (char c : text) {
+                const auto byte = static_cast<unsigned char>(c);
+                if (byte < 0x20 || byte > 0x7E || c == '"' || c == '\\' || c == '?') {
+                    char escaped[5];
+                    snprintf(escaped, sizeof(escaped), "\\%03o", byte);
+                    result += escaped;
+                }
+                else {
+                    result += c;
+                }
+            }
+            return result + '"';
+        }
+
+        string IntegerLiteral(int64_t value) {
+            if (value == numeric_limits<int64_t>::min()) {
+                return "std::numeric_limits<int64_t>::min()";
+            }
+            return "INT64_C(" + to_string(value) + ")";
+        }
+
+        string FloatLiteral(double value) {
+            if (std::isinf(value)) {
+                return value > 0 ? "std::numeric_limits<double>::infinity()"
+                                 : "-std::numeric_limits<double>::infinity()";
+            }
+            ostringstream out;
+            out << hexfloat << value;
+            return out.str();
+        }
+
+        const char* ArithmeticName(runtime::ArithmeticOp op) {
+            switch (op) {
+            case runtime::ArithmeticOp::Add:
+                return "runtime::ArithmeticOp::Add";
+            case runtime::ArithmeticOp::Sub:
+                return "runtime::ArithmeticOp::Sub";
+            case runtime::ArithmeticOp::Mult:
+                return "runtime::ArithmeticOp::Mult";
+            default:
+                return "runtime::ArithmeticOp::Div";
+            }
+        }
+
+        const char* CompareName(runtime::CompareOp op) {
+            switch (op) {
+            case runtime::CompareOp::Less:
+                return "runtime::CompareOp::Less";
+            case runtime::CompareOp::LessOrEqual:
+                return "runtime::CompareOp::LessOrEqual";
+            case runtime::CompareOp::Greater:
+                return "runtime::CompareOp::Greater";
+            case runtime::CompareOp::GreaterOrEqual:
+                return "runtime::CompareOp::GreaterOrEqual";
+            case runtime::CompareOp::Equal:
+                return "runtime::CompareOp::Equal";
+            default:
+                return "runtime::CompareOp::NotEqual";
+            }
+        }
+
+        // Значение выражения в выпущенном коде: имя переменной C++ или константы, которое можно читать
+        // до конца инструкции. Значение Bool хранится в bool без упаковки
+        struct Value {
+            string code;
+            bool is_bool = false;
+            bool is_string = false;     // значение заведомо String
+        };
+
+        // Возвращает true, если выражение всегда даёт Bool и может вычисляться как bool
+        bool IsBoolExpression(Executable& node) {
+            if (dynamic_cast<ast::Less*>(&node) || dynamic_cast<ast::LessOrEqual*>(&node)
+                || dynamic_cast<ast::Greater*>(&node) || dynamic_cast<ast::GreaterOrEqual*>(&node)
+                || dynamic_cast<ast::Equal*>(&node) || dynamic_cast<ast::NotEqual*>(&node)
+                || dynamic_cast<ast::Not*>(&node) || dynamic_cast<ast::Membership*>(&node)
+                || dynamic_cast<ast::BoolConst*>(&node)) {
+                return true;
+            }
+            // or и and возвращают один из операндов, поэтому Bool - только если оба операнда Bool
+            if (auto* or_operation = dynamic_cast<ast::Or*>(&node)) {
+                return IsBoolExpression(*or_operation->_lhs) && IsBoolExpression(*or_operation->_rhs);
+            }
+            if (auto* and_operation = dynamic_cast<ast::And*>(&node)) {
+                return IsBoolExpression(*and_operation->_lhs) && IsBoolExpression(*and_operation->_rhs);
+            }
+            return false;
+        }
+
+        // Выпускает текст модуля. Методы классов становятся функциями, программа - функцией __MODULE_ENTRY__
+        class Translator {
+        public:
+            string Translate(Executable& program) {
+                ostringstream main_body;
+                function_.out = &main_body;
+                Statement(program);
+
+                ostringstream module;
+                module << __MODULE_PRELUDE__ << '\n';
+                module << globals_.str();
+                if (!classes_.empty()) {
+                    module << "    const runtime::Class* g_classes[" << classes_.size() << "];\n";
+                }
+                module << '\n' << functions_.str();
+
+                module << "    // Создаёт классы программы в порядке объявления\n";
+                module << "    void CreateClasses([[maybe_unused]] std::vector<ObjectHolder>& classes) {\n";
+                module << class_definitions_.str();
+                module << "    }\n\n";
+                module << "}  // namespace\n\n";
+
+                module << "extern \"C\" void " << __MODULE_ENTRY__
+                       << "([[maybe_unused]] Closure& closure, [[maybe_unused]] Context& context, "
+                          "std::vector<ObjectHolder>& classes) {\n";
+                module << "    if (classes.empty()) {\n";
+                module << "        CreateClasses(classes);\n";
+                module << "    }\n";
+                if (!classes_.empty()) {
+                    module << "    for (size_t i = 0; i < classes.size(); ++i) {\n";
+                    module << "        g_classes[i] = classes[i].TryAs<runtime::Class>();\n";
+                    module << "    }\n";
+                }
+                if (!function_.hints.empty()) {
+                    module << "    uint32_t hints[" << function_.hints.size() << "] = {};\n";
+                }
+                DeclareLoops(module, 1);
+                module << main_body.str();
+                module << "}\n";
+                return module.str();
+            }
+
+        private:
+            // Переменная метода - локальная переменная C++
+            struct Local {
+                size_t index = 0;
+                bool always_defined = false;    // self и параметры определены с начала метода
+            };
+
+            // Состояние выпуска функции: метода либо программы
+            struct FunctionState {
+                ostringstream* out = nullptr;
+                int indent = 1;
+                size_t temporaries = 0;
+                size_t loop_depth = 0;
+                size_t max_loop_depth = 0;
+                // nullptr у программы, переменные которой живут в closure
+                const unordered_map<Symbol, Local>* locals = nullptr;
+                unordered_map<Symbol, uint32_t> hints;     // ячейки closure, в которых нашлись переменные программы
+                // переменные метода, которым значение присвоено на любом пути к текущей инструкции.
+                // Их чтение не проверяет признак определённости
+                unordered_set<Symbol> assigned;
+            };
+
+            // Инструкции
+
+            void Statement(Executable& node) {
+                if (auto* compound = dynamic_cast<ast::Compound*>(&node)) {
+                    for (const auto& statement : compound->GetStatements()) {
+                        Statement(*statement);
+                    }
+                }
+                else if (auto* if_else = dynamic_cast<ast::IfElse*>(&node)) {
+                    Open("{");
+                    Value condition = Expression(if_else->GetCondition());
+                    Open("if (" + Truth(condition) + ") {");
+                    const unordered_set<Symbol> before = function_.assigned;
+                    Statement(if_else->GetIfBody());
+                    unordered_set<Symbol> after_if = std::move(function_.assigned);
+                    function_.assigned = before;
+                    if (Executable* else_body = if_else->GetElseBody()) {
+                        Reopen("else {");
+                        Statement(*else_body);
+                        // после if определены переменные, которым присвоены значения в обеих ветках
+                        for (auto it = after_if.begin(); it != after_if.end();) {
+                            it = function_.assigned.count(*it) != 0 ? std::next(it) : after_if.erase(it);
+                        }
+                        function_.assigned = std::move(after_if);
+                    }
+                    Close();
+                    Close();
+                }
+                else if (auto* for_each = dynamic_cast<ast::ForEach*>(&node)) {
+                    Open("{");
+                    Value iterable = Expression(for_each->GetIterable());
+                    const string loop = "loops[" + to_string(function_.loop_depth) + "]";
+                    Line("bytecode::StartLoop(loops, " + Box(iterable) + ");");
+                    const string item = NewTemporary();
+                    Line("ObjectHolder " + item + ";");
+                    Open("while (bytecode::NextItem(" + loop + ", " + item + ")) {");
+                    function_.max_loop_depth = std::max(function_.max_loop_depth, ++function_.loop_depth);
+                    // тело цикла может не выполниться ни разу
+                    const unordered_set<Symbol> before = function_.assigned;
+                    StoreVariable(for_each->GetVar(), "std::move(" + item + ")");
+                    Statement(for_each->GetBody());
+                    function_.assigned = before;
+                    --function_.loop_depth;
+                    Close();
+                    Line("loops.pop_back();");
+                    Close();
+                }
+                else if (auto* return_statement = dynamic_cast<ast::Return*>(&node)) {
+                    Open("{");
+                    Value value = Expression(return_statement->GetValue());
+                    // return программы завершает её, как это делает дерево
+                    Line(function_.locals ? "return " + Box(value) + ";" : "return;");
+                    Close();
+                }
+                else if (auto* definition = dynamic_cast<ast::ClassDefinition*>(&node)) {
+                    const size_t index = DefineClass(definition->GetClass());
+                    StoreVariable(runtime::Symbol(definition->GetClass().GetName()), "classes[" + to_string(index) + "]");
+                }
+                else {
+                    // присваивание, print и выражение-инструкция: временные значения живут до конца блока
+                    Open("{");
+                    SimpleStatement(node);
+                    Close();
+                }
+            }
+
+            void SimpleStatement(Executable& node) {
+                if (auto* assignment = dynamic_cast<ast::Assignment*>(&node)) {
+                    Value value = Expression(assignment->GetValue());
+                    StoreVariable(assignment->GetVar(), Box(value));
+                }
+                else if (auto* field_assignment = dynamic_cast<ast::FieldAssignment*>(&node)) {
+                    Value object = Dotted(field_assignment->GetObject().GetDottedIds());
+                    Value value = Expression(field_assignment->GetValue());
+                    Line("StoreField(" + object.code + ", " + SymbolName(field_assignment->GetField()) + ", "
+                        + Box(value) + ");");
+                }
+                else if (auto* print = dynamic_cast<ast::Print*>(&node)) {
+                    // как и дерево, выводим каждый аргумент сразу после его вычисления
+                    Line("std::ostream& out = context.GetOutputStream();");
+                    const auto& args = print->GetArgs();
+                    for (size_t i = 0; i < args.size(); ++i) {
+                        Value item = Expression(*args[i]);
+                        Line("PrintItem(out, " + Box(item) + ", " + (i == 0 ? "true" : "false") + ", context);");
+                    }
+                    Line("out << '\\n';");
+                }
+                else {
+                    // значение выражения-инструкции отбрасывается
+                    Expression(node);
+                }
+            }
+
+            void StoreVariable(Symbol name, const string& value) {
+                if (!function_.locals) {
+                    Line("Store(closure, " + SymbolName(name) + ", " + Hint(name) + ", " + value + ");");
+                    return;
+                }
+                const Local& local = function_.locals->at(name);
+                Line("Assign(v" + to_string(local.index) + ", " + value + ");");
+                if (!local.always_defined) {
+                    Line("d" + to_string(local.index) + " = true;");
+                    function_.assigned.insert(name);
+                }
+            }
+
+            // Выражения
+
+            Value Expression(Executable& node) {
+                if (auto* number = dynamic_cast<ast::NumericConst*>(&node)) {
+                    return { NumberConstant(number->GetValue().GetValue()) };
+                }
+                if (auto* real = dynamic_cast<ast::FloatConst*>(&node)) {
+                    return { FloatConstant(real->GetValue().GetValue()) };
+                }
+                if (auto* str = dynamic_cast<ast::StringConst*>(&node)) {
+                    return { StringConstant(str->GetValue().View()), false, true };
+                }
+                if (auto* boolean = dynamic_cast<ast::BoolConst*>(&node)) {
+                    return { boolean->GetValue().GetValue() ? "true" : "false", true };
+                }
+                if (dynamic_cast<ast::None*>(&node)) {
+                    return { "none" };
+                }
+                if (auto* variable = dynamic_cast<ast::VariableValue*>(&node)) {
+                    return Dotted(variable->GetDottedIds());
+                }
+                if (std::optional<Value> value = Arithmetic<ast::Add>(node, runtime::ArithmeticOp::Add)) {
+                    return *value;
+                }
+                if (std::optional<Value> value = Arithmetic<ast::Sub>(node, runtime::ArithmeticOp::Sub)) {
+                    return *value;
+                }
+                if (std::optional<Value> value = Arithmetic<ast::Mult>(node, runtime::ArithmeticOp::Mult)) {
+                    return *value;
+                }
+                if (std::optional<Value> value = Arithmetic<ast::Div>(node, runtime::ArithmeticOp::Div)) {
+                    return *value;
+                }
+                if (std::optional<Value> value = Comparison<runtime::CompareOp::Less>(node)) {
+                    return *value;
+                }
+                if (std::optional<Value> value = Comparison<runtime::CompareOp::LessOrEqual>(node)) {
+                    return *value;
+                }
+                if (std::optional<Value> value = Comparison<runtime::CompareOp::Greater>(node)) {
+                    return *value;
+                }
+                if (std::optional<Value> value = Comparison<runtime::CompareOp::GreaterOrEqual>(node)) {
+                    return *value;
+                }
+                if (std::optional<Value> value = Comparison<runtime::CompareOp::Equal>(node)) {
+                    return *value;
+                }
+                if (std::optional<Value> value = Comparison<runtime::CompareOp::NotEqual>(node)) {
+                    return *value;
+                }
+                if (auto* or_operation = dynamic_cast<ast::Or*>(&node)) {
+                    return Logical(node, *or_operation->_lhs, *or_operation->_rhs, true);
+                }
+                if (auto* and_operation = dynamic_cast<ast::And*>(&node)) {
+                    return Logical(node, *and_operation->_lhs, *and_operation->_rhs, false);
+                }
+                if (auto* not_operation = dynamic_cast<ast::Not*>(&node)) {
+                    Value argument = Expression(*not_operation->_argument);
+                    return { BoolTemporary("!" + Truth(argument)), true };
+                }
+                if (auto* call = dynamic_cast<ast::MethodCall*>(&node)) {
+                    return MethodCall(*call);
+                }
+                if (auto* new_instance = dynamic_cast<ast::NewInstance*>(&node)) {
+                    return NewInstance(*new_instance);
+                }
+                if (auto* new_list = dynamic_cast<ast::NewList*>(&node)) {
+                    const string items = NewTemporary();
+                    Line("std::vector<ObjectHolder> " + items + ";");
+                    Line(items + ".reserve(" + to_string(new_list->GetItems().size()) + ");");
+                    for (const auto& item : new_list->GetItems()) {
+                        Value value = Expression(*item);
+                        Line(items + ".push_back(" + Box(value) + ");");
+                    }
+                    return { Temporary("ObjectHolder::Own(runtime::List(std::move(" + items + ")))") };
+                }
+                if (auto* new_dict = dynamic_cast<ast::NewDict*>(&node)) {
+                    const string result = Temporary("ObjectHolder::Own(runtime::Dict())");
+                    for (const auto& [key, value] : new_dict->GetItems()) {
+                        Value key_value = Expression(*key);
+                        Value item_value = Expression(*value);
+                        Line(result + ".TryAs<runtime::Dict>()->Set(" + Box(key_value) + ", " + Box(item_value)
+                            + ", context);");
+                    }
+                    return { result };
+                }
+                if (auto* stringify = dynamic_cast<ast::Stringify*>(&node)) {
+                    Value argument = Expression(*stringify->_argument);
+                    return { Temporary("ast::Stringify::Evaluate(" + Box(argument) + ", context)"), false, true };
+                }
+                if (auto* length = dynamic_cast<ast::Length*>(&node)) {
+                    Value argument = Expression(*length->_argument);
+                    return { Temporary("ast::Length::Evaluate(" + Box(argument) + ")") };
+                }
+                if (auto* int_array = dynamic_cast<ast::NewIntArray*>(&node)) {
+                    Value argument = Expression(*int_array->_argument);
+                    return { Temporary("ast::NewIntArray::Evaluate(" + Box(argument) + ")") };
+                }
+                if (auto* float_array = dynamic_cast<ast::NewFloatArray*>(&node)) {
+                    Value argument = Expression(*float_array->_argument);
+                    return { Temporary("ast::NewFloatArray::Evaluate(" + Box(argument) + ")") };
+                }
+                if (auto* index = dynamic_cast<ast::Index*>(&node)) {
+                    Value object = Expression(*index->_lhs);
+                    Value position = Expression(*index->_rhs);
+                    return { Temporary("ast::Index::Evaluate(" + Box(object) + ", " + Box(position) + ", context)") };
+                }
+                if (auto* membership = dynamic_cast<ast::Membership*>(&node)) {
+                    Value item = Expression(*membership->_lhs);
+                    Value container = Expression(*membership->_rhs);
+                    return { BoolTemporary("ast::Membership::Contains(" + Box(item) + ", " + Box(container)
+                                 + ", context)"),
+                        true };
+                }
+                if (auto* index_assignment = dynamic_cast<ast::IndexAssignment*>(&node)) {
+                    Value object = Expression(index_assignment->GetObject());
+                    Value position = Expression(index_assignment->GetIndex());
+                    // как и дерево, проверяем объект до вычисления значения
+                    Line("ast::IndexAssignment::CheckTarget(" + Box(object) + ", " + Box(position) + ");");
+                    Value value = Expression(index_assignment->GetValue());
+                    return { Temporary("ast::IndexAssignment::Assign(" + Box(object) + ", " + Box(position) + ", "
+                        + Box(value) + ", context)") };
+                }
+                if (auto* sort = dynamic_cast<ast::SortList*>(&node)) {
+                    Value list = Expression(sort->GetList());
+                    string key = "nullptr";
+                    if (Executable* key_node = sort->GetKey()) {
+                        key = "&" + Temporary(Box(Expression(*key_node)));
+                    }
+                    Line("ast::SortList::Sort(" + Box(list) + ", " + key + ", context);");
+                    return { "none" };
+                }
+                throw std::runtime_error("Translation to C++ is not supported for "s + typeid(node).name());
+            }
+
+            // Цепочка a.b.c. Первое имя - переменная, остальные - поля. Последнее поле копируется:
+            // вычисление остальной части выражения может присвоить ему новое значение
+            Value Dotted(const vector<Symbol>& ids) {
+                Value object = { Variable(ids.front()) };
+                for (size_t i = 1; i < ids.size(); ++i) {
+                    const string field = "bytecode::LoadField(" + object.code + ", " + SymbolName(ids[i]) + ")";
+                    object.code = i + 1 == ids.size() ? Temporary(field) : Reference(field);
+                }
+                return object;
+            }
+
+            string Variable(Symbol name) {
+                if (!function_.locals) {
+                    return Reference("Load(closure, " + SymbolName(name) + ", " + Hint(name) + ")");
+                }
+                auto found = function_.locals->find(name);
+                if (found == function_.locals->end()) {
+                    // кадр метода видит только self, параметры и собственные переменные
+                    return Reference("Undefined()");
+                }
+                const string variable = "v" + to_string(found->second.index);
+                if (found->second.always_defined || function_.assigned.count(name) != 0) {
+                    return variable;
+                }
+                return Reference("Defined(" + variable + ", d" + to_string(found->second.index) + ")");
+            }
+
+            template <typename Node>
+            std::optional<Value> Arithmetic(Executable& node, runtime::ArithmeticOp op) {
+                auto* operation = dynamic_cast<Node*>(&node);
+                if (!operation) {
+                    return std::nullopt;
+                }
+                Value lhs = Expression(*operation->_lhs);
+                // с числовой константой тип проверяется только у левого аргумента
+                if (auto* number = dynamic_cast<ast::NumericConst*>(operation->_rhs.get())) {
+                    const int64_t value = number->GetValue().GetValue();
+                    return Value{ Temporary("ArithmeticNumber<"s + ArithmeticName(op) + ">(" + Box(lhs) + ", "
+                        + NumberConstant(value) + ", " + IntegerLiteral(value) + ", context)") };
+                }
+                Value rhs = Expression(*operation->_rhs);
+                if (op == runtime::ArithmeticOp::Add && (lhs.is_string || rhs.is_string)) {
+                    // сумма двух заведомых строк - тоже строка
+                    return Value{ Temporary("ConcatStrings(" + Box(lhs) + ", " + Box(rhs) + ", context)"), false,
+                        lhs.is_string && rhs.is_string };
+                }
+                return Value{ Temporary("bytecode::ArithmeticValues("s + ArithmeticName(op) + ", " + Box(lhs) + ", "
+                    + Box(rhs) + ", context)") };
+            }
+
+            template <runtime::CompareOp op>
+            std::optional<Value> Comparison(Executable& node) {
+                auto* comparison = dynamic_cast<ast::Comparison<op>*>(&node);
+                if (!comparison) {
+                    return std::nullopt;
+                }
+                Value lhs = Expression(*comparison->_lhs);
+                if (auto* number = dynamic_cast<ast::NumericConst*>(comparison->_rhs.get())) {
+                    const int64_t value = number->GetValue().GetValue();
+                    return Value{ BoolTemporary("CompareNumber<"s + CompareName(op) + ">(" + Box(lhs) + ", "
+                                      + NumberConstant(value) + ", " + IntegerLiteral(value) + ", context)"),
+                        true };
+                }
+                Value rhs = Expression(*comparison->_rhs);
+                return Value{ BoolTemporary("bytecode::CompareValues("s + CompareName(op) + ", " + Box(lhs) + ", "
+                                  + Box(rhs) + ", context)"),
+                    true };
+            }
+
+            // or и and: правый операнд вычисляется, только если левый не решает исход
+            Value Logical(Executable& node, Executable& lhs_node, Executable& rhs_node, bool is_or) {
+                const bool is_bool = IsBoolExpression(node);
+                Value lhs = Expression(lhs_node);
+                const string result = NewTemporary();
+                string condition;
+                if (is_bool) {
+                    Line("bool " + result + " = " + lhs.code + ";");
+                    condition = is_or ? "!" + result : result;
+                }
+                else {
+                    Line("ObjectHolder " + result + " = " + Box(lhs) + ";");
+                    condition = (is_or ? "!runtime::IsTrue(" : "runtime::IsTrue(") + result + ")";
+                }
+                Open("if (" + condition + ") {");
+                Value rhs = Expression(rhs_node);
+                Line(result + " = " + (is_bool ? rhs.code : Box(rhs)) + ";");
+                Close();
+                return { result, is_bool };
+            }
+
+            Value MethodCall(ast::MethodCall& call) {
+                Value object = Expression(call.GetObject());
+                const string holder = Box(object);
+                const string result = NewTemporary();
+                const auto& args = call.GetArgs();
+                Line("ObjectHolder " + result + ";");
+                Open("if (CallsMethod(" + holder + ", " + SymbolName(call.GetMethod()) + ", " + to_string(args.size())
+                    + ")) {");
+                const string arguments = Arguments(args);
+                Line(result + " = bytecode::CallMethod(" + holder + ", " + SymbolName(call.GetMethod()) + ", "
+                    + arguments + ", " + to_string(args.size()) + ", context);");
+                Close();
+                return { result };
+            }
+
+            Value NewInstance(ast::NewInstance& node) {
+                auto found = class_indices_.find(&node.GetClass());
+                if (found == class_indices_.end()) {
+                    throw std::runtime_error("Class " + node.GetClass().GetName() + " is not declared in the program");
+                }
+                const string result = Temporary("ObjectHolder::Own(runtime::ClassInstance(*g_classes["
+                    + to_string(found->second) + "]))");
+                // конструктор вызывается, только если у класса есть __init__ с тем же числом параметров.
+                // Иначе аргументы не вычисляются вовсе
+                const runtime::Method* init = node.GetClass().GetMethod(runtime::__INIT_METHOD__);
+                const auto& args = node.GetArgs();
+                if (init != nullptr && init->formal_params.size() == args.size()) {
+                    const string arguments = Arguments(args);
+                    Line("static_cast<runtime::ClassInstance*>(" + result + ".Get())->Call("
+                        + SymbolName(runtime::__INIT_METHOD__) + ", " + arguments + ", " + to_string(args.size())
+                        + ", context);");
+                }
+                return { result };
+            }
+
+            // Вычисляет аргументы в массив и возвращает его имя
+            string Arguments(const vector<unique_ptr<Executable>>& args) {
+                if (args.empty()) {
+                    return "nullptr";
+                }
+                string list;
+                for (const auto& arg : args) {
+                    Value value = Expression(*arg);
+                    list += (list.empty() ? "" : ", ") + Box(value);
+                }
+                const string array = NewTemporary();
+                Line("const ObjectHolder " + array + "[] = { " + list + " };");
+                return array;
+            }
+
+            // Классы
+
+            size_t DefineClass(runtime::Class& cls) {
+                const size_t index = classes_.size();
+                classes_.push_back(&cls);
+                class_indices_[&cls] = index;
+
+                string parent = "nullptr";
+                if (const runtime::Class* base = cls.GetParent()) {
+                    auto found = class_indices_.find(base);
+                    if (found == class_indices_.end()) {
+                        throw std::runtime_error("Class " + base->GetName() + " is not declared in the program");
+                    }
+                    parent = "classes[" + to_string(found->second) + "].TryAs<runtime::Class>()";
+                }
+
+                // методы переводятся в собственные функции, выпуск программы продолжится с того же места
+                FunctionState program = std::move(function_);
+                ostringstream methods;
+                size_t number = 0;
+                for (runtime::Method& method : cls.GetMethods()) {
+                    const string function = "Method" + to_string(index) + "_" + to_string(number++);
+                    TranslateMethod(method, function);
+                    string params;
+                    for (Symbol param : method.formal_params) {
+                        params += (params.empty() ? "" : ", ") + SymbolName(param);
+                    }
+                    methods << "            methods.push_back(MakeMethod(" << SymbolName(method.name) << ", { " << params
+                            << " }, " << function << "));\n";
+                }
+                function_ = std::move(program);
+
+                class_definitions_ << "        {\n";
+                class_definitions_ << "            // " << cls.GetName() << '\n';
+                class_definitions_ << "            std::vector<runtime::Method> methods;\n";
+                class_definitions_ << methods.str();
+                class_definitions_ << "            classes.push_back(ObjectHolder::Own(runtime::Class(" << Quote(cls.GetName())
+                                   << ", std::move(methods), " << parent << ")));\n";
+                class_definitions_ << "        }\n";
+                return index;
+            }
+
+            void TranslateMethod(runtime::Method& method, const string& function) {
+                auto* body = dynamic_cast<ast::MethodBody*>(method.body.get());
+                if (!body) {
+                    throw std::runtime_error("Method " + method.name.Name() + " is not a parsed method body");
+                }
+                // self и параметры копируются из кадра, остальные переменные метода получают значение позже
+                unordered_map<Symbol, Local> locals;
+                locals.emplace(runtime::__SELF_NAME__, Local{ 0, true });
+                for (Symbol param : method.formal_params) {
+                    locals.emplace(param, Local{ locals.size(), true });
+                }
+                CollectLocals(body->GetBody(), locals);
+
+                ostringstream text;
+                function_ = FunctionState{};
+                function_.out = &text;
+                function_.indent = 2;
+                function_.locals = &locals;
+                Statement(body->GetBody());
+                Line("return none;");
+
+                vector<pair<Symbol, Local>> ordered(locals.begin(), locals.end());
+                sort(ordered.begin(), ordered.end(), [](const auto& lhs, const auto& rhs) {
+                    return lhs.second.index < rhs.second.index;
+                });
+                functions_ << "    // " << method.name.Name() << '\n';
+                functions_ << "    ObjectHolder " << function << "([[maybe_unused]] Closure& frame, "
+                              "[[maybe_unused]] Context& context) {\n";
+                for (const auto& [name, local] : ordered) {
+                    const string variable = "v" + to_string(local.index);
+                    if (local.always_defined) {
+                        functions_ << "        ObjectHolder " << variable << " = bytecode::LoadVariable(frame, "
+                                   << SymbolName(name) << ");   // " << name.Name() << '\n';
+                    }
+                    else {
+                        functions_ << "        ObjectHolder " << variable << ";   // " << name.Name() << '\n';
+                        functions_ << "        bool d" << local.index << " = false;\n";
+                    }
+                }
+                DeclareLoops(functions_, 2);
+                functions_ << text.str();
+                functions_ << "    }\n\n";
+            }
+
+            // Добавляет в locals переменные, которым метод присваивает значения
+            static void CollectLocals(Executable& node, unordered_map<Symbol, Local>& locals) {
+                auto add = [&locals](Symbol name) {
+                    locals.emplace(name, Local{ locals.size(), false });
+                };
+                if (auto* compound = dynamic_cast<ast::Compound*>(&node)) {
+                    for (const auto& statement : compound->GetStatements()) {
+                        CollectLocals(*statement, locals);
+                    }
+                }
+                else if (auto* assignment = dynamic_cast<ast::Assignment*>(&node)) {
+                    add(assignment->GetVar());
+                }
+                else if (auto* if_else = dynamic_cast<ast::IfElse*>(&node)) {
+                    CollectLocals(if_else->GetIfBody(), locals);
+                    if (Executable* else_body = if_else->GetElseBody()) {
+                        CollectLocals(*else_body, locals);
+                    }
+                }
+                else if (auto* for_each = dynamic_cast<ast::ForEach*>(&node)) {
+                    add(for_each->GetVar());
+                    CollectLocals(for_each->GetBody(), locals);
+                }
+            }
+
+            // Состояние циклов for выпускаемой функции
+            void DeclareLoops(ostringstream& out, int indent) const {
+                if (function_.max_loop_depth == 0) {
+                    return;
+                }
+                const string margin(static_cast<size_t>(indent) * 4, ' ');
+                out << margin << "std::vector<bytecode::Loop> loops;\n";
+                out << margin << "loops.reserve(" << function_.max_loop_depth << ");\n";
+            }
+
+            // Текст
+
+            string NewTemporary() {
+                return "t" + to_string(function_.temporaries++);
+            }
+            string Temporary(const string& init) {
+                const string name = NewTemporary();
+                Line("const ObjectHolder " + name + " = " + init + ";");
+                return name;
+            }
+            // Ссылка на переменную, которую не может изменить остальная часть выражения
+            string Reference(const string& init) {
+                const string name = NewTemporary();
+                Line("const ObjectHolder& " + name + " = " + init + ";");
+                return name;
+            }
+            string BoolTemporary(const string& init) {
+                const string name = NewTemporary();
+                Line("const bool " + name + " = " + init + ";");
+                return name;
+            }
+
+            static string Box(const Value& value) {
+                return value.is_bool ? "runtime::MakeBool(" + value.code + ")" : value.code;
+            }
+            static string Truth(const Value& value) {
+                return value.is_bool ? value.code : "runtime::IsTrue(" + value.code + ")";
+            }
+
+            string SymbolName(Symbol name) {
+                auto [it, added] = symbols_.emplace(name, symbols_.size());
+                if (added) {
+                    globals_ << "    const runtime::Symbol s" << it->second << "(" << Quote(name.Name()) << ");\n";
+                }
+                return "s" + to_string(it->second);
+            }
+
+            string Hint(Symbol name) {
+                auto [it, added] = function_.hints.emplace(name, static_cast<uint32_t>(function_.hints.size()));
+                return "hints[" + to_string(it->second) + "]";
+            }
+
+            string NumberConstant(int64_t value) {
+                return Constant(numbers_, value, "runtime::Number", IntegerLiteral(value));
+            }
+            string FloatConstant(double value) {
+                return Constant(floats_, value, "runtime::Float", FloatLiteral(value));
+            }
+            string StringConstant(string_view value) {
+                return Constant(strings_, string(value), "runtime::String",
+                    "runtime::String::Intern(std::string_view(" + Quote(value) + ", " + to_string(value.size()) + "))");
+            }
+
+            // Константа живёт до выгрузки модуля и разделяется без владения, как константа дерева
+            template <typename Key>
+            string Constant(map<Key, size_t>& table, const Key& key, const char* type, const string& init) {
+                auto [it, added] = table.emplace(key, constants_);
+                if (added) {
+                    ++constants_;
+                    globals_ << "    " << type << " c" << it->second << " = " << init << ";\n";
+                    globals_ << "    const ObjectHolder k" << it->second << " = ObjectHolder::Share(c" << it->second
+                             << ");\n";
+                }
+                return "k" + to_string(it->second);
+            }
+
+            void Line(const string& text) {
+                *function_.out << string(static_cast<size_t>(function_.indent) * 4, ' ') << text << '\n';
+            }
+            void Open(const string& text) {
+                Line(text);
+                ++function_.indent;
+            }
+            void Reopen(const string& text) {
+                --function_.indent;
+                Line("}");
+                Open(text);
+            }
+            void Close() {
+                --function_.indent;
+                Line("}");
+            }
+
+            ostringstream globals_;             // символы, константы
+            ostringstream functions_;
+            ostringstream class_definitions_;   // тело CreateClasses
+
+            unordered_map<Symbol, size_t> symbols_;
+            map<int64_t, size_t> numbers_;
+            map<double, size_t> floats_;
+            map<string, size_t> strings_;
+            size_t constants_ = 0;
+
+            vector<const runtime::Class*> classes_;
+            unordered_map<const runtime::Class*, size_t> class_indices_;
+
+            FunctionState function_;   // выпускаемая функция
+        };
+
+        // Каталог исходников интерпретатора с заголовками, которые включает модуль. Без макроса
+        // MYTHON_AOT_INCLUDE_DIR берётся каталог из __FILE__, но только абсолютный: относительный путь
+        // отсчитывается от каталога сборки, а модуль собирается из текущего каталога процесса
+        string SourceDirectory() {
+#ifdef MYTHON_AOT_INCLUDE_DIR
+            return MYTHON_AOT_INCLUDE_DIR;
+#else
+            const std::filesystem::path file(__FILE__);
+            if (!file.is_absolute()) {
+                throw std::runtime_error("Mython headers directory is unknown: set BuildOptions::include_dir "
+                    "or build with -DMYTHON_AOT_INCLUDE_DIR=\"<directory>\"");
+            }
+            return file.parent_path().string();
+#endif
+        }
+
+        // Заключает аргумент команды в одинарные кавычки оболочки
+        string ShellQuote(const string& arg) {
+            string result = "'";
+            for (char c : arg) {
+                if (c == '\'') {
+                    result += "'\\''";
+                }
+                else {
+                    result += c;
+                }
+            }
+            return result + "'";
+        }
+
+    }  // namespace
+
+    string TranslateProgram(Executable& program) {
+        return Translator().Translate(program);
+    }
+
+    void BuildModule(const string& source, const string& library, const BuildOptions& options) {
+        const string source_path = library + ".cpp";
+        {
+            ofstream out(source_path);
+            out << source;
+            if (!out) {
+                throw std::runtime_error("Can't write module source " + source_path);
+            }
+        }
+#ifdef MYTHON_AOT_DLOPEN
+        const string include_dir = options.include_dir.empty() ? SourceDirectory() : options.include_dir;
+        const string command = options.compiler + " " + options.flags + " -fPIC -shared -I" + ShellQuote(include_dir)
+            + " -o " + ShellQuote(library) + " " + ShellQuote(source_path) + " 2>&1";
+        FILE* pipe = popen(command.c_str(), "r");
+        if (!pipe) {
+            throw std::runtime_error("Can't run " + options.compiler);
+        }
+        // вывод компилятора попадает в сообщение об ошибке
+        string log;
+        char buffer[4096];
+        size_t size = 0;
+        while ((size = fread(buffer, 1, sizeof(buffer), pipe)) > 0) {
+            log.append(buffer, size);
+        }
+        if (pclose(pipe) != 0) {
+            throw std::runtime_error("Module build failed: " + command + "\n" + log);
+        }
+#else
+        throw std::runtime_error("Native modules are not supported on this platform");
+#endif
+    }
+
+    bool CanLoadModules() {
+#ifdef MYTHON_AOT_DLOPEN
+        return dlsym(RTLD_DEFAULT, "mython_aot_host") != nullptr;
+#else
+        return false;
+#endif
+    }
+
+    unique_ptr<Module> Module::Load(const string& library) {
+#ifdef MYTHON_AOT_DLOPEN
+        // имя без каталога dlopen искал бы среди системных библиотек
+        const string path = library.find('/') == string::npos ? "./" + library : library;
+        void* handle = dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+        if (!handle) {
+            string message = "Can't load module "s + library + ": " + dlerror();
+            if (!CanLoadModules()) {
+                message += " (the interpreter must be linked with -rdynamic)";
+            }
+            throw std::runtime_error(message);
+        }
+        auto entry = reinterpret_cast<Entry>(dlsym(handle, __MODULE_ENTRY__));
+        if (!entry) {
+            dlclose(handle);
+            throw std::runtime_error("Module " + library + " has no entry point "s + __MODULE_ENTRY__);
+        }
+        return unique_ptr<Module>(new Module(handle, entry));
+#else
+        throw std::runtime_error("Native modules are not supported on this platform: " + library);
+#endif
+    }
+
+    Module::Module(void* handle, Entry entry)
+        : _handle(handle)
+        , _entry(entry) {
+    }
+
+    Module::~Module() {
+        // тела методов классов - код библиотеки, поэтому классы удаляются до её выгрузки
+        _classes.clear();
+#ifdef MYTHON_AOT_DLOPEN
+        dlclose(_handle);
+#endif
+    }
+
+    runtime::ObjectHolder Module::Execute(runtime::Closure& closure, runtime::Context& context) {
+        _entry(closure, context, _classes);
+        return runtime::ObjectHolder::None();
+    }
+
+    unique_ptr<Module> CompileProgram(Executable& program, const string& library, const BuildOptions& options) {
+        BuildModule(TranslateProgram(program), library, options);
+        return Module::Load(library);
+    }
+
+}  // namespace aot
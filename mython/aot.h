@@ -0,0 +1,74 @@
+#pragma once
+
+#include "runtime.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace aot {
+
+    /*
+     * Переводит программу, разобранную ParseProgram, в исходный текст модуля C++. Модуль вызывает
+     * функции runtime и bytecode напрямую: переменные методов становятся локальными переменными C++,
+     * if, for и return - операторами C++, а сравнения, not и in, результат которых заведомо Bool,
+     * вычисляются как bool без упаковки в объект. Арифметика и сравнение с числовой константой проверяют
+     * тип одного аргумента и считают в int64_t, сложение заведомых строк склеивает их без общей арифметики,
+     * в остальных случаях работают общие функции runtime.
+     * Модуль не зависит от дерева: после сборки дерево можно удалить.
+     * Для узлов, которых транслятор не знает, выбрасывает runtime_error
+     */
+    [[nodiscard]] std::string TranslateProgram(runtime::Executable& program);
+
+    // Параметры сборки модуля системным компилятором
+    struct BuildOptions {
+        std::string compiler = "c++";
+        std::string flags = "-std=c++17 -O2";
+        // Каталог с runtime.h, statement.h и bytecode.h. Пустая строка - каталог исходников интерпретатора,
+        // заданный при сборке макросом MYTHON_AOT_INCLUDE_DIR, например -DMYTHON_AOT_INCLUDE_DIR='"/src/mython"'.
+        // Без макроса каталог известен, только если aot.cpp компилировался по абсолютному пути,
+        // иначе BuildModule выбрасывает runtime_error
+        std::string include_dir;
+    };
+
+    // Собирает исходный текст модуля source в разделяемую библиотеку library. Текст сохраняется рядом
+    // с ней в файле library + ".cpp". При ошибке компилятора выбрасывает runtime_error с его выводом
+    void BuildModule(const std::string& source, const std::string& library, const BuildOptions& options = {});
+
+    // Возвращает true, если исполняемый файл экспортирует символы runtime (собран с -rdynamic),
+    // и загруженный модуль сможет их найти
+    [[nodiscard]] bool CanLoadModules();
+
+    /*
+     * Загруженный модуль. Выполнение создаёт при первом запуске классы программы, тела методов которых -
+     * функции модуля, и выполняет программу в closure, как это делает дерево.
+     * Код и классы принадлежат модулю, поэтому таблицы символов со значениями программы должны быть
+     * уничтожены раньше него
+     */
+    class Module : public runtime::Executable {
+    public:
+        // Загружает библиотеку, собранную BuildModule. Если библиотека не загружается, выбрасывает runtime_error
+        [[nodiscard]] static std::unique_ptr<Module> Load(const std::string& library);
+
+        Module(const Module&) = delete;
+        Module& operator=(const Module&) = delete;
+        ~Module() override;
+
+        runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+
+    private:
+        using Entry = void (*)(runtime::Closure& closure, runtime::Context& context,
+            std::vector<runtime::ObjectHolder>& classes);
+
+        Module(void* handle, Entry entry);
+
+        void* _handle;
+        Entry _entry;
+        std::vector<runtime::ObjectHolder> _classes;    // классы программы, созданные модулем
+    };
+
+    // Переводит program, собирает библиотеку library и загружает её
+    [[nodiscard]] std::unique_ptr<Module> CompileProgram(runtime::Executable& program, const std::string& library,
+        const BuildOptions& options = {});
+
+}  // namespace aot
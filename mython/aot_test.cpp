@@ -0,0 +1,199 @@
+#include "aot.h"
+#include "lexer.h"
+#include "parse.h"
+#include "regvm.h"
+#include "test_runner_p.h"
+
+#include <filesystem>
+
+using namespace std;
+
+namespace aot {
+
+    namespace {
+
+        unique_ptr<runtime::Executable> Parse(const string& program) {
+            istringstream input(program);
+            parse::Lexer lexer(input);
+            return ParseProgram(lexer);
+        }
+
+        string RunTree(const string& program) {
+            runtime::DummyContext context;
+            runtime::Closure closure;
+            Parse(program)->Execute(closure, context);
+            return context.output.str();
+        }
+
+        bool Contains(const string& text, const string& part) {
+            return text.find(part) != string::npos;
+        }
+
+        const string __COUNTER_PROGRAM__ = R"(
+class Counter:
+  def __init__():
+    self.value = 0
+
+  def add(n):
+    if n > 2 and n < 9:
+      self.value = self.value + n * 2
+    else:
+      self.value = self.value - 1
+    return self
+
+  def total(items):
+    sum = 0
+    for item in items:
+      sum = sum + item
+      last = item
+    return sum + last
+
+class Named(Counter):
+  def __init__(name):
+    self.value = 0
+    self.name = name
+
+  def __str__():
+    return self.name + '="' + str(self.value) + '"'
+
+c = Named('c')
+for i in [1, 2, 3, 4, 5, 6, 7, 8, 9, 10]:
+  c.add(i)
+print c, c.total([1, 2, 3]), not c.value or 'set', 3 in [1, 2, 3], len('abc'), 7 / 2, 1.5 * 2
+)"s;
+
+        void TestTranslation() {
+            const string source = TranslateProgram(*Parse(__COUNTER_PROGRAM__));
+
+            // сравнение и арифметика с константой проверяют тип только левого аргумента
+            ASSERT(Contains(source, "CompareNumber<runtime::CompareOp::Greater>("s));
+            ASSERT(Contains(source, "ArithmeticNumber<runtime::ArithmeticOp::Mult>("s));
+            ASSERT(Contains(source, "bytecode::ArithmeticValues(runtime::ArithmeticOp::Add, "s));
+            // сложение со строковой константой склеивает строки без общей арифметики
+            ASSERT(Contains(source, "ConcatStrings("s));
+            // условие из двух сравнений вычисляется в bool без упаковки
+            ASSERT(Contains(source, "const bool t"s));
+            ASSERT(Contains(source, "bool t1 = t0;"s));
+            ASSERT(!Contains(source, "runtime::IsTrue(t1)"s));
+
+            // параметры и переменные метода - локальные переменные C++
+            ASSERT(Contains(source, "ObjectHolder v1 = bytecode::LoadVariable(frame, "s));
+            ASSERT(Contains(source, "ObjectHolder v2;   // sum"s));
+            // sum присвоено до цикла, last - только в его теле
+            ASSERT(!Contains(source, "Defined(v2, d2)"s));
+            ASSERT(Contains(source, "Defined(v4, d4)"s));
+
+            // класс-наследник ссылается на уже созданного родителя
+            ASSERT(Contains(source, "runtime::Class(\"Named\", std::move(methods), classes[0].TryAs<runtime::Class>())"s));
+            // кавычки строк передаются восьмеричными последовательностями
+            ASSERT(Contains(source, "std::string_view(\"=\\042\", 2)"s));
+            ASSERT(Contains(source, "extern \"C\" void mython_main("s));
+
+            // объект проверяется до вычисления присваиваемого значения, как в дереве
+            const string assignment = TranslateProgram(*Parse("x = [1]\nx[0] = len(x)\n"s));
+            const size_t check = assignment.find("ast::IndexAssignment::CheckTarget(");
+            ASSERT(check != string::npos);
+            ASSERT(check < assignment.find("ast::Length::Evaluate("));
+        }
+
+        void TestUnsupportedNodes() {
+            // тела, уже скомпилированные для виртуальной машины, дереву не принадлежат
+            ASSERT_THROWS((void)TranslateProgram(*regvm::CompileProgram(Parse("x = 1\n"s))), std::runtime_error);
+            ASSERT_THROWS((void)Module::Load("missing-mython-module.so"s), std::runtime_error);
+
+            const string empty = TranslateProgram(*Parse("print\n"s));
+            ASSERT(!Contains(empty, "g_classes"s));
+            ASSERT(!Contains(empty, "loops"s));
+        }
+
+        // Собирает программу в каталоге временных файлов
+        unique_ptr<Module> Build(const string& program, const string& name) {
+            const filesystem::path library = filesystem::temp_directory_path() / ("mython_aot_" + name + ".so");
+            return CompileProgram(*Parse(program), library.string());
+        }
+
+        void TestModuleMatchesInterpreter() {
+            if (!CanLoadModules()) {
+                // без -rdynamic модуль не находит функции runtime, и загрузка сообщает об этом
+                ASSERT_THROWS((void)Build("print 1\n"s, "unavailable"s), std::runtime_error);
+                return;
+            }
+            auto module = Build(__COUNTER_PROGRAM__, "counter"s);
+            runtime::DummyContext context;
+            runtime::Closure closure;
+            module->Execute(closure, context);
+            ASSERT_EQUAL(context.output.str(), RunTree(__COUNTER_PROGRAM__));
+            ASSERT_EQUAL(context.output.str(), "c=\"62\" 9 set True 3 3 3.0\n"s);
+
+            // переменные программы остаются в closure, тела методов - функции модуля
+            const auto* counter = closure.at(runtime::Symbol("c")).TryAs<runtime::ClassInstance>();
+            ASSERT(counter != nullptr);
+            ASSERT_EQUAL(counter->Fields().at(runtime::Symbol("name")).TryAs<runtime::String>()->GetValue(), "c"s);
+            const auto* named = closure.at(runtime::Symbol("Named")).TryAs<runtime::Class>();
+            ASSERT(named != nullptr && named->GetParent() == closure.at(runtime::Symbol("Counter")).TryAs<runtime::Class>());
+            ASSERT(named->GetMethod(runtime::Symbol("add")) != nullptr);
+            closure.clear();
+        }
+
+        void TestModuleErrors() {
+            if (!CanLoadModules()) {
+                return;
+            }
+            const string program = R"(
+class Walker:
+  def broken(flag):
+    if flag:
+      x = 1
+    return x
+
+  def deep(n):
+    return self.deep(n + 1)
+
+w = Walker()
+print w.broken(True)
+x = 1
+x.field = 2
+)"s;
+            auto module = Build(program, "errors"s);
+            runtime::DummyContext context;
+            runtime::Closure closure;
+            ASSERT_THROWS(module->Execute(closure, context), std::runtime_error);
+            ASSERT_EQUAL(context.output.str(), "1\n"s);
+
+            // переменная, присвоенная не на всех путях, проверяется при чтении
+            auto broken = Build("class W:\n  def f(flag):\n    if flag:\n      x = 1\n    return x\n\nw = W()\nprint w.f(False)\n"s,
+                "undefined"s);
+            runtime::Closure broken_closure;
+            ASSERT_THROWS(broken->Execute(broken_closure, context), std::runtime_error);
+
+            auto deep = Build(program.substr(0, program.find("w = Walker()")) + "w = Walker()\nw.deep(0)\n"s, "deep"s);
+            runtime::Closure deep_closure;
+            ASSERT_THROWS(deep->Execute(deep_closure, context), runtime::RecursionError);
+
+            // значение не вычисляется, если объект не поддерживает присваивание по индексу
+            auto order = Build("class P:\n  def touch():\n    print 'touched'\n    return 1\n\np = P()\nx = 5\nx[0] = p.touch()\n"s,
+                "order"s);
+            runtime::DummyContext order_context;
+            runtime::Closure order_closure;
+            ASSERT_THROWS(order->Execute(order_closure, order_context), std::runtime_error);
+            ASSERT(order_context.output.str().empty());
+
+            // тело цикла добавляет ключи в обходимый словарь
+            auto grow = Build("d = {1: 1}\nfor k in d:\n  d[k + 1] = 1\n"s, "grow"s);
+            runtime::Closure grow_closure;
+            ASSERT_THROWS(grow->Execute(grow_closure, context), std::runtime_error);
+        }
+
+    }  // namespace
+
+    void RunAotTests(TestRunner& tr) {
+        RUN_TEST(tr, aot::TestTranslation);
+        RUN_TEST(tr, aot::TestUnsupportedNodes);
+    }
+
+    void RunAotBuildTests(TestRunner& tr) {
+        RUN_TEST(tr, aot::TestModuleMatchesInterpreter);
+        RUN_TEST(tr, aot::TestModuleErrors);
+    }
+
+}  // namespace aot
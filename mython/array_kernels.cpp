@@ -0,0 +1,445 @@
+#include "array_kernels.h"
+#include "bigint.h"
+
+#include <algorithm>
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define MYTHON_KERNELS_AVX2 1
+#include <immintrin.h>
+#endif
+
+namespace runtime::kernels {
+
+    namespace {
+
+        // Скалярные версии ядер, развёрнутые на четыре независимых аккумулятора.
+        // Переполнение аккумулятора запоминается флагом и проверяется один раз в конце
+
+        bool SumScalar(const int64_t* data, size_t size, size_t from, int64_t& result) {
+            int64_t acc0 = 0, acc1 = 0, acc2 = 0, acc3 = 0;
+            bool overflow = false;
+            size_t i = from;
+            for (; i + 4 <= size; i += 4) {
+                overflow |= AddOverflow(acc0, data[i], acc0);
+                overflow |= AddOverflow(acc1, data[i + 1], acc1);
+                overflow |= AddOverflow(acc2, data[i + 2], acc2);
+                overflow |= AddOverflow(acc3, data[i + 3], acc3);
+            }
+            for (; i < size; ++i) {
+                overflow |= AddOverflow(acc0, data[i], acc0);
+            }
+            overflow |= AddOverflow(acc0, acc1, acc0);
+            overflow |= AddOverflow(acc2, acc3, acc2);
+            overflow |= AddOverflow(acc0, acc2, result);
+            return overflow;
+        }
+
+        int64_t MinScalar(const int64_t* data, size_t size, size_t from, int64_t init) {
+            int64_t m0 = init, m1 = init, m2 = init, m3 = init;
+            size_t i = from;
+            for (; i + 4 <= size; i += 4) {
+                m0 = std::min(m0, data[i]);
+                m1 = std::min(m1, data[i + 1]);
+                m2 = std::min(m2, data[i + 2]);
+                m3 = std::min(m3, data[i + 3]);
+            }
+            for (; i < size; ++i) {
+                m0 = std::min(m0, data[i]);
+            }
+            return std::min(std::min(m0, m1), std::min(m2, m3));
+        }
+
+        int64_t MaxScalar(const int64_t* data, size_t size, size_t from, int64_t init) {
+            int64_t m0 = init, m1 = init, m2 = init, m3 = init;
+            size_t i = from;
+            for (; i + 4 <= size; i += 4) {
+                m0 = std::max(m0, data[i]);
+                m1 = std::max(m1, data[i + 1]);
+                m2 = std::max(m2, data[i + 2]);
+                m3 = std::max(m3, data[i + 3]);
+            }
+            for (; i < size; ++i) {
+                m0 = std::max(m0, data[i]);
+            }
+            return std::max(std::max(m0, m1), std::max(m2, m3));
+        }
+
+        bool AddTail(int64_t* dst, const int64_t* lhs, const int64_t* rhs, size_t size, size_t from) {
+            bool overflow = false;
+            for (size_t i = from; i < size; ++i) {
+                overflow |= AddOverflow(lhs[i], rhs[i], dst[i]);
+            }
+            return overflow;
+        }
+
+        bool AddValueTail(int64_t* dst, const int64_t* src, int64_t value, size_t size, size_t from) {
+            bool overflow = false;
+            for (size_t i = from; i < size; ++i) {
+                overflow |= AddOverflow(src[i], value, dst[i]);
+            }
+            return overflow;
+        }
+
+        double SumScalar(const double* data, size_t size, size_t from) {
+            double acc0 = 0.0, acc1 = 0.0, acc2 = 0.0, acc3 = 0.0;
+            size_t i = from;
+            for (; i + 4 <= size; i += 4) {
+                acc0 += data[i];
+                acc1 += data[i + 1];
+                acc2 += data[i + 2];
+                acc3 += data[i + 3];
+            }
+            for (; i < size; ++i) {
+                acc0 += data[i];
+            }
+            return (acc0 + acc1) + (acc2 + acc3);
+        }
+
+        double DotScalar(const double* lhs, const double* rhs, size_t size, size_t from) {
+            double acc0 = 0.0, acc1 = 0.0, acc2 = 0.0, acc3 = 0.0;
+            size_t i = from;
+            for (; i + 4 <= size; i += 4) {
+                acc0 += lhs[i] * rhs[i];
+                acc1 += lhs[i + 1] * rhs[i + 1];
+                acc2 += lhs[i + 2] * rhs[i + 2];
+                acc3 += lhs[i + 3] * rhs[i + 3];
+            }
+            for (; i < size; ++i) {
+                acc0 += lhs[i] * rhs[i];
+            }
+            return (acc0 + acc1) + (acc2 + acc3);
+        }
+
+        double MinScalar(const double* data, size_t size, size_t from, double init) {
+            double result = init;
+            for (size_t i = from; i < size; ++i) {
+                result = std::min(result, data[i]);
+            }
+            return result;
+        }
+
+        double MaxScalar(const double* data, size_t size, size_t from, double init) {
+            double result = init;
+            for (size_t i = from; i < size; ++i) {
+                result = std::max(result, data[i]);
+            }
+            return result;
+        }
+
+#if defined(MYTHON_KERNELS_AVX2)
+
+        // Проверка поддержки AVX2 выполняется один раз при первом обращении
+        bool HasAvx2() {
+            static const bool has_avx2 = __builtin_cpu_supports("avx2");
+            return has_avx2;
+        }
+
+        // Возвращает маску дорожек, в которых сложение lhs + rhs = sum переполнилось:
+        // знак суммы отличается от знаков обоих слагаемых
+        __attribute__((target("avx2"))) __m256i OverflowLanes(__m256i lhs, __m256i rhs, __m256i sum) {
+            return _mm256_and_si256(_mm256_xor_si256(lhs, sum), _mm256_xor_si256(rhs, sum));
+        }
+
+        // Возвращает true, если в маске OverflowLanes отмечена хотя бы одна дорожка
+        __attribute__((target("avx2"))) bool AnyLane(__m256i overflow) {
+            return _mm256_movemask_pd(_mm256_castsi256_pd(overflow)) != 0;
+        }
+
+        __attribute__((target("avx2"))) bool SumAvx2(const int64_t* data, size_t size, int64_t& result) {
+            __m256i acc0 = _mm256_setzero_si256();
+            __m256i acc1 = _mm256_setzero_si256();
+            __m256i overflow = _mm256_setzero_si256();
+            size_t i = 0;
+            for (; i + 8 <= size; i += 8) {
+                __m256i next0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+                __m256i next1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i + 4));
+                __m256i sum0 = _mm256_add_epi64(acc0, next0);
+                __m256i sum1 = _mm256_add_epi64(acc1, next1);
+                overflow = _mm256_or_si256(overflow, _mm256_or_si256(
+                    OverflowLanes(acc0, next0, sum0), OverflowLanes(acc1, next1, sum1)));
+                acc0 = sum0;
+                acc1 = sum1;
+            }
+            alignas(32) int64_t lanes[8];
+            _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), acc0);
+            _mm256_store_si256(reinterpret_cast<__m256i*>(lanes + 4), acc1);
+            // дорожки и остаток складываются той же проверенной скалярной суммой
+            int64_t lanes_sum = 0;
+            int64_t tail_sum = 0;
+            bool lanes_overflow = SumScalar(lanes, 8, 0, lanes_sum);
+            bool tail_overflow = SumScalar(data, size, i, tail_sum);
+            return AnyLane(overflow) | lanes_overflow | tail_overflow | AddOverflow(lanes_sum, tail_sum, result);
+        }
+
+        // В AVX2 нет 64-битных min/max, поэтому используется сравнение и смешивание по маске
+        __attribute__((target("avx2"))) int64_t MinAvx2(const int64_t* data, size_t size) {
+            if (size < 4) {
+                return MinScalar(data, size, 1, data[0]);
+            }
+            __m256i acc = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data));
+            size_t i = 4;
+            for (; i + 4 <= size; i += 4) {
+                __m256i next = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+                acc = _mm256_blendv_epi8(acc, next, _mm256_cmpgt_epi64(acc, next));
+            }
+            alignas(32) int64_t lanes[4];
+            _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), acc);
+            int64_t result = std::min(std::min(lanes[0], lanes[1]), std::min(lanes[2], lanes[3]));
+            return MinScalar(data, size, i, result);
+        }
+
+        __attribute__((target("avx2"))) int64_t MaxAvx2(const int64_t* data, size_t size) {
+            if (size < 4) {
+                return MaxScalar(data, size, 1, data[0]);
+            }
+            __m256i acc = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data));
+            size_t i = 4;
+            for (; i + 4 <= size; i += 4) {
+                __m256i next = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+                acc = _mm256_blendv_epi8(acc, next, _mm256_cmpgt_epi64(next, acc));
+            }
+            alignas(32) int64_t lanes[4];
+            _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), acc);
+            int64_t result = std::max(std::max(lanes[0], lanes[1]), std::max(lanes[2], lanes[3]));
+            return MaxScalar(data, size, i, result);
+        }
+
+        __attribute__((target("avx2"))) bool AddAvx2(int64_t* dst, const int64_t* lhs, const int64_t* rhs,
+            size_t size) {
+            __m256i overflow = _mm256_setzero_si256();
+            size_t i = 0;
+            for (; i + 4 <= size; i += 4) {
+                __m256i left = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(lhs + i));
+                __m256i right = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rhs + i));
+                __m256i sum = _mm256_add_epi64(left, right);
+                overflow = _mm256_or_si256(overflow, OverflowLanes(left, right, sum));
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), sum);
+            }
+            return AnyLane(overflow) | AddTail(dst, lhs, rhs, size, i);
+        }
+
+        __attribute__((target("avx2"))) bool AddValueAvx2(int64_t* dst, const int64_t* src, int64_t value,
+            size_t size) {
+            const __m256i right = _mm256_set1_epi64x(value);
+            __m256i overflow = _mm256_setzero_si256();
+            size_t i = 0;
+            for (; i + 4 <= size; i += 4) {
+                __m256i left = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+                __m256i sum = _mm256_add_epi64(left, right);
+                overflow = _mm256_or_si256(overflow, OverflowLanes(left, right, sum));
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), sum);
+            }
+            return AnyLane(overflow) | AddValueTail(dst, src, value, size, i);
+        }
+
+        __attribute__((target("avx2"))) double SumAvx2(const double* data, size_t size) {
+            __m256d acc0 = _mm256_setzero_pd();
+            __m256d acc1 = _mm256_setzero_pd();
+            size_t i = 0;
+            for (; i + 8 <= size; i += 8) {
+                acc0 = _mm256_add_pd(acc0, _mm256_loadu_pd(data + i));
+                acc1 = _mm256_add_pd(acc1, _mm256_loadu_pd(data + i + 4));
+            }
+            alignas(32) double lanes[4];
+            _mm256_store_pd(lanes, _mm256_add_pd(acc0, acc1));
+            return ((lanes[0] + lanes[1]) + (lanes[2] + lanes[3])) + SumScalar(data, size, i);
+        }
+
+        // умножение и сложение выполняются раздельно, без FMA, как и в скалярной версии
+        __attribute__((target("avx2"))) double DotAvx2(const double* lhs, const double* rhs, size_t size) {
+            __m256d acc0 = _mm256_setzero_pd();
+            __m256d acc1 = _mm256_setzero_pd();
+            size_t i = 0;
+            for (; i + 8 <= size; i += 8) {
+                acc0 = _mm256_add_pd(acc0, _mm256_mul_pd(_mm256_loadu_pd(lhs + i), _mm256_loadu_pd(rhs + i)));
+                acc1 = _mm256_add_pd(acc1, _mm256_mul_pd(_mm256_loadu_pd(lhs + i + 4), _mm256_loadu_pd(rhs + i + 4)));
+            }
+            alignas(32) double lanes[4];
+            _mm256_store_pd(lanes, _mm256_add_pd(acc0, acc1));
+            return ((lanes[0] + lanes[1]) + (lanes[2] + lanes[3])) + DotScalar(lhs, rhs, size, i);
+        }
+
+        __attribute__((target("avx2"))) double MinAvx2(const double* data, size_t size) {
+            if (size < 4) {
+                return MinScalar(data, size, 1, data[0]);
+            }
+            __m256d acc = _mm256_loadu_pd(data);
+            size_t i = 4;
+            for (; i + 4 <= size; i += 4) {
+                acc = _mm256_min_pd(acc, _mm256_loadu_pd(data + i));
+            }
+            alignas(32) double lanes[4];
+            _mm256_store_pd(lanes, acc);
+            return MinScalar(data, size, i, MinScalar(lanes, 4, 1, lanes[0]));
+        }
+
+        __attribute__((target("avx2"))) double MaxAvx2(const double* data, size_t size) {
+            if (size < 4) {
+                return MaxScalar(data, size, 1, data[0]);
+            }
+            __m256d acc = _mm256_loadu_pd(data);
+            size_t i = 4;
+            for (; i + 4 <= size; i += 4) {
+                acc = _mm256_max_pd(acc, _mm256_loadu_pd(data + i));
+            }
+            alignas(32) double lanes[4];
+            _mm256_store_pd(lanes, acc);
+            return MaxScalar(data, size, i, MaxScalar(lanes, 4, 1, lanes[0]));
+        }
+
+#endif
+
+    }  // namespace
+
+    bool Sum(const int64_t* data, size_t size, int64_t& result) {
+#if defined(MYTHON_KERNELS_AVX2)
+        if (HasAvx2()) {
+            return SumAvx2(data, size, result);
+        }
+#endif
+        return SumScalar(data, size, 0, result);
+    }
+
+    int64_t Min(const int64_t* data, size_t size) {
+#if defined(MYTHON_KERNELS_AVX2)
+        if (HasAvx2()) {
+            return MinAvx2(data, size);
+        }
+#endif
+        return MinScalar(data, size, 1, data[0]);
+    }
+
+    int64_t Max(const int64_t* data, size_t size) {
+#if defined(MYTHON_KERNELS_AVX2)
+        if (HasAvx2()) {
+            return MaxAvx2(data, size);
+        }
+#endif
+        return MaxScalar(data, size, 1, data[0]);
+    }
+
+    bool Dot(const int64_t* lhs, const int64_t* rhs, size_t size, int64_t& result) {
+        // в AVX2 нет 64-битного умножения, поэтому ядро остаётся скалярным с четырьмя аккумуляторами
+        int64_t acc[4] = {0, 0, 0, 0};
+        bool overflow = false;
+        size_t i = 0;
+        for (; i + 4 <= size; i += 4) {
+            for (size_t lane = 0; lane < 4; ++lane) {
+                int64_t product = 0;
+                overflow |= MulOverflow(lhs[i + lane], rhs[i + lane], product);
+                overflow |= AddOverflow(acc[lane], product, acc[lane]);
+            }
+        }
+        for (; i < size; ++i) {
+            int64_t product = 0;
+            overflow |= MulOverflow(lhs[i], rhs[i], product);
+            overflow |= AddOverflow(acc[0], product, acc[0]);
+        }
+        return overflow | SumScalar(acc, 4, 0, result);
+    }
+
+    bool Add(int64_t* dst, const int64_t* lhs, const int64_t* rhs, size_t size) {
+#if defined(MYTHON_KERNELS_AVX2)
+        if (HasAvx2()) {
+            return AddAvx2(dst, lhs, rhs, size);
+        }
+#endif
+        return AddTail(dst, lhs, rhs, size, 0);
+    }
+
+    bool AddScalar(int64_t* dst, const int64_t* src, int64_t value, size_t size) {
+#if defined(MYTHON_KERNELS_AVX2)
+        if (HasAvx2()) {
+            return AddValueAvx2(dst, src, value, size);
+        }
+#endif
+        return AddValueTail(dst, src, value, size, 0);
+    }
+
+    bool Mul(int64_t* dst, const int64_t* lhs, const int64_t* rhs, size_t size) {
+        bool overflow = false;
+        for (size_t i = 0; i < size; ++i) {
+            overflow |= MulOverflow(lhs[i], rhs[i], dst[i]);
+        }
+        return overflow;
+    }
+
+    bool MulScalar(int64_t* dst, const int64_t* src, int64_t value, size_t size) {
+        bool overflow = false;
+        for (size_t i = 0; i < size; ++i) {
+            overflow |= MulOverflow(src[i], value, dst[i]);
+        }
+        return overflow;
+    }
+
+    void Fill(int64_t* dst, int64_t value, size_t size) {
+        std::fill(dst, dst + size, value);
+    }
+
+    double Sum(const double* data, size_t size) {
+#if defined(MYTHON_KERNELS_AVX2)
+        if (HasAvx2()) {
+            return SumAvx2(data, size);
+        }
+#endif
+        return SumScalar(data, size, 0);
+    }
+
+    double Min(const double* data, size_t size) {
+#if defined(MYTHON_KERNELS_AVX2)
+        if (HasAvx2()) {
+            return MinAvx2(data, size);
+        }
+#endif
+        return MinScalar(data, size, 1, data[0]);
+    }
+
+    double Max(const double* data, size_t size) {
+#if defined(MYTHON_KERNELS_AVX2)
+        if (HasAvx2()) {
+            return MaxAvx2(data, size);
+        }
+#endif
+        return MaxScalar(data, size, 1, data[0]);
+    }
+
+    double Dot(const double* lhs, const double* rhs, size_t size) {
+#if defined(MYTHON_KERNELS_AVX2)
+        if (HasAvx2()) {
+            return DotAvx2(lhs, rhs, size);
+        }
+#endif
+        return DotScalar(lhs, rhs, size, 0);
+    }
+
+    // поэлементные ядра double не зависят от порядка операций, и компилятор векторизует их сам
+
+    void Add(double* dst, const double* src, size_t size) {
+        for (size_t i = 0; i < size; ++i) {
+            dst[i] += src[i];
+        }
+    }
+
+    void AddScalar(double* dst, double value, size_t size) {
+        for (size_t i = 0; i < size; ++i) {
+            dst[i] += value;
+        }
+    }
+
+    void Mul(double* dst, const double* src, size_t size) {
+        for (size_t i = 0; i < size; ++i) {
+            dst[i] *= src[i];
+        }
+    }
+
+    void MulScalar(double* dst, double value, size_t size) {
+        for (size_t i = 0; i < size; ++i) {
+            dst[i] *= value;
+        }
+    }
+
+    void Fill(double* dst, double value, size_t size) {
+        std::fill(dst, dst + size, value);
+    }
+
+}  // namespace runtime::kernels
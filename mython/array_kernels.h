@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Векторные ядра массовых операций над непрерывными массивами int64_t и double.
+// На x86 с GCC/Clang при поддержке процессором AVX2 используются 256-битные инструкции,
+// в остальных случаях - развёрнутые скалярные циклы, которые компилятор может векторизовать сам.
+// Ядра сложения и умножения проверяют переполнение int64_t, как и скалярная арифметика Number,
+// и сообщают о нём результатом true. Ядра double складывают элементы в нескольких аккумуляторах,
+// поэтому округление суммы может отличаться от последовательного сложения в цикле
+namespace runtime::kernels {
+
+    // Записывает в result сумму size элементов массива data. Возвращает true, если промежуточная сумма
+    // вышла за пределы int64_t - тогда точную сумму вычисляет вызывающая сторона
+    bool Sum(const int64_t* data, size_t size, int64_t& result);
+
+    // Возвращает минимальный элемент массива data, size должен быть больше нуля
+    int64_t Min(const int64_t* data, size_t size);
+
+    // Возвращает максимальный элемент массива data, size должен быть больше нуля
+    int64_t Max(const int64_t* data, size_t size);
+
+    // Записывает в result скалярное произведение массивов lhs и rhs длины size.
+    // Возвращает true, если произведение или промежуточная сумма вышли за пределы int64_t
+    bool Dot(const int64_t* lhs, const int64_t* rhs, size_t size, int64_t& result);
+
+    // Записывает в dst поэлементные суммы массивов lhs и rhs длины size.
+    // Возвращает true, если хотя бы одна сумма не помещается в int64_t, значения dst тогда не определены
+    bool Add(int64_t* dst, const int64_t* lhs, const int64_t* rhs, size_t size);
+
+    // Записывает в dst суммы элементов src и значения value, возвращает true при переполнении
+    bool AddScalar(int64_t* dst, const int64_t* src, int64_t value, size_t size);
+
+    // Записывает в dst поэлементные произведения массивов lhs и rhs, возвращает true при переполнении
+    bool Mul(int64_t* dst, const int64_t* lhs, const int64_t* rhs, size_t size);
+
+    // Записывает в dst произведения элементов src и значения value, возвращает true при переполнении
+    bool MulScalar(int64_t* dst, const int64_t* src, int64_t value, size_t size);
+
+    // Заполняет массив dst значением value
+    void Fill(int64_t* dst, int64_t value, size_t size);
+
+    // Возвращает сумму size элементов массива data
+    double Sum(const double* data, size_t size);
+
+    // Возвращает минимальный элемент массива data, size должен быть больше нуля.
+    // Для массива с NaN результат не определён
+    double Min(const double* data, size_t size);
+
+    // Возвращает максимальный элемент массива data, size должен быть больше нуля
+    double Max(const double* data, size_t size);
+
+    // Возвращает скалярное произведение массивов lhs и rhs длины size
+    double Dot(const double* lhs, const double* rhs, size_t size);
+
+    // Поэлементно прибавляет к dst массив src длины size
+    void Add(double* dst, const double* src, size_t size);
+
+    // Прибавляет ко всем элементам dst значение value
+    void AddScalar(double* dst, double value, size_t size);
+
+    // Поэлементно умножает dst на массив src длины size
+    void Mul(double* dst, const double* src, size_t size);
+
+    // Умножает все элементы dst на значение value
+    void MulScalar(double* dst, double value, size_t size);
+
+    // Заполняет массив dst значением value
+    void Fill(double* dst, double value, size_t size);
+
+}  // namespace runtime::kernels
@@ -0,0 +1,177 @@
+#include "bench.h"
+
+#include "bytecode.h"
+#include "jit.h"
+#include "lexer.h"
+#include "parse.h"
+#include "regvm.h"
+
+#include <chrono>
+#include <iomanip>
+#include <optional>
+#include <sstream>
+#include <string>
+
+using namespace std;
+
+namespace bench {
+
+    namespace {
+
+        unique_ptr<runtime::Executable> Parse(const string& program) {
+            istringstream input(program);
+            parse::Lexer lexer(input);
+            return ParseProgram(lexer);
+        }
+
+        // Представительные программы для сравнения способов выполнения. N - число итераций главного цикла
+        const string __BENCH_METHODS__ = R"(
+class Counter:
+  def __init__():
+    self.value = 0
+
+  def add(n):
+    self.value = self.value + n
+    return self
+
+  def get():
+    return self.value
+
+class Accumulator:
+  def __init__(counter):
+    self.counter = counter
+
+  def feed(n):
+    if n > 2:
+      self.counter.add(n)
+    else:
+      self.counter.add(1)
+    return self.counter.get()
+
+c = Counter()
+acc = Accumulator(c)
+i = 0
+for step in intarray(N):
+  i = i + 1
+  acc.feed(i - (i / 4) * 4)
+print c.get()
+)";
+
+        const string __BENCH_ARITHMETIC__ = R"(
+total = 0
+i = 0
+for step in intarray(N):
+  i = i + 1
+  total = total + i * 3 - i / 2
+  if total > 1000000:
+    total = total - 1000000
+print total
+)";
+
+        // Горячий метод с собственным циклом: его код целиком выполняет JIT, а не интерпретатор программы
+        const string __BENCH_LOOPS__ = R"(
+class Mixer:
+  def __init__():
+    self.inner = intarray(8)
+
+  def mix(seed):
+    total = seed
+    i = 0
+    for step in self.inner:
+      i = i + 1
+      if total > 100000:
+        total = total - 99997
+      else:
+        total = total + i
+    return total
+
+m = Mixer()
+acc = 0
+for step in intarray(N):
+  acc = m.mix(acc)
+print acc
+)";
+
+        const string __BENCH_STRINGS__ = R"(
+text = ''
+count = 0
+for step in intarray(N):
+  word = 'w' + str(count)
+  if word != 'w7':
+    text = text + word
+  count = count + 1
+  if count > 50:
+    count = 0
+    text = ''
+print text
+)";
+
+    }  // namespace
+
+    void RunBackendBenchmark(std::ostream& out, int iterations) {
+        const std::pair<const char*, const string*> programs[] = {
+            { "methods", &__BENCH_METHODS__ },
+            { "arithmetic", &__BENCH_ARITHMETIC__ },
+            { "loops", &__BENCH_LOOPS__ },
+            { "strings", &__BENCH_STRINGS__ },
+        };
+        out << std::left << std::setw(12) << "program" << std::setw(10) << "backend" << std::right << std::setw(14)
+            << "instructions" << std::setw(14) << "dispatches" << std::setw(12) << "time, ms" << '\n';
+
+        for (const auto& [name, text] : programs) {
+            string source = *text;
+            source.replace(source.find("intarray(N)"), "intarray(N)"s.size(),
+                "intarray(" + std::to_string(iterations) + ")");
+
+            string expected;
+            for (const char* backend : { "tree", "stack", "register", "jit" }) {
+                unique_ptr<runtime::Executable> program = Parse(source);
+                const bytecode::Function* stack = nullptr;
+                const regvm::Function* registers = nullptr;
+                if (backend == "stack"sv) {
+                    auto compiled = bytecode::CompileProgram(std::move(program));
+                    stack = compiled.get();
+                    program = std::move(compiled);
+                }
+                else if (backend == "register"sv || backend == "jit"sv) {
+                    auto compiled = regvm::CompileProgram(std::move(program));
+                    registers = compiled.get();
+                    program = std::move(compiled);
+                }
+
+                std::optional<jit::TierUpScope> tier_up;
+                if (backend == "jit"sv) {
+                    tier_up.emplace();
+                }
+                runtime::DummyContext context;
+                runtime::Closure closure;
+                auto start = std::chrono::steady_clock::now();
+                program->Execute(closure, context);
+                auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start);
+
+                if (expected.empty()) {
+                    expected = context.output.str();
+                }
+                else if (context.output.str() != expected) {
+                    throw std::runtime_error("Backend "s + backend + " changed the output of " + name);
+                }
+
+                out << std::left << std::setw(12) << name << std::setw(10) << backend << std::right;
+                if (stack || registers) {
+                    bytecode::ExecutionStats stats = stack ? stack->GetStats() : registers->GetStats();
+                    out << std::setw(14) << stats.instructions;
+#ifdef MYTHON_DISPATCH_STATS
+                    out << std::setw(14) << stats.dispatches;
+#else
+                    out << std::setw(14) << "-";
+#endif
+                }
+                else {
+                    out << std::setw(14) << "-" << std::setw(14) << "-";
+                }
+                out << std::setw(12) << std::fixed << std::setprecision(2) << elapsed.count() << '\n';
+            }
+        }
+    }
+
+}  // namespace bench
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <ostream>
+
+namespace bench {
+
+    /*
+     * Выполняет представительные программы обходом дерева, стековой машиной bytecode, регистровой
+     * машиной regvm и ею же с компиляцией горячих методов jit, выводит в out размер кода, число
+     * выполненных интерпретатором инструкций и время выполнения. iterations - число итераций главного
+     * цикла каждой программы. У обхода дерева инструкций нет, эти столбцы для него пусты, а число
+     * выполненных инструкций выводится, только если машины собраны с MYTHON_DISPATCH_STATS.
+     * Выбрасывает runtime_error, если вывод программы расходится с выводом обхода дерева
+     */
+    void RunBackendBenchmark(std::ostream& out, int iterations);
+
+}  // namespace bench
@@ -0,0 +1,236 @@
+#include "bigint.h"
+
+#include <algorithm>
+
+namespace runtime {
+
+    namespace {
+        // основание десятичных блоков при выводе числа
+        constexpr uint32_t __DECIMAL_CHUNK_BASE__ = 1000000000;
+        constexpr int __DECIMAL_CHUNK_DIGITS__ = 9;
+    }
+
+    BigInt::BigInt(int64_t value)
+        : _negative(value < 0) {
+        // модуль считаем в беззнаковом типе, чтобы не переполниться на минимальном значении
+        uint64_t magnitude = value < 0 ? 0 - static_cast<uint64_t>(value) : static_cast<uint64_t>(value);
+        while (magnitude != 0) {
+            _digits.push_back(static_cast<uint32_t>(magnitude));
+            magnitude >>= 32;
+        }
+    }
+
+    BigInt::BigInt(bool negative, Digits digits)
+        : _digits(std::move(digits)) {
+        Trim(_digits);
+        _negative = negative && !_digits.empty();
+    }
+
+    std::optional<int64_t> BigInt::ToInt64() const {
+        if (_digits.size() > 2) {
+            return std::nullopt;
+        }
+        uint64_t magnitude = 0;
+        for (size_t i = _digits.size(); i-- > 0;) {
+            magnitude = (magnitude << 32) | _digits[i];
+        }
+        constexpr uint64_t max_positive = static_cast<uint64_t>(std::numeric_limits<int64_t>::max());
+        if (!_negative) {
+            return magnitude <= max_positive ? std::optional<int64_t>(static_cast<int64_t>(magnitude)) : std::nullopt;
+        }
+        if (magnitude <= max_positive + 1) {
+            return static_cast<int64_t>(0 - magnitude);
+        }
+        return std::nullopt;
+    }
+
+    double BigInt::ToDouble() const {
+        double result = 0;
+        for (size_t i = _digits.size(); i-- > 0;) {
+            result = result * 4294967296.0 + _digits[i];
+        }
+        return _negative ? -result : result;
+    }
+
+    bool BigInt::IsZero() const {
+        return _digits.empty();
+    }
+
+    bool BigInt::IsNegative() const {
+        return _negative;
+    }
+
+    int BigInt::Compare(const BigInt& other) const {
+        if (_negative != other._negative) {
+            return _negative ? -1 : 1;
+        }
+        int result = CompareDigits(_digits, other._digits);
+        return _negative ? -result : result;
+    }
+
+    size_t BigInt::Hash() const {
+        uint64_t hash = _negative ? 0x9e3779b97f4a7c15ULL : 0;
+        for (uint32_t digit : _digits) {
+            hash = (hash ^ digit) * 0x100000001b3ULL;
+        }
+        return static_cast<size_t>(hash);
+    }
+
+    std::string BigInt::ToString() const {
+        if (_digits.empty()) {
+            return "0";
+        }
+        // отщепляем блоки по девять десятичных цифр начиная с младших
+        Digits rest = _digits;
+        std::vector<uint32_t> chunks;
+        while (!rest.empty()) {
+            chunks.push_back(DivSmall(rest, __DECIMAL_CHUNK_BASE__));
+        }
+
+        std::string result = _negative ? "-" : "";
+        result += std::to_string(chunks.back());
+        for (size_t i = chunks.size() - 1; i-- > 0;) {
+            std::string chunk = std::to_string(chunks[i]);
+            result.append(__DECIMAL_CHUNK_DIGITS__ - chunk.size(), '0');
+            result += chunk;
+        }
+        return result;
+    }
+
+    BigInt operator+(const BigInt& lhs, const BigInt& rhs) {
+        if (lhs._negative == rhs._negative) {
+            return BigInt(lhs._negative, BigInt::AddDigits(lhs._digits, rhs._digits));
+        }
+        // при разных знаках вычитаем меньший модуль из большего
+        if (BigInt::CompareDigits(lhs._digits, rhs._digits) >= 0) {
+            return BigInt(lhs._negative, BigInt::SubDigits(lhs._digits, rhs._digits));
+        }
+        return BigInt(rhs._negative, BigInt::SubDigits(rhs._digits, lhs._digits));
+    }
+
+    BigInt operator-(const BigInt& lhs, const BigInt& rhs) {
+        return lhs + BigInt(!rhs._negative, rhs._digits);
+    }
+
+    BigInt operator*(const BigInt& lhs, const BigInt& rhs) {
+        return BigInt(lhs._negative != rhs._negative, BigInt::MulDigits(lhs._digits, rhs._digits));
+    }
+
+    BigInt operator/(const BigInt& lhs, const BigInt& rhs) {
+        return BigInt(lhs._negative != rhs._negative, BigInt::DivDigits(lhs._digits, rhs._digits));
+    }
+
+    int BigInt::CompareDigits(const Digits& lhs, const Digits& rhs) {
+        if (lhs.size() != rhs.size()) {
+            return lhs.size() < rhs.size() ? -1 : 1;
+        }
+        for (size_t i = lhs.size(); i-- > 0;) {
+            if (lhs[i] != rhs[i]) {
+                return lhs[i] < rhs[i] ? -1 : 1;
+            }
+        }
+        return 0;
+    }
+
+    BigInt::Digits BigInt::AddDigits(const Digits& lhs, const Digits& rhs) {
+        const Digits& longer = lhs.size() >= rhs.size() ? lhs : rhs;
+        const Digits& shorter = lhs.size() >= rhs.size() ? rhs : lhs;
+        Digits result;
+        result.reserve(longer.size() + 1);
+        uint64_t carry = 0;
+        for (size_t i = 0; i < longer.size(); ++i) {
+            uint64_t sum = carry + longer[i] + (i < shorter.size() ? shorter[i] : 0);
+            result.push_back(static_cast<uint32_t>(sum));
+            carry = sum >> 32;
+        }
+        if (carry != 0) {
+            result.push_back(static_cast<uint32_t>(carry));
+        }
+        return result;
+    }
+
+    BigInt::Digits BigInt::SubDigits(const Digits& lhs, const Digits& rhs) {
+        Digits result;
+        result.reserve(lhs.size());
+        int64_t borrow = 0;
+        for (size_t i = 0; i < lhs.size(); ++i) {
+            int64_t diff = static_cast<int64_t>(lhs[i]) - borrow - (i < rhs.size() ? rhs[i] : 0);
+            borrow = diff < 0 ? 1 : 0;
+            result.push_back(static_cast<uint32_t>(diff + (borrow << 32)));
+        }
+        Trim(result);
+        return result;
+    }
+
+    BigInt::Digits BigInt::MulDigits(const Digits& lhs, const Digits& rhs) {
+        if (lhs.empty() || rhs.empty()) {
+            return {};
+        }
+        Digits result(lhs.size() + rhs.size(), 0);
+        for (size_t i = 0; i < lhs.size(); ++i) {
+            uint64_t carry = 0;
+            for (size_t j = 0; j < rhs.size(); ++j) {
+                uint64_t cur = static_cast<uint64_t>(lhs[i]) * rhs[j] + result[i + j] + carry;
+                result[i + j] = static_cast<uint32_t>(cur);
+                carry = cur >> 32;
+            }
+            result[i + rhs.size()] = static_cast<uint32_t>(carry);
+        }
+        Trim(result);
+        return result;
+    }
+
+    BigInt::Digits BigInt::DivDigits(const Digits& lhs, const Digits& rhs) {
+        if (CompareDigits(lhs, rhs) < 0) {
+            return {};
+        }
+        // короткий делитель делим за один проход
+        if (rhs.size() == 1) {
+            Digits quotient = lhs;
+            DivSmall(quotient, rhs[0]);
+            return quotient;
+        }
+        // иначе двоичное деление столбиком: сдвигаем остаток на бит и вычитаем делитель, когда он помещается
+        Digits quotient(lhs.size(), 0);
+        Digits remainder;
+        for (size_t bit = lhs.size() * 32; bit-- > 0;) {
+            uint32_t carry = (lhs[bit / 32] >> (bit % 32)) & 1;
+            for (uint32_t& digit : remainder) {
+                uint32_t next_carry = digit >> 31;
+                digit = (digit << 1) | carry;
+                carry = next_carry;
+            }
+            if (carry != 0) {
+                remainder.push_back(carry);
+            }
+            if (CompareDigits(remainder, rhs) >= 0) {
+                remainder = SubDigits(remainder, rhs);
+                quotient[bit / 32] |= 1u << (bit % 32);
+            }
+        }
+        Trim(quotient);
+        return quotient;
+    }
+
+    uint32_t BigInt::DivSmall(Digits& digits, uint32_t divisor) {
+        uint64_t remainder = 0;
+        for (size_t i = digits.size(); i-- > 0;) {
+            uint64_t cur = (remainder << 32) | digits[i];
+            digits[i] = static_cast<uint32_t>(cur / divisor);
+            remainder = cur % divisor;
+        }
+        Trim(digits);
+        return static_cast<uint32_t>(remainder);
+    }
+
+    void BigInt::Trim(Digits& digits) {
+        while (!digits.empty() && digits.back() == 0) {
+            digits.pop_back();
+        }
+    }
+
+    std::ostream& operator<<(std::ostream& os, const BigInt& value) {
+        return os << value.ToString();
+    }
+
+}  // namespace runtime
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace runtime {
+
+    /*
+     * Проверенная 64-битная арифметика для быстрого пути целых чисел.
+     * Функции записывают lhs op rhs в result и возвращают true, если результат не помещается в int64_t
+     */
+    inline bool AddOverflow(int64_t lhs, int64_t rhs, int64_t& result) {
+#if defined(__GNUC__) || defined(__clang__)
+        return __builtin_add_overflow(lhs, rhs, &result);
+#else
+        if ((rhs > 0 && lhs > std::numeric_limits<int64_t>::max() - rhs)
+            || (rhs < 0 && lhs < std::numeric_limits<int64_t>::min() - rhs)) {
+            return true;
+        }
+        result = lhs + rhs;
+        return false;
+#endif
+    }
+
+    inline bool SubOverflow(int64_t lhs, int64_t rhs, int64_t& result) {
+#if defined(__GNUC__) || defined(__clang__)
+        return __builtin_sub_overflow(lhs, rhs, &result);
+#else
+        if ((rhs < 0 && lhs > std::numeric_limits<int64_t>::max() + rhs)
+            || (rhs > 0 && lhs < std::numeric_limits<int64_t>::min() + rhs)) {
+            return true;
+        }
+        result = lhs - rhs;
+        return false;
+#endif
+    }
+
+    inline bool MulOverflow(int64_t lhs, int64_t rhs, int64_t& result) {
+#if defined(__GNUC__) || defined(__clang__)
+        return __builtin_mul_overflow(lhs, rhs, &result);
+#else
+        constexpr int64_t max = std::numeric_limits<int64_t>::max();
+        constexpr int64_t min = std::numeric_limits<int64_t>::min();
+        bool overflow = lhs > 0
+            ? (rhs > 0 ? lhs > max / rhs : rhs < min / lhs)
+            : (rhs > 0 ? lhs < min / rhs : lhs != 0 && rhs < max / lhs);
+        if (overflow) {
+            return true;
+        }
+        result = lhs * rhs;
+        return false;
+#endif
+    }
+
+    // Целое число произвольной точности: знак и модуль в виде 32-битных разрядов от младшего к старшему
+    class BigInt {
+    public:
+        BigInt() = default;
+        BigInt(int64_t value);  // NOLINT(google-explicit-constructor,hicpp-explicit-conversions)
+
+        // Возвращает значение, если оно помещается в int64_t, иначе std::nullopt
+        [[nodiscard]] std::optional<int64_t> ToInt64() const;
+
+        // Возвращает ближайшее значение типа double, слишком большие числа дают бесконечность
+        [[nodiscard]] double ToDouble() const;
+
+        [[nodiscard]] bool IsZero() const;
+        [[nodiscard]] bool IsNegative() const;
+
+        // Возвращает отрицательное число, ноль или положительное число, если *this меньше, равно или больше other
+        [[nodiscard]] int Compare(const BigInt& other) const;
+
+        // Возвращает хеш значения, не согласованный с хешем int64_t
+        [[nodiscard]] size_t Hash() const;
+
+        // Возвращает десятичную запись числа
+        [[nodiscard]] std::string ToString() const;
+
+        friend BigInt operator+(const BigInt& lhs, const BigInt& rhs);
+        friend BigInt operator-(const BigInt& lhs, const BigInt& rhs);
+        friend BigInt operator*(const BigInt& lhs, const BigInt& rhs);
+        // Деление с отбрасыванием дробной части, как у встроенных целых. Делитель не должен быть нулём
+        friend BigInt operator/(const BigInt& lhs, const BigInt& rhs);
+
+        friend bool operator==(const BigInt& lhs, const BigInt& rhs) {
+            return lhs.Compare(rhs) == 0;
+        }
+        friend bool operator<(const BigInt& lhs, const BigInt& rhs) {
+            return lhs.Compare(rhs) < 0;
+        }
+
+    private:
+        using Digits = std::vector<uint32_t>;
+
+        BigInt(bool negative, Digits digits);
+
+        // Сравнивает модули чисел
+        static int CompareDigits(const Digits& lhs, const Digits& rhs);
+        static Digits AddDigits(const Digits& lhs, const Digits& rhs);
+        // Вычитает модули, lhs должен быть не меньше rhs
+        static Digits SubDigits(const Digits& lhs, const Digits& rhs);
+        static Digits MulDigits(const Digits& lhs, const Digits& rhs);
+        static Digits DivDigits(const Digits& lhs, const Digits& rhs);
+        // Делит модуль на короткое число на месте и возвращает остаток
+        static uint32_t DivSmall(Digits& digits, uint32_t divisor);
+        // Убирает старшие нулевые разряды
+        static void Trim(Digits& digits);
+
+        bool _negative = false;         // у нуля знак всегда положительный
+        Digits _digits = {};            // пустой массив соответствует нулю
+    };
+
+    std::ostream& operator<<(std::ostream& os, const BigInt& value);
+
+}  // namespace runtime
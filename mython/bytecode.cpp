@@ -0,0 +1,812 @@
+#include "bytecode.h"
+
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+namespace bytecode {
+
+    using runtime::Closure;
+    using runtime::CompareOp;
+    using runtime::Context;
+    using runtime::Executable;
+    using runtime::ObjectHolder;
+    using runtime::ObjectKind;
+    using runtime::Symbol;
+
+    namespace {
+
+        // Глубина стека значений, при которой он размещается в кадре интерпретатора без выделения памяти
+        constexpr size_t __VM_INLINE_STACK__ = 16;
+
+        // Изменение глубины стека значений при выполнении инструкции
+        int StackEffect(const Instruction& instruction) {
+            switch (instruction.op) {
+            case Opcode::PushConst:
+            case Opcode::PushNone:
+            case Opcode::LoadVar:
+            case Opcode::LoadSelfField:
+            case Opcode::AddVarConst:
+            case Opcode::CompareVarConst:
+            case Opcode::CompareSelfFieldVar:
+            case Opcode::CompareSelfFieldConst:
+            case Opcode::Exec:
+                return 1;
+            case Opcode::LoadField:
+            case Opcode::Not:
+            case Opcode::Jump:
+            case Opcode::IterNext:
+                return 0;
+            case Opcode::StoreField:
+                return -2;
+            case Opcode::Call:
+            case Opcode::Print:
+                return -static_cast<int>(instruction.b);
+            case Opcode::New:
+                return 1 - static_cast<int>(instruction.b);
+            default:
+                // снимают одно значение: сохранение, Pop, бинарные операции, условные переходы, начало цикла, return
+                return -1;
+            }
+        }
+
+        // Строит линейный код из дерева программы или тела метода
+        class Compiler {
+        public:
+            explicit Compiler(Code& code)
+                : code_(code) {
+            }
+
+            // Компилирует тело метода либо программу. В конце кода функция возвращает None
+            void CompileFunction(Executable& body) {
+                if (auto* method_body = dynamic_cast<ast::MethodBody*>(&body)) {
+                    CompileStatement(method_body->GetBody());
+                }
+                else {
+                    CompileStatement(body);
+                }
+                Emit(Opcode::PushNone);
+                Emit(Opcode::Return);
+            }
+
+        private:
+            void CompileStatement(Executable& node) {
+                if (auto* compound = dynamic_cast<ast::Compound*>(&node)) {
+                    for (const auto& statement : compound->GetStatements()) {
+                        CompileStatement(*statement);
+                    }
+                }
+                else if (auto* assignment = dynamic_cast<ast::Assignment*>(&node)) {
+                    CompileExpression(assignment->GetValue());
+                    Emit(Opcode::StoreVar, SymbolIndex(assignment->GetVar()));
+                }
+                else if (auto* field_assignment = dynamic_cast<ast::FieldAssignment*>(&node)) {
+                    CompileDottedIds(field_assignment->GetObject().GetDottedIds());
+                    CompileExpression(field_assignment->GetValue());
+                    Emit(Opcode::StoreField, SymbolIndex(field_assignment->GetField()));
+                }
+                else if (auto* print = dynamic_cast<ast::Print*>(&node)) {
+                    for (const auto& arg : print->GetArgs()) {
+                        CompileExpression(*arg);
+                    }
+                    Emit(Opcode::Print, 0, static_cast<uint32_t>(print->GetArgs().size()));
+                }
+                else if (auto* return_statement = dynamic_cast<ast::Return*>(&node)) {
+                    CompileExpression(return_statement->GetValue());
+                    Emit(Opcode::Return);
+                }
+                else if (auto* if_else = dynamic_cast<ast::IfElse*>(&node)) {
+                    CompileExpression(if_else->GetCondition());
+                    size_t to_else = Emit(Opcode::JumpIfFalse);
+                    CompileStatement(if_else->GetIfBody());
+                    if (Executable* else_body = if_else->GetElseBody()) {
+                        size_t to_end = Emit(Opcode::Jump);
+                        Bind(to_else);
+                        CompileStatement(*else_body);
+                        Bind(to_end);
+                    }
+                    else {
+                        Bind(to_else);
+                    }
+                }
+                else if (auto* for_each = dynamic_cast<ast::ForEach*>(&node)) {
+                    CompileExpression(for_each->GetIterable());
+                    Emit(Opcode::IterStart);
+                    uint32_t loop = Label();
+                    size_t next = Emit(Opcode::IterNext, SymbolIndex(for_each->GetVar()));
+                    CompileStatement(for_each->GetBody());
+                    Emit(Opcode::Jump, loop);
+                    Bind(next);
+                }
+                else {
+                    // класс объявляется как обычно, но тела его методов заменяются скомпилированными
+                    if (auto* definition = dynamic_cast<ast::ClassDefinition*>(&node)) {
+                        CompileClass(definition->GetClass());
+                    }
+                    CompileExpression(node);
+                    Emit(Opcode::Pop);
+                }
+            }
+
+            void CompileExpression(Executable& node) {
+                if (CompileConstant<runtime::Number>(node) || CompileConstant<runtime::Float>(node)
+                    || CompileConstant<runtime::String>(node) || CompileConstant<runtime::Bool>(node)) {
+                    return;
+                }
+                if (dynamic_cast<ast::None*>(&node)) {
+                    Emit(Opcode::PushNone);
+                }
+                else if (auto* variable = dynamic_cast<ast::VariableValue*>(&node)) {
+                    CompileDottedIds(variable->GetDottedIds());
+                }
+                else if (CompileBinary<ast::Add>(node, Opcode::Add) || CompileBinary<ast::Sub>(node, Opcode::Sub)
+                    || CompileBinary<ast::Mult>(node, Opcode::Mult) || CompileBinary<ast::Div>(node, Opcode::Div)) {
+                    return;
+                }
+                else if (CompileComparison<CompareOp::Less>(node) || CompileComparison<CompareOp::LessOrEqual>(node)
+                    || CompileComparison<CompareOp::Greater>(node) || CompileComparison<CompareOp::GreaterOrEqual>(node)
+                    || CompileComparison<CompareOp::Equal>(node) || CompileComparison<CompareOp::NotEqual>(node)) {
+                    return;
+                }
+                else if (auto* or_operation = dynamic_cast<ast::Or*>(&node)) {
+                    CompileExpression(*or_operation->_lhs);
+                    size_t to_end = Emit(Opcode::JumpIfTrueOrPop);
+                    CompileExpression(*or_operation->_rhs);
+                    Bind(to_end);
+                }
+                else if (auto* and_operation = dynamic_cast<ast::And*>(&node)) {
+                    CompileExpression(*and_operation->_lhs);
+                    size_t to_end = Emit(Opcode::JumpIfFalseOrPop);
+                    CompileExpression(*and_operation->_rhs);
+                    Bind(to_end);
+                }
+                else if (auto* not_operation = dynamic_cast<ast::Not*>(&node)) {
+                    CompileExpression(*not_operation->_argument);
+                    Emit(Opcode::Not);
+                }
+                else if (auto* call = dynamic_cast<ast::MethodCall*>(&node)) {
+                    CompileExpression(call->GetObject());
+                    for (const auto& arg : call->GetArgs()) {
+                        CompileExpression(*arg);
+                    }
+                    Emit(Opcode::Call, SymbolIndex(call->GetMethod()), static_cast<uint32_t>(call->GetArgs().size()));
+                }
+                else if (auto* new_instance = dynamic_cast<ast::NewInstance*>(&node);
+                         new_instance && IsConstructorCall(*new_instance)) {
+                    for (const auto& arg : new_instance->GetArgs()) {
+                        CompileExpression(*arg);
+                    }
+                    code_.classes.push_back(&new_instance->GetClass());
+                    Emit(Opcode::New, static_cast<uint32_t>(code_.classes.size() - 1),
+                        static_cast<uint32_t>(new_instance->GetArgs().size()));
+                }
+                else {
+                    // остальные узлы выполняются обходом дерева
+                    code_.nodes.push_back(&node);
+                    Emit(Opcode::Exec, static_cast<uint32_t>(code_.nodes.size() - 1));
+                }
+            }
+
+            template <typename T>
+            bool CompileConstant(Executable& node) {
+                auto* constant = dynamic_cast<ast::ValueStatement<T>*>(&node);
+                if (!constant) {
+                    return false;
+                }
+                // константа живёт в дереве, которым владеет Function, поэтому разделяется без владения
+                code_.constants.push_back(ObjectHolder::Share(constant->GetValue()));
+                Emit(Opcode::PushConst, static_cast<uint32_t>(code_.constants.size() - 1));
+                return true;
+            }
+
+            template <typename Node>
+            bool CompileBinary(Executable& node, Opcode op) {
+                auto* operation = dynamic_cast<Node*>(&node);
+                if (!operation) {
+                    return false;
+                }
+                CompileExpression(*operation->_lhs);
+                CompileExpression(*operation->_rhs);
+                Emit(op);
+                return true;
+            }
+
+            template <CompareOp op>
+            bool CompileComparison(Executable& node) {
+                auto* comparison = dynamic_cast<ast::Comparison<op>*>(&node);
+                if (!comparison) {
+                    return false;
+                }
+                CompileExpression(*comparison->_lhs);
+                CompileExpression(*comparison->_rhs);
+                Emit(Opcode::Compare, 0, 0, op);
+                return true;
+            }
+
+            void CompileDottedIds(const std::vector<Symbol>& ids) {
+                Emit(Opcode::LoadVar, SymbolIndex(ids.front()));
+                for (size_t i = 1; i < ids.size(); ++i) {
+                    Emit(Opcode::LoadField, SymbolIndex(ids[i]));
+                }
+            }
+
+            void CompileClass(runtime::Class& cls) {
+                for (runtime::Method& method : cls.GetMethods()) {
+                    if (!dynamic_cast<Function*>(method.body.get())) {
+                        method.body = std::make_unique<Function>(std::move(method.body));
+                    }
+                }
+            }
+
+            // Конструктор вызывается, только если у класса есть __init__ с тем же числом параметров.
+            // Иначе дерево не вычисляет аргументы вовсе, и узел остаётся обходу дерева
+            static bool IsConstructorCall(const ast::NewInstance& node) {
+                const runtime::Method* init = node.GetClass().GetMethod(runtime::__INIT_METHOD__);
+                return init != nullptr && init->formal_params.size() == node.GetArgs().size();
+            }
+
+            uint32_t SymbolIndex(Symbol name) {
+                for (size_t i = 0; i < code_.symbols.size(); ++i) {
+                    if (code_.symbols[i] == name) {
+                        return static_cast<uint32_t>(i);
+                    }
+                }
+                code_.symbols.push_back(name);
+                return static_cast<uint32_t>(code_.symbols.size() - 1);
+            }
+
+            // Возвращает адрес следующей инструкции как цель перехода. Инструкции до метки не сливаются
+            // с инструкциями после неё
+            uint32_t Label() {
+                barrier_ = code_.instructions.size();
+                return static_cast<uint32_t>(barrier_);
+            }
+
+            // Направляет переход, выпущенный по адресу jump, на следующую инструкцию
+            void Bind(size_t jump) {
+                Instruction& instruction = code_.instructions[jump];
+                (instruction.op == Opcode::IterNext ? instruction.b : instruction.a) = Label();
+            }
+
+            // Добавляет инструкцию, сливая её с предыдущими в суперинструкцию, где это возможно.
+            // Возвращает адрес добавленной инструкции
+            size_t Emit(Opcode op, uint32_t a = 0, uint32_t b = 0, CompareOp cmp = CompareOp::Equal) {
+                Instruction instruction;
+                instruction.op = op;
+                instruction.a = a;
+                instruction.b = b;
+                instruction.cmp = cmp;
+
+                // глубину считаем по несливающимся инструкциям, суперинструкция не глубже их
+                depth_ += StackEffect(instruction);
+                code_.max_stack = std::max(code_.max_stack, static_cast<size_t>(depth_));
+
+                Fuse(instruction);
+                code_.instructions.push_back(instruction);
+                return code_.instructions.size() - 1;
+            }
+
+            // Возвращает инструкцию с конца кода, если она стоит после последней метки
+            Instruction* Recent(size_t back) {
+                size_t size = code_.instructions.size();
+                if (back > size - barrier_) {
+                    return nullptr;
+                }
+                return &code_.instructions[size - back];
+            }
+
+            void Fuse(Instruction& instruction) {
+                Instruction* last = Recent(1);
+                Instruction* before = Recent(2);
+                if (instruction.op == Opcode::LoadField && last && last->op == Opcode::LoadVar
+                    && code_.symbols[last->a] == runtime::__SELF_NAME__) {
+                    // self.field
+                    instruction.op = Opcode::LoadSelfField;
+                }
+                else if ((instruction.op == Opcode::Compare || instruction.op == Opcode::Add) && before) {
+                    Opcode fused = Opcode::Pop;
+                    if (before->op == Opcode::LoadVar && last->op == Opcode::PushConst) {
+                        fused = instruction.op == Opcode::Add ? Opcode::AddVarConst : Opcode::CompareVarConst;
+                    }
+                    else if (instruction.op == Opcode::Compare && before->op == Opcode::LoadSelfField) {
+                        if (last->op == Opcode::LoadVar) {
+                            fused = Opcode::CompareSelfFieldVar;
+                        }
+                        else if (last->op == Opcode::PushConst) {
+                            fused = Opcode::CompareSelfFieldConst;
+                        }
+                    }
+                    if (fused == Opcode::Pop) {
+                        return;
+                    }
+                    instruction.op = fused;
+                    instruction.a = before->a;
+                    instruction.b = last->a;
+                    code_.instructions.pop_back();
+                }
+                else {
+                    return;
+                }
+                code_.instructions.pop_back();
+            }
+
+            Code& code_;
+            size_t barrier_ = 0;        // адрес последней метки
+            int depth_ = 0;
+        };
+
+        /*
+         * Выполняет code в таблице символов closure. Вызов с code, равным nullptr, ничего не выполняет,
+         * а только записывает в handlers таблицу адресов обработчиков инструкций.
+         * При MYTHON_THREADED_DISPATCH каждая инструкция хранит адрес своего обработчика, и обработчик
+         * переходит прямо к обработчику следующей: у каждого перехода своё место в коде и своя история
+         * в предсказателе ветвлений. Иначе инструкции выбираются общим switch
+         */
+        ObjectHolder Interpret(Code* code, Closure* closure, Context* context,
+            [[maybe_unused]] const void* const** handlers) {
+#ifdef MYTHON_THREADED_DISPATCH
+            static const void* const labels[] = {
+#define MYTHON_OPCODE_LABEL(name) &&op_##name,
+                MYTHON_OPCODES(MYTHON_OPCODE_LABEL)
+#undef MYTHON_OPCODE_LABEL
+            };
+            if (code == nullptr) {
+                *handlers = labels;
+                return ObjectHolder::None();
+            }
+            // Переход по адресу метки не вызывает деструкторы локальных объектов обработчика. Поэтому
+            // обработчики держат значения в ячейках стека, а локальные ObjectHolder живут во вложенном блоке,
+            // который закрывается до перехода к следующей инструкции
+#define VM_TARGET(name) op_##name:
+#define VM_DISPATCH() VM_COUNT(); goto *ip->handler
+#else
+            if (code == nullptr) {
+                return ObjectHolder::None();
+            }
+#define VM_TARGET(name) case Opcode::name:
+#define VM_DISPATCH() continue
+#endif
+#define VM_NEXT() ++ip; VM_DISPATCH()
+#define VM_JUMP(target) ip = base + (target); VM_DISPATCH()
+
+            ObjectHolder inline_stack[__VM_INLINE_STACK__];
+            std::unique_ptr<ObjectHolder[]> heap_stack;
+            ObjectHolder* sp = inline_stack;
+            if (code->max_stack > __VM_INLINE_STACK__) {
+                heap_stack = std::make_unique<ObjectHolder[]>(code->max_stack);
+                sp = heap_stack.get();
+            }
+            std::vector<Loop> loops;
+            const Instruction* const base = code->instructions.data();
+            const Instruction* ip = base;
+            const auto& constants = code->constants;
+            const auto& symbols = code->symbols;
+#ifdef MYTHON_DISPATCH_STATS
+            DispatchCounter dispatches(code->dispatches);
+#define VM_COUNT() dispatches.Count()
+#else
+#define VM_COUNT() static_cast<void>(0)
+#endif
+
+#ifdef MYTHON_THREADED_DISPATCH
+            VM_DISPATCH();
+#else
+            for (;;) {
+                VM_COUNT();
+                switch (ip->op) {
+#endif
+                VM_TARGET(PushConst) {
+                    *sp++ = constants[ip->a];
+                    VM_NEXT();
+                }
+                VM_TARGET(PushNone) {
+                    *sp++ = ObjectHolder::None();
+                    VM_NEXT();
+                }
+                VM_TARGET(LoadVar) {
+                    *sp++ = LoadVariable(*closure, symbols[ip->a]);
+                    VM_NEXT();
+                }
+                VM_TARGET(LoadField) {
+                    // копирующее присваивание захватывает поле до того, как отпустить объект, которому оно принадлежит
+                    sp[-1] = LoadField(sp[-1], symbols[ip->a]);
+                    VM_NEXT();
+                }
+                VM_TARGET(LoadSelfField) {
+                    *sp++ = LoadField(LoadVariable(*closure, runtime::__SELF_NAME__), symbols[ip->a]);
+                    VM_NEXT();
+                }
+                VM_TARGET(StoreVar) {
+                    --sp;
+                    // значение получает новую ссылку, сообщаем об этом идущему циклу сборки
+                    runtime::CycleCollector::WriteBarrier(*sp);
+                    (*closure)[symbols[ip->a]] = std::move(*sp);
+                    VM_NEXT();
+                }
+                VM_TARGET(StoreField) {
+                    sp -= 2;
+                    if (sp[0].Kind() != ObjectKind::Instance) {
+                        throw std::runtime_error("Only object fields can be assigned");
+                    }
+                    runtime::CycleCollector::WriteBarrier(sp[1]);
+                    static_cast<runtime::ClassInstance*>(sp[0].Get())->Fields()[symbols[ip->a]] = std::move(sp[1]);
+                    sp[0] = ObjectHolder::None();
+                    VM_NEXT();
+                }
+                VM_TARGET(Pop) {
+                    *--sp = ObjectHolder::None();
+                    VM_NEXT();
+                }
+                VM_TARGET(Add) {
+                    --sp;
+                    sp[-1] = ArithmeticValues(runtime::ArithmeticOp::Add, sp[-1], sp[0], *context);
+                    sp[0] = ObjectHolder::None();
+                    VM_NEXT();
+                }
+                VM_TARGET(Sub) {
+                    --sp;
+                    sp[-1] = ArithmeticValues(runtime::ArithmeticOp::Sub, sp[-1], sp[0], *context);
+                    sp[0] = ObjectHolder::None();
+                    VM_NEXT();
+                }
+                VM_TARGET(Mult) {
+                    --sp;
+                    sp[-1] = ArithmeticValues(runtime::ArithmeticOp::Mult, sp[-1], sp[0], *context);
+                    sp[0] = ObjectHolder::None();
+                    VM_NEXT();
+                }
+                VM_TARGET(Div) {
+                    --sp;
+                    sp[-1] = ArithmeticValues(runtime::ArithmeticOp::Div, sp[-1], sp[0], *context);
+                    sp[0] = ObjectHolder::None();
+                    VM_NEXT();
+                }
+                VM_TARGET(AddVarConst) {
+                    *sp++ = ArithmeticValues(runtime::ArithmeticOp::Add, LoadVariable(*closure, symbols[ip->a]), constants[ip->b],
+                        *context);
+                    VM_NEXT();
+                }
+                VM_TARGET(Compare) {
+                    --sp;
+                    sp[-1] = runtime::MakeBool(CompareValues(ip->cmp, sp[-1], sp[0], *context));
+                    sp[0] = ObjectHolder::None();
+                    VM_NEXT();
+                }
+                VM_TARGET(CompareVarConst) {
+                    *sp++ = runtime::MakeBool(
+                        CompareValues(ip->cmp, LoadVariable(*closure, symbols[ip->a]), constants[ip->b], *context));
+                    VM_NEXT();
+                }
+                VM_TARGET(CompareSelfFieldVar) {
+                    const ObjectHolder& field = LoadField(LoadVariable(*closure, runtime::__SELF_NAME__), symbols[ip->a]);
+                    *sp++ = runtime::MakeBool(
+                        CompareValues(ip->cmp, field, LoadVariable(*closure, symbols[ip->b]), *context));
+                    VM_NEXT();
+                }
+                VM_TARGET(CompareSelfFieldConst) {
+                    const ObjectHolder& field = LoadField(LoadVariable(*closure, runtime::__SELF_NAME__), symbols[ip->a]);
+                    *sp++ = runtime::MakeBool(CompareValues(ip->cmp, field, constants[ip->b], *context));
+                    VM_NEXT();
+                }
+                VM_TARGET(Not) {
+                    sp[-1] = runtime::MakeBool(!runtime::IsTrue(sp[-1]));
+                    VM_NEXT();
+                }
+                VM_TARGET(Jump) {
+                    VM_JUMP(ip->a);
+                }
+                VM_TARGET(JumpIfFalse) {
+                    --sp;
+                    const bool condition = runtime::IsTrue(*sp);
+                    *sp = ObjectHolder::None();
+                    if (!condition) {
+                        VM_JUMP(ip->a);
+                    }
+                    VM_NEXT();
+                }
+                VM_TARGET(JumpIfTrueOrPop) {
+                    // истинное левое значение и есть результат or
+                    if (runtime::IsTrue(sp[-1])) {
+                        VM_JUMP(ip->a);
+                    }
+                    *--sp = ObjectHolder::None();
+                    VM_NEXT();
+                }
+                VM_TARGET(JumpIfFalseOrPop) {
+                    // ложное левое значение и есть результат and
+                    if (!runtime::IsTrue(sp[-1])) {
+                        VM_JUMP(ip->a);
+                    }
+                    *--sp = ObjectHolder::None();
+                    VM_NEXT();
+                }
+                VM_TARGET(Call) {
+                    // объект и аргументы остаются на стеке до конца вызова
+                    ObjectHolder* args = sp - ip->b;
+                    args[-1] = CallMethod(args[-1], symbols[ip->a], args, ip->b, *context);
+                    while (sp != args) {
+                        *--sp = ObjectHolder::None();
+                    }
+                    VM_NEXT();
+                }
+                VM_TARGET(New) {
+                    {
+                        ObjectHolder* args = sp - ip->b;
+                        ObjectHolder instance = ObjectHolder::Own(runtime::ClassInstance(*code->classes[ip->a]));
+                        static_cast<runtime::ClassInstance*>(instance.Get())->Call(runtime::__INIT_METHOD__, args, ip->b,
+                            *context);
+                        while (sp != args) {
+                            *--sp = ObjectHolder::None();
+                        }
+                        *sp++ = std::move(instance);
+                    }
+                    VM_NEXT();
+                }
+                VM_TARGET(Print) {
+                    ObjectHolder* args = sp - ip->b;
+                    PrintValues(args, ip->b, *context);
+                    while (sp != args) {
+                        *--sp = ObjectHolder::None();
+                    }
+                    VM_NEXT();
+                }
+                VM_TARGET(IterStart) {
+                    StartLoop(loops, std::move(*--sp));
+                    VM_NEXT();
+                }
+                VM_TARGET(IterNext) {
+                    bool has_item;
+                    {
+                        ObjectHolder item;
+                        has_item = NextItem(loops.back(), item);
+                        if (has_item) {
+                            (*closure)[symbols[ip->a]] = std::move(item);
+                        }
+                    }
+                    if (!has_item) {
+                        loops.pop_back();
+                        VM_JUMP(ip->b);
+                    }
+                    VM_NEXT();
+                }
+                VM_TARGET(Exec) {
+                    *sp++ = code->nodes[ip->a]->Execute(*closure, *context);
+                    VM_NEXT();
+                }
+                VM_TARGET(Return) {
+                    return std::move(*--sp);
+                }
+#ifndef MYTHON_THREADED_DISPATCH
+                }
+            }
+#endif
+#undef VM_TARGET
+#undef VM_DISPATCH
+#undef VM_COUNT
+#undef VM_NEXT
+#undef VM_JUMP
+        }
+    }  // namespace
+
+    const ObjectHolder& LoadVariable(const Closure& scope, Symbol name) {
+        auto found = scope.find(name);
+        if (found == scope.end()) {
+            throw std::runtime_error(runtime::__UNDEFINED_VARIABLE_ERROR__);
+        }
+        return found->second;
+    }
+
+    const ObjectHolder& LoadField(const ObjectHolder& object, Symbol name) {
+        if (object.Kind() != ObjectKind::Instance) {
+            throw std::runtime_error(runtime::__UNDEFINED_VARIABLE_ERROR__);
+        }
+        return LoadVariable(static_cast<runtime::ClassInstance*>(object.Get())->Fields(), name);
+    }
+
+    bool CompareValues(CompareOp op, const ObjectHolder& lhs, const ObjectHolder& rhs, Context& context) {
+        if (lhs.Kind() == ObjectKind::Number && rhs.Kind() == ObjectKind::Number) {
+            int64_t lhs_value = static_cast<const runtime::Number*>(lhs.Get())->GetValue();
+            int64_t rhs_value = static_cast<const runtime::Number*>(rhs.Get())->GetValue();
+            switch (op) {
+            case CompareOp::Less:
+                return lhs_value < rhs_value;
+            case CompareOp::LessOrEqual:
+                return lhs_value <= rhs_value;
+            case CompareOp::Greater:
+                return lhs_value > rhs_value;
+            case CompareOp::GreaterOrEqual:
+                return lhs_value >= rhs_value;
+            case CompareOp::Equal:
+                return lhs_value == rhs_value;
+            case CompareOp::NotEqual:
+                return lhs_value != rhs_value;
+            }
+        }
+        return runtime::Compare(op, lhs, rhs, context);
+    }
+
+    ObjectHolder ArithmeticValues(runtime::ArithmeticOp op, const ObjectHolder& lhs, const ObjectHolder& rhs,
+        Context& context) {
+        if (lhs.Kind() == ObjectKind::Number && rhs.Kind() == ObjectKind::Number) {
+            int64_t lhs_value = static_cast<const runtime::Number*>(lhs.Get())->GetValue();
+            int64_t rhs_value = static_cast<const runtime::Number*>(rhs.Get())->GetValue();
+            switch (op) {
+            case runtime::ArithmeticOp::Add:
+                return runtime::NumberAdd(lhs_value, rhs_value);
+            case runtime::ArithmeticOp::Sub:
+                return runtime::NumberSub(lhs_value, rhs_value);
+            case runtime::ArithmeticOp::Mult:
+                return runtime::NumberMul(lhs_value, rhs_value);
+            case runtime::ArithmeticOp::Div:
+                return runtime::NumberDiv(lhs_value, rhs_value);
+            }
+        }
+        return runtime::Arithmetic(op, lhs, rhs, context);
+    }
+
+    ObjectHolder CallMethod(const ObjectHolder& object, Symbol method, const ObjectHolder* args, size_t count,
+        Context& context) {
+        if (object.Kind() == ObjectKind::Instance) {
+            auto* instance = static_cast<runtime::ClassInstance*>(object.Get());
+            if (instance->HasMethod(method, count)) {
+                return instance->Call(method, args, count, context);
+            }
+            return ObjectHolder::None();
+        }
+        // встроенные методы списков, словарей и числовых массивов
+        std::vector<ObjectHolder> builtin_args(args, args + count);
+        if (runtime::List* list = object.TryAs<runtime::List>()) {
+            return list->Call(method, builtin_args, context);
+        }
+        else if (runtime::Dict* dict = object.TryAs<runtime::Dict>()) {
+            return dict->Call(method, builtin_args, context);
+        }
+        else if (runtime::IntArray* array = object.TryAs<runtime::IntArray>()) {
+            return array->Call(method, builtin_args, context);
+        }
+        else if (runtime::FloatArray* array = object.TryAs<runtime::FloatArray>()) {
+            return array->Call(method, builtin_args, context);
+        }
+        throw std::runtime_error("Method \""s + method.Name() + "\" called on non-object value"s);
+    }
+
+    void StartLoop(std::vector<Loop>& loops, ObjectHolder iterable) {
+        Loop loop;
+        if (iterable.TryAs<runtime::List>()) {
+            loop.kind = Loop::Kind::List;
+        }
+        else if (const runtime::Dict* dict = iterable.TryAs<runtime::Dict>()) {
+            loop.kind = Loop::Kind::Dict;
+            loop.size = dict->Size();
+        }
+        else if (iterable.TryAs<runtime::IntArray>()) {
+            loop.kind = Loop::Kind::IntArray;
+        }
+        else if (iterable.TryAs<runtime::FloatArray>()) {
+            loop.kind = Loop::Kind::FloatArray;
+        }
+        else if (const runtime::String* str = iterable.TryAs<runtime::String>()) {
+            loop.kind = Loop::Kind::String;
+            loop.chars = std::string(str->View());
+        }
+        else {
+            throw std::runtime_error("Object is not iterable");
+        }
+        loop.iterable = std::move(iterable);
+        loops.push_back(std::move(loop));
+    }
+
+    bool NextItem(Loop& loop, ObjectHolder& item) {
+        size_t i = loop.index++;
+        switch (loop.kind) {
+        case Loop::Kind::List: {
+            // идём по индексу, так как тело цикла может дописывать элементы в список
+            auto* list = static_cast<runtime::List*>(loop.iterable.Get());
+            if (i < list->Size()) {
+                item = list->Values()[i];
+                return true;
+            }
+            return false;
+        }
+        case Loop::Kind::Dict: {
+            // как и ast::ForEach, не даём телу цикла менять размер словаря
+            auto* dict = static_cast<runtime::Dict*>(loop.iterable.Get());
+            if (dict->Size() != loop.size) {
+                throw std::runtime_error(runtime::__DICT_CHANGED_SIZE_ERROR__);
+            }
+            if (i < loop.size) {
+                item = dict->Entries()[i].key;
+                return true;
+            }
+            return false;
+        }
+        case Loop::Kind::IntArray: {
+            auto* array = static_cast<runtime::IntArray*>(loop.iterable.Get());
+            if (i < array->Size()) {
+                item = runtime::MakeNumber(array->Values()[i]);
+                return true;
+            }
+            return false;
+        }
+        case Loop::Kind::FloatArray: {
+            auto* array = static_cast<runtime::FloatArray*>(loop.iterable.Get());
+            if (i < array->Size()) {
+                item = ObjectHolder::Own(runtime::Float(array->Values()[i]));
+                return true;
+            }
+            return false;
+        }
+        case Loop::Kind::String:
+            if (i < loop.chars.size()) {
+                item = ObjectHolder::Own(runtime::String::Intern(std::string_view(&loop.chars[i], 1)));
+                return true;
+            }
+            return false;
+        }
+        return false;
+    }
+
+    void PrintValues(const ObjectHolder* values, size_t count, Context& context) {
+        std::ostream& out = context.GetOutputStream();
+        for (size_t i = 0; i < count; ++i) {
+            if (i != 0) {
+                out << ' ';
+            }
+            if (values[i]) {
+                values[i].Get()->Print(out, context);
+            }
+            else {
+                out << "None";
+            }
+        }
+        out << '\n';
+    }
+
+    const char* OpcodeName(Opcode op) {
+        static const char* const names[] = {
+#define MYTHON_OPCODE_NAME(name) #name,
+            MYTHON_OPCODES(MYTHON_OPCODE_NAME)
+#undef MYTHON_OPCODE_NAME
+        };
+        return names[static_cast<size_t>(op)];
+    }
+
+    Function::Function(std::unique_ptr<Executable> source)
+        : _source(std::move(source)) {
+        Compiler(_code).CompileFunction(*_source);
+#ifdef MYTHON_THREADED_DISPATCH
+        const void* const* handlers = nullptr;
+        Interpret(nullptr, nullptr, nullptr, &handlers);
+        for (Instruction& instruction : _code.instructions) {
+            instruction.handler = handlers[static_cast<size_t>(instruction.op)];
+        }
+#endif
+    }
+
+    ObjectHolder Function::Execute(Closure& closure, Context& context) {
+        return Interpret(&_code, &closure, &context, nullptr);
+    }
+
+    ExecutionStats Function::GetStats() const {
+        ExecutionStats stats{ _code.instructions.size(), _code.dispatches };
+        // методы классов заменены скомпилированными при компиляции объявления класса
+        for (Executable* node : _code.nodes) {
+            if (auto* definition = dynamic_cast<ast::ClassDefinition*>(node)) {
+                for (const runtime::Method& method : definition->GetClass().GetMethods()) {
+                    if (auto* body = dynamic_cast<const Function*>(method.body.get())) {
+                        ExecutionStats method_stats = body->GetStats();
+                        stats.instructions += method_stats.instructions;
+                        stats.dispatches += method_stats.dispatches;
+                    }
+                }
+            }
+        }
+        return stats;
+    }
+
+    std::unique_ptr<Function> CompileProgram(std::unique_ptr<Executable> program) {
+        return std::make_unique<Function>(std::move(program));
+    }
+
+}  // namespace bytecode
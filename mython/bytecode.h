@@ -0,0 +1,185 @@
+#pragma once
+
+#include "runtime.h"
+#include "statement.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// В GCC и Clang обработчики инструкций переходят друг к другу по адресам меток (direct threading).
+// Определите MYTHON_SWITCH_DISPATCH, чтобы собрать переносимый цикл со switch
+#if (defined(__GNUC__) || defined(__clang__)) && !defined(MYTHON_SWITCH_DISPATCH)
+#define MYTHON_THREADED_DISPATCH 1
+#endif
+
+// Определите MYTHON_DISPATCH_STATS, чтобы машины считали выполненные инструкции в Code::dispatches.
+// Без него счётчик не ведётся и остаётся нулевым, переход к следующей инструкции ничего не считает
+
+namespace bytecode {
+
+    // Инструкции стековой машины. Операнды a и b - индексы в таблицах Code, адреса переходов
+    // или число аргументов, cmp - оператор сравнения
+#define MYTHON_OPCODES(X)                                                                       \
+    X(PushConst)                /* a: константа */                                              \
+    X(PushNone)                                                                                 \
+    X(LoadVar)                  /* a: имя переменной */                                         \
+    X(LoadField)                /* a: имя поля объекта с вершины стека */                       \
+    X(LoadSelfField)            /* a: имя поля self, заменяет LoadVar self, LoadField */        \
+    X(StoreVar)                 /* a: имя переменной, снимает значение */                       \
+    X(StoreField)               /* a: имя поля, снимает значение и объект */                    \
+    X(Pop)                                                                                      \
+    X(Add)                                                                                      \
+    X(Sub)                                                                                      \
+    X(Mult)                                                                                     \
+    X(Div)                                                                                      \
+    X(AddVarConst)              /* a: переменная, b: константа, заменяет LoadVar, PushConst, Add */ \
+    X(Compare)                  /* cmp: оператор */                                             \
+    X(CompareVarConst)          /* a: переменная, b: константа, cmp: оператор */                \
+    X(CompareSelfFieldVar)      /* a: поле self, b: переменная, cmp: оператор */                \
+    X(CompareSelfFieldConst)    /* a: поле self, b: константа, cmp: оператор */                 \
+    X(Not)                                                                                      \
+    X(Jump)                     /* a: адрес перехода */                                         \
+    X(JumpIfFalse)              /* a: адрес перехода, снимает условие */                        \
+    X(JumpIfTrueOrPop)          /* a: адрес перехода для or */                                  \
+    X(JumpIfFalseOrPop)         /* a: адрес перехода для and */                                 \
+    X(Call)                     /* a: имя метода, b: число аргументов */                        \
+    X(New)                      /* a: класс, b: число аргументов __init__ */                    \
+    X(Print)                    /* b: число аргументов */                                       \
+    X(IterStart)                /* снимает итерируемый объект и начинает цикл */                \
+    X(IterNext)                 /* a: имя переменной цикла, b: адрес выхода из цикла */         \
+    X(Exec)                     /* a: узел дерева, выполняемый без компиляции */                \
+    X(Return)                   /* снимает результат и завершает функцию */
+
+    enum class Opcode : uint8_t {
+#define MYTHON_OPCODE_ENUM(name) name,
+        MYTHON_OPCODES(MYTHON_OPCODE_ENUM)
+#undef MYTHON_OPCODE_ENUM
+    };
+
+    // Возвращает название инструкции, например "LoadSelfField"
+    [[nodiscard]] const char* OpcodeName(Opcode op);
+
+    struct Instruction {
+        Opcode op = Opcode::PushNone;
+        runtime::CompareOp cmp = runtime::CompareOp::Equal;
+        uint32_t a = 0;
+        uint32_t b = 0;
+#ifdef MYTHON_THREADED_DISPATCH
+        const void* handler = nullptr;      // адрес обработчика инструкции внутри интерпретатора
+#endif
+    };
+
+    // Линейная форма тела метода или программы
+    struct Code {
+        std::vector<Instruction> instructions;
+        std::vector<runtime::ObjectHolder> constants;   // константы дерева, разделяемые без владения
+        std::vector<runtime::Symbol> symbols;
+        std::vector<runtime::Executable*> nodes;        // узлы дерева, выполняемые инструкцией Exec
+        std::vector<const runtime::Class*> classes;
+        size_t max_stack = 0;                           // наибольшая глубина стека значений
+        uint64_t dispatches = 0;                        // выполнено инструкций при MYTHON_DISPATCH_STATS
+    };
+
+    // Размер и счётчик выполнения кода программы вместе с методами объявленных в ней классов
+    struct ExecutionStats {
+        size_t instructions = 0;
+        uint64_t dispatches = 0;
+    };
+
+#ifdef MYTHON_DISPATCH_STATS
+    // Считает инструкции одного вызова и добавляет их к счётчику кода при любом выходе из него,
+    // в том числе по исключению
+    class DispatchCounter {
+    public:
+        explicit DispatchCounter(uint64_t& total)
+            : _total(total) {
+        }
+        DispatchCounter(const DispatchCounter&) = delete;
+        DispatchCounter& operator=(const DispatchCounter&) = delete;
+        ~DispatchCounter() {
+            _total += _count;
+        }
+
+        void Count() {
+            ++_count;
+        }
+
+    private:
+        uint64_t& _total;
+        uint64_t _count = 0;
+    };
+#endif
+
+    // Состояние цикла for
+    struct Loop {
+        enum class Kind : uint8_t {
+            List,
+            Dict,           // обходится по ключам
+            IntArray,
+            FloatArray,
+            String,         // обходится посимвольно
+        };
+
+        runtime::ObjectHolder iterable;     // держим итерируемый объект до конца цикла
+        std::string chars;                  // символы обходимой строки
+        size_t index = 0;
+        size_t size = 0;                    // размер словаря в начале цикла
+        Kind kind = Kind::List;
+    };
+
+    // Операции, общие для стековой машины и регистровой машины regvm. Сообщения об ошибках совпадают
+    // с сообщениями узлов дерева
+
+    // Значение переменной name. Если переменной нет, выбрасывает runtime_error
+    const runtime::ObjectHolder& LoadVariable(const runtime::Closure& scope, runtime::Symbol name);
+    // Значение поля name экземпляра класса object
+    const runtime::ObjectHolder& LoadField(const runtime::ObjectHolder& object, runtime::Symbol name);
+    // Арифметика и сравнение с быстрой веткой для двух Number
+    runtime::ObjectHolder ArithmeticValues(runtime::ArithmeticOp op, const runtime::ObjectHolder& lhs,
+        const runtime::ObjectHolder& rhs, runtime::Context& context);
+    bool CompareValues(runtime::CompareOp op, const runtime::ObjectHolder& lhs, const runtime::ObjectHolder& rhs,
+        runtime::Context& context);
+    // Вызов метода экземпляра либо встроенного метода контейнера. У экземпляра без подходящего метода
+    // результат - None, как у ast::MethodCall
+    runtime::ObjectHolder CallMethod(const runtime::ObjectHolder& object, runtime::Symbol method,
+        const runtime::ObjectHolder* args, size_t count, runtime::Context& context);
+    // Начинает цикл по iterable. Если объект не итерируемый, выбрасывает runtime_error
+    void StartLoop(std::vector<Loop>& loops, runtime::ObjectHolder iterable);
+    // Записывает в item очередной элемент цикла. Возвращает false, когда элементы закончились
+    bool NextItem(Loop& loop, runtime::ObjectHolder& item);
+    // Выводит значения так же, как ast::Print
+    void PrintValues(const runtime::ObjectHolder* values, size_t count, runtime::Context& context);
+
+    /*
+     * Тело метода либо программа, выполняемые стековой машиной вместо обхода дерева.
+     * Владеет исходным деревом, так как константы и инструкции Exec ссылаются на его узлы.
+     * Узлы, для которых нет инструкций (списки, словари, индексирование, sort и т.п.), выполняются
+     * как есть инструкцией Exec. Вложенные классы компилируются вместе с телом: тела их методов
+     * заменяются объектами Function
+     */
+    class Function : public runtime::Executable {
+    public:
+        explicit Function(std::unique_ptr<runtime::Executable> source);
+
+        // Выполняет код в таблице символов closure и возвращает результат return либо None
+        runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+
+        [[nodiscard]] const Code& GetCode() const {
+            return _code;
+        }
+        // Размер и счётчик выполнения этого кода и методов классов, объявленных в нём
+        [[nodiscard]] ExecutionStats GetStats() const;
+
+    private:
+        std::unique_ptr<runtime::Executable> _source;
+        Code _code;
+    };
+
+    // Компилирует программу, разобранную ParseProgram, вместе с методами всех объявленных в ней классов.
+    // Тела методов заменяются в самих классах программы, поэтому после компиляции их выполняет машина,
+    // даже если программа запущена обходом дерева
+    [[nodiscard]] std::unique_ptr<Function> CompileProgram(std::unique_ptr<runtime::Executable> program);
+
+}  // namespace bytecode
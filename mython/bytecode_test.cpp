@@ -0,0 +1,249 @@
+#include "bytecode.h"
+#include "lexer.h"
+#include "parse.h"
+#include "test_runner_p.h"
+
+#include <algorithm>
+
+using namespace std;
+
+namespace bytecode {
+
+    namespace {
+
+        unique_ptr<runtime::Executable> Parse(const string& program) {
+            istringstream input(program);
+            parse::Lexer lexer(input);
+            return ParseProgram(lexer);
+        }
+
+        // Выполняет программу обходом дерева и стековой машиной и проверяет, что вывод совпадает
+        string RunBoth(const string& program) {
+            runtime::DummyContext tree_context;
+            runtime::Closure tree_closure;
+            Parse(program)->Execute(tree_closure, tree_context);
+
+            runtime::DummyContext vm_context;
+            runtime::Closure vm_closure;
+            CompileProgram(Parse(program))->Execute(vm_closure, vm_context);
+
+            ASSERT_EQUAL(vm_context.output.str(), tree_context.output.str());
+            return vm_context.output.str();
+        }
+
+        bool HasOpcode(const Code& code, Opcode op) {
+            return any_of(code.instructions.begin(), code.instructions.end(), [op](const Instruction& instruction) {
+                return instruction.op == op;
+            });
+        }
+
+        void TestArithmeticAndLoops() {
+            const string program = R"(
+total = 0
+for i in [1, 2, 3, 4]:
+  if i > 2:
+    total = total + i * 10
+  else:
+    total = total + 1
+print total, 7 / 2, 'a' + 'b', 1.5 + 1
+for c in 'abc':
+  print c
+d = {'x': 1, 'y': 2}
+for k in d:
+  print k, d[k]
+print
+print None, 1 == 1, not 0
+for x in floatarray([0.5, 2]):
+  print x
+)"s;
+            ASSERT_EQUAL(RunBoth(program), "72 3 ab 2.5\na\nb\nc\nx 1\ny 2\n\nNone True True\n0.5\n2.0\n"s);
+        }
+
+        void TestShortCircuit() {
+            const string program = R"(
+n = 0
+items = []
+print n != 0 and 10 / n > 1, n or 'default', items and items[0] > 1
+print 1 and 2, 0 or 0, 3 or 1 / n
+)"s;
+            ASSERT_EQUAL(RunBoth(program), "False default []\n2 0 3\n"s);
+        }
+
+        void TestMethodsAndReturns() {
+            const string program = R"(
+class Counter:
+  def __init__(limit):
+    self.value = 0
+    self.limit = limit
+
+  def done():
+    return self.value >= self.limit
+
+  def step(delta):
+    self.value = self.value + delta
+    return self
+
+  def first_over(values):
+    for v in values:
+      if self.value < v:
+        return v
+    return None
+
+  def __str__():
+    return 'Counter(' + str(self.value) + ')'
+
+c = Counter(10)
+while_steps = [1, 2, 3, 4, 5, 6]
+for s in while_steps:
+  if not c.done():
+    c.step(s)
+print c, c.done(), c.first_over([3, 12, 20]), c.first_over([1])
+print c.missing(1)
+)"s;
+            ASSERT_EQUAL(RunBoth(program), "Counter(10) True 12 None\nNone\n"s);
+        }
+
+        void TestTreeFallbacks() {
+            const string program = R"(
+class Empty:
+  def size():
+    return 0
+
+class Pair:
+  def __init__(a, b):
+    self.a = a
+    self.b = b
+
+items = [3, 1, 2]
+items.append(0)
+sort(items)
+items[0] = 10
+e = Empty()
+p = Pair(1)
+q = Pair(1, 2)
+print items, len(items), e.size(), 2 in items, str(q.b)
+)"s;
+            ASSERT_EQUAL(RunBoth(program), "[10, 1, 2, 3] 4 0 True 2\n"s);
+        }
+
+        void TestSuperinstructions() {
+            const string program = R"(
+class Point:
+  def __init__(x):
+    self.x = x
+
+  def shifted(limit):
+    n = limit + 1
+    if self.x < limit:
+      return self.x
+    if self.x > 100:
+      return n
+    if n == 3:
+      return 3
+    return self.x
+
+p = Point(5)
+q = Point(200)
+print p.shifted(10), p.shifted(1), q.shifted(2)
+)"s;
+            ASSERT_EQUAL(RunBoth(program), "5 5 3\n"s);
+
+            auto function = CompileProgram(Parse(program));
+            runtime::DummyContext context;
+            runtime::Closure closure;
+            function->Execute(closure, context);
+
+            const auto* point = closure.at(runtime::Symbol("Point")).TryAs<runtime::Class>();
+            ASSERT(point != nullptr);
+            const runtime::Method* method = point->GetMethod(runtime::Symbol("shifted"));
+            ASSERT(method != nullptr);
+            const auto* compiled = dynamic_cast<const Function*>(method->body.get());
+            ASSERT(compiled != nullptr);
+
+            const Code& code = compiled->GetCode();
+            ASSERT(HasOpcode(code, Opcode::AddVarConst));
+            ASSERT(HasOpcode(code, Opcode::CompareSelfFieldVar));
+            ASSERT(HasOpcode(code, Opcode::CompareSelfFieldConst));
+            ASSERT(HasOpcode(code, Opcode::CompareVarConst));
+            ASSERT(HasOpcode(code, Opcode::LoadSelfField));
+            ASSERT(!HasOpcode(code, Opcode::Add));
+            ASSERT(!HasOpcode(code, Opcode::Compare));
+            ASSERT_EQUAL(string(OpcodeName(Opcode::LoadSelfField)), "LoadSelfField"s);
+        }
+
+        void TestJumpTargetsAreNotFused() {
+            // после or следующий операнд сложения стоит за меткой, его нельзя слить с инструкциями до неё
+            const string program = R"(
+x = 0
+y = (x or 5) + 1
+z = 1 + (x and 7)
+print y, z
+)"s;
+            ASSERT_EQUAL(RunBoth(program), "6 1\n"s);
+        }
+
+        void TestTemporariesAreReleased() {
+            // промежуточные значения снимаются со стека и освобождаются при любом способе диспетчеризации
+            const string program = R"(
+total = 0
+i = 0
+for step in intarray(100):
+  i = i + 1
+  total = total + i * 3000 - i * 2000
+  if total > 10 and i < 50:
+    total = total - 1
+)"s;
+            runtime::HeapModeScope heap_scope(runtime::HeapMode::Pooled);
+            const size_t live_before = runtime::Heap::GetPoolStats(sizeof(runtime::Number)).live;
+            {
+                runtime::DummyContext context;
+                runtime::Closure closure;
+                CompileProgram(Parse(program))->Execute(closure, context);
+                ASSERT(runtime::Heap::GetPoolStats(sizeof(runtime::Number)).live <= live_before + 3);
+            }
+            ASSERT_EQUAL(runtime::Heap::GetPoolStats(sizeof(runtime::Number)).live, live_before);
+        }
+
+        void TestErrors() {
+            runtime::DummyContext context;
+            runtime::Closure closure;
+            auto function = CompileProgram(Parse("print undefined\n"s));
+            try {
+                function->Execute(closure, context);
+                ASSERT(false);
+            }
+            catch (const std::runtime_error&) {
+            }
+
+            function = CompileProgram(Parse("for c in 5:\n  print c\n"s));
+            try {
+                function->Execute(closure, context);
+                ASSERT(false);
+            }
+            catch (const std::runtime_error&) {
+            }
+
+            // тело цикла добавляет ключи в обходимый словарь
+            function = CompileProgram(Parse("d = {1: 1}\nfor k in d:\n  d[k + 1] = 1\n"s));
+            try {
+                function->Execute(closure, context);
+                ASSERT(false);
+            }
+            catch (const std::runtime_error&) {
+            }
+        }
+
+    }  // namespace
+
+    void RunBytecodeTests(TestRunner& tr) {
+        RUN_TEST(tr, bytecode::TestArithmeticAndLoops);
+        RUN_TEST(tr, bytecode::TestShortCircuit);
+        RUN_TEST(tr, bytecode::TestMethodsAndReturns);
+        RUN_TEST(tr, bytecode::TestTreeFallbacks);
+        RUN_TEST(tr, bytecode::TestSuperinstructions);
+        RUN_TEST(tr, bytecode::TestJumpTargetsAreNotFused);
+        RUN_TEST(tr, bytecode::TestTemporariesAreReleased);
+        RUN_TEST(tr, bytecode::TestErrors);
+    }
+
+}  // namespace bytecode
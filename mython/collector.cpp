@@ -0,0 +1,398 @@
+#include "collector.h"
+#include "runtime.h"
+
+#include <unordered_set>
+#include <vector>
+
+namespace runtime {
+
+    namespace {
+
+        // Стадия цикла сборки
+        enum class Phase {
+            Idle,           // цикл не начат
+            Mark,           // обход подграфов кандидатов с пробным вычитанием внутренних ссылок
+            ScanSeed,       // поиск объектов с внешними ссылками
+            ScanPropagate,  // всё достижимое из объектов с внешними ссылками живо
+            ValidateSeed,   // отбор оставшихся серых объектов для проверки
+            Validate,       // проверка отобранных объектов по настоящим счётчикам
+            Clear,          // разрыв ссылок мусорных объектов
+            Sweep,          // снятие закрепления, мусор при этом удаляется
+        };
+
+        struct CollectorState {
+            std::vector<Object*> roots;                     // кандидаты в корни циклов
+            size_t threshold = __GC_DEFAULT_THRESHOLD__;
+            size_t budget = __GC_DEFAULT_SLICE_BUDGET__;
+            size_t countdown = __GC_SLICE_INTERVAL__;       // созданий объектов до следующего шага
+            bool in_slice = false;                          // идёт шаг, повторный вход запрещён
+
+            Phase phase = Phase::Idle;
+            std::vector<Object*> visited;                   // закреплённые объекты текущего цикла
+            std::vector<Object*> stack;                     // стек обхода текущей стадии
+            std::vector<Object*> suspects;                  // серые объекты, отобранные для проверки
+            std::vector<Object*> garbage;                   // подтверждённый мусор
+            size_t cursor = 0;                              // позиция в visited или garbage
+
+            CycleCollector::Stats stats;
+
+            ~CollectorState();
+        };
+
+        CollectorState& State() {
+            thread_local CollectorState state;
+            return state;
+        }
+
+        // Запрещает повторный вход в шаг сборки, например из деструкторов удаляемых объектов
+        class SliceGuard {
+        public:
+            explicit SliceGuard(CollectorState& state)
+                : _state(state) {
+                _state.in_slice = true;
+            }
+            ~SliceGuard() {
+                _state.in_slice = false;
+            }
+
+        private:
+            CollectorState& _state;
+        };
+
+        CollectorState::~CollectorState() {
+            // закреплённые объекты недоведённого цикла иначе остались бы в памяти навсегда
+            if (phase != Phase::Idle && !in_slice) {
+                CycleCollector::Collect();
+            }
+        }
+
+    }  // namespace
+
+    void CycleCollector::SetThreshold(size_t threshold) {
+        State().threshold = threshold;
+    }
+
+    size_t CycleCollector::GetThreshold() {
+        return State().threshold;
+    }
+
+    void CycleCollector::SetSliceBudget(size_t budget) {
+        State().budget = budget;
+    }
+
+    size_t CycleCollector::GetSliceBudget() {
+        return State().budget;
+    }
+
+    size_t CycleCollector::CandidateCount() {
+        return State().roots.size();
+    }
+
+    bool CycleCollector::InProgress() {
+        return State().phase != Phase::Idle;
+    }
+
+    size_t CycleCollector::Collect() {
+        CollectorState& state = State();
+        if (state.in_slice) {
+            return 0;
+        }
+        size_t freed_before = state.stats.freed_objects;
+        FinishCycle();
+        StartCycle();
+        RunSlice(0);
+        return state.stats.freed_objects - freed_before;
+    }
+
+    CycleCollector::Stats CycleCollector::GetStats() {
+        return State().stats;
+    }
+
+    void CycleCollector::ResetStats() {
+        State().stats = {};
+    }
+
+    void CycleCollector::WriteBarrier(const ObjectHolder& value) {
+        // новая ссылка на объект текущего цикла делает его живым для этого цикла
+        if (value.IsOwning()) {
+            Object::Header& header = value.Get()->_header;
+            if (header.pinned && header.color != GcColor::Black) {
+                header.dirty = true;
+            }
+        }
+    }
+
+    void CycleCollector::PossibleRoot(Object& object) {
+        if (object._header.root_index != __GC_NOT_BUFFERED__) {
+            return;
+        }
+        CollectorState& state = State();
+        object._header.root_index = static_cast<uint32_t>(state.roots.size());
+        state.roots.push_back(&object);
+    }
+
+    void CycleCollector::Forget(Object& object) {
+        // переносим последний элемент буфера на место удаляемого
+        std::vector<Object*>& roots = State().roots;
+        uint32_t index = object._header.root_index;
+        roots[index] = roots.back();
+        roots[index]->_header.root_index = index;
+        roots.pop_back();
+        object._header.root_index = __GC_NOT_BUFFERED__;
+    }
+
+    void CycleCollector::ForgetGraph(Object& object) {
+        std::unordered_set<Object*> visited{ &object };
+        std::vector<Object*> stack(1, &object);
+        while (!stack.empty()) {
+            Object* current = stack.back();
+            stack.pop_back();
+            if (current->_header.root_index != __GC_NOT_BUFFERED__) {
+                Forget(*current);
+            }
+            current->ForEachReference([&visited, &stack](const ObjectHolder& holder) {
+                if (holder.IsOwning() && visited.insert(holder.Get()).second) {
+                    stack.push_back(holder.Get());
+                }
+            });
+        }
+    }
+
+    void CycleCollector::MaybeCollect() {
+        CollectorState& state = State();
+        if (state.in_slice) {
+            return;
+        }
+        if (state.phase == Phase::Idle) {
+            if (state.threshold != 0 && state.roots.size() >= state.threshold) {
+                StartCycle();
+                RunSlice(state.budget);
+            }
+        }
+        else if (--state.countdown == 0) {
+            state.countdown = __GC_SLICE_INTERVAL__;
+            RunSlice(state.budget);
+        }
+    }
+
+    void CycleCollector::FinishCycle() {
+        CollectorState& state = State();
+        if (state.phase != Phase::Idle && !state.in_slice) {
+            RunSlice(0);
+        }
+    }
+
+    void CycleCollector::StartCycle() {
+        CollectorState& state = State();
+        // забираем кандидатов: объекты, ставшие кандидатами во время цикла, попадут в новый буфер
+        std::vector<Object*> roots;
+        roots.swap(state.roots);
+        for (Object* root : roots) {
+            root->_header.root_index = __GC_NOT_BUFFERED__;
+            Pin(*root);
+        }
+        state.phase = Phase::Mark;
+        state.countdown = __GC_SLICE_INTERVAL__;
+        state.stack = std::move(roots);
+    }
+
+    void CycleCollector::Pin(Object& object) {
+        Object::Header& header = object._header;
+        ++header.count;
+        header.pinned = true;
+        header.trial = static_cast<int32_t>(header.count - 1);
+        header.color = GcColor::Gray;
+        State().visited.push_back(&object);
+    }
+
+    bool CycleCollector::RunSlice(size_t budget) {
+        CollectorState& state = State();
+        auto start = std::chrono::steady_clock::now();
+        bool finished = false;
+        {
+            SliceGuard guard(state);
+            finished = Advance(budget);
+        }
+        auto pause = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+        ++state.stats.slices;
+        state.stats.total_time += pause;
+        if (pause > state.stats.max_pause) {
+            state.stats.max_pause = pause;
+        }
+        return finished;
+    }
+
+    bool CycleCollector::Advance(size_t budget) {
+        CollectorState& state = State();
+        size_t work = 0;
+
+        // передаёт visit объекты, на которые object держит владеющие ссылки
+        auto for_each_child = [&work](Object& object, auto&& visit) {
+            object.ForEachReference([&work, &visit](const ObjectHolder& holder) {
+                ++work;
+                if (holder.IsOwning()) {
+                    visit(*holder.Get());
+                }
+            });
+        };
+        // делает живыми серые объекты, достижимые из объектов стека
+        auto propagate_black = [&state, &for_each_child]() {
+            while (!state.stack.empty()) {
+                Object* object = state.stack.back();
+                state.stack.pop_back();
+                for_each_child(*object, [&state](Object& child) {
+                    if (child._header.pinned && child._header.color == GcColor::Gray) {
+                        child._header.color = GcColor::Black;
+                        state.stack.push_back(&child);
+                    }
+                });
+            }
+        };
+
+        while (state.phase != Phase::Idle) {
+            if (budget != 0 && work >= budget) {
+                return false;
+            }
+            ++work;
+
+            switch (state.phase) {
+            case Phase::Mark: {
+                if (state.stack.empty()) {
+                    state.phase = Phase::ScanSeed;
+                    state.cursor = 0;
+                    break;
+                }
+                Object* object = state.stack.back();
+                state.stack.pop_back();
+                // ссылки внутри подграфа пробно вычитаем. Каждый объект попадает на стек один раз, при закреплении
+                for_each_child(*object, [&state](Object& child) {
+                    if (!child._header.pinned) {
+                        Pin(child);
+                        state.stack.push_back(&child);
+                    }
+                    --child._header.trial;
+                });
+                break;
+            }
+            case Phase::ScanSeed: {
+                if (state.cursor == state.visited.size()) {
+                    state.phase = Phase::ScanPropagate;
+                    break;
+                }
+                Object* object = state.visited[state.cursor++];
+                Object::Header& header = object->_header;
+                if (header.color == GcColor::Gray && (header.trial > 0 || header.dirty)) {
+                    header.color = GcColor::Black;
+                    state.stack.push_back(object);
+                }
+                break;
+            }
+            case Phase::ScanPropagate: {
+                if (state.stack.empty()) {
+                    state.phase = Phase::ValidateSeed;
+                    state.cursor = 0;
+                    break;
+                }
+                Object* object = state.stack.back();
+                state.stack.pop_back();
+                for_each_child(*object, [&state](Object& child) {
+                    if (child._header.pinned && child._header.color == GcColor::Gray) {
+                        child._header.color = GcColor::Black;
+                        state.stack.push_back(&child);
+                    }
+                });
+                break;
+            }
+            case Phase::ValidateSeed: {
+                // Цвета меняет только сборщик, поэтому серое множество можно отбирать по шагам
+                if (state.cursor == state.visited.size()) {
+                    state.phase = Phase::Validate;
+                    break;
+                }
+                Object* object = state.visited[state.cursor++];
+                if (object->_header.color == GcColor::Gray) {
+                    state.suspects.push_back(object);
+                }
+                break;
+            }
+            case Phase::Validate: {
+                // Неделимая стадия: программа могла изменить граф между шагами, поэтому отобранные серые
+                // объекты проверяем заново по настоящим счётчикам. Объект с ссылкой извне серого множества
+                // и всё достижимое из него живы, остальное - мусор. Бюджет шага здесь не действует:
+                // счётчики должны быть сняты с одного состояния графа, поэтому пауза пропорциональна
+                // числу серых объектов и их ссылок
+                std::vector<Object*> candidates;
+                candidates.swap(state.suspects);
+                for (Object* object : candidates) {
+                    object->_header.trial = static_cast<int32_t>(object->_header.count - 1);
+                }
+                for (Object* object : candidates) {
+                    for_each_child(*object, [](Object& child) {
+                        if (child._header.pinned && child._header.color == GcColor::Gray) {
+                            --child._header.trial;
+                        }
+                    });
+                }
+                for (Object* object : candidates) {
+                    if (object->_header.color == GcColor::Gray && object->_header.trial > 0) {
+                        object->_header.color = GcColor::Black;
+                        state.stack.push_back(object);
+                        propagate_black();
+                    }
+                }
+                for (Object* object : candidates) {
+                    if (object->_header.color == GcColor::Gray) {
+                        object->_header.color = GcColor::White;
+                        state.garbage.push_back(object);
+                    }
+                }
+                state.phase = Phase::Clear;
+                state.cursor = 0;
+                break;
+            }
+            case Phase::Clear: {
+                if (state.cursor == state.garbage.size()) {
+                    state.phase = Phase::Sweep;
+                    state.cursor = 0;
+                    break;
+                }
+                // мусор удерживается закреплением, поэтому разрыв его ссылок ничего из него не удаляет
+                state.garbage[state.cursor++]->ClearReferences();
+                break;
+            }
+            case Phase::Sweep: {
+                if (state.cursor == state.visited.size()) {
+                    state.visited.clear();
+                    state.garbage.clear();
+                    state.phase = Phase::Idle;
+                    ++state.stats.collections;
+                    break;
+                }
+                // снимаем закрепление. Удаляется мусор и объекты, которые программа отпустила во время цикла
+                Object* object = state.visited[state.cursor++];
+                Object::Header& header = object->_header;
+                bool dirty = header.dirty;
+                header.pinned = false;
+                header.dirty = false;
+                header.color = GcColor::Black;
+                if (--header.count == 0) {
+                    if (header.root_index != __GC_NOT_BUFFERED__) {
+                        Forget(*object);
+                    }
+                    delete object;
+                    ++state.stats.freed_objects;
+                }
+                else if (dirty && header.traceable) {
+                    // граф вокруг объекта менялся во время цикла, проверим его ещё раз в следующем
+                    PossibleRoot(*object);
+                }
+                break;
+            }
+            case Phase::Idle:
+                break;
+            }
+        }
+        return true;
+    }
+
+}  // namespace runtime
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace runtime {
+
+    class Object;
+    class ObjectHolder;
+
+    // Число кандидатов в корни циклов, при котором сборка запускается по умолчанию
+    constexpr size_t __GC_DEFAULT_THRESHOLD__ = 10000;
+    // Объём работы одного шага инкрементальной сборки по умолчанию: число просмотренных объектов и ссылок
+    constexpr size_t __GC_DEFAULT_SLICE_BUDGET__ = 10000;
+    // Через сколько созданий объектов выполняется очередной шаг начатой сборки
+    constexpr size_t __GC_SLICE_INTERVAL__ = 64;
+    // Индекс объекта, не входящего в буфер кандидатов
+    constexpr uint32_t __GC_NOT_BUFFERED__ = UINT32_MAX;
+
+    // Цвет объекта при пробном вычитании ссылок
+    enum class GcColor : uint8_t {
+        Black,  // живой объект, обычное состояние
+        Gray,   // ссылки из подграфа кандидатов пробно вычтены
+        White,  // внешних ссылок не осталось, объект - мусор
+    };
+
+    /*
+     * Сборщик циклических ссылок между объектами Mython.
+     * Счётчик ссылок не освобождает объекты, ссылающиеся друг на друга, например экземпляр, сохранивший self
+     * в поле другого объекта. Контейнер, счётчик которого уменьшился, но не обнулился, запоминается как
+     * кандидат в корни цикла. Сборка пробно вычитает ссылки внутри подграфов кандидатов (алгоритм Bacon-Rajan):
+     * объекты, у которых не осталось внешних ссылок, образуют мусорные циклы и удаляются.
+     *
+     * Сборка инкрементальная: цикл разбит на шаги с ограниченным объёмом работы, которые выполняются
+     * между созданиями объектов. Объекты текущего цикла закреплены лишней ссылкой, поэтому программа не может
+     * удалить их, пока сборщик держит на них указатели. Пробные счётчики хранятся отдельно от настоящих,
+     * а оставшиеся серые объекты перед удалением проверяются по настоящим счётчикам за один неделимый шаг.
+     * Бюджет на этот шаг не действует: его время пропорционально числу серых объектов и их ссылок. Обычно
+     * это мусор, но если программа во время цикла отпустила большую часть подграфа кандидатов, пауза
+     * вырастает до размера всего подграфа. Самый долгий шаг виден в Stats::max_pause.
+     * Барьер записи при присваивании помечает значение, получившее новую ссылку во время цикла, живым.
+     * Состояние сборщика своё у каждого потока, как и неатомарные счётчики ссылок
+     */
+    class CycleCollector {
+    public:
+        struct Stats {
+            size_t collections = 0;                         // завершённых циклов сборки
+            size_t slices = 0;                              // выполненных шагов
+            size_t freed_objects = 0;                       // удалённых объектов
+            std::chrono::nanoseconds max_pause{ 0 };        // самый долгий шаг
+            std::chrono::nanoseconds total_time{ 0 };       // суммарное время всех шагов
+        };
+
+        // Задаёт число кандидатов, при котором сборка запускается автоматически при создании объекта.
+        // Ноль отключает автоматическую сборку
+        static void SetThreshold(size_t threshold);
+        [[nodiscard]] static size_t GetThreshold();
+
+        // Задаёт объём работы одного шага. Ноль выполняет весь цикл за один шаг
+        static void SetSliceBudget(size_t budget);
+        [[nodiscard]] static size_t GetSliceBudget();
+
+        // Возвращает число запомненных кандидатов в корни циклов
+        [[nodiscard]] static size_t CandidateCount();
+
+        // Возвращает true, если начатый цикл сборки ещё не завершён
+        [[nodiscard]] static bool InProgress();
+
+        // Завершает начатый цикл, затем полностью собирает мусорные циклы среди накопленных кандидатов.
+        // Возвращает число удалённых объектов
+        static size_t Collect();
+
+        // Возвращает счётчики сборщика текущего потока
+        [[nodiscard]] static Stats GetStats();
+        // Обнуляет счётчики сборщика текущего потока
+        static void ResetStats();
+
+        // Барьер записи: value стал доступен по новой ссылке
+        static void WriteBarrier(const ObjectHolder& value);
+
+    private:
+        friend class ObjectHolder;
+
+        // Запоминает контейнер, счётчик которого уменьшился до ненулевого значения
+        static void PossibleRoot(Object& object);
+        // Убирает удаляемый объект из буфера кандидатов
+        static void Forget(Object& object);
+        // Убирает из буфера кандидатов все объекты, достижимые из object, перед передачей в другой поток
+        static void ForgetGraph(Object& object);
+        // Начинает цикл, если кандидатов набралось не меньше порога, либо продолжает начатый
+        static void MaybeCollect();
+        // Доводит начатый цикл до конца
+        static void FinishCycle();
+
+        // Закрепляет кандидатов и начинает новый цикл
+        static void StartCycle();
+        // Закрепляет объект на время цикла. Пробный счётчик начинается с числа ссылок до закрепления
+        static void Pin(Object& object);
+        // Выполняет шаги цикла в пределах budget и учитывает время шага. Возвращает true, если цикл завершён
+        static bool RunSlice(size_t budget);
+        static bool Advance(size_t budget);
+    };
+
+}  // namespace runtime
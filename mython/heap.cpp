@@ -0,0 +1,338 @@
+#include "heap.h"
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <vector>
+
+namespace runtime {
+
+    namespace {
+
+        // размер блока молодого поколения
+        constexpr size_t __NURSERY_BLOCK_SIZE__ = 64 * 1024;
+        // объекты крупнее выделяются обычным operator new
+        constexpr size_t __NURSERY_MAX_OBJECT_SIZE__ = 256;
+        // сколько освободившихся блоков поток держит про запас
+        constexpr size_t __NURSERY_SPARE_BLOCKS__ = 4;
+        // перед каждым объектом хранится указатель на его блок, сляб пула с меткой в младшем бите
+        // либо nullptr для обычного выделения
+        constexpr size_t __ALLOCATION_PREFIX__ = sizeof(void*);
+        constexpr uintptr_t __SLAB_TAG__ = 1;
+        // размер сляба пулов
+        constexpr size_t __POOL_SLAB_SIZE__ = 16 * 1024;
+        // шаг классов размеров пулов
+        constexpr size_t __POOL_GRANULARITY__ = 16;
+        constexpr size_t __POOL_CLASS_COUNT__ = __NURSERY_MAX_OBJECT_SIZE__ / __POOL_GRANULARITY__;
+
+        struct HeapState;
+
+        struct Block {
+            // живые объекты блока плюс одна ссылка потока-владельца, пока блок текущий.
+            // Атомарный, потому что объект может освободить и другой поток после ObjectHandoff
+            std::atomic<uint32_t> live{ 0 };
+            const HeapState* owner = nullptr;
+            char* bump = nullptr;
+            char* end = nullptr;
+        };
+
+        constexpr size_t __BLOCK_HEADER_SIZE__ = (sizeof(Block) + 15) / 16 * 16;
+
+        struct Slab {
+            // занятые блоки сляба плюс одна ссылка потока-владельца, пока он жив
+            std::atomic<uint32_t> live{ 1 };
+            uint64_t owner_id = 0;              // номер потока-владельца: адрес состояния может быть переиспользован
+            size_t pool = 0;                    // класс размеров
+        };
+
+        constexpr size_t __SLAB_HEADER_SIZE__ = (sizeof(Slab) + 15) / 16 * 16;
+
+        // Пул блоков одного класса размеров
+        struct Pool {
+            void* free = nullptr;               // односвязный список свободных блоков, ссылка хранится в блоке
+            char* bump = nullptr;               // ещё не нарезанная часть текущего сляба
+            char* end = nullptr;
+            Slab* current = nullptr;
+            std::vector<Slab*> slabs;
+            Heap::PoolStats stats;
+        };
+
+        char* BlockData(Block* block) {
+            return reinterpret_cast<char*>(block) + __BLOCK_HEADER_SIZE__;
+        }
+
+        constexpr size_t AlignUp(size_t size) {
+            return (size + 7) / 8 * 8;
+        }
+
+        // указатель на состояние кучи потока, пока оно живо. Тривиальный тип, поэтому к нему
+        // можно обращаться и при разрушении других thread_local объектов
+        thread_local HeapState* t_alive_state = nullptr;
+
+        uint64_t NextOwnerId() {
+            static std::atomic<uint64_t> next_id{ 1 };
+            return next_id.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        struct HeapState {
+            HeapMode mode = HeapMode::RefCounting;
+            Block* current = nullptr;
+            std::vector<Block*> spare;
+            Heap::Stats stats;
+            uint64_t id = NextOwnerId();
+            Pool pools[__POOL_CLASS_COUNT__];
+            Block* arena_current = nullptr;
+            std::vector<Block*> arena_blocks;   // блоки открытой арены
+
+            HeapState() {
+                spare.reserve(__NURSERY_SPARE_BLOCKS__);
+                for (size_t i = 0; i < __POOL_CLASS_COUNT__; ++i) {
+                    pools[i].stats.chunk_size = (i + 1) * __POOL_GRANULARITY__;
+                }
+                t_alive_state = this;
+            }
+            HeapState(const HeapState&) = delete;
+            HeapState& operator=(const HeapState&) = delete;
+            ~HeapState();
+        };
+
+        // Снимает одну ссылку с блока. Опустевший блок возвращается в запас своего потока либо освобождается
+        void DropReference(Block* block) noexcept {
+            if (block->live.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+                return;
+            }
+            HeapState* state = t_alive_state;
+            if (state && block->owner == state && state->spare.size() < __NURSERY_SPARE_BLOCKS__) {
+                state->spare.push_back(block);
+            }
+            else {
+                ::operator delete(block);
+            }
+        }
+
+        // Снимает одну ссылку со сляба. Сляб освобождается вместе с последним своим блоком
+        void DropReference(Slab* slab) noexcept {
+            if (slab->live.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                ::operator delete(slab);
+            }
+        }
+
+        HeapState::~HeapState() {
+            t_alive_state = nullptr;
+            if (current) {
+                DropReference(current);
+            }
+            for (Block* block : arena_blocks) {
+                DropReference(block);
+            }
+            for (Block* block : spare) {
+                ::operator delete(block);
+            }
+            // слябы с объектами, переданными в другие потоки, доживут до освобождения этих объектов
+            for (Pool& pool : pools) {
+                for (Slab* slab : pool.slabs) {
+                    DropReference(slab);
+                }
+            }
+        }
+
+        HeapState& State() {
+            thread_local HeapState state;
+            return state;
+        }
+
+        // Берёт блок из запаса потока либо выделяет новый. Блок начинается с одной ссылки владельца
+        Block* AcquireBlock(HeapState& state) {
+            Block* block = nullptr;
+            if (!state.spare.empty()) {
+                block = state.spare.back();
+                state.spare.pop_back();
+            }
+            else {
+                block = new (::operator new(__NURSERY_BLOCK_SIZE__)) Block;
+            }
+            block->live.store(1, std::memory_order_relaxed);
+            block->owner = &state;
+            block->bump = BlockData(block);
+            block->end = reinterpret_cast<char*>(block) + __NURSERY_BLOCK_SIZE__;
+            return block;
+        }
+
+        // Делает текущим блок, в котором есть место
+        Block* NextBlock(HeapState& state) {
+            if (Block* current = state.current) {
+                // осталась только ссылка владельца: все объекты блока мертвы, начинаем его заново
+                if (current->live.load(std::memory_order_acquire) == 1) {
+                    current->bump = BlockData(current);
+                    ++state.stats.nursery_resets;
+                    return current;
+                }
+                // выжившие объекты остаются на месте, блок уходит в старое поколение
+                ++state.stats.promoted_blocks;
+                state.current = nullptr;
+                DropReference(current);
+            }
+
+            state.current = AcquireBlock(state);
+            return state.current;
+        }
+
+        size_t PoolIndex(size_t total) {
+            return (total + __POOL_GRANULARITY__ - 1) / __POOL_GRANULARITY__ - 1;
+        }
+
+        // Выделяет блок пула размером не меньше total и записывает в префикс его сляб.
+        // Свободный блок хранит ссылку на следующий сразу за префиксом, поэтому префикс переживает переиспользование
+        char* PoolAllocate(HeapState& state, size_t total) {
+            Pool& pool = state.pools[PoolIndex(total)];
+            char* memory = nullptr;
+            if (pool.free) {
+                memory = static_cast<char*>(pool.free);
+                std::memcpy(&pool.free, memory + __ALLOCATION_PREFIX__, sizeof(pool.free));
+                ++pool.stats.recycled;
+            }
+            else {
+                size_t chunk_size = pool.stats.chunk_size;
+                if (!pool.current || pool.end - pool.bump < static_cast<std::ptrdiff_t>(chunk_size)) {
+                    Slab* slab = new (::operator new(__POOL_SLAB_SIZE__)) Slab;
+                    slab->owner_id = state.id;
+                    slab->pool = PoolIndex(total);
+                    pool.slabs.push_back(slab);
+                    pool.current = slab;
+                    pool.bump = reinterpret_cast<char*>(slab) + __SLAB_HEADER_SIZE__;
+                    pool.end = reinterpret_cast<char*>(slab) + __POOL_SLAB_SIZE__;
+                    ++pool.stats.slabs;
+                }
+                memory = pool.bump;
+                pool.bump += chunk_size;
+                uintptr_t prefix = reinterpret_cast<uintptr_t>(pool.current) | __SLAB_TAG__;
+                std::memcpy(memory, &prefix, sizeof(prefix));
+            }
+            uintptr_t prefix = 0;
+            std::memcpy(&prefix, memory, sizeof(prefix));
+            reinterpret_cast<Slab*>(prefix & ~__SLAB_TAG__)->live.fetch_add(1, std::memory_order_relaxed);
+            if (++pool.stats.live > pool.stats.peak) {
+                pool.stats.peak = pool.stats.live;
+            }
+            return memory;
+        }
+
+        // Возвращает блок в пул потока-владельца либо, если сляб принадлежит другому потоку, только снимает ссылку
+        void PoolFree(Slab* slab, char* memory) noexcept {
+            HeapState* state = t_alive_state;
+            if (state && slab->owner_id == state->id) {
+                Pool& pool = state->pools[slab->pool];
+                std::memcpy(memory + __ALLOCATION_PREFIX__, &pool.free, sizeof(pool.free));
+                pool.free = memory;
+                --pool.stats.live;
+                // ссылка владельца держит сляб, поэтому здесь он не освобождается
+                slab->live.fetch_sub(1, std::memory_order_relaxed);
+                return;
+            }
+            DropReference(slab);
+        }
+
+    }  // namespace
+
+    void Heap::SetMode(HeapMode mode) {
+        State().mode = mode;
+    }
+
+    HeapMode Heap::GetMode() {
+        return State().mode;
+    }
+
+    Heap::Stats Heap::GetStats() {
+        return State().stats;
+    }
+
+    Heap::PoolStats Heap::GetPoolStats(size_t size) {
+        size_t total = AlignUp(size + __ALLOCATION_PREFIX__);
+        if (total > __NURSERY_MAX_OBJECT_SIZE__) {
+            return {};
+        }
+        return State().pools[PoolIndex(total)].stats;
+    }
+
+    void* Heap::Allocate(size_t size) {
+        HeapState& state = State();
+        size_t total = AlignUp(size + __ALLOCATION_PREFIX__);
+        Block* block = nullptr;
+        char* memory = nullptr;
+
+        if (state.mode == HeapMode::Pooled && total <= __NURSERY_MAX_OBJECT_SIZE__) {
+            return PoolAllocate(state, total) + __ALLOCATION_PREFIX__;
+        }
+        if (state.mode == HeapMode::Generational && total <= __NURSERY_MAX_OBJECT_SIZE__) {
+            block = state.current;
+            if (!block || block->end - block->bump < static_cast<std::ptrdiff_t>(total)) {
+                block = NextBlock(state);
+            }
+            memory = block->bump;
+            block->bump += total;
+            block->live.fetch_add(1, std::memory_order_relaxed);
+            ++state.stats.nursery_allocations;
+        }
+        else if (state.mode == HeapMode::Arena && total <= __NURSERY_MAX_OBJECT_SIZE__) {
+            // блоки арены не переиспользуются до её закрытия
+            block = state.arena_current;
+            if (!block || block->end - block->bump < static_cast<std::ptrdiff_t>(total)) {
+                block = AcquireBlock(state);
+                state.arena_blocks.push_back(block);
+                state.arena_current = block;
+                ++state.stats.arena_blocks;
+            }
+            memory = block->bump;
+            block->bump += total;
+            block->live.fetch_add(1, std::memory_order_relaxed);
+            ++state.stats.arena_allocations;
+        }
+        else {
+            memory = static_cast<char*>(::operator new(total));
+        }
+
+        std::memcpy(memory, &block, sizeof(block));
+        return memory + __ALLOCATION_PREFIX__;
+    }
+
+    void Heap::Free(void* pointer) noexcept {
+        if (!pointer) {
+            return;
+        }
+        char* memory = static_cast<char*>(pointer) - __ALLOCATION_PREFIX__;
+        uintptr_t prefix = 0;
+        std::memcpy(&prefix, memory, sizeof(prefix));
+        if (prefix & __SLAB_TAG__) {
+            PoolFree(reinterpret_cast<Slab*>(prefix & ~__SLAB_TAG__), memory);
+            return;
+        }
+        Block* block = reinterpret_cast<Block*>(prefix);
+        if (block) {
+            DropReference(block);
+        }
+        else {
+            ::operator delete(memory);
+        }
+    }
+
+    void Heap::OpenArena() {
+        HeapState& state = State();
+        if (state.mode == HeapMode::Arena) {
+            throw std::logic_error("Execution arena is already open");
+        }
+        state.mode = HeapMode::Arena;
+    }
+
+    void Heap::CloseArena() noexcept {
+        HeapState& state = State();
+        // снимаем ссылки арены: блоки без живых объектов сразу уходят в запас или освобождаются
+        for (Block* block : state.arena_blocks) {
+            DropReference(block);
+        }
+        state.arena_blocks.clear();
+        state.arena_current = nullptr;
+    }
+
+}  // namespace runtime
@@ -0,0 +1,142 @@
+#pragma once
+
+#include "collector.h"
+
+#include <cstddef>
+
+namespace runtime {
+
+    // Способ размещения объектов-значений
+    enum class HeapMode {
+        RefCounting,    // каждый объект выделяется и освобождается отдельно через глобальный operator new, режим по умолчанию
+        Generational,   // объекты-значения выделяются сдвигом указателя в молодом поколении
+        Pooled,         // объекты берутся из пулов блоков фиксированного размера
+        Arena,          // объекты выделяются сдвигом указателя в арене выполнения и освобождаются вместе с ней
+    };
+
+    /*
+     * Куча объектов-значений (Number, Float, Bool, String) и экземпляров классов.
+     * Временные значения, которые порождают арифметические узлы, живут недолго. В режиме Generational
+     * они выделяются сдвигом указателя в текущем блоке молодого поколения (nursery), а освобождение
+     * только уменьшает счётчик живых объектов блока. Блок, все объекты которого уже освобождены,
+     * переиспользуется с начала без обращения к malloc.
+     * Заполненный блок с выжившими объектами переходит в старое поколение на месте: ObjectHolder хранит
+     * прямые указатели, поэтому объекты не перемещаются, а блок освобождается вместе с последним
+     * своим объектом.
+     * В режиме Pooled объекты размещаются в пулах классов размеров, кратных 16 байтам. Пул нарезает
+     * крупные слябы на блоки одного размера, освобождённый блок попадает в список свободных блоков пула
+     * и отдаётся следующему объекту того же класса без обращения к malloc.
+     * В режиме Arena объекты выделяются в блоках арены одного выполнения программы. Освобождение объекта
+     * только уменьшает счётчик его блока, а закрытие арены возвращает блоки без живых объектов.
+     * Режим, молодое поколение, пулы и арена свои у каждого потока
+     */
+    class Heap {
+    public:
+        struct Stats {
+            size_t nursery_allocations = 0;     // объектов выделено в молодом поколении
+            size_t nursery_resets = 0;          // блоков молодого поколения переиспользовано целиком
+            size_t promoted_blocks = 0;         // блоков перешло в старое поколение с выжившими объектами
+            size_t arena_allocations = 0;       // объектов выделено в аренах
+            size_t arena_blocks = 0;            // блоков занято аренами
+        };
+
+        // Счётчики пула одного класса размеров
+        struct PoolStats {
+            size_t chunk_size = 0;              // размер блока пула вместе со служебным префиксом
+            size_t live = 0;                    // занятых блоков
+            size_t peak = 0;                    // наибольшее число занятых блоков
+            size_t recycled = 0;                // выделений из списка свободных блоков
+            size_t slabs = 0;                   // слябов, нарезанных пулом
+        };
+
+        // Задаёт режим размещения новых объектов текущего потока. Уже созданные объекты
+        // освобождаются тем способом, которым были выделены
+        static void SetMode(HeapMode mode);
+        [[nodiscard]] static HeapMode GetMode();
+
+        // Возвращает счётчики кучи текущего потока
+        [[nodiscard]] static Stats GetStats();
+        // Возвращает счётчики пула текущего потока, из которого выделяются объекты размера size.
+        // Блоки, освобождённые другим потоком после ObjectHandoff, в live владельца не учитываются
+        [[nodiscard]] static PoolStats GetPoolStats(size_t size);
+
+        // Выделяет память под объект-значение размера size с выравниванием не больше 8 байт
+        [[nodiscard]] static void* Allocate(size_t size);
+        // Освобождает память, выделенную Allocate, в том числе в другом потоке
+        static void Free(void* pointer) noexcept;
+
+        // Открывает арену выполнения и переключает поток в режим Arena.
+        // Если арена уже открыта, выбрасывает исключение logic_error
+        static void OpenArena();
+        // Закрывает арену и возвращает её блоки. Блок с ещё живыми объектами освобождается вместе
+        // с последним из них. Режим кучи не меняется
+        static void CloseArena() noexcept;
+    };
+
+    // Задаёт режим кучи на время своей жизни и восстанавливает прежний при выходе
+    class HeapModeScope {
+    public:
+        explicit HeapModeScope(HeapMode mode)
+            : _previous(Heap::GetMode()) {
+            Heap::SetMode(mode);
+        }
+        HeapModeScope(const HeapModeScope&) = delete;
+        HeapModeScope& operator=(const HeapModeScope&) = delete;
+        ~HeapModeScope() {
+            Heap::SetMode(_previous);
+        }
+
+    private:
+        HeapMode _previous;
+    };
+
+    /*
+     * Арена одного выполнения программы. Пока арена открыта, все объекты, размещаемые через Heap,
+     * выделяются в ней сдвигом указателя, а память возвращается целыми блоками при закрытии арены.
+     * Освобождение арены не мгновенное: объекты по-прежнему удаляются по одному, когда исчезает последняя
+     * ссылка на них, например при разрушении таблицы символов запроса, и каждый из них уменьшает счётчик
+     * своего блока. Арена убирает обращения к распределителю памяти, но не вызовы деструкторов.
+     * Сбросить блоки без обхода объектов нельзя: деструкторы строк и контейнеров освобождают память
+     * вне арены, а объект, по ошибке оставшийся доступным после выполнения, должен остаться целым,
+     * поэтому блок с ним живёт до освобождения последнего такого объекта.
+     * Объекты, которые должны пережить выполнение, например значения для постоянной глобальной
+     * таблицы символов, копируются из арены функцией CopyOut
+     */
+    class ExecutionArena {
+    public:
+        ExecutionArena()
+            : _outer(Heap::GetMode()) {
+            Heap::OpenArena();
+        }
+        ExecutionArena(const ExecutionArena&) = delete;
+        ExecutionArena& operator=(const ExecutionArena&) = delete;
+        ~ExecutionArena() {
+            // мусорные циклы выполнения удерживали бы блоки арены после её закрытия
+            if (CycleCollector::CandidateCount() != 0) {
+                CycleCollector::Collect();
+            }
+            Heap::CloseArena();
+            Heap::SetMode(_outer);
+        }
+
+        // Возвращает режим кучи, действовавший до открытия арены. В нём размещаются копии из арены
+        [[nodiscard]] HeapMode OuterMode() const {
+            return _outer;
+        }
+
+    private:
+        HeapMode _outer;
+    };
+
+    // Примесь для классов объектов-значений: их экземпляры размещаются через Heap
+    class HeapAllocated {
+    public:
+        static void* operator new(size_t size) {
+            return Heap::Allocate(size);
+        }
+        static void operator delete(void* pointer) noexcept {
+            Heap::Free(pointer);
+        }
+    };
+
+}  // namespace runtime
@@ -0,0 +1,1040 @@
+#include "jit.h"
+
+#include <cstring>
+#include <exception>
+#include <initializer_list>
+#include <limits>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(__x86_64__) && defined(__linux__)
+#include <sys/mman.h>
+#define MYTHON_JIT_X86_64
+#endif
+
+using namespace std;
+
+namespace jit {
+
+    using regvm::Code;
+    using regvm::Instruction;
+    using regvm::Opcode;
+    using regvm::Operand;
+    using regvm::OperandKind;
+    using runtime::Closure;
+    using runtime::Context;
+    using runtime::ObjectHolder;
+
+    namespace {
+
+        // Размер регистрового файла, который размещается в кадре без выделения памяти, как у regvm
+        constexpr size_t __JIT_INLINE_REGISTERS__ = 16;
+
+        // Результат обработчика инструкции, по которому машинный код выбирает следующий шаг
+        constexpr uint32_t __STEP_NEXT__ = 0;      // следующая инструкция
+        constexpr uint32_t __STEP_BRANCH__ = 1;    // переход по адресу a инструкции
+        constexpr uint32_t __STEP_EXIT__ = 2;      // выход из функции: return либо исключение
+
+        // Состояние выполнения машинного кода. Его адрес лежит в rbx, пока код выполняется
+        struct Frame {
+            Code* code;
+            Closure* closure;
+            Context* context;
+            ObjectHolder* registers;
+            std::vector<bytecode::Loop> loops;
+            ObjectHolder result;
+            std::exception_ptr error;
+        };
+
+        // Обработчик инструкции, который вызывает машинный код: rdi - кадр, rsi - инструкция
+        using Helper = uint32_t (*)(Frame* frame, Instruction* instruction);
+
+        // Точка входа машинного кода: rdi - кадр, rsi - регистровый файл, rdx - таблица символов
+        using Entry = void (*)(Frame* frame, ObjectHolder* registers, Closure* closure);
+
+        template <OperandKind kind>
+        const ObjectHolder& Read(Frame& frame, Operand& operand) {
+            if constexpr (kind == OperandKind::Register) {
+                return frame.registers[operand.index];
+            }
+            else if constexpr (kind == OperandKind::Constant) {
+                return frame.code->constants[operand.index];
+            }
+            else if constexpr (kind == OperandKind::Variable) {
+                if (ObjectHolder* value = frame.closure->FindHinted(frame.code->symbols[operand.index], operand.hint)) {
+                    return *value;
+                }
+                throw std::runtime_error(runtime::__UNDEFINED_VARIABLE_ERROR__);
+            }
+            else {
+                static const ObjectHolder none;
+                return none;
+            }
+        }
+
+        const ObjectHolder& Read(Frame& frame, Operand& operand) {
+            switch (operand.kind) {
+            case OperandKind::Register:
+                return Read<OperandKind::Register>(frame, operand);
+            case OperandKind::Constant:
+                return Read<OperandKind::Constant>(frame, operand);
+            case OperandKind::Variable:
+                return Read<OperandKind::Variable>(frame, operand);
+            case OperandKind::None:
+                break;
+            }
+            return Read<OperandKind::None>(frame, operand);
+        }
+
+        void Store(Frame& frame, Operand& operand, ObjectHolder value) {
+            switch (operand.kind) {
+            case OperandKind::Register:
+                frame.registers[operand.index] = std::move(value);
+                break;
+            case OperandKind::Variable: {
+                // значение получает новую ссылку, сообщаем об этом идущему циклу сборки
+                runtime::CycleCollector::WriteBarrier(value);
+                const runtime::Symbol name = frame.code->symbols[operand.index];
+                ObjectHolder* slot = frame.closure->FindHinted(name, operand.hint);
+                if (slot == nullptr) {
+                    slot = &(*frame.closure)[name];
+                }
+                *slot = std::move(value);
+                break;
+            }
+            default:
+                break;
+            }
+        }
+
+        // Выполняет action. Исключение не может пройти через машинный код без таблиц раскрутки,
+        // поэтому оно запоминается в кадре, а код выходит из функции
+        template <typename Action>
+        uint32_t Guarded(Frame* frame, Action action) {
+            try {
+                return action();
+            }
+            catch (...) {
+                frame->error = std::current_exception();
+                return __STEP_EXIT__;
+            }
+        }
+
+        // Обработчики с операндами, вид которых известен при компиляции: чтение обходится без ветвления
+
+        template <runtime::ArithmeticOp op>
+        struct ArithmeticStep {
+            template <OperandKind lhs, OperandKind rhs>
+            static uint32_t Run(Frame* frame, Instruction* instruction) {
+                return Guarded(frame, [&] {
+                    Store(*frame, instruction->dst, bytecode::ArithmeticValues(op, Read<lhs>(*frame, instruction->lhs),
+                        Read<rhs>(*frame, instruction->rhs), *frame->context));
+                    return __STEP_NEXT__;
+                });
+            }
+        };
+
+        struct CompareStep {
+            template <OperandKind lhs, OperandKind rhs>
+            static uint32_t Run(Frame* frame, Instruction* instruction) {
+                return Guarded(frame, [&] {
+                    Store(*frame, instruction->dst, runtime::MakeBool(bytecode::CompareValues(instruction->cmp,
+                        Read<lhs>(*frame, instruction->lhs), Read<rhs>(*frame, instruction->rhs), *frame->context)));
+                    return __STEP_NEXT__;
+                });
+            }
+        };
+
+        struct MoveStep {
+            template <OperandKind lhs, OperandKind>
+            static uint32_t Run(Frame* frame, Instruction* instruction) {
+                return Guarded(frame, [&] {
+                    Store(*frame, instruction->dst, Read<lhs>(*frame, instruction->lhs));
+                    return __STEP_NEXT__;
+                });
+            }
+        };
+
+        struct NotStep {
+            template <OperandKind lhs, OperandKind>
+            static uint32_t Run(Frame* frame, Instruction* instruction) {
+                return Guarded(frame, [&] {
+                    Store(*frame, instruction->dst, runtime::MakeBool(!runtime::IsTrue(Read<lhs>(*frame, instruction->lhs))));
+                    return __STEP_NEXT__;
+                });
+            }
+        };
+
+        // Условный переход: ветвь выбирается, когда истинность lhs равна jump_if
+        template <bool jump_if>
+        struct BranchStep {
+            template <OperandKind lhs, OperandKind>
+            static uint32_t Run(Frame* frame, Instruction* instruction) {
+                return Guarded(frame, [&] {
+                    return runtime::IsTrue(Read<lhs>(*frame, instruction->lhs)) == jump_if ? __STEP_BRANCH__ : __STEP_NEXT__;
+                });
+            }
+        };
+
+        struct ReturnStep {
+            template <OperandKind lhs, OperandKind>
+            static uint32_t Run(Frame* frame, Instruction* instruction) {
+                return Guarded(frame, [&] {
+                    frame->result = Read<lhs>(*frame, instruction->lhs);
+                    return __STEP_EXIT__;
+                });
+            }
+        };
+
+        template <typename Step, OperandKind lhs>
+        Helper Specialize(OperandKind rhs) {
+            switch (rhs) {
+            case OperandKind::None:
+                return &Step::template Run<lhs, OperandKind::None>;
+            case OperandKind::Register:
+                return &Step::template Run<lhs, OperandKind::Register>;
+            case OperandKind::Constant:
+                return &Step::template Run<lhs, OperandKind::Constant>;
+            case OperandKind::Variable:
+                return &Step::template Run<lhs, OperandKind::Variable>;
+            }
+            return nullptr;
+        }
+
+        // Выбирает обработчик Step для видов операндов lhs и rhs инструкции
+        template <typename Step>
+        Helper Specialize(const Instruction& instruction) {
+            switch (instruction.lhs.kind) {
+            case OperandKind::None:
+                return Specialize<Step, OperandKind::None>(instruction.rhs.kind);
+            case OperandKind::Register:
+                return Specialize<Step, OperandKind::Register>(instruction.rhs.kind);
+            case OperandKind::Constant:
+                return Specialize<Step, OperandKind::Constant>(instruction.rhs.kind);
+            case OperandKind::Variable:
+                return Specialize<Step, OperandKind::Variable>(instruction.rhs.kind);
+            }
+            return nullptr;
+        }
+
+        // Обработчики медленных инструкций, общие со стековой и регистровой машинами
+
+        uint32_t LoadField(Frame* frame, Instruction* instruction) {
+            return Guarded(frame, [&] {
+                Store(*frame, instruction->dst, bytecode::LoadField(Read(*frame, instruction->lhs),
+                    frame->code->symbols[instruction->a]));
+                return __STEP_NEXT__;
+            });
+        }
+
+        uint32_t StoreField(Frame* frame, Instruction* instruction) {
+            return Guarded(frame, [&] {
+                const ObjectHolder& object = Read(*frame, instruction->lhs);
+                if (object.Kind() != runtime::ObjectKind::Instance) {
+                    throw std::runtime_error("Only object fields can be assigned");
+                }
+                const ObjectHolder& value = Read(*frame, instruction->rhs);
+                runtime::CycleCollector::WriteBarrier(value);
+                static_cast<runtime::ClassInstance*>(object.Get())->Fields()[frame->code->symbols[instruction->a]] = value;
+                return __STEP_NEXT__;
+            });
+        }
+
+        uint32_t Call(Frame* frame, Instruction* instruction) {
+            return Guarded(frame, [&] {
+                Store(*frame, instruction->dst, bytecode::CallMethod(Read(*frame, instruction->lhs),
+                    frame->code->symbols[instruction->a], frame->registers + instruction->rhs.index, instruction->b,
+                    *frame->context));
+                return __STEP_NEXT__;
+            });
+        }
+
+        uint32_t New(Frame* frame, Instruction* instruction) {
+            return Guarded(frame, [&] {
+                ObjectHolder instance = ObjectHolder::Own(runtime::ClassInstance(*frame->code->classes[instruction->a]));
+                static_cast<runtime::ClassInstance*>(instance.Get())->Call(runtime::__INIT_METHOD__,
+                    frame->registers + instruction->rhs.index, instruction->b, *frame->context);
+                Store(*frame, instruction->dst, std::move(instance));
+                return __STEP_NEXT__;
+            });
+        }
+
+        uint32_t Print(Frame* frame, Instruction* instruction) {
+            return Guarded(frame, [&] {
+                bytecode::PrintValues(frame->registers + instruction->rhs.index, instruction->b, *frame->context);
+                return __STEP_NEXT__;
+            });
+        }
+
+        uint32_t IterStart(Frame* frame, Instruction* instruction) {
+            return Guarded(frame, [&] {
+                bytecode::StartLoop(frame->loops, Read(*frame, instruction->lhs));
+                return __STEP_NEXT__;
+            });
+        }
+
+        uint32_t IterNext(Frame* frame, Instruction* instruction) {
+            return Guarded(frame, [&] {
+                ObjectHolder item;
+                if (!bytecode::NextItem(frame->loops.back(), item)) {
+                    frame->loops.pop_back();
+                    return __STEP_BRANCH__;
+                }
+                Store(*frame, instruction->dst, std::move(item));
+                return __STEP_NEXT__;
+            });
+        }
+
+        uint32_t Exec(Frame* frame, Instruction* instruction) {
+            return Guarded(frame, [&] {
+                Store(*frame, instruction->dst, frame->code->nodes[instruction->a]->Execute(*frame->closure,
+                    *frame->context));
+                return __STEP_NEXT__;
+            });
+        }
+
+        // Возвращает обработчик инструкции либо nullptr, если шаблона для неё нет
+        Helper SelectHelper(const Instruction& instruction) {
+            switch (instruction.op) {
+            case Opcode::Move:
+                return Specialize<MoveStep>(instruction);
+            case Opcode::LoadField:
+                return &LoadField;
+            case Opcode::StoreField:
+                return &StoreField;
+            case Opcode::Add:
+                return Specialize<ArithmeticStep<runtime::ArithmeticOp::Add>>(instruction);
+            case Opcode::Sub:
+                return Specialize<ArithmeticStep<runtime::ArithmeticOp::Sub>>(instruction);
+            case Opcode::Mult:
+                return Specialize<ArithmeticStep<runtime::ArithmeticOp::Mult>>(instruction);
+            case Opcode::Div:
+                return Specialize<ArithmeticStep<runtime::ArithmeticOp::Div>>(instruction);
+            case Opcode::Compare:
+                return Specialize<CompareStep>(instruction);
+            case Opcode::Not:
+                return Specialize<NotStep>(instruction);
+            case Opcode::JumpIfFalse:
+                return Specialize<BranchStep<false>>(instruction);
+            case Opcode::JumpIfTrue:
+                return Specialize<BranchStep<true>>(instruction);
+            case Opcode::Call:
+                return &Call;
+            case Opcode::New:
+                return &New;
+            case Opcode::Print:
+                return &Print;
+            case Opcode::IterStart:
+                return &IterStart;
+            case Opcode::IterNext:
+                return &IterNext;
+            case Opcode::Exec:
+                return &Exec;
+            case Opcode::Return:
+                return Specialize<ReturnStep>(instruction);
+            default:
+                // Jump выпускается без обработчика, прочие инструкции JIT не знает
+                return nullptr;
+            }
+        }
+
+        // Регистры x86-64 в порядке их номеров в кодировке команд
+        enum Reg : uint8_t {
+            RAX, RCX, RDX, RBX, RSP, RBP, RSI, RDI, R8, R9, R10, R11, R12, R13, R14, R15,
+        };
+
+        // Условия переходов и cmov в порядке их кодов
+        enum Cond : uint8_t {
+            Overflow = 0x0,
+            AboveOrEqual = 0x3,
+            Equal = 0x4,
+            NotEqual = 0x5,
+            BelowOrEqual = 0x6,
+            Above = 0x7,
+            Less = 0xC,
+            GreaterOrEqual = 0xD,
+            LessOrEqual = 0xE,
+            Greater = 0xF,
+        };
+
+        // Собирает машинный код x86-64. Переходы ведут на метки и разрешаются, когда известны адреса всех меток
+        class Assembler {
+        public:
+            using Label = size_t;
+
+            [[nodiscard]] Label NewLabel() {
+                _labels.push_back(__UNBOUND__);
+                return _labels.size() - 1;
+            }
+
+            void Bind(Label label) {
+                _labels[label] = _bytes.size();
+            }
+
+            void Emit(std::initializer_list<uint8_t> bytes) {
+                _bytes.insert(_bytes.end(), bytes);
+            }
+
+            void Emit32(uint32_t value) {
+                for (int i = 0; i < 4; ++i) {
+                    _bytes.push_back(static_cast<uint8_t>(value >> (8 * i)));
+                }
+            }
+
+            void Emit64(uint64_t value) {
+                for (int i = 0; i < 8; ++i) {
+                    _bytes.push_back(static_cast<uint8_t>(value >> (8 * i)));
+                }
+            }
+
+            // Команда с операндом в памяти [base + disp]: префикс REX, код, ModRM и 32-битное смещение
+            void Memory(bool wide, std::initializer_list<uint8_t> opcode, uint8_t reg, Reg base, size_t disp) {
+                Rex(wide, reg, base);
+                Emit(opcode);
+                Emit({ static_cast<uint8_t>(0x80 | (reg & 7) << 3 | (base & 7)) });
+                if ((base & 7) == RSP) {
+                    Emit({ 0x24 });     // SIB без индекса: rsp и r12 иначе не адресуются
+                }
+                Emit32(static_cast<uint32_t>(disp));
+            }
+
+            // Команда над двумя регистрами: reg - поле reg, rm - поле r/m байта ModRM
+            void Direct(bool wide, std::initializer_list<uint8_t> opcode, uint8_t reg, Reg rm) {
+                Rex(wide, reg, rm);
+                Emit(opcode);
+                Emit({ static_cast<uint8_t>(0xC0 | (reg & 7) << 3 | (rm & 7)) });
+            }
+
+            void Load(Reg dst, Reg base, size_t disp) {
+                Memory(true, { 0x8B }, dst, base, disp);                // mov dst, [base + disp]
+            }
+            void Load32(Reg dst, Reg base, size_t disp) {
+                Memory(false, { 0x8B }, dst, base, disp);               // mov dst32, [base + disp]
+            }
+            void Store(Reg base, size_t disp, Reg src) {
+                Memory(true, { 0x89 }, src, base, disp);                // mov [base + disp], src
+            }
+            void StoreByte(Reg base, size_t disp, uint8_t value) {
+                Memory(false, { 0xC6 }, 0, base, disp);                 // mov byte [base + disp], value
+                Emit({ value });
+            }
+            void CopyByte(Reg dst, size_t dst_disp, Reg src, size_t src_disp) {
+                Memory(false, { 0x0F, 0xB6 }, RCX, src, src_disp);      // movzx ecx, byte [src + src_disp]
+                Memory(false, { 0x88 }, RCX, dst, dst_disp);            // mov [dst + dst_disp], cl
+            }
+            void TestByte(Reg base, size_t disp, uint8_t mask) {
+                Memory(false, { 0xF6 }, 0, base, disp);                 // test byte [base + disp], mask
+                Emit({ mask });
+            }
+            void Compare32(Reg base, size_t disp, int8_t value) {
+                Memory(false, { 0x83 }, 7, base, disp);                 // cmp dword [base + disp], value
+                Emit({ static_cast<uint8_t>(value) });
+            }
+            void Compare64(Reg base, size_t disp, int8_t value) {
+                Memory(true, { 0x83 }, 7, base, disp);                  // cmp qword [base + disp], value
+                Emit({ static_cast<uint8_t>(value) });
+            }
+            void Increment32(Reg base, size_t disp) {
+                Memory(false, { 0xFF }, 0, base, disp);                 // inc dword [base + disp]
+            }
+            void Decrement32(Reg base, size_t disp) {
+                Memory(false, { 0xFF }, 1, base, disp);                 // dec dword [base + disp]
+            }
+            // Флаги [base + disp] - value
+            void CompareMemory(Reg base, size_t disp, Reg value) {
+                Memory(true, { 0x39 }, value, base, disp);              // cmp [base + disp], value
+            }
+            // Флаги value - [base + disp]
+            void CompareWithMemory(Reg value, Reg base, size_t disp) {
+                Memory(true, { 0x3B }, value, base, disp);              // cmp value, [base + disp]
+            }
+            void AddMemory(Reg dst, Reg base, size_t disp) {
+                Memory(true, { 0x03 }, dst, base, disp);                // add dst, [base + disp]
+            }
+            void SubMemory(Reg dst, Reg base, size_t disp) {
+                Memory(true, { 0x2B }, dst, base, disp);                // sub dst, [base + disp]
+            }
+            void LoadAddress(Reg dst, Reg base, size_t disp) {
+                Memory(true, { 0x8D }, dst, base, disp);                // lea dst, [base + disp]
+            }
+            void MoveImmediate(Reg dst, uint64_t value) {
+                Rex(true, 0, dst);
+                Emit({ static_cast<uint8_t>(0xB8 | (dst & 7)) });       // mov dst, imm64
+                Emit64(value);
+            }
+            void Move(Reg dst, Reg src) {
+                Direct(true, { 0x89 }, src, dst);                       // mov dst, src
+            }
+            void Add(Reg dst, Reg src) {
+                Direct(true, { 0x01 }, src, dst);                       // add dst, src
+            }
+            void AddImmediate(Reg dst, int32_t value) {
+                Direct(true, { 0x81 }, 0, dst);                         // add dst, imm32
+                Emit32(static_cast<uint32_t>(value));
+            }
+            void MultiplyImmediate(Reg dst, Reg src, int32_t value) {
+                Direct(true, { 0x69 }, dst, src);                       // imul dst, src, imm32
+                Emit32(static_cast<uint32_t>(value));
+            }
+            // Флаги lhs - rhs
+            void Compare(Reg lhs, Reg rhs) {
+                Direct(true, { 0x39 }, rhs, lhs);                       // cmp lhs, rhs
+            }
+            void CompareImmediate(Reg lhs, int32_t value) {
+                Direct(true, { 0x81 }, 7, lhs);                         // cmp lhs, imm32
+                Emit32(static_cast<uint32_t>(value));
+            }
+            void Test(Reg value) {
+                Direct(true, { 0x85 }, value, value);                   // test value, value
+            }
+            void MoveIf(Cond cond, Reg dst, Reg src) {
+                Direct(true, { 0x0F, static_cast<uint8_t>(0x40 | cond) }, dst, src);   // cmovcc dst, src
+            }
+            void Push(Reg reg) {
+                Rex(false, 0, reg);
+                Emit({ static_cast<uint8_t>(0x50 | (reg & 7)) });
+            }
+            void Pop(Reg reg) {
+                Rex(false, 0, reg);
+                Emit({ static_cast<uint8_t>(0x58 | (reg & 7)) });
+            }
+
+            void Jump(Label target) {
+                Emit({ 0xE9 });                                         // jmp rel32
+                Fixup(target);
+            }
+            void JumpIf(Cond cond, Label target) {
+                Emit({ 0x0F, static_cast<uint8_t>(0x80 | cond) });      // jcc rel32
+                Fixup(target);
+            }
+
+            // Записывает смещения переходов. Возвращает false, если какая-то метка не привязана
+            bool Resolve() {
+                for (const auto& [position, label] : _fixups) {
+                    if (_labels[label] == __UNBOUND__) {
+                        return false;
+                    }
+                    const auto displacement = static_cast<int32_t>(
+                        static_cast<int64_t>(_labels[label]) - static_cast<int64_t>(position + 4));
+                    std::memcpy(_bytes.data() + position, &displacement, sizeof(displacement));
+                }
+                return true;
+            }
+
+            [[nodiscard]] size_t Size() const {
+                return _bytes.size();
+            }
+
+            [[nodiscard]] const std::vector<uint8_t>& GetBytes() const {
+                return _bytes;
+            }
+
+        private:
+            static constexpr size_t __UNBOUND__ = std::numeric_limits<size_t>::max();
+
+            // Префикс REX нужен для 64-битного операнда и для регистров r8-r15
+            void Rex(bool wide, uint8_t reg, uint8_t rm) {
+                const auto rex = static_cast<uint8_t>(0x40 | (wide ? 8 : 0) | (reg & 8) >> 1 | (rm & 8) >> 3);
+                if (rex != 0x40) {
+                    Emit({ rex });
+                }
+            }
+
+            void Fixup(Label target) {
+                _fixups.push_back({ _bytes.size(), target });
+                Emit32(0);
+            }
+
+            std::vector<uint8_t> _bytes;
+            std::vector<size_t> _labels;                        // адреса меток
+            std::vector<std::pair<size_t, Label>> _fixups;      // позиция смещения и метка
+        };
+
+        /*
+         * Адреса и смещения, которые шаблоны зашивают в машинный код. Вид значения проверяется сравнением
+         * указателя на таблицу виртуальных функций Number: по Itanium C++ ABI он лежит в первом слове
+         * объекта. Объект другого вида, в том числе наследник Number, просто не проходит проверку
+         */
+        struct Natives {
+            runtime::NativeLayout layout;
+            uint64_t number_vtable = 0;
+            size_t number_value = 0;        // int64_t внутри Number от начала Object
+            size_t number_size = 0;
+            uint64_t small_numbers = 0;     // Number со значением __SMALL_INT_MIN__, следующие лежат подряд
+            uint64_t true_object = 0;
+            uint64_t false_object = 0;
+        };
+
+        const Natives& GetNatives() {
+            static const Natives natives = [] {
+                Natives result;
+                result.layout = runtime::GetNativeLayout();
+                const runtime::Number number(0);
+                const runtime::Object& object = number;
+                std::memcpy(&result.number_vtable, &object, sizeof(result.number_vtable));
+                result.number_value = static_cast<size_t>(reinterpret_cast<const char*>(&number.GetValue())
+                    - reinterpret_cast<const char*>(&object));
+                result.number_size = sizeof(runtime::Number);
+
+                // общие числа берутся из кеша MakeNumber без выделения памяти, если он лежит одним массивом
+                const ObjectHolder first = runtime::MakeNumber(runtime::__SMALL_INT_MIN__);
+                const ObjectHolder last = runtime::MakeNumber(runtime::__SMALL_INT_MAX__);
+                const auto first_address = reinterpret_cast<uintptr_t>(first.Get());
+                if (!first.IsOwning() && !last.IsOwning() && reinterpret_cast<uintptr_t>(last.Get()) - first_address
+                        == (runtime::__SMALL_INT_MAX__ - runtime::__SMALL_INT_MIN__) * sizeof(runtime::Number)) {
+                    result.small_numbers = first_address;
+                }
+                result.true_object = reinterpret_cast<uintptr_t>(runtime::MakeBool(true).Get());
+                result.false_object = reinterpret_cast<uintptr_t>(runtime::MakeBool(false).Get());
+                return result;
+            }();
+            return natives;
+        }
+
+        // Значение, на которое указывает операнд None
+        const ObjectHolder __NONE_SLOT__;
+
+        /*
+         * Переводит трёхадресный код в машинный. Пока код выполняется, rbx хранит кадр, r12 - регистровый
+         * файл, r13 - таблицу символов. Move, Jump, условные переходы и Add, Sub, Compare двух Number
+         * выполняются прямо в машинном коде. Если проверка вида значения не прошла, сложение переполнилось
+         * или результат нельзя записать без выделения памяти и освобождения объекта, управление уходит
+         * в холодный участок в конце функции, который вызывает обработчик всей инструкции.
+         * Операнды к этому моменту не изменены, поэтому обработчик выполняет инструкцию с начала.
+         * Остальные инструкции сразу вызывают обработчик: mov rdi, rbx; mov rsi, <инструкция>;
+         * mov rax, <обработчик>; call rax
+         */
+        class Translator {
+        public:
+            Translator(Code& code, Assembler& assembler)
+                : _code(code)
+                , _assembler(assembler)
+                , _natives(GetNatives()) {
+            }
+
+            bool Translate() {
+                Assembler& as = _assembler;
+                const size_t count = _code.instructions.size();
+                for (size_t i = 0; i <= count; ++i) {
+                    _labels.push_back(as.NewLabel());
+                }
+                _exit = _labels.back();
+
+                as.Emit({ 0xF3, 0x0F, 0x1E, 0xFA });    // endbr64
+                as.Push(RBX);                          // три регистра и адрес возврата: стек выровнен на 16
+                as.Push(R12);
+                as.Push(R13);
+                as.Move(RBX, RDI);
+                as.Move(R12, RSI);
+                as.Move(R13, RDX);
+                for (size_t i = 0; i < count; ++i) {
+                    Instruction& instruction = _code.instructions[i];
+                    const bool jumps = instruction.op == Opcode::Jump || instruction.op == Opcode::JumpIfFalse
+                        || instruction.op == Opcode::JumpIfTrue || instruction.op == Opcode::IterNext;
+                    if (jumps && instruction.a > count) {
+                        return false;
+                    }
+                    as.Bind(_labels[i]);
+                    if (!TranslateInstruction(instruction, i)) {
+                        return false;
+                    }
+                }
+                as.Bind(_exit);
+                as.Pop(R13);
+                as.Pop(R12);
+                as.Pop(RBX);
+                as.Emit({ 0xC3 });                     // ret
+
+                for (const Cold& cold : _cold) {
+                    as.Bind(cold.label);
+                    CallHelper(*cold.instruction, cold.helper);
+                    as.Jump(cold.next);
+                }
+                return as.Resolve();
+            }
+
+        private:
+            // Холодный участок: вызов обработчика инструкции, когда быстрый путь не подошёл
+            struct Cold {
+                Assembler::Label label;
+                Instruction* instruction;
+                Helper helper;
+                Assembler::Label next;
+            };
+
+            bool TranslateInstruction(Instruction& instruction, size_t index) {
+                if (instruction.op == Opcode::Jump) {
+                    _assembler.Jump(_labels[instruction.a]);
+                    return true;
+                }
+                Helper helper = SelectHelper(instruction);
+                if (helper == nullptr) {
+                    return false;
+                }
+                const Assembler::Label next = _labels[index + 1];
+                switch (instruction.op) {
+                case Opcode::Move:
+                    TranslateMove(instruction, NewCold(instruction, helper, next));
+                    break;
+                case Opcode::Add:
+                case Opcode::Sub:
+                case Opcode::Compare:
+                    TranslateNumbers(instruction, NewCold(instruction, helper, next));
+                    break;
+                case Opcode::JumpIfFalse:
+                case Opcode::JumpIfTrue:
+                    TranslateBranch(instruction, NewCold(instruction, helper, next), next);
+                    break;
+                default:
+                    CallHelper(instruction, helper);
+                    break;
+                }
+                return true;
+            }
+
+            Assembler::Label NewCold(Instruction& instruction, Helper helper, Assembler::Label next) {
+                const Assembler::Label label = _assembler.NewLabel();
+                _cold.push_back({ label, &instruction, helper, next });
+                return label;
+            }
+
+            // Вызывает обработчик и разбирает его ответ. Для инструкций без перехода ответ BRANCH не приходит
+            void CallHelper(Instruction& instruction, Helper helper) {
+                Assembler& as = _assembler;
+                as.Move(RDI, RBX);
+                as.MoveImmediate(RSI, reinterpret_cast<uintptr_t>(&instruction));
+                as.MoveImmediate(RAX, reinterpret_cast<uintptr_t>(helper));
+                as.Emit({ 0xFF, 0xD0 });                                // call rax
+                switch (instruction.op) {
+                case Opcode::Return:
+                    as.Jump(_exit);
+                    break;
+                case Opcode::JumpIfFalse:
+                case Opcode::JumpIfTrue:
+                case Opcode::IterNext:
+                    as.Emit({ 0x83, 0xF8, __STEP_BRANCH__ });           // cmp eax, BRANCH
+                    as.JumpIf(Equal, _labels[instruction.a]);
+                    as.JumpIf(Above, _exit);
+                    break;
+                default:
+                    as.Test(RAX);
+                    as.JumpIf(NotEqual, _exit);
+                    break;
+                }
+            }
+
+            // Загружает в target адрес ObjectHolder операнда. Переменная ищется только во встроенной ячейке
+            // таблицы символов по подсказке операнда, промах подсказки ведёт в cold
+            void ResolveSlot(Operand& operand, Reg target, Assembler::Label cold) {
+                Assembler& as = _assembler;
+                const runtime::NativeLayout& layout = _natives.layout;
+                switch (operand.kind) {
+                case OperandKind::Register:
+                    as.LoadAddress(target, R12, operand.index * sizeof(ObjectHolder));
+                    break;
+                case OperandKind::Constant:
+                    as.MoveImmediate(target, reinterpret_cast<uintptr_t>(&_code.constants[operand.index]));
+                    break;
+                case OperandKind::Variable: {
+                    static_assert(sizeof(runtime::Symbol) == sizeof(uint64_t)
+                        && std::is_trivially_copyable_v<runtime::Symbol>);
+                    uint64_t name = 0;
+                    std::memcpy(&name, &_code.symbols[operand.index], sizeof(name));
+                    as.MoveImmediate(R11, reinterpret_cast<uintptr_t>(&operand.hint));
+                    as.Load32(target, R11, 0);
+                    as.CompareImmediate(target, static_cast<int32_t>(runtime::__CLOSURE_INLINE_SLOTS__));
+                    as.JumpIf(AboveOrEqual, cold);
+                    as.CompareWithMemory(target, R13, layout.closure_size);
+                    as.JumpIf(AboveOrEqual, cold);
+                    as.MultiplyImmediate(target, target, static_cast<int32_t>(sizeof(Closure::value_type)));
+                    as.Add(target, R13);
+                    as.MoveImmediate(R11, name);
+                    as.CompareMemory(target, layout.closure_slots + layout.slot_name, R11);
+                    as.JumpIf(NotEqual, cold);
+                    as.LoadAddress(target, target, layout.closure_slots + layout.slot_value);
+                    break;
+                }
+                case OperandKind::None:
+                    as.MoveImmediate(target, reinterpret_cast<uintptr_t>(&__NONE_SLOT__));
+                    break;
+                }
+            }
+
+            // Загружает в object объект ячейки slot, если это Number. rcx хранит таблицу функций Number
+            void GuardNumber(Reg slot, Reg object, Assembler::Label cold) {
+                Assembler& as = _assembler;
+                as.Load(object, slot, _natives.layout.holder_data);
+                as.Test(object);
+                as.JumpIf(Equal, cold);
+                as.CompareMemory(object, 0, RCX);
+                as.JumpIf(NotEqual, cold);
+            }
+
+            // Освобождает значение ячейки slot, если это не последняя ссылка на объект без ссылок на другие
+            // объекты, и записывает в неё невладеющую ссылку на общий объект value
+            void StoreShared(Reg slot, Reg value, Assembler::Label cold) {
+                Assembler& as = _assembler;
+                const runtime::NativeLayout& layout = _natives.layout;
+                const Assembler::Label write = as.NewLabel();
+                as.TestByte(slot, layout.holder_owning, 1);
+                as.JumpIf(Equal, write);
+                as.Load(R9, slot, layout.holder_data);
+                as.TestByte(R9, layout.object_traceable, 1);
+                as.JumpIf(NotEqual, cold);
+                as.Compare32(R9, layout.object_count, 1);
+                as.JumpIf(BelowOrEqual, cold);
+                as.Decrement32(R9, layout.object_count);
+                as.Bind(write);
+                as.Store(slot, layout.holder_data, value);
+                as.StoreByte(slot, layout.holder_owning, 0);
+            }
+
+            // dst = lhs: копирование ObjectHolder со счётчиком ссылок. Новая ссылка на объект текущего цикла
+            // сборки и освобождение последней ссылки остаются обработчику
+            void TranslateMove(Instruction& instruction, Assembler::Label cold) {
+                Assembler& as = _assembler;
+                const runtime::NativeLayout& layout = _natives.layout;
+                ResolveSlot(instruction.lhs, RSI, cold);
+                if (instruction.dst.kind == OperandKind::None) {
+                    return;
+                }
+                ResolveSlot(instruction.dst, R8, cold);
+                const Assembler::Label done = as.NewLabel();
+                const Assembler::Label retained = as.NewLabel();
+                const Assembler::Label released = as.NewLabel();
+                const Assembler::Label write = as.NewLabel();
+                as.Compare(RSI, R8);
+                as.JumpIf(Equal, done);
+                as.Load(RAX, RSI, layout.holder_data);
+                as.TestByte(RSI, layout.holder_owning, 1);
+                as.JumpIf(Equal, retained);
+                as.TestByte(RAX, layout.object_pinned, 1);
+                as.JumpIf(NotEqual, cold);
+                as.Bind(retained);
+                as.TestByte(R8, layout.holder_owning, 1);
+                as.JumpIf(Equal, released);
+                as.Load(R9, R8, layout.holder_data);
+                as.TestByte(R9, layout.object_traceable, 1);
+                as.JumpIf(NotEqual, cold);
+                as.Compare32(R9, layout.object_count, 1);
+                as.JumpIf(BelowOrEqual, cold);
+                as.Decrement32(R9, layout.object_count);
+                as.Bind(released);
+                as.TestByte(RSI, layout.holder_owning, 1);
+                as.JumpIf(Equal, write);
+                as.Increment32(RAX, layout.object_count);
+                as.Bind(write);
+                as.Store(R8, layout.holder_data, RAX);
+                as.CopyByte(R8, layout.holder_owning, RSI, layout.holder_owning);
+                as.Bind(done);
+            }
+
+            // Add, Sub и Compare двух Number. Сумма записывается в Number ячейки dst, если на него больше нет
+            // ссылок, либо берётся из кеша общих чисел. Результат сравнения - общий объект True или False
+            void TranslateNumbers(Instruction& instruction, Assembler::Label cold) {
+                Assembler& as = _assembler;
+                const runtime::NativeLayout& layout = _natives.layout;
+                ResolveSlot(instruction.lhs, RSI, cold);
+                ResolveSlot(instruction.rhs, RDI, cold);
+                as.MoveImmediate(RCX, _natives.number_vtable);
+                GuardNumber(RSI, RAX, cold);
+                GuardNumber(RDI, RDX, cold);
+                as.Load(RAX, RAX, _natives.number_value);
+
+                if (instruction.op == Opcode::Compare) {
+                    as.CompareWithMemory(RAX, RDX, _natives.number_value);
+                    as.MoveImmediate(RDX, _natives.false_object);
+                    as.MoveImmediate(R9, _natives.true_object);
+                    as.MoveIf(Condition(instruction.cmp), RDX, R9);
+                    if (instruction.dst.kind != OperandKind::None) {
+                        ResolveSlot(instruction.dst, R8, cold);
+                        StoreShared(R8, RDX, cold);
+                    }
+                    return;
+                }
+
+                if (instruction.op == Opcode::Add) {
+                    as.AddMemory(RAX, RDX, _natives.number_value);
+                }
+                else {
+                    as.SubMemory(RAX, RDX, _natives.number_value);
+                }
+                as.JumpIf(Overflow, cold);
+                if (instruction.dst.kind == OperandKind::None) {
+                    return;
+                }
+                ResolveSlot(instruction.dst, R8, cold);
+                const Assembler::Label done = as.NewLabel();
+                const Assembler::Label shared = as.NewLabel();
+                as.TestByte(R8, layout.holder_owning, 1);
+                as.JumpIf(Equal, shared);
+                as.Load(RDX, R8, layout.holder_data);
+                as.CompareMemory(RDX, 0, RCX);
+                as.JumpIf(NotEqual, shared);
+                as.Compare32(RDX, layout.object_count, 1);
+                as.JumpIf(NotEqual, shared);
+                as.Store(RDX, _natives.number_value, RAX);
+                as.Jump(done);
+
+                as.Bind(shared);
+                if (_natives.small_numbers == 0) {
+                    as.Jump(cold);
+                }
+                else {
+                    as.Move(RDX, RAX);
+                    as.AddImmediate(RDX, static_cast<int32_t>(-runtime::__SMALL_INT_MIN__));
+                    as.CompareImmediate(RDX, static_cast<int32_t>(runtime::__SMALL_INT_MAX__ - runtime::__SMALL_INT_MIN__));
+                    as.JumpIf(Above, cold);
+                    as.MultiplyImmediate(RDX, RDX, static_cast<int32_t>(_natives.number_size));
+                    as.MoveImmediate(R9, _natives.small_numbers);
+                    as.Add(RDX, R9);
+                    StoreShared(R8, RDX, cold);
+                }
+                as.Bind(done);
+            }
+
+            // Условный переход по общим объектам True и False, None и Number. Прочие значения проверяет
+            // обработчик
+            void TranslateBranch(Instruction& instruction, Assembler::Label cold, Assembler::Label next) {
+                Assembler& as = _assembler;
+                const bool jump_if = instruction.op == Opcode::JumpIfTrue;
+                const Assembler::Label on_true = jump_if ? _labels[instruction.a] : next;
+                const Assembler::Label on_false = jump_if ? next : _labels[instruction.a];
+                ResolveSlot(instruction.lhs, RSI, cold);
+                as.Load(RAX, RSI, _natives.layout.holder_data);
+                as.Test(RAX);
+                as.JumpIf(Equal, on_false);
+                as.MoveImmediate(RCX, _natives.true_object);
+                as.Compare(RAX, RCX);
+                as.JumpIf(Equal, on_true);
+                as.MoveImmediate(RCX, _natives.false_object);
+                as.Compare(RAX, RCX);
+                as.JumpIf(Equal, on_false);
+                as.MoveImmediate(RCX, _natives.number_vtable);
+                as.CompareMemory(RAX, 0, RCX);
+                as.JumpIf(NotEqual, cold);
+                as.Compare64(RAX, _natives.number_value, 0);
+                as.JumpIf(Equal, on_false);
+                as.Jump(on_true);
+            }
+
+            static Cond Condition(runtime::CompareOp op) {
+                switch (op) {
+                case runtime::CompareOp::Less:
+                    return Less;
+                case runtime::CompareOp::LessOrEqual:
+                    return LessOrEqual;
+                case runtime::CompareOp::Greater:
+                    return Greater;
+                case runtime::CompareOp::GreaterOrEqual:
+                    return GreaterOrEqual;
+                case runtime::CompareOp::Equal:
+                    return Equal;
+                case runtime::CompareOp::NotEqual:
+                    break;
+                }
+                return NotEqual;
+            }
+
+            Code& _code;
+            Assembler& _assembler;
+            const Natives& _natives;
+            std::vector<Assembler::Label> _labels;      // адреса инструкций, последняя метка - выход
+            Assembler::Label _exit = 0;
+            std::vector<Cold> _cold;
+        };
+
+        // Копирует код в новые страницы и делает их исполняемыми. Страницы не бывают одновременно
+        // доступны на запись и исполнение
+        void* AllocateExecutable([[maybe_unused]] const std::vector<uint8_t>& bytes) {
+#ifdef MYTHON_JIT_X86_64
+            void* memory = mmap(nullptr, bytes.size(), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (memory == MAP_FAILED) {
+                return nullptr;
+            }
+            std::memcpy(memory, bytes.data(), bytes.size());
+            if (mprotect(memory, bytes.size(), PROT_READ | PROT_EXEC) != 0) {
+                munmap(memory, bytes.size());
+                return nullptr;
+            }
+            return memory;
+#else
+            return nullptr;
+#endif
+        }
+
+        void ReleaseExecutable([[maybe_unused]] void* memory, [[maybe_unused]] size_t size) {
+#ifdef MYTHON_JIT_X86_64
+            munmap(memory, size);
+#endif
+        }
+
+        // Function::CompileNative компилирует код только при первом обращении
+        void TierUp(const runtime::Method& method) {
+            if (auto* function = dynamic_cast<regvm::Function*>(method.body.get())) {
+                function->CompileNative();
+            }
+        }
+
+    }  // namespace
+
+    bool IsSupported() {
+#ifdef MYTHON_JIT_X86_64
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    std::unique_ptr<NativeCode> NativeCode::Compile(Code& code) {
+        if (!IsSupported()) {
+            return nullptr;
+        }
+        Assembler assembler;
+        if (!Translator(code, assembler).Translate()) {
+            return nullptr;
+        }
+        void* memory = AllocateExecutable(assembler.GetBytes());
+        if (memory == nullptr) {
+            return nullptr;
+        }
+        return std::unique_ptr<NativeCode>(new NativeCode(code, memory, assembler.Size()));
+    }
+
+    NativeCode::NativeCode(Code& code, void* memory, size_t size)
+        : _code(code)
+        , _memory(memory)
+        , _size(size) {
+    }
+
+    NativeCode::~NativeCode() {
+        ReleaseExecutable(_memory, _size);
+    }
+
+    ObjectHolder NativeCode::Run(Closure& closure, Context& context) {
+        ObjectHolder inline_registers[__JIT_INLINE_REGISTERS__];
+        std::unique_ptr<ObjectHolder[]> heap_registers;
+        ObjectHolder* registers = inline_registers;
+        if (_code.registers > __JIT_INLINE_REGISTERS__) {
+            heap_registers = std::make_unique<ObjectHolder[]>(_code.registers);
+            registers = heap_registers.get();
+        }
+
+        Frame frame{ &_code, &closure, &context, registers, {}, {}, {} };
+        reinterpret_cast<Entry>(_memory)(&frame, registers, &closure);
+        if (frame.error) {
+            std::rethrow_exception(frame.error);
+        }
+        return std::move(frame.result);
+    }
+
+    TierUpScope::TierUpScope(uint64_t threshold) {
+        runtime::SetTierUp(&TierUp, threshold);
+    }
+
+    TierUpScope::~TierUpScope() {
+        runtime::SetTierUp(nullptr, 0);
+    }
+
+}  // namespace jit
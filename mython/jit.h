@@ -0,0 +1,61 @@
+#pragma once
+
+#include "regvm.h"
+#include "runtime.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace jit {
+
+    // Число вызовов, после которого метод компилируется в машинный код
+    constexpr uint64_t __DEFAULT_TIER_UP_THRESHOLD__ = 50;
+
+    // Возвращает true, если JIT выпускает код для этой платформы: x86-64 с исполняемой памятью mmap
+    [[nodiscard]] bool IsSupported();
+
+    /*
+     * Машинный код x86-64 трёхадресного кода regvm::Function, построенный по шаблонам. Move, переходы
+     * и Add, Sub, Compare двух Number выполняются прямо в машинном коде: операнды читаются из регистров
+     * кадра и встроенных ячеек таблицы символов, вид значения проверяется сравнением указателей, переполнение -
+     * флагом процессора. Если проверка не прошла, инструкцию выполняет её обработчик в C++, как и все
+     * остальные инструкции. Исключение обработчика запоминается в кадре, код выходит из функции,
+     * и Run выбрасывает его заново
+     */
+    class NativeCode {
+    public:
+        // Компилирует code, который должен жить дольше результата. Возвращает nullptr, если платформа
+        // не поддерживается, для инструкции нет шаблона или не удалось получить исполняемую память
+        [[nodiscard]] static std::unique_ptr<NativeCode> Compile(regvm::Code& code);
+
+        NativeCode(const NativeCode&) = delete;
+        NativeCode& operator=(const NativeCode&) = delete;
+        ~NativeCode();
+
+        // Выполняет код в таблице символов closure и возвращает результат return либо None
+        runtime::ObjectHolder Run(runtime::Closure& closure, runtime::Context& context);
+
+        // Размер машинного кода в байтах
+        [[nodiscard]] size_t Size() const {
+            return _size;
+        }
+
+    private:
+        NativeCode(regvm::Code& code, void* memory, size_t size);
+
+        regvm::Code& _code;
+        void* _memory;
+        size_t _size;
+    };
+
+    // Пока объект жив, методы с телом regvm::Function компилируются после threshold вызовов
+    class TierUpScope {
+    public:
+        explicit TierUpScope(uint64_t threshold = __DEFAULT_TIER_UP_THRESHOLD__);
+        TierUpScope(const TierUpScope&) = delete;
+        TierUpScope& operator=(const TierUpScope&) = delete;
+        ~TierUpScope();
+    };
+
+}  // namespace jit
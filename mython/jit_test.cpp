@@ -0,0 +1,268 @@
+#include "jit.h"
+#include "lexer.h"
+#include "parse.h"
+#include "test_runner_p.h"
+
+using namespace std;
+
+namespace jit {
+
+    namespace {
+
+        unique_ptr<runtime::Executable> Parse(const string& program) {
+            istringstream input(program);
+            parse::Lexer lexer(input);
+            return ParseProgram(lexer);
+        }
+
+        string RunTree(const string& program) {
+            runtime::DummyContext context;
+            runtime::Closure closure;
+            Parse(program)->Execute(closure, context);
+            return context.output.str();
+        }
+
+        const regvm::Function* GetMethodBody(const runtime::Closure& closure, const string& cls, const string& method) {
+            const auto* class_object = closure.at(runtime::Symbol(cls)).TryAs<runtime::Class>();
+            ASSERT(class_object != nullptr);
+            const runtime::Method* found = class_object->GetMethod(runtime::Symbol(method));
+            ASSERT(found != nullptr);
+            return dynamic_cast<const regvm::Function*>(found->body.get());
+        }
+
+        void TestHotMethodsAreCompiled() {
+            const string program = R"(
+class Counter:
+  def __init__():
+    self.value = 0
+
+  def add(n):
+    if n > 2:
+      self.value = self.value + n * 2
+    else:
+      self.value = self.value - 1
+    return self
+
+  def describe():
+    return 'Counter(' + str(self.value) + ')'
+
+c = Counter()
+for i in [1, 2, 3, 4, 5, 6, 7, 8, 9, 10]:
+  c.add(i)
+print c.describe(), c.value
+)"s;
+            TierUpScope tier_up(5);
+            runtime::DummyContext context;
+            runtime::Closure closure;
+            regvm::CompileProgram(Parse(program))->Execute(closure, context);
+            ASSERT_EQUAL(context.output.str(), RunTree(program));
+
+            const auto* add = GetMethodBody(closure, "Counter"s, "add"s);
+            const auto* describe = GetMethodBody(closure, "Counter"s, "describe"s);
+            ASSERT(add != nullptr && describe != nullptr);
+            ASSERT_EQUAL(closure.at(runtime::Symbol("Counter")).TryAs<runtime::Class>()->GetMethod(runtime::Symbol("add"))->calls, 10U);
+            // горячий метод скомпилирован, вызванный один раз остался интерпретатору
+            ASSERT_EQUAL(add->IsNative(), IsSupported());
+            ASSERT(!describe->IsNative());
+
+            // метод, число вызовов которого уже больше нового порога, компилируется при следующем вызове
+            TierUpScope lower(1);
+            regvm::CompileProgram(Parse("print c.describe()\n"s))->Execute(closure, context);
+            ASSERT_EQUAL(describe->IsNative(), IsSupported());
+        }
+
+        void TestMatchesInterpreter() {
+            // с порогом 1 каждый метод выполняется машинным кодом с первого вызова
+            const string program = R"(
+class Shape:
+  def __init__(name):
+    self.name = name
+    self.sides = []
+
+  def add(length):
+    self.sides.append(length)
+    return self
+
+  def perimeter():
+    total = 0
+    for side in self.sides:
+      total = total + side
+    return total
+
+  def kind():
+    n = len(self.sides)
+    if n == 3:
+      return 'triangle'
+    if n == 4 and self.perimeter() > 9:
+      return 'big quad'
+    return not n or 'polygon'
+
+  def __str__():
+    return self.name + ':' + str(self.kind())
+
+s = Shape('s')
+for side in [3, 4, 5]:
+  s.add(side)
+q = Shape('q')
+for i in [1, 2, 3, 4]:
+  q.add(i)
+e = Shape('e')
+print s, s.perimeter(), q, q.perimeter(), e, e.kind(), 7 / 2, 1.5 * 2
+)"s;
+            TierUpScope tier_up(1);
+            runtime::DummyContext context;
+            runtime::Closure closure;
+            regvm::CompileProgram(Parse(program))->Execute(closure, context);
+            ASSERT_EQUAL(context.output.str(), RunTree(program));
+            ASSERT_EQUAL(context.output.str(), "s:triangle 12 q:big quad 10 e:True True 3 3.0\n"s);
+            ASSERT_EQUAL(GetMethodBody(closure, "Shape"s, "perimeter"s)->IsNative(), IsSupported());
+        }
+
+        void TestInlineNumbers() {
+            // Move, Add, Sub, Compare и переходы выполняются машинным кодом, пока значения - Number,
+            // и обработчиками в остальных случаях
+            const string program = R"(
+class Calc:
+  def step(x, limit):
+    y = x
+    x = x + 1
+    z = x - y
+    w = x
+    x = x + 1
+    a = limit - 1
+    b = limit + 1
+    c = a - b - 1
+    if x > limit:
+      return [y, x, z, w, a, b, c, 'over']
+    if x == limit:
+      return [y, x, z, w, a, b, c, x < limit, x <= limit, x >= limit, x != limit]
+    return [y, x, z, w, a, b, c]
+
+  def test(value):
+    if value:
+      return 'yes'
+    return 'no'
+
+  def mixed(a, b):
+    return [a + b, a < b, a == b]
+
+  def minus(a, b):
+    return a - b
+
+  def many(p1, p2, p3, p4, p5):
+    t1 = p1 + p2
+    t2 = t1 + p3
+    t3 = t2 + p4
+    t4 = t3 + p5
+    t5 = t4 - p1
+    t6 = t5 + t1
+    return t6
+
+c = Calc()
+for x in [1, 1022, 1023, 1024, -258, -257, 9223372036854775806, 5]:
+  print c.step(x, 1026), c.step(x, 1024)
+for value in [0, 1, -1, None, True, False, '', 'a', [], [0], c]:
+  print c.test(value)
+print c.mixed('a', 'b'), c.mixed(1.5, 2), c.mixed(9223372036854775807, 1), c.minus(-9223372036854775807, 5), c.minus(2.5, 1)
+print c.many(1, 2, 3, 4, 5), c.many(1000, 2000, 3000, 4000, 5000)
+)"s;
+            TierUpScope tier_up(1);
+            runtime::DummyContext context;
+            runtime::Closure closure;
+            regvm::CompileProgram(Parse(program))->Execute(closure, context);
+            ASSERT_EQUAL(context.output.str(), RunTree(program));
+            ASSERT_EQUAL(GetMethodBody(closure, "Calc"s, "step"s)->IsNative(), IsSupported());
+            ASSERT_EQUAL(GetMethodBody(closure, "Calc"s, "many"s)->IsNative(), IsSupported());
+        }
+
+        void TestErrorsLeaveNativeCode() {
+            // исключение обработчика выходит из машинного кода и выбрасывается тем же типом
+            const string program = R"(
+class Walker:
+  def deep(n):
+    return self.deep(n + 1)
+
+  def broken():
+    x = 1
+    return x + missing
+
+  def fields():
+    x = 1
+    x.field = 2
+
+  def grow(d):
+    for k in d:
+      d[k + 1] = 1
+
+  def ok():
+    return 1
+
+w = Walker()
+)"s;
+            TierUpScope tier_up(1);
+            runtime::DummyContext context;
+            runtime::Closure closure;
+            regvm::CompileProgram(Parse(program))->Execute(closure, context);
+            ASSERT_THROWS(regvm::CompileProgram(Parse("w.deep(0)\n"s))->Execute(closure, context),
+                runtime::RecursionError);
+            ASSERT_THROWS(regvm::CompileProgram(Parse("w.broken()\n"s))->Execute(closure, context),
+                std::runtime_error);
+            ASSERT_THROWS(regvm::CompileProgram(Parse("w.fields()\n"s))->Execute(closure, context),
+                std::runtime_error);
+            ASSERT_THROWS(regvm::CompileProgram(Parse("w.grow({1: 1})\n"s))->Execute(closure, context),
+                std::runtime_error);
+            ASSERT_EQUAL(GetMethodBody(closure, "Walker"s, "grow"s)->IsNative(), IsSupported());
+            ASSERT_EQUAL(GetMethodBody(closure, "Walker"s, "deep"s)->IsNative(), IsSupported());
+
+            // после ошибок код продолжает работать
+            runtime::DummyContext after;
+            regvm::CompileProgram(Parse("print w.ok()\n"s))->Execute(closure, after);
+            ASSERT_EQUAL(after.output.str(), "1\n"s);
+        }
+
+        void TestFallback() {
+            // инструкция без шаблона: код остаётся интерпретатору
+            regvm::Code code;
+            regvm::Instruction unknown;
+            unknown.op = static_cast<regvm::Opcode>(0xFF);
+            code.instructions.push_back(unknown);
+            ASSERT(NativeCode::Compile(code) == nullptr);
+
+            regvm::Code empty;
+            regvm::Instruction return_none;
+            return_none.op = regvm::Opcode::Return;
+            empty.instructions.push_back(return_none);
+            auto native = NativeCode::Compile(empty);
+            ASSERT_EQUAL(native != nullptr, IsSupported());
+            if (native) {
+                runtime::DummyContext context;
+                runtime::Closure closure;
+                ASSERT(!native->Run(closure, context));
+                ASSERT(native->Size() > 0U);
+            }
+
+            // методы с телом обхода дерева горячими не компилируются и выполняются как раньше
+            const string program = R"(
+class Box:
+  def get():
+    return 4
+
+b = Box()
+for i in [1, 2, 3]:
+  print b.get()
+)"s;
+            TierUpScope tier_up(1);
+            ASSERT_EQUAL(RunTree(program), "4\n4\n4\n"s);
+        }
+
+    }  // namespace
+
+    void RunJitTests(TestRunner& tr) {
+        RUN_TEST(tr, jit::TestHotMethodsAreCompiled);
+        RUN_TEST(tr, jit::TestMatchesInterpreter);
+        RUN_TEST(tr, jit::TestInlineNumbers);
+        RUN_TEST(tr, jit::TestErrorsLeaveNativeCode);
+        RUN_TEST(tr, jit::TestFallback);
+    }
+
+}  // namespace jit
@@ -13,7 +13,7 @@ namespace parse {
             istringstream input("x = 42\n"s);
             Lexer lexer(input);
 
-            ASSERT_EQUAL(lexer.CurrentToken(), Token(token_type::Id{ "x"s }));
+            ASSERT_EQUAL(lexer.CurrentToken(), Token(token_type::Id{ runtime::Symbol("x") }));
             ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Char{ '=' }));
             ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Number{ 42 }));
             ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Newline{}));
@@ -65,13 +65,13 @@ namespace parse {
             istringstream input("x    _42 big_number   Return Class  dEf"s);
             Lexer lexer(input);
 
-            ASSERT_EQUAL(lexer.CurrentToken(), Token(token_type::Id{ "x"s }));
-            ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Id{ "_42"s }));
-            ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Id{ "big_number"s }));
+            ASSERT_EQUAL(lexer.CurrentToken(), Token(token_type::Id{ runtime::Symbol("x") }));
+            ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Id{ runtime::Symbol("_42") }));
+            ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Id{ runtime::Symbol("big_number") }));
             ASSERT_EQUAL(lexer.NextToken(),
-                Token(token_type::Id{ "Return"s }));  // keywords are case-sensitive
-            ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Id{ "Class"s }));
-            ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Id{ "dEf"s }));
+                Token(token_type::Id{ runtime::Symbol("Return") }));  // keywords are case-sensitive
+            ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Id{ runtime::Symbol("Class") }));
+            ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Id{ runtime::Symbol("dEf") }));
         }
 
         void TestStrings() {
@@ -122,33 +122,33 @@ no_indent
 
             Lexer lexer(input);
 
-            ASSERT_EQUAL(lexer.CurrentToken(), Token(token_type::Id{ "no_indent"s }));
+            ASSERT_EQUAL(lexer.CurrentToken(), Token(token_type::Id{ runtime::Symbol("no_indent") }));
             ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Newline{}));
             ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Indent{}));
-            ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Id{ "indent_one"s }));
+            ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Id{ runtime::Symbol("indent_one") }));
             ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Newline{}));
             ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Indent{}));
-            ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Id{ "indent_two"s }));
+            ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Id{ runtime::Symbol("indent_two") }));
             ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Newline{}));
             ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Indent{}));
-            ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Id{ "indent_three"s }));
+            ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Id{ runtime::Symbol("indent_three") }));
             ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Newline{}));
-            ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Id{ "indent_three"s }));
+            ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Id{ runtime::Symbol("indent_three") }));
             ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Newline{}));
-            ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Id{ "indent_three"s }));
+            ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Id{ runtime::Symbol("indent_three") }));
             ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Newline{}));
             ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Dedent{}));
-            ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Id{ "indent_two"s }));
+            ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Id{ runtime::Symbol("indent_two") }));
             ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Newline{}));
             ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Dedent{}));
-            ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Id{ "indent_one"s }));
+            ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Id{ runtime::Symbol("indent_one") }));
             ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Newline{}));
             ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Indent{}));
-            ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Id{ "indent_two"s }));
+            ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Id{ runtime::Symbol("indent_two") }));
             ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Newline{}));
             ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Dedent{}));
             ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Dedent{}));
-            ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Id{ "no_indent"s }));
+            ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Id{ runtime::Symbol("no_indent") }));
             ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Newline{}));
             ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Eof{}));
         }
@@ -164,18 +164,18 @@ x = 1
 )"s);
             Lexer lexer(input);
 
-            ASSERT_EQUAL(lexer.CurrentToken(), Token(token_type::Id{ "x"s }));
+            ASSERT_EQUAL(lexer.CurrentToken(), Token(token_type::Id{ runtime::Symbol("x") }));
             ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Char{ '=' }));
             ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Number{ 1 }));
             ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Newline{}));
             ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Indent{}));
-            ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Id{ "y"s }));
+            ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Id{ runtime::Symbol("y") }));
             ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Char{ '=' }));
             ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Number{ 2 }));
             ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Newline{}));
             // Пустая строка, состоящая только из пробельных символов не меняет текущий отступ,
             // поэтому следующая лексема — это Id, а не Dedent
-            ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Id{ "z"s }));
+            ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Id{ runtime::Symbol("z") }));
             ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Char{ '=' }));
             ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Number{ 3 }));
             ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Newline{}));
@@ -201,70 +201,70 @@ print str(p)
 )"s);
             Lexer lexer(input);
 
-            ASSERT_EQUAL(lexer.CurrentToken(), Token(token_type::Id{ "x"s }));
+            ASSERT_EQUAL(lexer.CurrentToken(), Token(token_type::Id{ runtime::Symbol("x") }));
             ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Char{ '=' }));
             ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Number{ 4 }));
             ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Newline{}));
-            ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Id{ "y"s }));
+            ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Id{ runtime::Symbol("y") }));
             ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Char{ '=' }));
             ASSERT_EQUAL(lexer.NextToken(), Token(token_type::String{ "hello"s }));
             ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Newline{}));
             ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Class{}));
-            ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Id{ "Point"s }));
+            ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Id{ runtime::Symbol("Point") }));
             ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Char{ ':' }));
             ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Newline{}));
             ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Indent{}));
             ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Def{}));
-            ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Id{ "__init__"s }));
+            ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Id{ runtime::Symbol("__init__") }));
             ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Char{ '(' }));
-            ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Id{ "self"s }));
+            ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Id{ runtime::Symbol("self") }));
             ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Char{ ',' }));
-            ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Id{ "x"s }));
+            ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Id{ runtime::Symbol("x") }));
             ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Char{ ',' }));
-            ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Id{ "y"s }));
+            ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Id{ runtime::Symbol("y") }));
             ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Char{ ')' }));
             ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Char{ ':' }));
             ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Newline{}));
             ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Indent{}));
-            ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Id{ "self"s }));
+            ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Id{ runtime::Symbol("self") }));
             ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Char{ '.' }));
-            ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Id{ "x"s }));
+            ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Id{ runtime::Symbol("x") }));
             ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Char{ '=' }));
-            ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Id{ "x"s }));
+            ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Id{ runtime::Symbol("x") }));
             ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Newline{}));
-            ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Id{ "self"s }));
+            ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Id{ runtime::Symbol("self") }));
             ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Char{ '.' }));
-            ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Id{ "y"s }));
+            ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Id{ runtime::Symbol("y") }));
             ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Char{ '=' }));
-            ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Id{ "y"s }));
+            ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Id{ runtime::Symbol("y") }));
             ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Newline{}));
             ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Dedent{}));
             ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Def{}));
-            ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Id{ "__str__"s }));
+            ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Id{ runtime::Symbol("__str__") }));
             ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Char{ '(' }));
-            ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Id{ "self"s }));
+            ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Id{ runtime::Symbol("self") }));
             ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Char{ ')' }));
             ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Char{ ':' }));
             ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Newline{}));
             ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Indent{}));
             ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Return{}));
-            ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Id{ "str"s }));
+            ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Id{ runtime::Symbol("str") }));
             ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Char{ '(' }));
-            ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Id{ "x"s }));
+            ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Id{ runtime::Symbol("x") }));
             ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Char{ ')' }));
             ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Char{ '+' }));
             ASSERT_EQUAL(lexer.NextToken(), Token(token_type::String{ " "s }));
             ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Char{ '+' }));
-            ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Id{ "str"s }));
+            ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Id{ runtime::Symbol("str") }));
             ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Char{ '(' }));
-            ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Id{ "y"s }));
+            ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Id{ runtime::Symbol("y") }));
             ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Char{ ')' }));
             ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Newline{}));
             ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Dedent{}));
             ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Dedent{}));
-            ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Id{ "p"s }));
+            ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Id{ runtime::Symbol("p") }));
             ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Char{ '=' }));
-            ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Id{ "Point"s }));
+            ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Id{ runtime::Symbol("Point") }));
             ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Char{ '(' }));
             ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Number{ 1 }));
             ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Char{ ',' }));
@@ -272,9 +272,9 @@ print str(p)
             ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Char{ ')' }));
             ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Newline{}));
             ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Print{}));
-            ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Id{ "str"s }));
+            ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Id{ runtime::Symbol("str") }));
             ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Char{ '(' }));
-            ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Id{ "p"s }));
+            ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Id{ runtime::Symbol("p") }));
             ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Char{ ')' }));
             ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Newline{}));
             ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Eof{}));
@@ -288,7 +288,7 @@ print str(p)
             Lexer lex(is);
 
             ASSERT_DOESNT_THROW(lex.Expect<token_type::Id>());
-            ASSERT_EQUAL(lex.Expect<token_type::Id>().value, "bugaga"s);
+            ASSERT_EQUAL(lex.Expect<token_type::Id>().value.Name(), "bugaga"s);
             ASSERT_DOESNT_THROW(lex.Expect<token_type::Id>("bugaga"s));
             ASSERT_THROWS(lex.Expect<token_type::Id>("widget"s), LexerError);
             ASSERT_THROWS(lex.Expect<token_type::Return>(), LexerError);
@@ -310,8 +310,8 @@ print str(p)
                 istringstream is("a b"s);
                 Lexer lexer(is);
 
-                ASSERT_EQUAL(lexer.CurrentToken(), Token(token_type::Id{ "a"s }));
-                ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Id{ "b"s }));
+                ASSERT_EQUAL(lexer.CurrentToken(), Token(token_type::Id{ runtime::Symbol("a") }));
+                ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Id{ runtime::Symbol("b") }));
                 ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Newline{}));
                 ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Eof{}));
                 ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Eof{}));
@@ -350,9 +350,9 @@ abc#
 #)"s);
 
                 Lexer lexer(is);
-                ASSERT_EQUAL(lexer.CurrentToken(), Token(token_type::Id{ "x"s }));
+                ASSERT_EQUAL(lexer.CurrentToken(), Token(token_type::Id{ runtime::Symbol("x") }));
                 ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Newline{}));
-                ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Id{ "abc"s }));
+                ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Id{ runtime::Symbol("abc") }));
                 ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Newline{}));
                 ASSERT_EQUAL(lexer.NextToken(), Token(token_type::String{ "#"s }));
                 ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Newline{}));
@@ -381,6 +381,76 @@ abc#
 
         }
 
+        void TestListTokens() {
+
+            istringstream input("for x in [1, y[0]]:"s);
+            Lexer lexer(input);
+
+            ASSERT_EQUAL(lexer.CurrentToken(), Token(token_type::For{}));
+            ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Id{ runtime::Symbol("x") }));
+            ASSERT_EQUAL(lexer.NextToken(), Token(token_type::In{}));
+            ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Char{ '[' }));
+            ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Number{ 1 }));
+            ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Char{ ',' }));
+            ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Id{ runtime::Symbol("y") }));
+            ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Char{ '[' }));
+            ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Number{ 0 }));
+            ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Char{ ']' }));
+            ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Char{ ']' }));
+            ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Char{ ':' }));
+            ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Newline{}));
+        }
+
+        void TestFloatNumbers() {
+
+            istringstream input("x = 3.14 + 1e3 - 2.5E-3 * p.y"s);
+            Lexer lexer(input);
+
+            ASSERT_EQUAL(lexer.CurrentToken(), Token(token_type::Id{ runtime::Symbol("x") }));
+            ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Char{ '=' }));
+            ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Float{ 3.14 }));
+            ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Char{ '+' }));
+            ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Float{ 1000.0 }));
+            ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Char{ '-' }));
+            ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Float{ 0.0025 }));
+            ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Char{ '*' }));
+            ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Id{ runtime::Symbol("p") }));
+            ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Char{ '.' }));
+            ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Id{ runtime::Symbol("y") }));
+
+            istringstream broken("x = 1e"s);
+            ASSERT_THROWS(Lexer{ broken }, LexerError);
+        }
+
+        void TestLargeNumbers() {
+
+            istringstream input("x = 3000000000 * 9223372036854775807"s);
+            Lexer lexer(input);
+
+            ASSERT_EQUAL(lexer.CurrentToken(), Token(token_type::Id{ runtime::Symbol("x") }));
+            ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Char{ '=' }));
+            ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Number{ 3000000000 }));
+            ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Char{ '*' }));
+            ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Number{ 9223372036854775807 }));
+
+            // литерал, не помещающийся в 64 бита, - ошибка лексера
+            istringstream overflow("x = 9223372036854775808"s);
+            ASSERT_THROWS(Lexer{ overflow }, LexerError);
+        }
+
+        void TestInternedIds() {
+
+            istringstream input("count = count + 1"s);
+            Lexer lexer(input);
+
+            // одинаковые идентификаторы разделяют одну строку таблицы символов
+            const std::string& first = lexer.CurrentToken().As<token_type::Id>().value.Name();
+            lexer.NextToken();
+            lexer.NextToken();
+            ASSERT_EQUAL(&lexer.CurrentToken().As<token_type::Id>().value.Name(), &first);
+            ASSERT_EQUAL(lexer.CurrentToken(), Token(token_type::Id{ runtime::Symbol("count") }));
+        }
+
     }  // namespace
 
 
@@ -402,6 +472,10 @@ abc#
         RUN_TEST(tr, parse::TestCommentsAreIgnored);
         RUN_TEST(tr, parse::TestYandexSix);
         RUN_TEST(tr, parse::TestYandexFourt);
+        RUN_TEST(tr, parse::TestListTokens);
+        RUN_TEST(tr, parse::TestLargeNumbers);
+        RUN_TEST(tr, parse::TestFloatNumbers);
+        RUN_TEST(tr, parse::TestInternedIds);
     }
 
 }  // namespace parse
\ No newline at end of file
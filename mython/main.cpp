@@ -1,168 +1,441 @@
-﻿#include "lexer.h"
-#include "parse.h"
-#include "runtime.h"
-#include "statement.h"
-#include "test_runner_p.h"
-
-#include <iostream>
-
-using namespace std;
-
-namespace parse {
-    void RunOpenLexerTests(TestRunner& tr);
-}  // namespace parse
-
-namespace ast {
-    void RunUnitTests(TestRunner& tr);
-}
-namespace runtime {
-    void RunObjectHolderTests(TestRunner& tr);
-    void RunObjectsTests(TestRunner& tr);
-}  // namespace runtime
-
-void TestParseProgram(TestRunner& tr);
-
-namespace {
-
-    void RunMythonProgram(istream& input, ostream& output) {
-        parse::Lexer lexer(input);
-        auto program = ParseProgram(lexer);
-
-        runtime::SimpleContext context{ output };
-        runtime::Closure closure;
-        program->Execute(closure, context);
-    }
-
-    void TestSelfInConstructor() {
-        istringstream input(R"--(
-class X:
-  def __init__(p):
-    p.x = self
-
-class XHolder:
-  def __init__():
-    dummy = 0
-
-xh = XHolder()
-x = X(xh)
-)--");
-        parse::Lexer lexer(input);
-        auto program = ParseProgram(lexer);
-
-        runtime::DummyContext context;
-        runtime::Closure closure;
-        program->Execute(closure, context);
-        const auto* xh = closure.at("xh"s).TryAs<runtime::ClassInstance>();
-        ASSERT(xh != nullptr);
-        ASSERT_EQUAL(xh->Fields().at("x"s).Get(), closure.at("x"s).Get());
-    }
-
-    void TestSimplePrints() {
-        istringstream input(R"(
-print 57
-print 10, 24, -8
-print 'hello'
-print "world"
-print True, False
-print
-print None
-)");
-
-        ostringstream output;
-        RunMythonProgram(input, output);
-
-        ASSERT_EQUAL(output.str(), "57\n10 24 -8\nhello\nworld\nTrue False\n\nNone\n");
-    }
-
-    void TestAssignments() {
-        istringstream input(R"(
-x = 57
-print x
-x = 'C++ black belt'
-print x
-y = False
-x = y
-print x
-x = None
-print x, y
-)");
-
-        ostringstream output;
-        RunMythonProgram(input, output);
-
-        ASSERT_EQUAL(output.str(), "57\nC++ black belt\nFalse\nNone False\n");
-    }
-
-    void TestArithmetics() {
-        istringstream input("print 1+2+3+4+5, 1*2*3*4*5, 1-2-3-4-5, 36/4/3, 2*5+10/2");
-
-        ostringstream output;
-        RunMythonProgram(input, output);
-
-        ASSERT_EQUAL(output.str(), "15 120 -13 3 15\n");
-    }
-
-    void TestVariablesArePointers() {
-        istringstream input(R"(
-class Counter:
-  def __init__():
-    self.value = 0
-
-  def add():
-    self.value = self.value + 1
-
-class Dummy:
-  def do_add(counter):
-    counter.add()
-
-x = Counter()
-y = x
-
-x.add()
-y.add()
-
-print x.value
-
-d = Dummy()
-d.do_add(x)
-
-print y.value
-)");
-
-        ostringstream output;
-        RunMythonProgram(input, output);
-
-        ASSERT_EQUAL(output.str(), "2\n3\n");
-    }
-
-    void TestAll() {
-        TestRunner tr;
-        parse::RunOpenLexerTests(tr);
-        runtime::RunObjectHolderTests(tr);
-        runtime::RunObjectsTests(tr);
-        ast::RunUnitTests(tr);
-        TestParseProgram(tr);
-
-        RUN_TEST(tr, TestSelfInConstructor);
-        RUN_TEST(tr, TestSimplePrints);
-        RUN_TEST(tr, TestAssignments);
-        RUN_TEST(tr, TestArithmetics);
-        RUN_TEST(tr, TestVariablesArePointers);
-    }
-
-}  // namespace
-
-
-
-int main() {
-    try {
-        TestAll();
-
-        RunMythonProgram(cin, cout);
-    }
-    catch (const std::exception& e) {
-        std::cerr << e.what() << std::endl;
-        return 1;
-    }
-    return 0;
+﻿#include "aot.h"
+#include "bench.h"
+#include "bytecode.h"
+#include "jit.h"
+#include "lexer.h"
+#include "parse.h"
+#include "regvm.h"
+#include "runtime.h"
+#include "statement.h"
+#include "test_runner_p.h"
+
+#include <iostream>
+#include <optional>
+#include <string>
+
+using namespace std;
+
+namespace parse {
+    void RunOpenLexerTests(TestRunner& tr);
+}  // namespace parse
+
+namespace ast {
+    void RunUnitTests(TestRunner& tr);
+}
+namespace runtime {
+    void RunObjectHolderTests(TestRunner& tr);
+    void RunObjectsTests(TestRunner& tr);
+}  // namespace runtime
+namespace bytecode {
+    void RunBytecodeTests(TestRunner& tr);
+}  // namespace bytecode
+namespace regvm {
+    void RunRegisterVmTests(TestRunner& tr);
+}  // namespace regvm
+namespace jit {
+    void RunJitTests(TestRunner& tr);
+}  // namespace jit
+namespace aot {
+    void RunAotTests(TestRunner& tr);
+    void RunAotBuildTests(TestRunner& tr);
+}  // namespace aot
+
+void TestParseProgram(TestRunner& tr);
+
+namespace {
+
+    // Способ выполнения разобранной программы
+    enum class Backend {
+        Tree,       // обход дерева
+        Stack,      // стековая машина bytecode::Function
+        Register,   // регистровая машина regvm::Function
+        Jit,        // регистровая машина, горячие методы которой компилируются в машинный код
+        Aot,        // программа переводится в C++ и собирается в разделяемую библиотеку
+        Module,     // выполняется ранее собранная библиотека, программа из входного потока не читается
+    };
+
+    // Число итераций главного цикла программ, на которых --bench сравнивает способы выполнения
+    constexpr int __BENCH_ITERATIONS__ = 200000;
+
+    // library - разделяемая библиотека модуля для Backend::Aot и Backend::Module
+    std::unique_ptr<runtime::Executable> PrepareProgram(istream& input, Backend backend, const string& library) {
+        if (backend == Backend::Module) {
+            return aot::Module::Load(library);
+        }
+        parse::Lexer lexer(input);
+        auto program = ParseProgram(lexer);
+        if (backend == Backend::Aot) {
+            // модуль не зависит от дерева, поэтому дерево удаляется сразу после сборки
+            return aot::CompileProgram(*program, library);
+        }
+        if (backend == Backend::Stack) {
+            return bytecode::CompileProgram(std::move(program));
+        }
+        if (backend == Backend::Register || backend == Backend::Jit) {
+            return regvm::CompileProgram(std::move(program));
+        }
+        return program;
+    }
+
+    // Исполняет программу, размещая объекты-значения в куче режима heap_mode
+    void RunMythonProgram(istream& input, ostream& output,
+        runtime::HeapMode heap_mode = runtime::HeapMode::RefCounting, Backend backend = Backend::Tree,
+        const string& library = {}) {
+        std::optional<jit::TierUpScope> tier_up;
+        if (backend == Backend::Jit) {
+            tier_up.emplace();
+        }
+        if (heap_mode == runtime::HeapMode::Arena) {
+            // дерево программы живёт дольше выполнения, поэтому разбираем его вне арены
+            auto program = PrepareProgram(input, backend, library);
+
+            runtime::SimpleContext context{ output };
+            runtime::ExecutionArena arena;
+            runtime::Closure closure;
+            program->Execute(closure, context);
+            return;
+        }
+        runtime::HeapModeScope heap_scope(heap_mode);
+        auto program = PrepareProgram(input, backend, library);
+
+        runtime::SimpleContext context{ output };
+        runtime::Closure closure;
+        program->Execute(closure, context);
+    }
+
+    void TestSelfInConstructor() {
+        istringstream input(R"--(
+class X:
+  def __init__(p):
+    p.x = self
+
+class XHolder:
+  def __init__():
+    dummy = 0
+
+xh = XHolder()
+x = X(xh)
+)--");
+        parse::Lexer lexer(input);
+        auto program = ParseProgram(lexer);
+
+        runtime::DummyContext context;
+        runtime::Closure closure;
+        program->Execute(closure, context);
+        const auto* xh = closure.at(runtime::Symbol("xh")).TryAs<runtime::ClassInstance>();
+        ASSERT(xh != nullptr);
+        ASSERT_EQUAL(xh->Fields().at(runtime::Symbol("x")).Get(), closure.at(runtime::Symbol("x")).Get());
+    }
+
+    void TestCyclesAreCollected() {
+        istringstream input(R"--(
+class Node:
+  def __init__(p):
+    p.x = self
+    self.p = p
+
+class Holder:
+  def __init__():
+    self.x = None
+
+n = 0
+steps = [1, 2, 3, 4, 5]
+for i in steps:
+  n = Node(Holder())
+)--");
+        parse::Lexer lexer(input);
+        auto program = ParseProgram(lexer);
+
+        runtime::DummyContext context;
+        runtime::Closure closure;
+        runtime::CycleCollector::Collect();
+        program->Execute(closure, context);
+
+        // четыре пары из пяти уже недостижимы, последняя живёт в переменной n
+        ASSERT_EQUAL(runtime::CycleCollector::Collect(), 8U);
+        closure.clear();
+        ASSERT_EQUAL(runtime::CycleCollector::Collect(), 2U);
+        ASSERT_EQUAL(runtime::CycleCollector::CandidateCount(), 0U);
+    }
+
+    void TestSimplePrints() {
+        istringstream input(R"(
+print 57
+print 10, 24, -8
+print 'hello'
+print "world"
+print True, False
+print
+print None
+)");
+
+        ostringstream output;
+        RunMythonProgram(input, output);
+
+        ASSERT_EQUAL(output.str(), "57\n10 24 -8\nhello\nworld\nTrue False\n\nNone\n");
+    }
+
+    void TestAssignments() {
+        istringstream input(R"(
+x = 57
+print x
+x = 'C++ black belt'
+print x
+y = False
+x = y
+print x
+x = None
+print x, y
+)");
+
+        ostringstream output;
+        RunMythonProgram(input, output);
+
+        ASSERT_EQUAL(output.str(), "57\nC++ black belt\nFalse\nNone False\n");
+    }
+
+    void TestArithmetics() {
+        istringstream input("print 1+2+3+4+5, 1*2*3*4*5, 1-2-3-4-5, 36/4/3, 2*5+10/2");
+
+        ostringstream output;
+        RunMythonProgram(input, output);
+
+        ASSERT_EQUAL(output.str(), "15 120 -13 3 15\n");
+    }
+
+    void TestGenerationalHeap() {
+        const string program = R"--(
+class Counter:
+  def __init__():
+    self.total = 0
+    self.label = 'sum'
+
+  def add(n):
+    self.total = self.total + n * 2 - n
+
+c = Counter()
+for i in [1, 2, 3]:
+  for j in [10, 20, 30, 40]:
+    c.add(i * j + 0.5 - 0.5)
+s = ''
+for ch in 'abc':
+  s = s + ch + '-'
+print c.label, c.total, s, 3 < 4
+)--";
+        istringstream refcount_input(program);
+        ostringstream refcount_output;
+        RunMythonProgram(refcount_input, refcount_output, runtime::HeapMode::RefCounting);
+
+        auto before = runtime::Heap::GetStats();
+        istringstream generational_input(program);
+        ostringstream generational_output;
+        RunMythonProgram(generational_input, generational_output, runtime::HeapMode::Generational);
+
+        // оба режима дают одинаковый результат, временные значения выделяются в молодом поколении
+        ASSERT_EQUAL(generational_output.str(), refcount_output.str());
+        ASSERT_EQUAL(generational_output.str(), "sum 600.0 a-b-c- True\n"s);
+        ASSERT(runtime::Heap::GetStats().nursery_allocations > before.nursery_allocations);
+        ASSERT(runtime::Heap::GetMode() == runtime::HeapMode::RefCounting);
+
+        // в режиме пулов временные значения переиспользуют освобождённые блоки
+        auto pool_before = runtime::Heap::GetPoolStats(sizeof(runtime::Number));
+        istringstream pooled_input(program);
+        ostringstream pooled_output;
+        RunMythonProgram(pooled_input, pooled_output, runtime::HeapMode::Pooled);
+        ASSERT_EQUAL(pooled_output.str(), refcount_output.str());
+        auto pool_after = runtime::Heap::GetPoolStats(sizeof(runtime::Number));
+        ASSERT(pool_after.recycled > pool_before.recycled);
+        ASSERT_EQUAL(pool_after.live, pool_before.live);
+    }
+
+    void TestRequestArena() {
+        // каждый запрос выполняется в своей арене, общий результат переносится в постоянную таблицу символов
+        istringstream first_input(R"--(
+class Node:
+  def __init__(value):
+    self.value = value
+    self.items = [value, value * 2]
+    self.self = self
+
+result = Node(21)
+scratch = 0
+for i in [1, 2, 3]:
+  scratch = scratch + i * result.value
+)--");
+        istringstream second_input(R"--(
+print result.value, result.items, result.self.value, scratch
+)--");
+        parse::Lexer first_lexer(first_input);
+        auto first = ParseProgram(first_lexer);
+        parse::Lexer second_lexer(second_input);
+        auto second = ParseProgram(second_lexer);
+
+        ostringstream output;
+        runtime::SimpleContext context{ output };
+        runtime::Closure global;
+        auto before = runtime::Heap::GetStats();
+        {
+            runtime::ExecutionArena arena;
+            runtime::Closure request;
+            first->Execute(request, context);
+            global[runtime::Symbol("result")] = runtime::CopyOut(request.at(runtime::Symbol("result")), arena, context);
+            global[runtime::Symbol("scratch")] = runtime::CopyOut(request.at(runtime::Symbol("scratch")), arena, context);
+        }
+        runtime::CycleCollector::Collect();
+        ASSERT(runtime::Heap::GetStats().arena_allocations > before.arena_allocations);
+        ASSERT(runtime::Heap::GetMode() == runtime::HeapMode::RefCounting);
+        {
+            runtime::ExecutionArena arena;
+            runtime::Closure request = global;
+            second->Execute(request, context);
+        }
+        ASSERT_EQUAL(output.str(), "21 [21, 42] 21 126\n"s);
+        global.clear();
+        runtime::CycleCollector::Collect();
+
+        istringstream arena_input("x = [1, 2]\nx.append(x)\nprint len(x), 'ok'\n");
+        ostringstream arena_output;
+        RunMythonProgram(arena_input, arena_output, runtime::HeapMode::Arena);
+        ASSERT_EQUAL(arena_output.str(), "3 ok\n"s);
+    }
+
+    void TestVariablesArePointers() {
+        istringstream input(R"(
+class Counter:
+  def __init__():
+    self.value = 0
+
+  def add():
+    self.value = self.value + 1
+
+class Dummy:
+  def do_add(counter):
+    counter.add()
+
+x = Counter()
+y = x
+
+x.add()
+y.add()
+
+print x.value
+
+d = Dummy()
+d.do_add(x)
+
+print y.value
+)");
+
+        ostringstream output;
+        RunMythonProgram(input, output);
+
+        ASSERT_EQUAL(output.str(), "2\n3\n");
+    }
+
+    void TestAll() {
+        TestRunner tr;
+        parse::RunOpenLexerTests(tr);
+        runtime::RunObjectHolderTests(tr);
+        runtime::RunObjectsTests(tr);
+        ast::RunUnitTests(tr);
+        TestParseProgram(tr);
+        bytecode::RunBytecodeTests(tr);
+        regvm::RunRegisterVmTests(tr);
+        jit::RunJitTests(tr);
+        aot::RunAotTests(tr);
+
+        RUN_TEST(tr, TestSelfInConstructor);
+        RUN_TEST(tr, TestCyclesAreCollected);
+        RUN_TEST(tr, TestSimplePrints);
+        RUN_TEST(tr, TestAssignments);
+        RUN_TEST(tr, TestArithmetics);
+        RUN_TEST(tr, TestVariablesArePointers);
+        RUN_TEST(tr, TestGenerationalHeap);
+        RUN_TEST(tr, TestRequestArena);
+    }
+
+}  // namespace
+
+
+
+int main(int argc, char* argv[]) {
+    try {
+        // --heap=generational включает поколенческую кучу объектов-значений, --heap=pooled - пулы блоков,
+        // --heap=arena - арену выполнения, --heap=refcount оставляет обычный operator new. --vm=stack
+        // и --vm=register выполняют программу стековой или регистровой машиной вместо обхода дерева,
+        // --vm=jit вдобавок компилирует горячие методы в машинный код. --bench сравнивает способы
+        // выполнения на представительных программах вместо выполнения программы из cin.
+        // --aot=<библиотека> переводит программу в C++, собирает её системным компилятором и выполняет,
+        // --aot-load=<библиотека> выполняет собранную ранее библиотеку. Для загрузки библиотек
+        // интерпретатор собирается с -rdynamic, а если исходники компилируются по относительным путям,
+        // ещё и с -DMYTHON_AOT_INCLUDE_DIR. --test-aot дополнительно проверяет сборку библиотек
+        runtime::HeapMode heap_mode = runtime::HeapMode::RefCounting;
+        Backend backend = Backend::Tree;
+        string library;
+        bool benchmark = false;
+        bool test_aot = false;
+        for (int i = 1; i < argc; ++i) {
+            string_view arg = argv[i];
+            if (arg == "--heap=generational"sv) {
+                heap_mode = runtime::HeapMode::Generational;
+            }
+            else if (arg == "--heap=refcount"sv) {
+                heap_mode = runtime::HeapMode::RefCounting;
+            }
+            else if (arg == "--heap=pooled"sv) {
+                heap_mode = runtime::HeapMode::Pooled;
+            }
+            else if (arg == "--heap=arena"sv) {
+                heap_mode = runtime::HeapMode::Arena;
+            }
+            else if (arg == "--vm=tree"sv) {
+                backend = Backend::Tree;
+            }
+            else if (arg == "--vm=stack"sv) {
+                backend = Backend::Stack;
+            }
+            else if (arg == "--vm=register"sv) {
+                backend = Backend::Register;
+            }
+            else if (arg == "--vm=jit"sv) {
+                backend = Backend::Jit;
+            }
+            else if (arg.substr(0, 6) == "--aot="sv) {
+                backend = Backend::Aot;
+                library = arg.substr(6);
+            }
+            else if (arg.substr(0, 11) == "--aot-load="sv) {
+                backend = Backend::Module;
+                library = arg.substr(11);
+            }
+            else if (arg == "--test-aot"sv) {
+                test_aot = true;
+            }
+            else if (arg == "--bench"sv) {
+                benchmark = true;
+            }
+            else {
+                std::cerr << "Unknown option "sv << arg << std::endl;
+                return 1;
+            }
+        }
+
+        TestAll();
+        if (test_aot) {
+            TestRunner tr;
+            aot::RunAotBuildTests(tr);
+        }
+
+        if (benchmark) {
+            runtime::HeapModeScope heap_scope(heap_mode);
+            bench::RunBackendBenchmark(cout, __BENCH_ITERATIONS__);
+            return 0;
+        }
+        RunMythonProgram(cin, cout, heap_mode, backend, library);
+    }
+    catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
 }
\ No newline at end of file
@@ -1,18 +1,18 @@
-﻿#pragma once
-
-#include <memory>
-#include <stdexcept>
-
-namespace parse {
-    class Lexer;
-}
-
-namespace runtime {
-    class Executable;
-}
-
-struct ParseError : std::runtime_error {
-    using std::runtime_error::runtime_error;
-};
-
+﻿#pragma once
+
+#include <memory>
+#include <stdexcept>
+
+namespace parse {
+    class Lexer;
+}
+
+namespace runtime {
+    class Executable;
+}
+
+struct ParseError : std::runtime_error {
+    using std::runtime_error::runtime_error;
+};
+
 std::unique_ptr<runtime::Executable> ParseProgram(parse::Lexer& lexer);
\ No newline at end of file
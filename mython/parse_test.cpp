@@ -1,314 +1,834 @@
-﻿#include "lexer.h"
-#include "parse.h"
-#include "statement.h"
-#include "test_runner_p.h"
-
-using namespace std;
-
-namespace parse {
-
-    unique_ptr<ast::Statement> ParseProgramFromString(const string& program) {
-        istringstream is(program);
-        parse::Lexer lexer(is);
-        return ParseProgram(lexer);
-    }
-
-    void TestSimpleProgram() {
-        const string program = R"(
-x = 4
-y = 5
-z = "hello, "
-n = "world"
-print x + y, z + n
-)"s;
-
-        runtime::DummyContext context;
-
-        runtime::Closure closure;
-        auto tree = ParseProgramFromString(program);
-        tree->Execute(closure, context);
-
-        ASSERT_EQUAL(context.output.str(), "9 hello, world\n"s);
-    }
-
-    void TestSimpleProgramWithClasses() {
-        const string program = R"(
-program_name = "Point print test"
-
-class Point:
-  def __init__(x, y):
-    self.x = x
-    self.y = y
-
-  def __str__():
-    return '(' + str(self.x) + '; ' + str(self.y) + ')'
-
-origin = Point(200, 100)
-
-print program_name, origin
-)"s;
-
-        runtime::DummyContext context;
-
-        runtime::Closure closure;
-        auto tree = ParseProgramFromString(program);
-        tree->Execute(closure, context);
-
-        ASSERT_EQUAL(context.output.str(), "Point print test (200; 100)\n"s);
-    }
-
-    void TestProgramWithClasses() {
-        const string program = R"(
-program_name = "Classes test"
-
-class Empty:
-  def __init__():
-    x = 0
-
-class Point:
-  def __init__(x, y):
-    self.x = x
-    self.y = y
-
-  def SetX(value):
-    self.x = value
-  def SetY(value):
-    self.y = value
-
-  def __str__():
-    return '(' + str(self.x) + '; ' + str(self.y) + ')'
-
-origin = Empty()
-origin = Point(0, 0)
-
-far_far_away = Point(10000, 50000)
-
-print program_name, origin, far_far_away, origin.SetX(1)
-)"s;
-
-        runtime::DummyContext context;
-
-        runtime::Closure closure;
-        auto tree = ParseProgramFromString(program);
-        tree->Execute(closure, context);
-
-        ASSERT_EQUAL(context.output.str(), "Classes test (0; 0) (10000; 50000) None\n"s);
-    }
-
-    void TestProgramWithIf() {
-        const string program = R"(
-x = 4
-y = 5
-if x > y:
-  print "x > y"
-else:
-  print "x <= y"
-if x > 0:
-  if y < 0:
-    print "y < 0"
-  else:
-    print "y >= 0"
-else:
-  print 'x <= 0'
-)"s;
-
-        runtime::DummyContext context;
-
-        runtime::Closure closure;
-        auto tree = ParseProgramFromString(program);
-        tree->Execute(closure, context);
-
-        ASSERT_EQUAL(context.output.str(), "x <= y\ny >= 0\n"s);
-    }
-
-    void TestReturnFromIf() {
-        const string program = R"(
-class Abs:
-  def calc(n):
-    if n > 0:
-      return n
-    else:
-      return -n
-
-x = Abs()
-print x.calc(2)
-)"s;
-
-        runtime::DummyContext context;
-
-        runtime::Closure closure;
-        auto tree = ParseProgramFromString(program);
-        tree->Execute(closure, context);
-
-        ASSERT_EQUAL(context.output.str(), "2\n"s);
-    }
-
-    void TestRecursion() {
-        const string program = R"(
-class ArithmeticProgression:
-  def calc(n):
-    self.result = 0
-    self.calc_impl(n)
-
-  def calc_impl(n):
-    value = n
-    if value > 0:
-      self.result = self.result + value
-      self.calc_impl(value - 1)
-
-x = ArithmeticProgression()
-x.calc(10)
-print x.result
-)"s;
-
-        runtime::DummyContext context;
-
-        runtime::Closure closure;
-        auto tree = ParseProgramFromString(program);
-        tree->Execute(closure, context);
-
-        ASSERT_EQUAL(context.output.str(), "55\n"s);
-    }
-
-    void TestSimpleRecursion2() {
-        const string program = R"(
-class GCD:
-  def __init__():
-    self.call_count = 0
-
-  def calc(a, b):
-    self.call_count = self.call_count + 1
-    if a < b:
-      return self.calc(b, a)
-    if b == 0:
-      return a
-    return self.calc(a - b, b)
-
-x = GCD()
-print x.calc(16, 12)
-print x.call_count
-)"s;
-
-        runtime::DummyContext context;
-
-        runtime::Closure closure;
-        auto tree = ParseProgramFromString(program);
-        tree->Execute(closure, context);
-
-        ASSERT_EQUAL(context.output.str(), "4\n7\n"s);
-    }
-
-    void TestRecursion2() {
-        const string program = R"(
-class GCD:
-  def __init__():
-    self.call_count = 0
-
-  def calc(a, b):
-    self.call_count = self.call_count + 1
-    if a < b:
-      return self.calc(b, a)
-    if b == 0:
-      return a
-    return self.calc(a - b, b)
-
-x = GCD()
-print x.calc(510510, 18629977)
-print x.calc(22, 17)
-print x.call_count
-)"s;
-
-        runtime::DummyContext context;
-
-        runtime::Closure closure;
-        auto tree = ParseProgramFromString(program);
-        tree->Execute(closure, context);
-
-        ASSERT_EQUAL(context.output.str(), "17\n1\n115\n"s);
-    }
-
-    void TestComplexLogicalExpression() {
-        const string program = R"(
-a = 1
-b = 2
-c = 3
-ok = a + b > c and a + c > b and b + c > a
-print ok
-)"s;
-
-        runtime::DummyContext context;
-
-        runtime::Closure closure;
-        auto tree = ParseProgramFromString(program);
-        tree->Execute(closure, context);
-
-        ASSERT_EQUAL(context.output.str(), "False\n"s);
-    }
-
-    void TestClassicalPolymorphism() {
-        const string program = R"(
-class Shape:
-  def __str__():
-    return "Shape"
-
-class Rect(Shape):
-  def __init__(w, h):
-    self.w = w
-    self.h = h
-
-  def __str__():
-    return "Rect(" + str(self.w) + 'x' + str(self.h) + ')'
-
-class Circle(Shape):
-  def __init__(r):
-    self.r = r
-
-  def __str__():
-    return 'Circle(' + str(self.r) + ')'
-
-class Triangle(Shape):
-  def __init__(a, b, c):
-    self.ok = a + b > c and a + c > b and b + c > a
-    if (self.ok):
-      self.a = a
-      self.b = b
-      self.c = c
-
-  def __str__():
-    if self.ok:
-      return 'Triangle(' + str(self.a) + ', ' + str(self.b) + ', ' + str(self.c) + ')'
-    else:
-      return 'Wrong triangle'
-
-r = Rect(10, 20)
-c = Circle(52)
-t1 = Triangle(3, 4, 5)
-t2 = Triangle(125, 1, 2)
-
-print r, c, t1, t2
-)"s;
-
-        runtime::DummyContext context;
-
-        runtime::Closure closure;
-        auto tree = ParseProgramFromString(program);
-        tree->Execute(closure, context);
-
-        ASSERT_EQUAL(context.output.str(),
-            "Rect(10x20) Circle(52) Triangle(3, 4, 5) Wrong triangle\n"s);
-    }
-
-}  // namespace parse
-
-void TestParseProgram(TestRunner& tr) {
-    RUN_TEST(tr, parse::TestSimpleProgram);
-    RUN_TEST(tr, parse::TestSimpleProgramWithClasses);
-    RUN_TEST(tr, parse::TestProgramWithClasses);
-    RUN_TEST(tr, parse::TestProgramWithIf);
-    RUN_TEST(tr, parse::TestReturnFromIf);
-    RUN_TEST(tr, parse::TestRecursion);
-    RUN_TEST(tr, parse::TestSimpleRecursion2);
-    RUN_TEST(tr, parse::TestRecursion2);
-    RUN_TEST(tr, parse::TestComplexLogicalExpression);
-    RUN_TEST(tr, parse::TestClassicalPolymorphism);
+﻿#include "lexer.h"
+#include "parse.h"
+#include "statement.h"
+#include "test_runner_p.h"
+
+using namespace std;
+
+namespace parse {
+
+    unique_ptr<ast::Statement> ParseProgramFromString(const string& program) {
+        istringstream is(program);
+        parse::Lexer lexer(is);
+        return ParseProgram(lexer);
+    }
+
+    void TestSimpleProgram() {
+        const string program = R"(
+x = 4
+y = 5
+z = "hello, "
+n = "world"
+print x + y, z + n
+)"s;
+
+        runtime::DummyContext context;
+
+        runtime::Closure closure;
+        auto tree = ParseProgramFromString(program);
+        tree->Execute(closure, context);
+
+        ASSERT_EQUAL(context.output.str(), "9 hello, world\n"s);
+    }
+
+    void TestSimpleProgramWithClasses() {
+        const string program = R"(
+program_name = "Point print test"
+
+class Point:
+  def __init__(x, y):
+    self.x = x
+    self.y = y
+
+  def __str__():
+    return '(' + str(self.x) + '; ' + str(self.y) + ')'
+
+origin = Point(200, 100)
+
+print program_name, origin
+)"s;
+
+        runtime::DummyContext context;
+
+        runtime::Closure closure;
+        auto tree = ParseProgramFromString(program);
+        tree->Execute(closure, context);
+
+        ASSERT_EQUAL(context.output.str(), "Point print test (200; 100)\n"s);
+    }
+
+    void TestProgramWithClasses() {
+        const string program = R"(
+program_name = "Classes test"
+
+class Empty:
+  def __init__():
+    x = 0
+
+class Point:
+  def __init__(x, y):
+    self.x = x
+    self.y = y
+
+  def SetX(value):
+    self.x = value
+  def SetY(value):
+    self.y = value
+
+  def __str__():
+    return '(' + str(self.x) + '; ' + str(self.y) + ')'
+
+origin = Empty()
+origin = Point(0, 0)
+
+far_far_away = Point(10000, 50000)
+
+print program_name, origin, far_far_away, origin.SetX(1)
+)"s;
+
+        runtime::DummyContext context;
+
+        runtime::Closure closure;
+        auto tree = ParseProgramFromString(program);
+        tree->Execute(closure, context);
+
+        ASSERT_EQUAL(context.output.str(), "Classes test (0; 0) (10000; 50000) None\n"s);
+    }
+
+    void TestProgramWithIf() {
+        const string program = R"(
+x = 4
+y = 5
+if x > y:
+  print "x > y"
+else:
+  print "x <= y"
+if x > 0:
+  if y < 0:
+    print "y < 0"
+  else:
+    print "y >= 0"
+else:
+  print 'x <= 0'
+)"s;
+
+        runtime::DummyContext context;
+
+        runtime::Closure closure;
+        auto tree = ParseProgramFromString(program);
+        tree->Execute(closure, context);
+
+        ASSERT_EQUAL(context.output.str(), "x <= y\ny >= 0\n"s);
+    }
+
+    void TestReturnFromIf() {
+        const string program = R"(
+class Abs:
+  def calc(n):
+    if n > 0:
+      return n
+    else:
+      return -n
+
+x = Abs()
+print x.calc(2)
+)"s;
+
+        runtime::DummyContext context;
+
+        runtime::Closure closure;
+        auto tree = ParseProgramFromString(program);
+        tree->Execute(closure, context);
+
+        ASSERT_EQUAL(context.output.str(), "2\n"s);
+    }
+
+    void TestRecursion() {
+        const string program = R"(
+class ArithmeticProgression:
+  def calc(n):
+    self.result = 0
+    self.calc_impl(n)
+
+  def calc_impl(n):
+    value = n
+    if value > 0:
+      self.result = self.result + value
+      self.calc_impl(value - 1)
+
+x = ArithmeticProgression()
+x.calc(10)
+print x.result
+)"s;
+
+        runtime::DummyContext context;
+
+        runtime::Closure closure;
+        auto tree = ParseProgramFromString(program);
+        tree->Execute(closure, context);
+
+        ASSERT_EQUAL(context.output.str(), "55\n"s);
+    }
+
+    void TestSimpleRecursion2() {
+        const string program = R"(
+class GCD:
+  def __init__():
+    self.call_count = 0
+
+  def calc(a, b):
+    self.call_count = self.call_count + 1
+    if a < b:
+      return self.calc(b, a)
+    if b == 0:
+      return a
+    return self.calc(a - b, b)
+
+x = GCD()
+print x.calc(16, 12)
+print x.call_count
+)"s;
+
+        runtime::DummyContext context;
+
+        runtime::Closure closure;
+        auto tree = ParseProgramFromString(program);
+        tree->Execute(closure, context);
+
+        ASSERT_EQUAL(context.output.str(), "4\n7\n"s);
+    }
+
+    void TestRecursion2() {
+        const string program = R"(
+class GCD:
+  def __init__():
+    self.call_count = 0
+
+  def calc(a, b):
+    self.call_count = self.call_count + 1
+    if a < b:
+      return self.calc(b, a)
+    if b == 0:
+      return a
+    return self.calc(a - b, b)
+
+x = GCD()
+print x.calc(510510, 18629977)
+print x.calc(22, 17)
+print x.call_count
+)"s;
+
+        runtime::DummyContext context;
+
+        runtime::Closure closure;
+        auto tree = ParseProgramFromString(program);
+        tree->Execute(closure, context);
+
+        ASSERT_EQUAL(context.output.str(), "17\n1\n115\n"s);
+    }
+
+    void TestComplexLogicalExpression() {
+        const string program = R"(
+a = 1
+b = 2
+c = 3
+ok = a + b > c and a + c > b and b + c > a
+print ok
+)"s;
+
+        runtime::DummyContext context;
+
+        runtime::Closure closure;
+        auto tree = ParseProgramFromString(program);
+        tree->Execute(closure, context);
+
+        ASSERT_EQUAL(context.output.str(), "False\n"s);
+    }
+
+    void TestClassicalPolymorphism() {
+        const string program = R"(
+class Shape:
+  def __str__():
+    return "Shape"
+
+class Rect(Shape):
+  def __init__(w, h):
+    self.w = w
+    self.h = h
+
+  def __str__():
+    return "Rect(" + str(self.w) + 'x' + str(self.h) + ')'
+
+class Circle(Shape):
+  def __init__(r):
+    self.r = r
+
+  def __str__():
+    return 'Circle(' + str(self.r) + ')'
+
+class Triangle(Shape):
+  def __init__(a, b, c):
+    self.ok = a + b > c and a + c > b and b + c > a
+    if (self.ok):
+      self.a = a
+      self.b = b
+      self.c = c
+
+  def __str__():
+    if self.ok:
+      return 'Triangle(' + str(self.a) + ', ' + str(self.b) + ', ' + str(self.c) + ')'
+    else:
+      return 'Wrong triangle'
+
+r = Rect(10, 20)
+c = Circle(52)
+t1 = Triangle(3, 4, 5)
+t2 = Triangle(125, 1, 2)
+
+print r, c, t1, t2
+)"s;
+
+        runtime::DummyContext context;
+
+        runtime::Closure closure;
+        auto tree = ParseProgramFromString(program);
+        tree->Execute(closure, context);
+
+        ASSERT_EQUAL(context.output.str(),
+            "Rect(10x20) Circle(52) Triangle(3, 4, 5) Wrong triangle\n"s);
+    }
+
+    void TestLists() {
+        const string program = R"(
+class Stack:
+  def __init__():
+    self.items = []
+
+  def push(value):
+    self.items.append(value)
+
+  def top():
+    return self.items[-1]
+
+  def size():
+    return len(self.items)
+
+s = Stack()
+s.push(1)
+s.push('two')
+s.push([3, 4])
+print s.items, s.size(), s.top()[1]
+
+total = 0
+for x in [1, 2, 3, 4]:
+  total = total + x
+print total
+
+s.items[0] = 10
+print s.items[0] + s.size(), len([]), len('abc')
+for c in 'ab':
+  print c
+)"s;
+
+        runtime::DummyContext context;
+
+        runtime::Closure closure;
+        auto tree = ParseProgramFromString(program);
+        tree->Execute(closure, context);
+
+        ASSERT_EQUAL(context.output.str(), "[1, two, [3, 4]] 3 4\n10\n13 0 3\na\nb\n"s);
+
+        // объект без присваивания по индексу отвергается до вычисления значения
+        runtime::DummyContext order_context;
+        runtime::Closure order_closure;
+        auto order = ParseProgramFromString("x = 5\nx[0] = s.push(7)\n"s);
+        order_closure[runtime::Symbol("s")] = closure.at(runtime::Symbol("s"));
+        ASSERT_THROWS(order->Execute(order_closure, order_context), std::runtime_error);
+        tree = ParseProgramFromString("print s.size()\n"s);
+        tree->Execute(order_closure, order_context);
+        ASSERT_EQUAL(order_context.output.str(), "3\n"s);
+    }
+
+    void TestDicts() {
+        const string program = R"(
+class Point:
+  def __init__(x, y):
+    self.x = x
+    self.y = y
+
+  def __eq__(other):
+    return self.x == other.x and self.y == other.y
+
+  def __hash__():
+    return self.x * 31 + self.y
+
+ages = {'alice': 30, 'bob': 25}
+ages['carol'] = 41
+ages['bob'] = ages['bob'] + 1
+print ages, len(ages), ages.get('dave', 0)
+print 'bob' in ages, 'dave' in ages, 'dave' not in ages, 2 in [1, 2], 'el' in 'hello'
+
+names = {}
+names[Point(1, 2)] = 'a'
+print names[Point(1, 2)], Point(2, 1) in names
+
+total = 0
+for name in ages:
+  total = total + ages[name]
+print total
+)"s;
+
+        runtime::DummyContext context;
+
+        runtime::Closure closure;
+        auto tree = ParseProgramFromString(program);
+        tree->Execute(closure, context);
+
+        ASSERT_EQUAL(context.output.str(),
+            "{alice: 30, bob: 26, carol: 41} 3 0\nTrue False True True True\na False\n97\n"s);
+
+        // значения по существующим ключам менять можно, добавлять ключи во время обхода нельзя
+        runtime::DummyContext update_context;
+        runtime::Closure update_closure;
+        ParseProgramFromString("d = {1: 1, 2: 2}\nfor k in d:\n  d[k] = d[k] * 10\nprint d\n"s)
+            ->Execute(update_closure, update_context);
+        ASSERT_EQUAL(update_context.output.str(), "{1: 10, 2: 20}\n"s);
+        runtime::Closure grow_closure;
+        ASSERT_THROWS(ParseProgramFromString("d = {1: 1}\nfor k in d:\n  d[k + 1] = 1\n"s)
+            ->Execute(grow_closure, context), std::runtime_error);
+    }
+
+    void TestLargeIntegers() {
+        const string program = R"(
+counter = 2147483647
+counter = counter + 1
+big = 9223372036854775807 * 4
+print counter, big, big / 4, big - big, big > counter
+factorial = 1
+for n in [1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25]:
+  factorial = factorial * n
+print factorial
+)"s;
+
+        runtime::DummyContext context;
+
+        runtime::Closure closure;
+        auto tree = ParseProgramFromString(program);
+        tree->Execute(closure, context);
+
+        ASSERT_EQUAL(context.output.str(),
+            "2147483648 36893488147419103228 9223372036854775807 0 True\n15511210043330985984000000\n"s);
+    }
+
+    void TestFloats() {
+        const string program = R"(
+price = 19.99
+count = 3
+total = price * count
+print total, total > 59, 7 / 2, 7 / 2.0, -1.5e-3, count + 0.5
+scores = {1: 'one'}
+print scores[1.0], str(2.0) + '!', 1 == 1.0
+)"s;
+
+        runtime::DummyContext context;
+
+        runtime::Closure closure;
+        auto tree = ParseProgramFromString(program);
+        tree->Execute(closure, context);
+
+        ASSERT_EQUAL(context.output.str(), "59.97 True 3 3.5 -0.0015 3.5\none 2.0! True\n"s);
+    }
+
+    void TestStringAccumulation() {
+        const string program = R"(
+class Report:
+  def build(acc, n):
+    if n == 0:
+      return acc
+    return self.build(acc + str(n - n / 10 * 10), n - 1)
+
+r = Report()
+line = r.build('', 500)
+copy = line
+line = line + '|'
+print len(line), len(copy), line[0], line[-1], copy[-1], 'x' + 'y' + 'z'
+)"s;
+
+        runtime::DummyContext context;
+
+        runtime::Closure closure;
+        auto tree = ParseProgramFromString(program);
+        tree->Execute(closure, context);
+
+        ASSERT_EQUAL(context.output.str(), "501 500 0 | 1 xyz\n"s);
+    }
+
+    void TestStringTagDispatch() {
+        const string program = R"(
+class Shape:
+  def __init__(tag):
+    self.tag = tag
+
+  def area(size):
+    if self.tag == 'square':
+      return size * size
+    if self.tag == 'line':
+      return size
+    return 0
+
+shapes = [Shape('square'), Shape('line'), Shape('sq' + 'uare'), Shape('dot')]
+total = 0
+for s in shapes:
+  total = total + s.area(3)
+vowels = 0
+for c in 'interned':
+  if c == 'e' or c == 'i':
+    vowels = vowels + 1
+word = 'tag'
+print total, vowels, 'ab' < 'abc', word[1] == 'a'
+)"s;
+
+        runtime::DummyContext context;
+
+        runtime::Closure closure;
+        auto tree = ParseProgramFromString(program);
+        tree->Execute(closure, context);
+
+        ASSERT_EQUAL(context.output.str(), "21 3 True True\n"s);
+    }
+
+    void TestSort() {
+        const string program = R"(
+class Task:
+  def __init__(name, priority):
+    self.name = name
+    self.priority = priority
+
+  def rank():
+    return 0 - self.priority
+
+  def __str__():
+    return self.name
+
+numbers = [5, 3, 9, 1]
+sort(numbers)
+names = ['b', 'c', 'a']
+sort(names)
+print numbers, names
+
+tasks = [Task('write', 2), Task('test', 3), Task('plan', 1)]
+sort(tasks, 'priority')
+print tasks
+sort(tasks, 'rank')
+print tasks
+)"s;
+
+        runtime::DummyContext context;
+
+        runtime::Closure closure;
+        auto tree = ParseProgramFromString(program);
+        tree->Execute(closure, context);
+
+        ASSERT_EQUAL(context.output.str(),
+            "[1, 3, 5, 9] [a, b, c]\n[plan, write, test]\n[test, write, plan]\n"s);
+    }
+
+    void TestIntArrays() {
+        const string program = R"(
+samples = intarray([3, -1, 4, 1, 5])
+weights = intarray(5)
+weights.fill(2)
+weights[0] = 1
+print samples, len(samples), samples.sum(), samples.min(), samples.max(), samples.dot(weights)
+
+samples.add(weights)
+samples.mul(10)
+print samples, 30 in samples, 3 in samples
+
+total = 0
+for x in intarray([1, 2, 3]):
+  total = total + x
+print total, samples[-1]
+)"s;
+
+        runtime::DummyContext context;
+
+        runtime::Closure closure;
+        auto tree = ParseProgramFromString(program);
+        tree->Execute(closure, context);
+
+        ASSERT_EQUAL(context.output.str(),
+            "[3, -1, 4, 1, 5] 5 12 -1 5 21\n[40, 10, 60, 30, 70] True False\n6 70\n"s);
+    }
+
+    void TestFloatArrays() {
+        const string program = R"(
+samples = floatarray([1.5, -2, 4])
+weights = floatarray(3)
+weights.fill(0.5)
+weights[0] = 2
+print samples, len(samples), samples.sum(), samples.min(), samples.max(), samples.dot(weights)
+
+samples.add(weights)
+samples.mul(2)
+print samples, 7.0 in samples, 7 in samples, 3 in samples, samples[-1]
+print floatarray(intarray([1, 2]))
+)"s;
+
+        runtime::DummyContext context;
+
+        runtime::Closure closure;
+        auto tree = ParseProgramFromString(program);
+        tree->Execute(closure, context);
+
+        ASSERT_EQUAL(context.output.str(),
+            "[1.5, -2.0, 4.0] 3 3.5 -2.0 4.0 4.0\n[7.0, -3.0, 9.0] True True False 9.0\n[1.0, 2.0]\n"s);
+    }
+
+    void TestSharedSmallValues() {
+        // малые числа и логические значения - общие объекты, присваивание не меняет их для других имён
+        const string program = R"(
+class Box:
+  def __init__():
+    self.count = 0
+    self.flag = False
+
+a = 2 + 3
+b = a
+a = a + 1
+first = Box()
+second = Box()
+first.count = first.count + 1
+first.flag = not first.flag
+big = 1000 * 1000
+same = big
+big = big + 1
+print a, b, first.count, second.count, first.flag, second.flag, big, same, 3 < 4 and b == 5
+)"s;
+
+        runtime::DummyContext context;
+
+        runtime::Closure closure;
+        auto tree = ParseProgramFromString(program);
+        tree->Execute(closure, context);
+
+        ASSERT_EQUAL(context.output.str(), "6 5 1 0 True False 1000001 1000000 True\n"s);
+        ASSERT(closure.at(runtime::Symbol("b")).IsImmortal());
+        ASSERT(!closure.at(runtime::Symbol("same")).IsImmortal());
+    }
+
+    void TestMethodFrames() {
+        // return прерывает циклы и ветвления только своего метода, кадры вложенных вызовов независимы
+        const string program = R"(
+class Finder:
+  def __init__(limit):
+    self.limit = limit
+
+  def first_over(items):
+    for x in items:
+      if x > self.limit:
+        return x
+    return None
+
+  def fact(n):
+    if n < 2:
+      return 1
+    return n * self.fact(n - 1)
+
+  def many(a, b, c, d, e, f, g):
+    h = a + b
+    i = h + c
+    j = i + d
+    k = j + e
+    return k + f + g
+
+f = Finder(3)
+print f.first_over([1, 5, 2, 7]), f.first_over([1, 2]), f.fact(10), f.many(1, 2, 3, 4, 5, 6, 7)
+for ch in 'xyz':
+  print f.first_over(intarray([1, 9])), ch
+)"s;
+
+        runtime::DummyContext context;
+
+        runtime::Closure closure;
+        auto tree = ParseProgramFromString(program);
+        tree->Execute(closure, context);
+
+        ASSERT_EQUAL(context.output.str(), "5 None 3628800 28\n9 x\n9 y\n9 z\n"s);
+
+        // вне метода return отвергается при разборе
+        for (const string& outside : { "return 1\n"s, "if True:\n  return 1\n"s, "for x in [1]:\n  return x\n"s }) {
+            try {
+                ParseProgramFromString(outside);
+                ASSERT(false);
+            }
+            catch (const ParseError&) {
+            }
+        }
+    }
+
+    void TestRecursionLimit() {
+        // бесконечная рекурсия завершается исключением RecursionError, а не переполнением стека
+        const string program = R"(
+class Deep:
+  def down(n):
+    if n == 0:
+      return 0
+    return self.down(n - 1) + 1
+
+  def forever(n):
+    return self.forever(n + 1)
+
+d = Deep()
+)"s;
+
+        runtime::DummyContext context;
+
+        runtime::Closure closure;
+        auto tree = ParseProgramFromString(program);
+        tree->Execute(closure, context);
+
+        auto run = [&](const string& line) {
+            ParseProgramFromString(line)->Execute(closure, context);
+        };
+        try {
+            run("print d.forever(0)\n"s);
+            ASSERT(false);
+        }
+        catch (const runtime::RecursionError&) {
+        }
+        // после ошибки интерпретатор продолжает работать
+        run("print d.down(500)\n"s);
+
+        runtime::SetRecursionLimit(50);
+        run("print d.down(40)\n"s);
+        try {
+            run("print d.down(60)\n"s);
+            ASSERT(false);
+        }
+        catch (const runtime::RecursionError&) {
+        }
+        runtime::SetRecursionLimit(runtime::__DEFAULT_RECURSION_LIMIT__);
+        ASSERT_EQUAL(context.output.str(), "500\n40\n"s);
+
+        // длинная цепочка операторов - не вложенность, она разбирается и выполняется
+        string sum = "1"s;
+        for (int i = 0; i < 999; ++i) {
+            sum += " + 1"s;
+        }
+        runtime::DummyContext sum_context;
+        runtime::Closure sum_closure;
+        ParseProgramFromString("print "s + sum + "\n"s)->Execute(sum_closure, sum_context);
+        ASSERT_EQUAL(sum_context.output.str(), "1000\n"s);
+
+        // слишком глубокая вложенность и слишком длинная цепочка отвергаются при разборе
+        for (const string& deep : { string(10000, '(') + "1"s + string(10000, ')'), string(10000, '-') + "1"s,
+                 sum + sum }) {
+            try {
+                ParseProgramFromString("print "s + deep + "\n"s);
+                ASSERT(false);
+            }
+            catch (const ParseError&) {
+            }
+        }
+    }
+
+    void TestShortCircuitGuards() {
+        // проверка защищает индексирование и деление, правая часть выполняется только при необходимости
+        const string program = R"(
+class Probe:
+  def __init__():
+    self.calls = 0
+
+  def expensive():
+    self.calls = self.calls + 1
+    return True
+
+p = Probe()
+items = []
+if items and items[0] > 1:
+  print 'unreachable'
+if len(items) == 0 and p.expensive():
+  print 'called'
+n = 0
+if n != 0 and 10 / n > 1:
+  print 'unreachable'
+if True or p.expensive():
+  print 'skipped'
+print p.calls, 0 or 'default', 3 and 4, None or 0, not (0 or '')
+)"s;
+
+        runtime::DummyContext context;
+
+        runtime::Closure closure;
+        auto tree = ParseProgramFromString(program);
+        tree->Execute(closure, context);
+
+        ASSERT_EQUAL(context.output.str(), "called\nskipped\n1 default 4 0 True\n"s);
+    }
+
+    void TestQuickenedOperations() {
+        // одни и те же узлы выполняются с числами, строками и экземплярами, меняя специализацию
+        const string program = R"(
+class Vec:
+  def __init__(x):
+    self.x = x
+
+  def __add__(other):
+    self.x = self.x + other.x
+    return self
+
+class Mixer:
+  def mix(a, b):
+    return a + b
+
+m = Mixer()
+total = Vec(0)
+for i in [1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12]:
+  total = m.mix(total, Vec(i))
+n = 0
+for i in [1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12]:
+  n = m.mix(n, i)
+s = ''
+for c in 'quickening':
+  s = m.mix(s, c)
+print total.x, n, s, m.mix(0.5, 1), m.mix(9223372036854775807, 1)
+)"s;
+
+        runtime::DummyContext context;
+
+        runtime::Closure closure;
+        auto tree = ParseProgramFromString(program);
+        tree->Execute(closure, context);
+
+        ASSERT_EQUAL(context.output.str(), "78 78 quickening 1.5 9223372036854775808\n"s);
+    }
+
+}  // namespace parse
+
+void TestParseProgram(TestRunner& tr) {
+    RUN_TEST(tr, parse::TestSimpleProgram);
+    RUN_TEST(tr, parse::TestSimpleProgramWithClasses);
+    RUN_TEST(tr, parse::TestProgramWithClasses);
+    RUN_TEST(tr, parse::TestProgramWithIf);
+    RUN_TEST(tr, parse::TestReturnFromIf);
+    RUN_TEST(tr, parse::TestRecursion);
+    RUN_TEST(tr, parse::TestSimpleRecursion2);
+    RUN_TEST(tr, parse::TestRecursion2);
+    RUN_TEST(tr, parse::TestComplexLogicalExpression);
+    RUN_TEST(tr, parse::TestClassicalPolymorphism);
+    RUN_TEST(tr, parse::TestLists);
+    RUN_TEST(tr, parse::TestDicts);
+    RUN_TEST(tr, parse::TestLargeIntegers);
+    RUN_TEST(tr, parse::TestFloats);
+    RUN_TEST(tr, parse::TestStringAccumulation);
+    RUN_TEST(tr, parse::TestStringTagDispatch);
+    RUN_TEST(tr, parse::TestSort);
+    RUN_TEST(tr, parse::TestIntArrays);
+    RUN_TEST(tr, parse::TestFloatArrays);
+    RUN_TEST(tr, parse::TestSharedSmallValues);
+    RUN_TEST(tr, parse::TestMethodFrames);
+    RUN_TEST(tr, parse::TestRecursionLimit);
+    RUN_TEST(tr, parse::TestShortCircuitGuards);
+    RUN_TEST(tr, parse::TestQuickenedOperations);
 }
\ No newline at end of file
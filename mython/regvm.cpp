@@ -0,0 +1,638 @@
+#include "regvm.h"
+
+#include "jit.h"
+
+#include <optional>
+
+using namespace std;
+
+namespace regvm {
+
+    using runtime::Closure;
+    using runtime::CompareOp;
+    using runtime::Context;
+    using runtime::Executable;
+    using runtime::ObjectHolder;
+    using runtime::Symbol;
+
+    namespace {
+
+        // Размер регистрового файла, который размещается в кадре интерпретатора без выделения памяти
+        constexpr size_t __VM_INLINE_REGISTERS__ = 16;
+
+        // Строит трёхадресный код из дерева программы или тела метода.
+        // Регистры выделяются стопкой: временные значения выражения освобождаются, как только
+        // их прочитала инструкция, а все регистры инструкции - по её завершении
+        class Compiler {
+        public:
+            explicit Compiler(Code& code)
+                : code_(code) {
+            }
+
+            // Компилирует тело метода либо программу. В конце кода функция возвращает None
+            void CompileFunction(Executable& body) {
+                if (auto* method_body = dynamic_cast<ast::MethodBody*>(&body)) {
+                    CompileStatement(method_body->GetBody());
+                }
+                else {
+                    CompileStatement(body);
+                }
+                Emit(Opcode::Return);
+            }
+
+        private:
+            void CompileStatement(Executable& node) {
+                const uint32_t mark = next_register_;
+                if (auto* compound = dynamic_cast<ast::Compound*>(&node)) {
+                    for (const auto& statement : compound->GetStatements()) {
+                        CompileStatement(*statement);
+                    }
+                }
+                else if (auto* assignment = dynamic_cast<ast::Assignment*>(&node)) {
+                    // результат выражения записывается прямо в ячейку переменной
+                    CompileInto(assignment->GetValue(), Variable(assignment->GetVar()));
+                }
+                else if (auto* field_assignment = dynamic_cast<ast::FieldAssignment*>(&node)) {
+                    Operand object = CompileDottedOperand(field_assignment->GetObject().GetDottedIds());
+                    Operand value = CompileOperand(field_assignment->GetValue());
+                    Instruction& instruction = Emit(Opcode::StoreField);
+                    instruction.lhs = object;
+                    instruction.rhs = value;
+                    instruction.a = SymbolIndex(field_assignment->GetField());
+                }
+                else if (auto* print = dynamic_cast<ast::Print*>(&node)) {
+                    Operand base = CompileArguments(print->GetArgs());
+                    Instruction& instruction = Emit(Opcode::Print);
+                    instruction.rhs = base;
+                    instruction.b = static_cast<uint32_t>(print->GetArgs().size());
+                }
+                else if (auto* return_statement = dynamic_cast<ast::Return*>(&node)) {
+                    Operand value = CompileOperand(return_statement->GetValue());
+                    Emit(Opcode::Return).lhs = value;
+                }
+                else if (auto* if_else = dynamic_cast<ast::IfElse*>(&node)) {
+                    Operand condition = CompileOperand(if_else->GetCondition());
+                    size_t to_else = EmitJump(Opcode::JumpIfFalse, condition);
+                    next_register_ = mark;
+                    CompileStatement(if_else->GetIfBody());
+                    if (Executable* else_body = if_else->GetElseBody()) {
+                        size_t to_end = EmitJump(Opcode::Jump, Operand{});
+                        Bind(to_else);
+                        CompileStatement(*else_body);
+                        Bind(to_end);
+                    }
+                    else {
+                        Bind(to_else);
+                    }
+                }
+                else if (auto* for_each = dynamic_cast<ast::ForEach*>(&node)) {
+                    Operand iterable = CompileOperand(for_each->GetIterable());
+                    Emit(Opcode::IterStart).lhs = iterable;
+                    next_register_ = mark;
+                    const size_t next = code_.instructions.size();
+                    Emit(Opcode::IterNext).dst = Variable(for_each->GetVar());
+                    CompileStatement(for_each->GetBody());
+                    Emit(Opcode::Jump).a = static_cast<uint32_t>(next);
+                    Bind(next);
+                }
+                else {
+                    // класс объявляется как обычно, но тела его методов заменяются скомпилированными
+                    if (auto* definition = dynamic_cast<ast::ClassDefinition*>(&node)) {
+                        CompileClass(definition->GetClass());
+                    }
+                    // значение выражения-инструкции отбрасывается
+                    CompileInto(node, Operand{});
+                }
+                next_register_ = mark;
+            }
+
+            // Компилирует выражение так, чтобы его значение оказалось в dst
+            void CompileInto(Executable& node, Operand dst) {
+                const uint32_t mark = next_register_;
+                CompileExpression(node, dst);
+                next_register_ = mark;
+            }
+
+            void CompileExpression(Executable& node, Operand dst) {
+                if (std::optional<Operand> operand = SimpleOperand(node)) {
+                    Instruction& instruction = Emit(Opcode::Move);
+                    instruction.dst = dst;
+                    instruction.lhs = *operand;
+                    return;
+                }
+                if (auto* variable = dynamic_cast<ast::VariableValue*>(&node)) {
+                    CompileDotted(variable->GetDottedIds(), dst);
+                    return;
+                }
+                if (CompileBinary<ast::Add>(node, Opcode::Add, dst) || CompileBinary<ast::Sub>(node, Opcode::Sub, dst)
+                    || CompileBinary<ast::Mult>(node, Opcode::Mult, dst)
+                    || CompileBinary<ast::Div>(node, Opcode::Div, dst)) {
+                    return;
+                }
+                if (CompileComparison<CompareOp::Less>(node, dst) || CompileComparison<CompareOp::LessOrEqual>(node, dst)
+                    || CompileComparison<CompareOp::Greater>(node, dst)
+                    || CompileComparison<CompareOp::GreaterOrEqual>(node, dst)
+                    || CompileComparison<CompareOp::Equal>(node, dst)
+                    || CompileComparison<CompareOp::NotEqual>(node, dst)) {
+                    return;
+                }
+                if (auto* or_operation = dynamic_cast<ast::Or*>(&node)) {
+                    CompileLogical(*or_operation->_lhs, *or_operation->_rhs, Opcode::JumpIfTrue, dst);
+                }
+                else if (auto* and_operation = dynamic_cast<ast::And*>(&node)) {
+                    CompileLogical(*and_operation->_lhs, *and_operation->_rhs, Opcode::JumpIfFalse, dst);
+                }
+                else if (auto* not_operation = dynamic_cast<ast::Not*>(&node)) {
+                    Operand argument = CompileOperand(*not_operation->_argument);
+                    Instruction& instruction = Emit(Opcode::Not);
+                    instruction.dst = dst;
+                    instruction.lhs = argument;
+                }
+                else if (auto* call = dynamic_cast<ast::MethodCall*>(&node)) {
+                    Operand object = CompileOperand(call->GetObject());
+                    Operand base = CompileArguments(call->GetArgs());
+                    Instruction& instruction = Emit(Opcode::Call);
+                    instruction.dst = dst;
+                    instruction.lhs = object;
+                    instruction.rhs = base;
+                    instruction.a = SymbolIndex(call->GetMethod());
+                    instruction.b = static_cast<uint32_t>(call->GetArgs().size());
+                }
+                else if (auto* new_instance = dynamic_cast<ast::NewInstance*>(&node);
+                         new_instance && IsConstructorCall(*new_instance)) {
+                    Operand base = CompileArguments(new_instance->GetArgs());
+                    code_.classes.push_back(&new_instance->GetClass());
+                    Instruction& instruction = Emit(Opcode::New);
+                    instruction.dst = dst;
+                    instruction.rhs = base;
+                    instruction.a = static_cast<uint32_t>(code_.classes.size() - 1);
+                    instruction.b = static_cast<uint32_t>(new_instance->GetArgs().size());
+                }
+                else {
+                    // остальные узлы выполняются обходом дерева
+                    code_.nodes.push_back(&node);
+                    Instruction& instruction = Emit(Opcode::Exec);
+                    instruction.dst = dst;
+                    instruction.a = static_cast<uint32_t>(code_.nodes.size() - 1);
+                }
+            }
+
+            // Возвращает операнд со значением выражения. Константы и простые переменные читаются
+            // инструкцией напрямую, остальные выражения вычисляются во временный регистр
+            Operand CompileOperand(Executable& node) {
+                if (std::optional<Operand> operand = SimpleOperand(node)) {
+                    return *operand;
+                }
+                Operand temporary = AllocateRegisters(1);
+                CompileInto(node, temporary);
+                return temporary;
+            }
+
+            std::optional<Operand> SimpleOperand(Executable& node) {
+                if (std::optional<Operand> constant = Constant<runtime::Number>(node)) {
+                    return constant;
+                }
+                if (std::optional<Operand> constant = Constant<runtime::Float>(node)) {
+                    return constant;
+                }
+                if (std::optional<Operand> constant = Constant<runtime::String>(node)) {
+                    return constant;
+                }
+                if (std::optional<Operand> constant = Constant<runtime::Bool>(node)) {
+                    return constant;
+                }
+                if (dynamic_cast<ast::None*>(&node)) {
+                    return Operand{};
+                }
+                if (auto* variable = dynamic_cast<ast::VariableValue*>(&node);
+                    variable && variable->GetDottedIds().size() == 1) {
+                    return Variable(variable->GetDottedIds().front());
+                }
+                return std::nullopt;
+            }
+
+            template <typename T>
+            std::optional<Operand> Constant(Executable& node) {
+                auto* constant = dynamic_cast<ast::ValueStatement<T>*>(&node);
+                if (!constant) {
+                    return std::nullopt;
+                }
+                // константа живёт в дереве, которым владеет Function, поэтому разделяется без владения
+                code_.constants.push_back(ObjectHolder::Share(constant->GetValue()));
+                return Operand{ OperandKind::Constant, static_cast<uint32_t>(code_.constants.size() - 1) };
+            }
+
+            template <typename Node>
+            bool CompileBinary(Executable& node, Opcode op, Operand dst) {
+                auto* operation = dynamic_cast<Node*>(&node);
+                if (!operation) {
+                    return false;
+                }
+                Operand lhs = CompileOperand(*operation->_lhs);
+                Operand rhs = CompileOperand(*operation->_rhs);
+                Instruction& instruction = Emit(op);
+                instruction.dst = dst;
+                instruction.lhs = lhs;
+                instruction.rhs = rhs;
+                return true;
+            }
+
+            template <CompareOp op>
+            bool CompileComparison(Executable& node, Operand dst) {
+                auto* comparison = dynamic_cast<ast::Comparison<op>*>(&node);
+                if (!comparison) {
+                    return false;
+                }
+                Operand lhs = CompileOperand(*comparison->_lhs);
+                Operand rhs = CompileOperand(*comparison->_rhs);
+                Instruction& instruction = Emit(Opcode::Compare);
+                instruction.cmp = op;
+                instruction.dst = dst;
+                instruction.lhs = lhs;
+                instruction.rhs = rhs;
+                return true;
+            }
+
+            // or и and: значение левого операнда остаётся результатом, если оно решает исход.
+            // Результат собирается в регистре: переменная dst может входить в правый операнд
+            void CompileLogical(Executable& lhs, Executable& rhs, Opcode jump, Operand dst) {
+                Operand result = dst.kind == OperandKind::Register ? dst : AllocateRegisters(1);
+                CompileInto(lhs, result);
+                size_t to_end = EmitJump(jump, result);
+                CompileInto(rhs, result);
+                Bind(to_end);
+                if (dst.kind != OperandKind::Register) {
+                    Instruction& instruction = Emit(Opcode::Move);
+                    instruction.dst = dst;
+                    instruction.lhs = result;
+                }
+            }
+
+            // Вычисляет аргументы в идущие подряд регистры и возвращает первый из них
+            Operand CompileArguments(const std::vector<std::unique_ptr<runtime::Executable>>& args) {
+                Operand base = AllocateRegisters(static_cast<uint32_t>(args.size()));
+                for (size_t i = 0; i < args.size(); ++i) {
+                    CompileInto(*args[i], Operand{ OperandKind::Register, base.index + static_cast<uint32_t>(i) });
+                }
+                return base;
+            }
+
+            // Цепочка a.b.c: промежуточные объекты проходят через временный регистр, в dst пишется
+            // только последнее поле, поэтому ошибка посередине цепочки не портит переменную dst
+            void CompileDotted(const std::vector<Symbol>& ids, Operand dst) {
+                Operand object = Variable(ids.front());
+                if (ids.size() == 1) {
+                    Instruction& instruction = Emit(Opcode::Move);
+                    instruction.dst = dst;
+                    instruction.lhs = object;
+                    return;
+                }
+                Operand temporary = ids.size() > 2 ? AllocateRegisters(1) : Operand{};
+                for (size_t i = 1; i < ids.size(); ++i) {
+                    Instruction& instruction = Emit(Opcode::LoadField);
+                    instruction.dst = i + 1 == ids.size() ? dst : temporary;
+                    instruction.lhs = object;
+                    instruction.a = SymbolIndex(ids[i]);
+                    object = temporary;
+                }
+            }
+
+            Operand CompileDottedOperand(const std::vector<Symbol>& ids) {
+                if (ids.size() == 1) {
+                    return Variable(ids.front());
+                }
+                Operand temporary = AllocateRegisters(1);
+                CompileDotted(ids, temporary);
+                return temporary;
+            }
+
+            void CompileClass(runtime::Class& cls) {
+                for (runtime::Method& method : cls.GetMethods()) {
+                    if (!dynamic_cast<Function*>(method.body.get())) {
+                        method.body = std::make_unique<Function>(std::move(method.body));
+                    }
+                }
+            }
+
+            // Конструктор вызывается, только если у класса есть __init__ с тем же числом параметров.
+            // Иначе дерево не вычисляет аргументы вовсе, и узел остаётся обходу дерева
+            static bool IsConstructorCall(const ast::NewInstance& node) {
+                const runtime::Method* init = node.GetClass().GetMethod(runtime::__INIT_METHOD__);
+                return init != nullptr && init->formal_params.size() == node.GetArgs().size();
+            }
+
+            Operand AllocateRegisters(uint32_t count) {
+                Operand base{ OperandKind::Register, next_register_ };
+                next_register_ += count;
+                code_.registers = std::max(code_.registers, static_cast<size_t>(next_register_));
+                return base;
+            }
+
+            Operand Variable(Symbol name) {
+                return Operand{ OperandKind::Variable, SymbolIndex(name) };
+            }
+
+            uint32_t SymbolIndex(Symbol name) {
+                for (size_t i = 0; i < code_.symbols.size(); ++i) {
+                    if (code_.symbols[i] == name) {
+                        return static_cast<uint32_t>(i);
+                    }
+                }
+                code_.symbols.push_back(name);
+                return static_cast<uint32_t>(code_.symbols.size() - 1);
+            }
+
+            Instruction& Emit(Opcode op) {
+                Instruction instruction;
+                instruction.op = op;
+                code_.instructions.push_back(instruction);
+                return code_.instructions.back();
+            }
+
+            size_t EmitJump(Opcode op, Operand condition) {
+                Emit(op).lhs = condition;
+                return code_.instructions.size() - 1;
+            }
+
+            // Направляет переход, выпущенный по адресу jump, на следующую инструкцию
+            void Bind(size_t jump) {
+                code_.instructions[jump].a = static_cast<uint32_t>(code_.instructions.size());
+            }
+
+            Code& code_;
+            uint32_t next_register_ = 0;
+        };
+
+        ObjectHolder Construct(const runtime::Class& cls, const ObjectHolder* args, size_t count, Context& context) {
+            ObjectHolder instance = ObjectHolder::Own(runtime::ClassInstance(cls));
+            static_cast<runtime::ClassInstance*>(instance.Get())->Call(runtime::__INIT_METHOD__, args, count, context);
+            return instance;
+        }
+
+        /*
+         * Выполняет code в таблице символов closure. Вызов с code, равным nullptr, ничего не выполняет,
+         * а только записывает в handlers таблицу адресов обработчиков инструкций. Диспетчеризация та же,
+         * что у стековой машины bytecode
+         */
+        ObjectHolder Interpret(Code* code, Closure* closure, Context* context,
+            [[maybe_unused]] const void* const** handlers) {
+#ifdef MYTHON_THREADED_DISPATCH
+            static const void* const labels[] = {
+#define MYTHON_REGISTER_OPCODE_LABEL(name) &&op_##name,
+                MYTHON_REGISTER_OPCODES(MYTHON_REGISTER_OPCODE_LABEL)
+#undef MYTHON_REGISTER_OPCODE_LABEL
+            };
+            if (code == nullptr) {
+                *handlers = labels;
+                return ObjectHolder::None();
+            }
+            // Переход по адресу метки не вызывает деструкторы локальных объектов обработчика, поэтому
+            // обработчики передают значения сразу в store, а локальные ObjectHolder живут во вложенном блоке
+#define VM_TARGET(name) op_##name:
+#define VM_DISPATCH() VM_COUNT(); goto *ip->handler
+#else
+            if (code == nullptr) {
+                return ObjectHolder::None();
+            }
+#define VM_TARGET(name) case Opcode::name:
+#define VM_DISPATCH() continue
+#endif
+#define VM_NEXT() ++ip; VM_DISPATCH()
+#define VM_JUMP(target) ip = base + (target); VM_DISPATCH()
+
+            ObjectHolder inline_registers[__VM_INLINE_REGISTERS__];
+            std::unique_ptr<ObjectHolder[]> heap_registers;
+            ObjectHolder* registers = inline_registers;
+            if (code->registers > __VM_INLINE_REGISTERS__) {
+                heap_registers = std::make_unique<ObjectHolder[]>(code->registers);
+                registers = heap_registers.get();
+            }
+            std::vector<bytecode::Loop> loops;
+            Instruction* const base = code->instructions.data();
+            Instruction* ip = base;
+            const auto& constants = code->constants;
+            const auto& symbols = code->symbols;
+#ifdef MYTHON_DISPATCH_STATS
+            bytecode::DispatchCounter dispatches(code->dispatches);
+#define VM_COUNT() dispatches.Count()
+#else
+#define VM_COUNT() static_cast<void>(0)
+#endif
+
+            static const ObjectHolder none;
+            auto read = [&](Operand& operand) -> const ObjectHolder& {
+                switch (operand.kind) {
+                case OperandKind::Register:
+                    return registers[operand.index];
+                case OperandKind::Constant:
+                    return constants[operand.index];
+                case OperandKind::Variable:
+                    if (ObjectHolder* value = closure->FindHinted(symbols[operand.index], operand.hint)) {
+                        return *value;
+                    }
+                    throw std::runtime_error(runtime::__UNDEFINED_VARIABLE_ERROR__);
+                case OperandKind::None:
+                    break;
+                }
+                return none;
+            };
+            auto store = [&](Operand& operand, ObjectHolder value) {
+                switch (operand.kind) {
+                case OperandKind::Register:
+                    registers[operand.index] = std::move(value);
+                    break;
+                case OperandKind::Variable: {
+                    // значение получает новую ссылку, сообщаем об этом идущему циклу сборки
+                    runtime::CycleCollector::WriteBarrier(value);
+                    ObjectHolder* slot = closure->FindHinted(symbols[operand.index], operand.hint);
+                    if (slot == nullptr) {
+                        slot = &(*closure)[symbols[operand.index]];
+                    }
+                    *slot = std::move(value);
+                    break;
+                }
+                default:
+                    break;
+                }
+            };
+
+#ifdef MYTHON_THREADED_DISPATCH
+            VM_DISPATCH();
+#else
+            for (;;) {
+                VM_COUNT();
+                switch (ip->op) {
+#endif
+                VM_TARGET(Move) {
+                    store(ip->dst, read(ip->lhs));
+                    VM_NEXT();
+                }
+                VM_TARGET(LoadField) {
+                    store(ip->dst, bytecode::LoadField(read(ip->lhs), symbols[ip->a]));
+                    VM_NEXT();
+                }
+                VM_TARGET(StoreField) {
+                    const ObjectHolder& object = read(ip->lhs);
+                    if (object.Kind() != runtime::ObjectKind::Instance) {
+                        throw std::runtime_error("Only object fields can be assigned");
+                    }
+                    const ObjectHolder& value = read(ip->rhs);
+                    runtime::CycleCollector::WriteBarrier(value);
+                    static_cast<runtime::ClassInstance*>(object.Get())->Fields()[symbols[ip->a]] = value;
+                    VM_NEXT();
+                }
+                VM_TARGET(Add) {
+                    store(ip->dst, bytecode::ArithmeticValues(runtime::ArithmeticOp::Add, read(ip->lhs), read(ip->rhs),
+                        *context));
+                    VM_NEXT();
+                }
+                VM_TARGET(Sub) {
+                    store(ip->dst, bytecode::ArithmeticValues(runtime::ArithmeticOp::Sub, read(ip->lhs), read(ip->rhs),
+                        *context));
+                    VM_NEXT();
+                }
+                VM_TARGET(Mult) {
+                    store(ip->dst, bytecode::ArithmeticValues(runtime::ArithmeticOp::Mult, read(ip->lhs), read(ip->rhs),
+                        *context));
+                    VM_NEXT();
+                }
+                VM_TARGET(Div) {
+                    store(ip->dst, bytecode::ArithmeticValues(runtime::ArithmeticOp::Div, read(ip->lhs), read(ip->rhs),
+                        *context));
+                    VM_NEXT();
+                }
+                VM_TARGET(Compare) {
+                    store(ip->dst, runtime::MakeBool(bytecode::CompareValues(ip->cmp, read(ip->lhs), read(ip->rhs),
+                        *context)));
+                    VM_NEXT();
+                }
+                VM_TARGET(Not) {
+                    store(ip->dst, runtime::MakeBool(!runtime::IsTrue(read(ip->lhs))));
+                    VM_NEXT();
+                }
+                VM_TARGET(Jump) {
+                    VM_JUMP(ip->a);
+                }
+                VM_TARGET(JumpIfFalse) {
+                    if (!runtime::IsTrue(read(ip->lhs))) {
+                        VM_JUMP(ip->a);
+                    }
+                    VM_NEXT();
+                }
+                VM_TARGET(JumpIfTrue) {
+                    if (runtime::IsTrue(read(ip->lhs))) {
+                        VM_JUMP(ip->a);
+                    }
+                    VM_NEXT();
+                }
+                VM_TARGET(Call) {
+                    store(ip->dst, bytecode::CallMethod(read(ip->lhs), symbols[ip->a], registers + ip->rhs.index, ip->b,
+                        *context));
+                    VM_NEXT();
+                }
+                VM_TARGET(New) {
+                    store(ip->dst, Construct(*code->classes[ip->a], registers + ip->rhs.index, ip->b, *context));
+                    VM_NEXT();
+                }
+                VM_TARGET(Print) {
+                    bytecode::PrintValues(registers + ip->rhs.index, ip->b, *context);
+                    VM_NEXT();
+                }
+                VM_TARGET(IterStart) {
+                    bytecode::StartLoop(loops, read(ip->lhs));
+                    VM_NEXT();
+                }
+                VM_TARGET(IterNext) {
+                    bool has_item;
+                    {
+                        ObjectHolder item;
+                        has_item = bytecode::NextItem(loops.back(), item);
+                        if (has_item) {
+                            store(ip->dst, std::move(item));
+                        }
+                    }
+                    if (!has_item) {
+                        loops.pop_back();
+                        VM_JUMP(ip->a);
+                    }
+                    VM_NEXT();
+                }
+                VM_TARGET(Exec) {
+                    store(ip->dst, code->nodes[ip->a]->Execute(*closure, *context));
+                    VM_NEXT();
+                }
+                VM_TARGET(Return) {
+                    return read(ip->lhs);
+                }
+#ifndef MYTHON_THREADED_DISPATCH
+                }
+            }
+#endif
+#undef VM_TARGET
+#undef VM_DISPATCH
+#undef VM_COUNT
+#undef VM_NEXT
+#undef VM_JUMP
+        }
+    }  // namespace
+
+    const char* OpcodeName(Opcode op) {
+        static const char* const names[] = {
+#define MYTHON_REGISTER_OPCODE_NAME(name) #name,
+            MYTHON_REGISTER_OPCODES(MYTHON_REGISTER_OPCODE_NAME)
+#undef MYTHON_REGISTER_OPCODE_NAME
+        };
+        return names[static_cast<size_t>(op)];
+    }
+
+    Function::Function(std::unique_ptr<Executable> source)
+        : _source(std::move(source)) {
+        Compiler(_code).CompileFunction(*_source);
+#ifdef MYTHON_THREADED_DISPATCH
+        const void* const* handlers = nullptr;
+        Interpret(nullptr, nullptr, nullptr, &handlers);
+        for (Instruction& instruction : _code.instructions) {
+            instruction.handler = handlers[static_cast<size_t>(instruction.op)];
+        }
+#endif
+    }
+
+    Function::~Function() = default;
+
+    ObjectHolder Function::Execute(Closure& closure, Context& context) {
+        if (_native) {
+            return _native->Run(closure, context);
+        }
+        return Interpret(&_code, &closure, &context, nullptr);
+    }
+
+    bool Function::CompileNative() {
+        if (!_native_tried) {
+            _native_tried = true;
+            _native = jit::NativeCode::Compile(_code);
+        }
+        return _native != nullptr;
+    }
+
+    bytecode::ExecutionStats Function::GetStats() const {
+        bytecode::ExecutionStats stats{ _code.instructions.size(), _code.dispatches };
+        // методы классов заменены скомпилированными при компиляции объявления класса
+        for (Executable* node : _code.nodes) {
+            if (auto* definition = dynamic_cast<ast::ClassDefinition*>(node)) {
+                for (const runtime::Method& method : definition->GetClass().GetMethods()) {
+                    if (auto* body = dynamic_cast<const Function*>(method.body.get())) {
+                        bytecode::ExecutionStats method_stats = body->GetStats();
+                        stats.instructions += method_stats.instructions;
+                        stats.dispatches += method_stats.dispatches;
+                    }
+                }
+            }
+        }
+        return stats;
+    }
+
+    std::unique_ptr<Function> CompileProgram(std::unique_ptr<Executable> program) {
+        return std::make_unique<Function>(std::move(program));
+    }
+
+}  // namespace regvm
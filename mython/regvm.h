@@ -0,0 +1,126 @@
+#pragma once
+
+#include "bytecode.h"
+#include "runtime.h"
+#include "statement.h"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace jit {
+    class NativeCode;
+}  // namespace jit
+
+namespace regvm {
+
+    // Инструкции регистровой машины. Каждая читает до двух операндов lhs, rhs и пишет результат в dst.
+    // Операнд - регистр кадра, константа или переменная таблицы символов, поэтому выражение вроде
+    // i = i + 1 занимает одну инструкцию без загрузок и сохранений
+#define MYTHON_REGISTER_OPCODES(X)                                                              \
+    X(Move)             /* dst = lhs */                                                         \
+    X(LoadField)        /* dst = lhs.a */                                                       \
+    X(StoreField)       /* lhs.a = rhs */                                                       \
+    X(Add)              /* dst = lhs + rhs */                                                   \
+    X(Sub)                                                                                      \
+    X(Mult)                                                                                     \
+    X(Div)                                                                                      \
+    X(Compare)          /* dst = lhs cmp rhs */                                                 \
+    X(Not)              /* dst = not lhs */                                                     \
+    X(Jump)             /* a: адрес перехода */                                                 \
+    X(JumpIfFalse)      /* a: адрес перехода, если lhs ложно */                                 \
+    X(JumpIfTrue)       /* a: адрес перехода, если lhs истинно */                               \
+    X(Call)             /* dst = lhs.a(b аргументов из регистров начиная с rhs) */              \
+    X(New)              /* dst = экземпляр класса a, __init__ с b аргументами из регистров с rhs */ \
+    X(Print)            /* b значений из регистров начиная с rhs */                             \
+    X(IterStart)        /* начинает цикл по lhs */                                              \
+    X(IterNext)         /* dst = очередной элемент цикла, a: адрес выхода из цикла */           \
+    X(Exec)             /* dst = результат узла дерева a */                                     \
+    X(Return)           /* завершает функцию с результатом lhs */
+
+    enum class Opcode : uint8_t {
+#define MYTHON_REGISTER_OPCODE_ENUM(name) name,
+        MYTHON_REGISTER_OPCODES(MYTHON_REGISTER_OPCODE_ENUM)
+#undef MYTHON_REGISTER_OPCODE_ENUM
+    };
+
+    // Возвращает название инструкции, например "Move"
+    [[nodiscard]] const char* OpcodeName(Opcode op);
+
+    enum class OperandKind : uint8_t {
+        None,           // значение None, в качестве dst - результат отбрасывается
+        Register,
+        Constant,
+        Variable,
+    };
+
+    struct Operand {
+        OperandKind kind = OperandKind::None;
+        uint32_t index = 0;     // номер регистра, константы или имени переменной
+        uint32_t hint = 0;      // ячейка таблицы символов, в которой переменная нашлась в прошлый раз
+    };
+
+    struct Instruction {
+        Opcode op = Opcode::Move;
+        runtime::CompareOp cmp = runtime::CompareOp::Equal;
+        Operand dst;
+        Operand lhs;
+        Operand rhs;
+        uint32_t a = 0;
+        uint32_t b = 0;
+#ifdef MYTHON_THREADED_DISPATCH
+        const void* handler = nullptr;      // адрес обработчика инструкции внутри интерпретатора
+#endif
+    };
+
+    // Трёхадресная форма тела метода или программы
+    struct Code {
+        std::vector<Instruction> instructions;
+        std::vector<runtime::ObjectHolder> constants;   // константы дерева, разделяемые без владения
+        std::vector<runtime::Symbol> symbols;
+        std::vector<runtime::Executable*> nodes;        // узлы дерева, выполняемые инструкцией Exec
+        std::vector<const runtime::Class*> classes;
+        size_t registers = 0;                           // размер регистрового файла кадра
+        uint64_t dispatches = 0;                        // выполнено инструкций при MYTHON_DISPATCH_STATS
+    };
+
+    /*
+     * Тело метода либо программа, выполняемые регистровой машиной. Временные значения выражений
+     * живут в регистрах кадра, переменные читаются и пишутся прямо в ячейках таблицы символов по
+     * подсказке операнда. Узлы без инструкций выполняются инструкцией Exec, как в bytecode::Function.
+     * После CompileNative тот же код выполняется машинным кодом jit::NativeCode
+     */
+    class Function : public runtime::Executable {
+    public:
+        explicit Function(std::unique_ptr<runtime::Executable> source);
+        ~Function() override;
+
+        // Выполняет код в таблице символов closure и возвращает результат return либо None
+        runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+
+        [[nodiscard]] const Code& GetCode() const {
+            return _code;
+        }
+        // Размер и счётчик выполнения этого кода и методов классов, объявленных в нём
+        [[nodiscard]] bytecode::ExecutionStats GetStats() const;
+
+        // Компилирует код в машинный при первом вызове. Возвращает false, если JIT не поддерживает
+        // платформу или одну из инструкций кода: тогда функция и дальше выполняется интерпретатором
+        bool CompileNative();
+        [[nodiscard]] bool IsNative() const {
+            return _native != nullptr;
+        }
+
+    private:
+        std::unique_ptr<runtime::Executable> _source;
+        Code _code;
+        std::unique_ptr<jit::NativeCode> _native;
+        bool _native_tried = false;
+    };
+
+    // Компилирует программу, разобранную ParseProgram, вместе с методами всех объявленных в ней классов.
+    // Тела методов заменяются в самих классах программы, поэтому после компиляции их выполняет машина,
+    // даже если программа запущена обходом дерева
+    [[nodiscard]] std::unique_ptr<Function> CompileProgram(std::unique_ptr<runtime::Executable> program);
+
+}  // namespace regvm
@@ -0,0 +1,231 @@
+#include "bench.h"
+#include "bytecode.h"
+#include "lexer.h"
+#include "parse.h"
+#include "regvm.h"
+#include "test_runner_p.h"
+
+#include <algorithm>
+
+using namespace std;
+
+namespace regvm {
+
+    namespace {
+
+        unique_ptr<runtime::Executable> Parse(const string& program) {
+            istringstream input(program);
+            parse::Lexer lexer(input);
+            return ParseProgram(lexer);
+        }
+
+        // Выполняет программу обходом дерева, стековой и регистровой машинами и проверяет, что вывод совпадает
+        string RunAll(const string& program) {
+            runtime::DummyContext tree_context;
+            runtime::Closure tree_closure;
+            Parse(program)->Execute(tree_closure, tree_context);
+
+            runtime::DummyContext stack_context;
+            runtime::Closure stack_closure;
+            bytecode::CompileProgram(Parse(program))->Execute(stack_closure, stack_context);
+
+            runtime::DummyContext register_context;
+            runtime::Closure register_closure;
+            CompileProgram(Parse(program))->Execute(register_closure, register_context);
+
+            ASSERT_EQUAL(stack_context.output.str(), tree_context.output.str());
+            ASSERT_EQUAL(register_context.output.str(), tree_context.output.str());
+            return register_context.output.str();
+        }
+
+        size_t CountOpcode(const Code& code, Opcode op) {
+            return static_cast<size_t>(std::count_if(code.instructions.begin(), code.instructions.end(),
+                [op](const Instruction& instruction) {
+                    return instruction.op == op;
+                }));
+        }
+
+        void TestMatchesTree() {
+            const string program = R"(
+class Counter:
+  def __init__(limit):
+    self.value = 0
+    self.limit = limit
+
+  def done():
+    return self.value >= self.limit
+
+  def step(delta):
+    self.value = self.value + delta
+    return self
+
+  def first_over(values):
+    for v in values:
+      if self.value < v:
+        return v
+    return None
+
+  def __str__():
+    return 'Counter(' + str(self.value) + ')'
+
+c = Counter(10)
+for s in [1, 2, 3, 4, 5, 6]:
+  if not c.done():
+    c.step(s)
+print c, c.done(), c.first_over([3, 12, 20]), c.first_over([1]), c.missing(1)
+total = 0
+for i in [1, 2, 3, 4]:
+  if i > 2:
+    total = total + i * 10
+  else:
+    total = total + 1
+print total, 7 / 2, 'a' + 'b', 1.5 + 1
+d = {'x': 1, 'y': 2}
+for k in d:
+  print k, d[k]
+for ch in 'ab':
+  print ch
+print
+print None, 1 == 1, not 0, 0 or 'default', 1 and 2
+)"s;
+            ASSERT_EQUAL(RunAll(program),
+                "Counter(10) True 12 None None\n72 3 ab 2.5\nx 1\ny 2\na\nb\n\nNone True True default 2\n"s);
+        }
+
+        void TestThreeAddressCode() {
+            const string program = R"(
+i = 0
+total = 0
+for step in intarray(5):
+  i = i + 1
+  total = total + i * 3 - i / 2
+print i, total
+)"s;
+            ASSERT_EQUAL(RunAll(program), "5 39\n"s);
+
+            auto function = CompileProgram(Parse(program));
+            const Code& code = function->GetCode();
+            // i = i + 1 - одна инструкция, читающая и пишущая переменную напрямую
+            const auto increment = std::find_if(code.instructions.begin(), code.instructions.end(),
+                [](const Instruction& instruction) {
+                    return instruction.op == Opcode::Add && instruction.dst.kind == OperandKind::Variable
+                        && instruction.lhs.kind == OperandKind::Variable
+                        && instruction.rhs.kind == OperandKind::Constant;
+                });
+            ASSERT(increment != code.instructions.end());
+            // пересылки нужны только для присваивания констант и аргументов print
+            ASSERT_EQUAL(CountOpcode(code, Opcode::Move), 4U);
+            ASSERT(code.registers <= 2U);
+            ASSERT_EQUAL(string(OpcodeName(Opcode::IterNext)), "IterNext"s);
+
+            // тело цикла короче, чем у стековой машины, и выполняет меньше инструкций
+            runtime::DummyContext register_context;
+            runtime::Closure register_closure;
+            function->Execute(register_closure, register_context);
+            auto stack_function = bytecode::CompileProgram(Parse(program));
+            runtime::DummyContext stack_context;
+            runtime::Closure stack_closure;
+            stack_function->Execute(stack_closure, stack_context);
+            ASSERT(function->GetStats().instructions < stack_function->GetStats().instructions);
+#ifdef MYTHON_DISPATCH_STATS
+            ASSERT(function->GetStats().dispatches < stack_function->GetStats().dispatches);
+#endif
+        }
+
+        void TestDestinationIsWrittenLast() {
+            // переменная-приёмник входит в правую часть: её нельзя перезаписать до конца вычисления
+            const string program = R"(
+class Node:
+  def __init__(value, next):
+    self.value = value
+    self.next = next
+
+x = 0
+y = 5
+x = y and x
+print x
+x = 0
+x = x or y
+print x
+n = Node(1, Node(2, Node(3, None)))
+n = n.next.next
+print n.value
+n = Node(1, Node(2, None))
+n = n.next
+print n.value
+)"s;
+            ASSERT_EQUAL(RunAll(program), "0\n5\n3\n2\n"s);
+        }
+
+        void TestMethodStats() {
+            const string program = R"(
+class Point:
+  def __init__(x):
+    self.x = x
+
+  def shifted(limit):
+    if self.x < limit:
+      return self.x + limit
+    return self.x
+
+p = Point(5)
+print p.shifted(10), p.shifted(1)
+)"s;
+            ASSERT_EQUAL(RunAll(program), "15 5\n"s);
+
+            auto function = CompileProgram(Parse(program));
+            runtime::DummyContext context;
+            runtime::Closure closure;
+            function->Execute(closure, context);
+
+            const auto* point = closure.at(runtime::Symbol("Point")).TryAs<runtime::Class>();
+            ASSERT(point != nullptr);
+            const auto* method = dynamic_cast<const Function*>(point->GetMethod(runtime::Symbol("shifted"))->body.get());
+            ASSERT(method != nullptr);
+            // методы учитываются в счётчиках программы
+            ASSERT(function->GetStats().instructions > function->GetCode().instructions.size());
+#ifdef MYTHON_DISPATCH_STATS
+            ASSERT(function->GetStats().dispatches > function->GetCode().dispatches);
+            ASSERT(method->GetCode().dispatches > 0U);
+#else
+            ASSERT_EQUAL(function->GetStats().dispatches, 0U);
+#endif
+        }
+
+        void TestErrors() {
+            runtime::DummyContext context;
+            runtime::Closure closure;
+            ASSERT_THROWS(CompileProgram(Parse("print undefined\n"s))->Execute(closure, context),
+                std::runtime_error);
+            ASSERT_THROWS(CompileProgram(Parse("x = 1\nx.field = 2\n"s))->Execute(closure, context),
+                std::runtime_error);
+            ASSERT_THROWS(CompileProgram(Parse("for c in 5:\n  print c\n"s))->Execute(closure, context),
+                std::runtime_error);
+            ASSERT_THROWS(CompileProgram(Parse("d = {1: 1}\nfor k in d:\n  d[k + 1] = 1\n"s))->Execute(closure, context),
+                std::runtime_error);
+        }
+
+        void TestBackendBenchmark() {
+            // сам замер выполняет main --bench, здесь только проверяется, что отчёт собирается
+            std::ostringstream out;
+            bench::RunBackendBenchmark(out, 1);
+            const string report = out.str();
+            for (const char* name : { "methods", "arithmetic", "loops", "strings", "tree", "stack", "register", "jit" }) {
+                ASSERT(report.find(name) != string::npos);
+            }
+            // заголовок и по четыре строки на программу
+            ASSERT_EQUAL(std::count(report.begin(), report.end(), '\n'), 17);
+        }
+
+    }  // namespace
+
+    void RunRegisterVmTests(TestRunner& tr) {
+        RUN_TEST(tr, regvm::TestMatchesTree);
+        RUN_TEST(tr, regvm::TestThreeAddressCode);
+        RUN_TEST(tr, regvm::TestDestinationIsWrittenLast);
+        RUN_TEST(tr, regvm::TestMethodStats);
+        RUN_TEST(tr, regvm::TestErrors);
+        RUN_TEST(tr, regvm::TestBackendBenchmark);
+    }
+
+}  // namespace regvm
@@ -1,22 +1,251 @@
 #include "runtime.h"
+#include "array_kernels.h"
 
+#include <algorithm>
+#include <array>
 #include <cassert>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <mutex>
+#include <new>
 #include <optional>
 #include <sstream>
+#include <unordered_map>
 #include <iostream>
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define MYTHON_DICT_SSE2 1
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
 using namespace std;
 
 namespace runtime {
 
     namespace {
-        const string __PRINT_METHOD__ = "__str__"s;
-        const string __EQUAL_METHOD__ = "__eq__"s;
-        const string __LESS_METHOD__ = "__lt__"s;
+        const Symbol __PRINT_METHOD__("__str__");
+        const Symbol __EQUAL_METHOD__("__eq__");
+        const Symbol __LESS_METHOD__("__lt__");
+        const Symbol __ADD_OPERATOR_METHOD__("__add__");
+        const Symbol __APPEND_METHOD__("append");
+        const Symbol __HASH_METHOD__("__hash__");
+        const Symbol __KEYS_METHOD__("keys");
+        const Symbol __VALUES_METHOD__("values");
+        const Symbol __GET_METHOD__("get");
+        const Symbol __SUM_METHOD__("sum");
+        const Symbol __MIN_METHOD__("min");
+        const Symbol __MAX_METHOD__("max");
+        const Symbol __DOT_METHOD__("dot");
+        const Symbol __ADD_METHOD__("add");
+        const Symbol __MUL_METHOD__("mul");
+        const Symbol __FILL_METHOD__("fill");
+
+        // ширина группы управляющих байтов словаря
+        constexpr size_t __DICT_GROUP_WIDTH__ = 16;
+        // управляющий байт свободного слота, 7 бит хеша его никогда не дают
+        constexpr int8_t __DICT_EMPTY_CONTROL__ = -128;
+
+        // Возвращает целое число object в виде BigInt, object должен хранить Number или BigNumber
+        BigInt ToBigInt(const ObjectHolder& object) {
+            if (const Number* number = object.TryAs<Number>()) {
+                return BigInt(number->GetValue());
+            }
+            return object.TryAs<BigNumber>()->GetValue();
+        }
+
+        // длина диапазона, начиная с которой сортировка переходит от разбиений к вставкам
+        constexpr ptrdiff_t __SORT_INSERTION_THRESHOLD__ = 16;
+
+        /*
+         * Интроспективная сортировка для List::Sort. Элементы переставляются только обменами, а все циклы
+         * ограничены границами диапазона, поэтому исключение из пользовательского __lt__ или
+         * несогласованное сравнение не приводят к потере элементов и выходу за пределы массива
+         */
+        template <typename It, typename Less>
+        void InsertionSort(It first, It last, Less& less) {
+            for (It i = first; i < last; ++i) {
+                for (It j = i; j > first && less(*j, *(j - 1)); --j) {
+                    std::iter_swap(j, j - 1);
+                }
+            }
+        }
+
+        template <typename It, typename Less>
+        void SiftDown(It first, ptrdiff_t root, ptrdiff_t size, Less& less) {
+            while (true) {
+                ptrdiff_t child = 2 * root + 1;
+                if (child >= size) {
+                    return;
+                }
+                if (child + 1 < size && less(first[child], first[child + 1])) {
+                    ++child;
+                }
+                if (!less(first[root], first[child])) {
+                    return;
+                }
+                std::iter_swap(first + root, first + child);
+                root = child;
+            }
+        }
+
+        template <typename It, typename Less>
+        void HeapSort(It first, It last, Less& less) {
+            ptrdiff_t size = last - first;
+            for (ptrdiff_t i = size / 2; i-- > 0;) {
+                SiftDown(first, i, size, less);
+            }
+            for (ptrdiff_t end = size - 1; end > 0; --end) {
+                std::iter_swap(first, first + end);
+                SiftDown(first, 0, end, less);
+            }
+        }
+
+        // Разбиение Хоара вокруг медианы трёх, возвращает итоговую позицию опорного элемента
+        template <typename It, typename Less>
+        It Partition(It first, It last, Less& less) {
+            It mid = first + (last - first) / 2;
+            It back = last - 1;
+            if (less(*mid, *first)) {
+                std::iter_swap(mid, first);
+            }
+            if (less(*back, *mid)) {
+                std::iter_swap(back, mid);
+                if (less(*mid, *first)) {
+                    std::iter_swap(mid, first);
+                }
+            }
+            // опорный элемент держим в начале диапазона
+            std::iter_swap(first, mid);
+
+            It i = first + 1;
+            It j = last - 1;
+            while (true) {
+                while (i <= j && less(*i, *first)) {
+                    ++i;
+                }
+                while (i <= j && less(*first, *j)) {
+                    --j;
+                }
+                if (i >= j) {
+                    break;
+                }
+                // равные опорному элементы тоже обмениваем, чтобы разбиение оставалось сбалансированным
+                std::iter_swap(i, j);
+                ++i;
+                --j;
+            }
+            std::iter_swap(first, j);
+            return j;
+        }
+
+        // меньшую часть сортируем рекурсивно, большую - в цикле, стек остаётся O(log n)
+        template <typename It, typename Less>
+        void IntroSortLoop(It first, It last, int depth_limit, Less& less) {
+            while (last - first > __SORT_INSERTION_THRESHOLD__) {
+                if (depth_limit-- == 0) {
+                    HeapSort(first, last, less);
+                    return;
+                }
+                It pivot = Partition(first, last, less);
+                if (pivot - first < last - pivot) {
+                    IntroSortLoop(first, pivot, depth_limit, less);
+                    first = pivot + 1;
+                }
+                else {
+                    IntroSortLoop(pivot + 1, last, depth_limit, less);
+                    last = pivot;
+                }
+            }
+            InsertionSort(first, last, less);
+        }
+
+        template <typename It, typename Less>
+        void IntroSort(It first, It last, Less less) {
+            // уже упорядоченный и строго убывающий диапазоны распознаём за один проход
+            if (std::is_sorted(first, last, std::ref(less))) {
+                return;
+            }
+            if (std::adjacent_find(first, last, [&less](const auto& lhs, const auto& rhs) {
+                    return !less(rhs, lhs);
+                }) == last) {
+                std::reverse(first, last);
+                return;
+            }
+
+            // глубина разбиений ограничена 2 * log2(n), дальше переходим на пирамидальную сортировку
+            int depth_limit = 0;
+            for (ptrdiff_t size = last - first; size > 1; size >>= 1) {
+                depth_limit += 2;
+            }
+            IntroSortLoop(first, last, depth_limit, less);
+        }
+
+        // перемешивает биты хеша, чтобы и номер группы, и управляющий байт зависели от всего значения
+        size_t MixHash(uint64_t value) {
+            value ^= value >> 33;
+            value *= 0xff51afd7ed558ccdULL;
+            value ^= value >> 33;
+            value *= 0xc4ceb9fe1a85ec53ULL;
+            value ^= value >> 33;
+            return static_cast<size_t>(value);
+        }
+
+        // управляющий байт слота - младшие 7 бит хеша
+        int8_t ControlByte(size_t hash) {
+            return static_cast<int8_t>(hash & 0x7F);
+        }
+
+        // номер начальной группы последовательности проб берётся из старших бит хеша
+        size_t GroupIndex(size_t hash) {
+            return hash >> 7;
+        }
+
+        // возвращает номер младшего установленного бита ненулевой маски
+        unsigned CountTrailingZeros(uint32_t mask) {
+        #if defined(_MSC_VER)
+            unsigned long index = 0;
+            _BitScanForward(&index, mask);
+            return static_cast<unsigned>(index);
+        #else
+            return static_cast<unsigned>(__builtin_ctz(mask));
+        #endif
+        }
+
+        // возвращает битовую маску позиций группы, управляющий байт которых равен value
+        uint32_t MatchGroup(const int8_t* group, int8_t value) {
+        #if defined(MYTHON_DICT_SSE2)
+            // сравниваем все 16 байт группы одной инструкцией
+            const __m128i control = _mm_loadu_si128(reinterpret_cast<const __m128i*>(group));
+            return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(control, _mm_set1_epi8(value))));
+        #else
+            uint32_t mask = 0;
+            for (size_t i = 0; i != __DICT_GROUP_WIDTH__; ++i) {
+                mask |= static_cast<uint32_t>(group[i] == value) << i;
+            }
+            return mask;
+        #endif
+        }
     }  // namespace
 
-    ObjectHolder::ObjectHolder(std::shared_ptr<Object> data)
-        : data_(std::move(data)) {
+    const Symbol __SELF_NAME__("self");
+    const Symbol __INIT_METHOD__("__init__");
+
+    void Object::ForEachReference([[maybe_unused]] const std::function<void(const ObjectHolder&)>& visit) {
+    }
+
+    void Object::ClearReferences() {
+    }
+
+    ObjectHolder::ObjectHolder(Object* data, bool owning) noexcept
+        : data_(data), owning_(owning) {
+        Retain();
     }
 
     void ObjectHolder::AssertIsValid() const {
@@ -24,14 +253,82 @@ namespace runtime {
     }
 
     ObjectHolder ObjectHolder::Share(Object& object) {
-        // Возвращаем невладеющий shared_ptr (его deleter ничего не делает)
-        return ObjectHolder(std::shared_ptr<Object>(&object, [](auto* /*p*/) { /* do nothing */ }));
+        // объект с ненулевым счётчиком живёт в куче под управлением ObjectHolder, новая ссылка его удерживает.
+        // Невладеющий ObjectHolder не меняет счётчик и не удаляет объект
+        return ObjectHolder(&object, object._header.count != 0);
     }
 
     ObjectHolder ObjectHolder::None() {
         return ObjectHolder();
     }
 
+    void ObjectHolder::Destroy(Object* object) noexcept {
+        thread_local bool destroying = false;
+        thread_local std::vector<Object*> pending;
+
+        if (object->_header.root_index != __GC_NOT_BUFFERED__) {
+            CycleCollector::Forget(*object);
+        }
+        if (destroying) {
+            pending.push_back(object);
+            return;
+        }
+        destroying = true;
+        delete object;
+        while (!pending.empty()) {
+            Object* next = pending.back();
+            pending.pop_back();
+            delete next;
+        }
+        destroying = false;
+    }
+
+    ObjectHolder ObjectHolder::Immortal(Object& object) {
+        object._header.immortal = true;
+        return ObjectHolder(&object, false);
+    }
+
+    ObjectHandoff ObjectHolder::Handoff() && {
+        // общий объект никому не принадлежит, его может использовать любой поток
+        if (IsImmortal()) {
+            return ObjectHandoff(std::exchange(data_, nullptr), false);
+        }
+        // начатый цикл сборки держит на объектах лишнюю ссылку, доводим его до конца
+        CycleCollector::FinishCycle();
+        if (!owning_ || data_->_header.count != 1) {
+            throw std::runtime_error("Only the single owner of an object can hand it off"s);
+        }
+        // кандидаты сборщика циклов принадлежат потоку, поэтому переданный граф из буфера убираем
+        CycleCollector::ForgetGraph(*data_);
+        // забираем ссылку владельца, не меняя счётчик: теперь её держит ObjectHandoff
+        owning_ = false;
+        return ObjectHandoff(std::exchange(data_, nullptr), true);
+    }
+
+    ObjectHolder ObjectHolder::Adopt(ObjectHandoff handoff) {
+        ObjectHolder result;
+        result.data_ = std::exchange(handoff._object, nullptr);
+        result.owning_ = result.data_ != nullptr && handoff._owning;
+        return result;
+    }
+
+    ObjectHandoff& ObjectHandoff::operator=(ObjectHandoff&& other) noexcept {
+        if (this != &other) {
+            if (_owning) {
+                delete _object;
+            }
+            _object = std::exchange(other._object, nullptr);
+            _owning = other._owning;
+        }
+        return *this;
+    }
+
+    ObjectHandoff::~ObjectHandoff() {
+        if (_owning) {
+            delete _object;
+        }
+    }
+
     Object& ObjectHolder::operator*() const {
         AssertIsValid();
         return *Get();
@@ -43,13 +340,233 @@ namespace runtime {
     }
 
     Object* ObjectHolder::Get() const {
-        return data_.get();
+        return data_;
     }
 
     ObjectHolder::operator bool() const {
         return Get() != nullptr;
     }
 
+    Closure::Closure(std::initializer_list<value_type> items) {
+        for (const auto& [name, value] : items) {
+            (*this)[name] = value;
+        }
+    }
+
+    Closure::Closure(const Closure& other) {
+        for (const auto& [name, value] : other) {
+            Append(name, value);
+        }
+    }
+
+    Closure::Closure(Closure&& other) noexcept {
+        StealFrom(other);
+    }
+
+    Closure& Closure::operator=(const Closure& other) {
+        if (this != &other) {
+            Closure copy(other);
+            swap(copy);
+        }
+        return *this;
+    }
+
+    Closure& Closure::operator=(Closure&& other) noexcept {
+        if (this != &other) {
+            clear();
+            StealFrom(other);
+        }
+        return *this;
+    }
+
+    Closure::~Closure() {
+        clear();
+    }
+
+    ObjectHolder& Closure::operator[](Symbol name) {
+        size_t index = IndexOf(name);
+        if (index == _size) {
+            Append(name, ObjectHolder::None());
+        }
+        return Slot(index).second;
+    }
+
+    ObjectHolder& Closure::at(Symbol name) {
+        size_t index = IndexOf(name);
+        if (index == _size) {
+            throw std::out_of_range("Name "s + name.Name() + " is not defined"s);
+        }
+        return Slot(index).second;
+    }
+
+    const ObjectHolder& Closure::at(Symbol name) const {
+        return const_cast<Closure*>(this)->at(name);
+    }
+
+    Closure::iterator Closure::find(Symbol name) {
+        return { this, IndexOf(name) };
+    }
+
+    Closure::const_iterator Closure::find(Symbol name) const {
+        return { this, IndexOf(name) };
+    }
+
+    size_t Closure::count(Symbol name) const {
+        return IndexOf(name) != _size ? 1 : 0;
+    }
+
+    std::pair<Closure::iterator, bool> Closure::insert(value_type item) {
+        size_t index = IndexOf(item.first);
+        if (index != _size) {
+            return { { this, index }, false };
+        }
+        Append(item.first, std::move(item.second));
+        return { { this, index }, true };
+    }
+
+    void Closure::Append(Symbol name, ObjectHolder value) {
+        if (_size < __CLOSURE_INLINE_SLOTS__) {
+            new (&reinterpret_cast<value_type*>(_inline)[_size]) value_type(name, std::move(value));
+        }
+        else {
+            if (!_overflow) {
+                _overflow = std::make_unique<std::deque<value_type>>();
+            }
+            _overflow->emplace_back(name, std::move(value));
+        }
+        if (_index) {
+            _index->emplace(name, _size);
+        }
+        ++_size;
+        // крупной таблице перебор обходится дороже хеширования
+        if (!_index && _size == __CLOSURE_INDEX_THRESHOLD__) {
+            _index = std::make_unique<std::unordered_map<Symbol, size_t>>();
+            for (size_t i = 0; i != _size; ++i) {
+                _index->emplace(Slot(i).first, i);
+            }
+        }
+    }
+
+    void Closure::clear() noexcept {
+        size_t inline_count = std::min(_size, __CLOSURE_INLINE_SLOTS__);
+        for (size_t i = 0; i != inline_count; ++i) {
+            reinterpret_cast<value_type*>(_inline)[i].~value_type();
+        }
+        _size = 0;
+        _overflow.reset();
+        _index.reset();
+        _return_value = ObjectHolder::None();
+        _returning = false;
+    }
+
+    void Closure::swap(Closure& other) noexcept {
+        Closure temporary(std::move(other));
+        other.StealFrom(*this);
+        StealFrom(temporary);
+    }
+
+    void Closure::StealFrom(Closure& other) noexcept {
+        // встроенные ячейки переносим поэлементно, переменные из std::deque остаются на месте
+        size_t inline_count = std::min(other._size, __CLOSURE_INLINE_SLOTS__);
+        for (size_t i = 0; i != inline_count; ++i) {
+            value_type& item = other.Slot(i);
+            new (&reinterpret_cast<value_type*>(_inline)[i]) value_type(item.first, std::move(item.second));
+            item.~value_type();
+        }
+        _size = std::exchange(other._size, 0);
+        _overflow = std::move(other._overflow);
+        _index = std::move(other._index);
+        _return_value = std::move(other._return_value);
+        _returning = std::exchange(other._returning, false);
+    }
+
+    size_t Closure::IndexOf(Symbol name) const {
+        if (_index) {
+            auto found = _index->find(name);
+            return found != _index->end() ? found->second : _size;
+        }
+        for (size_t i = 0; i != _size; ++i) {
+            if (Slot(i).first == name) {
+                return i;
+            }
+        }
+        return _size;
+    }
+
+    const NativeLayout& GetNativeLayout() {
+        // смещения берутся у настоящих объектов, так как Object и Closure не являются standard-layout
+        static const NativeLayout layout = [] {
+            const auto offset = [](const void* field, const void* base) {
+                return static_cast<size_t>(static_cast<const char*>(field) - static_cast<const char*>(base));
+            };
+            NativeLayout result;
+            const ObjectHolder holder;
+            result.holder_data = offset(&holder.data_, &holder);
+            result.holder_owning = offset(&holder.owning_, &holder);
+
+            const Number number(0);
+            const Object& object = number;
+            result.object_count = offset(&object._header.count, &object);
+            result.object_pinned = offset(&object._header.pinned, &object);
+            result.object_traceable = offset(&object._header.traceable, &object);
+
+            const Closure closure{};
+            result.closure_slots = offset(closure._inline, &closure);
+            result.closure_size = offset(&closure._size, &closure);
+            const Closure::value_type slot{ Symbol(), ObjectHolder() };
+            result.slot_name = offset(&slot.first, &slot);
+            result.slot_value = offset(&slot.second, &slot);
+            return result;
+        }();
+        return layout;
+    }
+
+    namespace {
+
+        thread_local size_t t_recursion_limit = __DEFAULT_RECURSION_LIMIT__;
+        thread_local size_t t_call_depth = 0;
+        thread_local TierUpHandler t_tier_up_handler = nullptr;
+        thread_local uint64_t t_tier_up_threshold = 0;
+
+        // Учитывает вызов метода в глубине вложенных вызовов потока
+        class CallDepthGuard {
+        public:
+            CallDepthGuard() {
+                if (t_call_depth >= t_recursion_limit) {
+                    throw RecursionError("Maximum recursion depth exceeded"s);
+                }
+                ++t_call_depth;
+            }
+            CallDepthGuard(const CallDepthGuard&) = delete;
+            CallDepthGuard& operator=(const CallDepthGuard&) = delete;
+            ~CallDepthGuard() {
+                --t_call_depth;
+            }
+        };
+
+        // Учитывает вызов метода и передаёт горячий метод обработчику. Порог может быть задан уже после того,
+        // как метод его превысил, поэтому сравнение нестрогое, а повторные вызовы отсекает сам обработчик
+        void CountCall(const Method& method) {
+            if (++method.calls >= t_tier_up_threshold && t_tier_up_handler != nullptr) {
+                t_tier_up_handler(method);
+            }
+        }
+
+    }  // namespace
+
+    void SetRecursionLimit(size_t limit) {
+        t_recursion_limit = limit;
+    }
+
+    size_t GetRecursionLimit() {
+        return t_recursion_limit;
+    }
+
+    void SetTierUp(TierUpHandler handler, uint64_t threshold) {
+        t_tier_up_handler = handler;
+        t_tier_up_threshold = threshold;
+    }
+
     bool IsTrue(const ObjectHolder& object) {
 
         runtime::Object* data = object.Get();
@@ -64,8 +581,26 @@ namespace runtime {
             else if (object.TryAs<Number>()) {
                 return object.TryAs<Number>()->GetValue() == 0 ? false : true;
             }
+            else if (object.TryAs<BigNumber>()) {
+                return object.TryAs<BigNumber>()->GetValue().IsZero() ? false : true;
+            }
+            else if (object.TryAs<Float>()) {
+                return object.TryAs<Float>()->GetValue() == 0.0 ? false : true;
+            }
             else if (object.TryAs<String>()) {
-                return object.TryAs<String>()->GetValue().empty() ? false : true;
+                return object.TryAs<String>()->Size() == 0 ? false : true;
+            }
+            else if (object.TryAs<List>()) {
+                return object.TryAs<List>()->Size() == 0 ? false : true;
+            }
+            else if (object.TryAs<Dict>()) {
+                return object.TryAs<Dict>()->Size() == 0 ? false : true;
+            }
+            else if (object.TryAs<IntArray>()) {
+                return object.TryAs<IntArray>()->Size() == 0 ? false : true;
+            }
+            else if (object.TryAs<FloatArray>()) {
+                return object.TryAs<FloatArray>()->Size() == 0 ? false : true;
             }
             else {
                 return false;
@@ -100,7 +635,7 @@ namespace runtime {
         }
     }
 
-    bool ClassInstance::HasMethod(const std::string& method, size_t argument_count) const {
+    bool ClassInstance::HasMethod(Symbol method, size_t argument_count) const {
         // пытаемся найти нужный метод
         const runtime::Method* founded = _base_class.GetMethod(method);
         // если метод найден и количество параметров совпадает с указанным
@@ -112,6 +647,18 @@ namespace runtime {
         }
     }
 
+    void ClassInstance::ForEachReference(const std::function<void(const ObjectHolder&)>& visit) {
+        for (const auto& [name, value] : _instance_closure) {
+            visit(value);
+        }
+    }
+
+    void ClassInstance::ClearReferences() {
+        // поля отпускаем уже после того, как объект перестал на них ссылаться
+        Closure released;
+        released.swap(_instance_closure);
+    }
+
     Closure& ClassInstance::Fields() {
         return _instance_closure;
     }
@@ -122,108 +669,888 @@ namespace runtime {
 
     ClassInstance::ClassInstance(const Class& cls) 
         : _base_class(cls) {
+        EnableCycleTracking();
     }
 
-    ObjectHolder ClassInstance::Call(const std::string& method,
+    ObjectHolder ClassInstance::Call(Symbol method,
         const std::vector<ObjectHolder>& actual_args, Context& context) {
-        if (HasMethod(method, actual_args.size())) {
+        return Call(method, actual_args.data(), actual_args.size(), context);
+    }
 
+    ObjectHolder ClassInstance::Call(Symbol method, const ObjectHolder* args, size_t count, Context& context) {
+        if (HasMethod(method, count)) {
+
+            CallDepthGuard depth_guard;
             // берем нужный нам метод
             const runtime::Method* _method = _base_class.GetMethod(method);
-            // для его выполнения создаём таблицу символов выполнения
+            CountCall(*_method);
+            // кадр вызова: self в нулевой ячейке, затем параметры по порядку
             Closure _executable_closure;
+            _executable_closure.Append(__SELF_NAME__, ObjectHolder::Share(*this));
             // заполняем созданную таблицу символов по переданным аргументам
-            for (size_t i = 0; i != actual_args.size(); ++i) {
-                _executable_closure[_method->formal_params[i]] = actual_args[i];
+            for (size_t i = 0; i != count; ++i) {
+                _executable_closure[_method->formal_params[i]] = args[i];
             }
 
-            // добавляем в таблицу крайнее поле о вызывающем классе
-            _executable_closure["self"] = ObjectHolder::Share(*this);
-
             // производим выполнение метода
             return _method->body->Execute(_executable_closure, context);
         }
         else {
             // Если метод не найден выбрасываем исключение
-            throw std::runtime_error("Method \""s + method + "\" is not found"s);
+            throw std::runtime_error("Method \""s + method.Name() + "\" is not found"s);
         }
     }
 
-    Class::Class(std::string name, std::vector<Method> methods, const Class* parent)
-        : _class_name(name), _class_methods(std::move(methods)), _class_parent(parent) {
+    ObjectHolder ClassInstance::Call(Symbol method, const std::vector<std::unique_ptr<Executable>>& args,
+        Closure& caller, Context& context) {
+        if (!HasMethod(method, args.size())) {
+            throw std::runtime_error("Method \""s + method.Name() + "\" is not found"s);
+        }
+        CallDepthGuard depth_guard;
+        const runtime::Method* _method = _base_class.GetMethod(method);
+        CountCall(*_method);
+        Closure frame;
+        frame.Append(__SELF_NAME__, ObjectHolder::Share(*this));
+        // аргументы вычисляются сразу в ячейки параметров
+        for (size_t i = 0; i != args.size(); ++i) {
+            frame[_method->formal_params[i]] = args[i]->Execute(caller, context);
+        }
+        return _method->body->Execute(frame, context);
     }
 
-    const Method* Class::GetMethod(const std::string& name) const {
-        // ищем сначала в списке методов текущего класса
-        for (auto& item : _class_methods) {
-            if (item.name == name) {
-                return &item;
+    List::List() {
+        EnableCycleTracking();
+    }
+
+    List::List(std::vector<ObjectHolder> items)
+        : _items(std::move(items)) {
+        EnableCycleTracking();
+    }
+
+    void List::ForEachReference(const std::function<void(const ObjectHolder&)>& visit) {
+        for (const auto& item : _items) {
+            visit(item);
+        }
+    }
+
+    void List::ClearReferences() {
+        std::vector<ObjectHolder> released;
+        released.swap(_items);
+    }
+
+    void List::Print(std::ostream& os, Context& context) {
+        os << '[';
+        bool is_first = true;
+        for (const auto& item : _items) {
+            if (!is_first) {
+                os << ", "sv;
+            }
+            is_first = false;
+
+            // пустой элемент выводим как None
+            if (item) {
+                item->Print(os, context);
+            }
+            else {
+                os << "None"sv;
             }
         }
-        // если не нашли ищем в классе-родителе, если он имеется
-        if (_class_parent) {
-            return _class_parent->GetMethod(name);
+        os << ']';
+    }
+
+    ObjectHolder List::Call(Symbol method,
+        const std::vector<ObjectHolder>& actual_args, [[maybe_unused]] Context& context) {
+        if (method == __APPEND_METHOD__ && actual_args.size() == 1) {
+            Append(actual_args[0]);
+            return ObjectHolder::None();
+        }
+        else {
+            // Если метод не найден выбрасываем исключение
+            throw std::runtime_error("List has no method \""s + method.Name() + "\""s);
         }
-        return nullptr;
     }
 
-    const std::string& Class::GetName() const {
-        return _class_name;
+    void List::Append(ObjectHolder item) {
+        _items.push_back(std::move(item));
     }
 
-    void Class::Print(ostream& os, [[maybe_unused]] Context& context) {
-        os << "Class "sv << _class_name;
+    size_t List::Size() const {
+        return _items.size();
     }
 
-    void Bool::Print(std::ostream& os, [[maybe_unused]] Context& context) {
-        os << (GetValue() ? "True"sv : "False"sv);
+    ObjectHolder& List::At(int64_t index) {
+        // отрицательный индекс отсчитываем от конца списка
+        int64_t position = index < 0 ? static_cast<int64_t>(_items.size()) + index : index;
+        if (position < 0 || position >= static_cast<int64_t>(_items.size())) {
+            throw std::runtime_error("List index out of range"s);
+        }
+        return _items[static_cast<size_t>(position)];
     }
 
-    bool Equal(const ObjectHolder& lhs, const ObjectHolder& rhs, Context& сontext) {
+    void List::Sort(Context& context, Symbol key) {
 
-        // если оба вернули nullptr, то это по сути означает что там объекты типа None
-        if (!lhs.Get() && !rhs.Get()) {
-            return true;
+        // вычисляем ключи сортировки один раз на элемент
+        std::vector<ObjectHolder> keys;
+        if (key.Empty()) {
+            keys = _items;
         }
         else {
-            // пытаемся привести к типу runtime::ClassInstance
-            if (lhs.TryAs<runtime::ClassInstance>()) {
-                runtime::ClassInstance* lhs_instanse = lhs.TryAs<runtime::ClassInstance>();
-                // проверяем наличие метода "__eq__"
-                if (lhs_instanse->HasMethod(__EQUAL_METHOD__, 1)) {
-                    // вызываем метод
-                    return lhs_instanse->Call(__EQUAL_METHOD__, {
-                        ObjectHolder().Share(*rhs.Get()) }, сontext).TryAs<Bool>()->GetValue();
+            keys.reserve(_items.size());
+            for (const auto& item : _items) {
+                ClassInstance* instance = item.TryAs<ClassInstance>();
+                if (!instance) {
+                    throw std::runtime_error("Sort key \""s + key.Name() + "\" requires class instances"s);
+                }
+                if (instance->HasMethod(key, 0)) {
+                    keys.push_back(instance->Call(key, {}, context));
+                }
+                else if (auto field = instance->Fields().find(key); field != instance->Fields().end()) {
+                    keys.push_back(field->second);
                 }
                 else {
-                    // в противном случае кидаем исключение
-                    throw std::runtime_error("Cannot compare objects for equality"s);
+                    throw std::runtime_error("Object has no sort key \""s + key.Name() + "\""s);
                 }
             }
-            // пытаемся привести к типу runtime::Bool
-            else if (lhs.TryAs<runtime::Bool>() && rhs.TryAs<runtime::Bool>()) {
-                return lhs.TryAs<runtime::Bool>()->GetValue() == rhs.TryAs<runtime::Bool>()->GetValue();
-            }
-            // пытаемся привести к типу runtime::Number
-            else if (lhs.TryAs<runtime::Number>() && rhs.TryAs<runtime::Number>()) {
-                return lhs.TryAs<runtime::Number>()->GetValue() == rhs.TryAs<runtime::Number>()->GetValue();
-            }
-            // пытаемся привести к типу runtime::String
-            else if (lhs.TryAs<runtime::String>() && rhs.TryAs<runtime::String>()) {
-                return lhs.TryAs<runtime::String>()->GetValue() == rhs.TryAs<runtime::String>()->GetValue();
+        }
+
+        bool all_numbers = std::all_of(keys.begin(), keys.end(), [](const ObjectHolder& k) {
+            return k.TryAs<Number>() != nullptr;
+        });
+        bool all_strings = !all_numbers && std::all_of(keys.begin(), keys.end(), [](const ObjectHolder& k) {
+            return k.TryAs<String>() != nullptr;
+        });
+
+        // сортируем пары из ключа и индекса элемента, затем переставляем элементы
+        auto sort_by = [this, &keys](auto extract, auto less) {
+            using Key = decltype(extract(keys.front()));
+            std::vector<std::pair<Key, size_t>> order;
+            order.reserve(keys.size());
+            for (size_t i = 0; i < keys.size(); ++i) {
+                order.emplace_back(extract(keys[i]), i);
             }
-            // если касты не удаются то кидаем исключение
-            else {
-                throw std::runtime_error("Cannot compare objects for equality"s);
+            IntroSort(order.begin(), order.end(), [&less](const auto& lhs, const auto& rhs) {
+                return less(lhs.first, rhs.first);
+            });
+
+            std::vector<ObjectHolder> sorted;
+            sorted.reserve(_items.size());
+            for (const auto& [unused, index] : order) {
+                sorted.push_back(std::move(_items[index]));
             }
+            _items = std::move(sorted);
+        };
+
+        if (keys.empty()) {
+            return;
+        }
+        else if (all_numbers) {
+            // числа сравниваем напрямую без обращений к объектам
+            sort_by([](const ObjectHolder& k) { return k.TryAs<Number>()->GetValue(); },
+                    [](int64_t lhs, int64_t rhs) { return lhs < rhs; });
+        }
+        else if (all_strings) {
+            sort_by([](const ObjectHolder& k) { return k.TryAs<String>()->View(); },
+                    [](std::string_view lhs, std::string_view rhs) { return lhs < rhs; });
+        }
+        else {
+            sort_by([](const ObjectHolder& k) { return &k; },
+                    [&context](const ObjectHolder* lhs, const ObjectHolder* rhs) { return Less(*lhs, *rhs, context); });
         }
     }
 
-    bool Less(const ObjectHolder& lhs, const ObjectHolder& rhs, Context& context) {
+    std::vector<ObjectHolder>& List::Values() {
+        return _items;
+    }
 
-        // если оба вернули nullptr, сравнивать нечего
-        if (!lhs.Get() && !rhs.Get()) {
-            throw std::runtime_error("Cannot compare objects for equality"s);
+    const std::vector<ObjectHolder>& List::Values() const {
+        return _items;
+    }
+
+    Dict::Dict() {
+        EnableCycleTracking();
+    }
+
+    void Dict::ForEachReference(const std::function<void(const ObjectHolder&)>& visit) {
+        for (const auto& entry : _entries) {
+            visit(entry.key);
+            visit(entry.value);
+        }
+    }
+
+    void Dict::ClearReferences() {
+        std::vector<Entry> released;
+        released.swap(_entries);
+        _control.clear();
+        _slots.clear();
+    }
+
+    void Dict::Print(std::ostream& os, Context& context) {
+        // выводит элемент словаря, пустой элемент выводим как None
+        auto print_item = [&os, &context](const ObjectHolder& item) {
+            if (item) {
+                item->Print(os, context);
+            }
+            else {
+                os << "None"sv;
+            }
+        };
+
+        os << '{';
+        bool is_first = true;
+        for (const auto& entry : _entries) {
+            if (!is_first) {
+                os << ", "sv;
+            }
+            is_first = false;
+
+            print_item(entry.key);
+            os << ": "sv;
+            print_item(entry.value);
+        }
+        os << '}';
+    }
+
+    ObjectHolder Dict::Call(Symbol method,
+        const std::vector<ObjectHolder>& actual_args, Context& context) {
+        if (method == __KEYS_METHOD__ && actual_args.empty()) {
+            std::vector<ObjectHolder> keys;
+            keys.reserve(_entries.size());
+            for (const auto& entry : _entries) {
+                keys.push_back(entry.key);
+            }
+            return ObjectHolder::Own(List(std::move(keys)));
+        }
+        else if (method == __VALUES_METHOD__ && actual_args.empty()) {
+            std::vector<ObjectHolder> values;
+            values.reserve(_entries.size());
+            for (const auto& entry : _entries) {
+                values.push_back(entry.value);
+            }
+            return ObjectHolder::Own(List(std::move(values)));
+        }
+        else if (method == __GET_METHOD__ && (actual_args.size() == 1 || actual_args.size() == 2)) {
+            // при отсутствии ключа возвращаем значение по умолчанию либо None
+            if (ObjectHolder* value = Find(actual_args[0], context)) {
+                return *value;
+            }
+            return actual_args.size() == 2 ? actual_args[1] : ObjectHolder::None();
+        }
+        else {
+            // Если метод не найден выбрасываем исключение
+            throw std::runtime_error("Dict has no method \""s + method.Name() + "\""s);
+        }
+    }
+
+    ObjectHolder* Dict::Find(const ObjectHolder& key, Context& context) {
+        size_t index = FindEntry(key, Hash(key, context), context);
+        return index != _entries.size() ? &_entries[index].value : nullptr;
+    }
+
+    bool Dict::Contains(const ObjectHolder& key, Context& context) {
+        return Find(key, context) != nullptr;
+    }
+
+    ObjectHolder& Dict::At(const ObjectHolder& key, Context& context) {
+        if (ObjectHolder* value = Find(key, context)) {
+            return *value;
+        }
+        throw std::runtime_error("Key is not found in dict"s);
+    }
+
+    void Dict::Set(ObjectHolder key, ObjectHolder value, Context& context) {
+        const size_t hash = Hash(key, context);
+        const size_t index = FindEntry(key, hash, context);
+
+        // если ключ уже есть - просто заменяем значение
+        if (index != _entries.size()) {
+            _entries[index].value = std::move(value);
+            return;
+        }
+
+        // поддерживаем заполнение таблицы не выше 7/8, чтобы в каждой последовательности проб был свободный слот
+        if ((_entries.size() + 1) * 8 > _control.size() * 7) {
+            Rehash(_control.empty() ? 1 : _control.size() / __DICT_GROUP_WIDTH__ * 2);
+        }
+
+        _entries.push_back({ hash, std::move(key), std::move(value) });
+        InsertSlot(hash, static_cast<uint32_t>(index));
+    }
+
+    size_t Dict::Size() const {
+        return _entries.size();
+    }
+
+    const std::vector<Dict::Entry>& Dict::Entries() const {
+        return _entries;
+    }
+
+    size_t Dict::FindEntry(const ObjectHolder& key, size_t hash, Context& context) const {
+        if (_control.empty()) {
+            return _entries.size();
+        }
+
+        const size_t group_mask = _control.size() / __DICT_GROUP_WIDTH__ - 1;
+        const int8_t control = ControlByte(hash);
+        size_t group = GroupIndex(hash) & group_mask;
+
+        // треугольная последовательность проб обходит все группы при их количестве, равном степени двойки
+        for (size_t probe = 1; ; ++probe) {
+            const int8_t* group_control = _control.data() + group * __DICT_GROUP_WIDTH__;
+
+            // ключи сравниваем только в слотах с совпавшими 7 битами хеша
+            for (uint32_t match = MatchGroup(group_control, control); match != 0; match &= match - 1) {
+                const uint32_t entry_index = _slots[group * __DICT_GROUP_WIDTH__ + CountTrailingZeros(match)];
+                const Entry& entry = _entries[entry_index];
+                if (entry.hash == hash && EqualKeys(entry.key, key, context)) {
+                    return entry_index;
+                }
+            }
+
+            // свободный слот в группе означает, что дальше ключ искать бессмысленно
+            if (MatchGroup(group_control, __DICT_EMPTY_CONTROL__) != 0) {
+                return _entries.size();
+            }
+            group = (group + probe) & group_mask;
+        }
+    }
+
+    void Dict::InsertSlot(size_t hash, uint32_t entry_index) {
+        const size_t group_mask = _control.size() / __DICT_GROUP_WIDTH__ - 1;
+        size_t group = GroupIndex(hash) & group_mask;
+
+        for (size_t probe = 1; ; ++probe) {
+            int8_t* group_control = _control.data() + group * __DICT_GROUP_WIDTH__;
+            if (uint32_t empty = MatchGroup(group_control, __DICT_EMPTY_CONTROL__)) {
+                const size_t slot = group * __DICT_GROUP_WIDTH__ + CountTrailingZeros(empty);
+                _control[slot] = ControlByte(hash);
+                _slots[slot] = entry_index;
+                return;
+            }
+            group = (group + probe) & group_mask;
+        }
+    }
+
+    void Dict::Rehash(size_t group_count) {
+        _control.assign(group_count * __DICT_GROUP_WIDTH__, __DICT_EMPTY_CONTROL__);
+        _slots.assign(group_count * __DICT_GROUP_WIDTH__, 0);
+
+        // полные хеши хранятся в записях, поэтому __hash__ повторно не вызывается
+        for (size_t i = 0; i != _entries.size(); ++i) {
+            InsertSlot(_entries[i].hash, static_cast<uint32_t>(i));
+        }
+    }
+
+    Class::Class(std::string name, std::vector<Method> methods, const Class* parent)
+        : _class_name(name), _class_methods(std::move(methods)), _class_parent(parent) {
+    }
+
+    const Method* Class::GetMethod(Symbol name) const {
+        // ищем сначала в списке методов текущего класса
+        for (auto& item : _class_methods) {
+            if (item.name == name) {
+                return &item;
+            }
+        }
+        // если не нашли ищем в классе-родителе, если он имеется
+        if (_class_parent) {
+            return _class_parent->GetMethod(name);
+        }
+        return nullptr;
+    }
+
+    const std::string& Class::GetName() const {
+        return _class_name;
+    }
+
+    std::vector<Method>& Class::GetMethods() {
+        return _class_methods;
+    }
+
+    const Class* Class::GetParent() const {
+        return _class_parent;
+    }
+
+    void Class::Print(ostream& os, [[maybe_unused]] Context& context) {
+        os << "Class "sv << _class_name;
+    }
+
+    void Bool::Print(std::ostream& os, [[maybe_unused]] Context& context) {
+        os << (GetValue() ? "True"sv : "False"sv);
+    }
+
+    namespace {
+
+        // Выводит value кратчайшей записью, однозначно восстанавливающей значение
+        void PrintFloat(std::ostream& os, double value) {
+            char buffer[64];
+
+            // как и Python, переходим на экспоненциальную запись для порядков меньше -4 и от 16
+            std::to_chars_result result = std::to_chars(buffer, buffer + sizeof(buffer), value, std::chars_format::scientific);
+            const char* exponent = std::find(buffer, result.ptr, 'e');
+            int power = 0;
+            if (exponent != result.ptr) {
+                std::from_chars(exponent + (exponent[1] == '+' ? 2 : 1), result.ptr, power);
+            }
+            if (std::isfinite(value) && power >= -4 && power < 16) {
+                result = std::to_chars(buffer, buffer + sizeof(buffer), value, std::chars_format::fixed);
+            }
+
+            std::string_view text(buffer, static_cast<size_t>(result.ptr - buffer));
+            os << text;
+            if (std::isfinite(value) && text.find_first_of(".e"sv) == std::string_view::npos) {
+                os << ".0"sv;
+            }
+        }
+
+    }  // namespace
+
+    void Float::Print(std::ostream& os, [[maybe_unused]] Context& context) {
+        PrintFloat(os, GetValue());
+    }
+
+    String::String(std::string value)
+        : _buffer(std::make_shared<std::string>(std::move(value))) {
+        _size = _buffer->size();
+    }
+
+    String::String(std::shared_ptr<std::string> buffer, size_t size)
+        : _buffer(std::move(buffer))
+        , _size(size) {
+    }
+
+    String String::Intern(std::string_view value) {
+        // односимвольные строки берём из готового массива, не обращаясь к таблице
+        if (value.size() == 1) {
+            static const std::vector<String> chars = [] {
+                std::vector<String> result;
+                result.reserve(256);
+                for (int c = 0; c != 256; ++c) {
+                    char ch = static_cast<char>(c);
+                    result.push_back(InternTable(std::string_view(&ch, 1)));
+                }
+                return result;
+            }();
+            return chars[static_cast<unsigned char>(value[0])];
+        }
+        return InternTable(value);
+    }
+
+    String String::InternTable(std::string_view value) {
+        struct Entry {
+            std::shared_ptr<std::string> buffer;
+            size_t hash;
+        };
+        // ключ ссылается на текст буфера, который после интернирования не меняется
+        static std::mutex mutex;
+        static std::unordered_map<std::string_view, Entry> table;
+
+        std::lock_guard guard(mutex);
+        auto found = table.find(value);
+        if (found == table.end()) {
+            auto buffer = std::make_shared<std::string>(value);
+            std::string_view key(*buffer);
+            found = table.emplace(key, Entry{ std::move(buffer), std::hash<std::string_view>{}(key) }).first;
+        }
+
+        String result(found->second.buffer, found->second.buffer->size());
+        result._hash = found->second.hash;
+        result._has_hash = true;
+        result._interned = true;
+        return result;
+    }
+
+    String String::Concat(const String& lhs, const String& rhs) {
+        const size_t size = lhs._size + rhs._size;
+
+        // буфер, которым владеет только lhs, дописываем на месте: других строк, видящих его текст, нет.
+        // Хвост, оставшийся от уже уничтоженных строк, отбрасываем. В s + s rhs - та же строка
+        if (!lhs._interned && !lhs._pinned && lhs._buffer.use_count() == 1 && rhs._buffer != lhs._buffer) {
+            lhs._buffer->resize(lhs._size);
+            lhs._buffer->append(rhs.View());
+            return String(lhs._buffer, size);
+        }
+
+        // иначе буфер разделён, и изменение было бы видно другим строкам - собираем новый
+        auto buffer = std::make_shared<std::string>();
+        buffer->reserve(size);
+        buffer->append(lhs.View());
+        buffer->append(rhs.View());
+        return String(std::move(buffer), size);
+    }
+
+    void String::Print(std::ostream& os, [[maybe_unused]] Context& context) {
+        os << View();
+    }
+
+    const std::string& String::GetValue() const {
+        if (_buffer->size() != _size) {
+            _buffer = std::make_shared<std::string>(_buffer->substr(0, _size));
+        }
+        _pinned = true;
+        return *_buffer;
+    }
+
+    bool String::IsInterned() const {
+        return _interned;
+    }
+
+    size_t String::Hash() const {
+        if (!_has_hash) {
+            _hash = std::hash<std::string_view>{}(View());
+            _has_hash = true;
+        }
+        return _hash;
+    }
+
+    bool String::Equals(const String& other) const {
+        if (_size != other._size) {
+            return false;
+        }
+        // префиксы одинаковой длины одного буфера совпадают
+        if (_buffer == other._buffer) {
+            return true;
+        }
+        // равные интернированные строки всегда разделяют буфер
+        if (_interned && other._interned) {
+            return false;
+        }
+        if (_has_hash && other._has_hash && _hash != other._hash) {
+            return false;
+        }
+        return View() == other.View();
+    }
+
+    bool String::Less(const String& other) const {
+        // из двух префиксов одного буфера меньше более короткий
+        if (_buffer == other._buffer) {
+            return _size < other._size;
+        }
+        return View() < other.View();
+    }
+
+    std::string_view String::View() const {
+        return std::string_view(_buffer->data(), _size);
+    }
+
+    size_t String::Size() const {
+        return _size;
+    }
+
+    namespace {
+
+        // Точная сумма для случая, когда ядро сообщило о переполнении: частичные суммы копятся в int64_t
+        // и переносятся в BigInt, только когда очередное слагаемое не помещается
+        ObjectHolder ExactSum(const std::vector<int64_t>& values) {
+            BigInt total;
+            int64_t partial = 0;
+            for (int64_t value : values) {
+                int64_t next = 0;
+                if (AddOverflow(partial, value, next)) {
+                    total = total + BigInt(partial);
+                    next = value;
+                }
+                partial = next;
+            }
+            return MakeInteger(total + BigInt(partial));
+        }
+
+        // Точное скалярное произведение, lhs и rhs одной длины
+        ObjectHolder ExactDot(const std::vector<int64_t>& lhs, const std::vector<int64_t>& rhs) {
+            BigInt total;
+            int64_t partial = 0;
+            for (size_t i = 0; i < lhs.size(); ++i) {
+                int64_t product = 0;
+                if (MulOverflow(lhs[i], rhs[i], product)) {
+                    total = total + BigInt(lhs[i]) * BigInt(rhs[i]);
+                    continue;
+                }
+                int64_t next = 0;
+                if (AddOverflow(partial, product, next)) {
+                    total = total + BigInt(partial);
+                    next = product;
+                }
+                partial = next;
+            }
+            return MakeInteger(total + BigInt(partial));
+        }
+
+    }  // namespace
+
+    IntArray::IntArray(std::vector<int64_t> values)
+        : _values(std::move(values)) {
+    }
+
+    void IntArray::Print(std::ostream& os, [[maybe_unused]] Context& context) {
+        os << '[';
+        bool is_first = true;
+        for (int64_t value : _values) {
+            if (!is_first) {
+                os << ", "sv;
+            }
+            is_first = false;
+            os << value;
+        }
+        os << ']';
+    }
+
+    ObjectHolder IntArray::Call(Symbol method,
+        const std::vector<ObjectHolder>& actual_args, [[maybe_unused]] Context& context) {
+
+        // возвращает числовое значение аргумента либо выбрасывает исключение
+        auto number_arg = [&method](const ObjectHolder& arg) -> int64_t {
+            if (const Number* number = arg.TryAs<Number>()) {
+                return number->GetValue();
+            }
+            throw std::runtime_error("IntArray method \""s + method.Name() + "\" expects a number"s);
+        };
+        // возвращает массив-аргумент той же длины либо nullptr, если аргумент не массив
+        auto array_arg = [this, &method](const ObjectHolder& arg) -> const IntArray* {
+            const IntArray* other = arg.TryAs<IntArray>();
+            if (other && other->Size() != _values.size()) {
+                throw std::runtime_error("IntArray method \""s + method.Name() + "\" expects arrays of equal length"s);
+            }
+            return other;
+        };
+
+        if (method == __SUM_METHOD__ && actual_args.empty()) {
+            int64_t result = 0;
+            if (kernels::Sum(_values.data(), _values.size(), result)) {
+                return ExactSum(_values);
+            }
+            return MakeNumber(result);
+        }
+        else if ((method == __MIN_METHOD__ || method == __MAX_METHOD__) && actual_args.empty()) {
+            if (_values.empty()) {
+                throw std::runtime_error("IntArray method \""s + method.Name() + "\" of empty array"s);
+            }
+            int64_t result = method == __MIN_METHOD__
+                ? kernels::Min(_values.data(), _values.size())
+                : kernels::Max(_values.data(), _values.size());
+            return MakeNumber(result);
+        }
+        else if (method == __DOT_METHOD__ && actual_args.size() == 1) {
+            const IntArray* other = array_arg(actual_args[0]);
+            if (!other) {
+                throw std::runtime_error("IntArray method \"dot\" expects an array"s);
+            }
+            int64_t result = 0;
+            if (kernels::Dot(_values.data(), other->_values.data(), _values.size(), result)) {
+                return ExactDot(_values, other->_values);
+            }
+            return MakeNumber(result);
+        }
+        else if ((method == __ADD_METHOD__ || method == __MUL_METHOD__) && actual_args.size() == 1) {
+            bool is_add = method == __ADD_METHOD__;
+            // результат собирается в новом буфере, чтобы при переполнении массив остался прежним
+            std::vector<int64_t> result(_values.size());
+            bool overflow = false;
+            if (const IntArray* other = array_arg(actual_args[0])) {
+                overflow = is_add ? kernels::Add(result.data(), _values.data(), other->_values.data(), _values.size())
+                                  : kernels::Mul(result.data(), _values.data(), other->_values.data(), _values.size());
+            }
+            else {
+                int64_t value = number_arg(actual_args[0]);
+                overflow = is_add ? kernels::AddScalar(result.data(), _values.data(), value, _values.size())
+                                  : kernels::MulScalar(result.data(), _values.data(), value, _values.size());
+            }
+            if (overflow) {
+                // элементы массива - int64_t, поэтому результат, не помещающийся в 64 бита, сохранить нельзя
+                throw std::runtime_error("IntArray method \""s + method.Name() + "\" overflows 64-bit items"s);
+            }
+            _values.swap(result);
+            return ObjectHolder::None();
+        }
+        else if (method == __FILL_METHOD__ && actual_args.size() == 1) {
+            kernels::Fill(_values.data(), number_arg(actual_args[0]), _values.size());
+            return ObjectHolder::None();
+        }
+        else if (method == __APPEND_METHOD__ && actual_args.size() == 1) {
+            _values.push_back(number_arg(actual_args[0]));
+            return ObjectHolder::None();
+        }
+        else {
+            // Если метод не найден выбрасываем исключение
+            throw std::runtime_error("IntArray has no method \""s + method.Name() + "\""s);
+        }
+    }
+
+    size_t IntArray::Size() const {
+        return _values.size();
+    }
+
+    int64_t& IntArray::At(int64_t index) {
+        // отрицательный индекс отсчитываем от конца массива
+        int64_t position = index < 0 ? static_cast<int64_t>(_values.size()) + index : index;
+        if (position < 0 || position >= static_cast<int64_t>(_values.size())) {
+            throw std::runtime_error("IntArray index out of range"s);
+        }
+        return _values[static_cast<size_t>(position)];
+    }
+
+    std::vector<int64_t>& IntArray::Values() {
+        return _values;
+    }
+
+    const std::vector<int64_t>& IntArray::Values() const {
+        return _values;
+    }
+
+    FloatArray::FloatArray(std::vector<double> values)
+        : _values(std::move(values)) {
+    }
+
+    void FloatArray::Print(std::ostream& os, [[maybe_unused]] Context& context) {
+        os << '[';
+        bool is_first = true;
+        for (double value : _values) {
+            if (!is_first) {
+                os << ", "sv;
+            }
+            is_first = false;
+            PrintFloat(os, value);
+        }
+        os << ']';
+    }
+
+    ObjectHolder FloatArray::Call(Symbol method,
+        const std::vector<ObjectHolder>& actual_args, [[maybe_unused]] Context& context) {
+
+        // возвращает значение числового аргумента любого типа либо выбрасывает исключение
+        auto number_arg = [&method](const ObjectHolder& arg) -> double {
+            if (IsNumeric(arg)) {
+                return ToDouble(arg);
+            }
+            throw std::runtime_error("FloatArray method \""s + method.Name() + "\" expects a number"s);
+        };
+        // возвращает массив-аргумент той же длины либо nullptr, если аргумент не массив
+        auto array_arg = [this, &method](const ObjectHolder& arg) -> const FloatArray* {
+            const FloatArray* other = arg.TryAs<FloatArray>();
+            if (other && other->Size() != _values.size()) {
+                throw std::runtime_error("FloatArray method \""s + method.Name() + "\" expects arrays of equal length"s);
+            }
+            return other;
+        };
+
+        if (method == __SUM_METHOD__ && actual_args.empty()) {
+            return ObjectHolder::Own(Float(kernels::Sum(_values.data(), _values.size())));
+        }
+        else if ((method == __MIN_METHOD__ || method == __MAX_METHOD__) && actual_args.empty()) {
+            if (_values.empty()) {
+                throw std::runtime_error("FloatArray method \""s + method.Name() + "\" of empty array"s);
+            }
+            double result = method == __MIN_METHOD__
+                ? kernels::Min(_values.data(), _values.size())
+                : kernels::Max(_values.data(), _values.size());
+            return ObjectHolder::Own(Float(result));
+        }
+        else if (method == __DOT_METHOD__ && actual_args.size() == 1) {
+            const FloatArray* other = array_arg(actual_args[0]);
+            if (!other) {
+                throw std::runtime_error("FloatArray method \"dot\" expects an array"s);
+            }
+            return ObjectHolder::Own(Float(kernels::Dot(_values.data(), other->_values.data(), _values.size())));
+        }
+        else if ((method == __ADD_METHOD__ || method == __MUL_METHOD__) && actual_args.size() == 1) {
+            bool is_add = method == __ADD_METHOD__;
+            if (const FloatArray* other = array_arg(actual_args[0])) {
+                is_add ? kernels::Add(_values.data(), other->_values.data(), _values.size())
+                       : kernels::Mul(_values.data(), other->_values.data(), _values.size());
+            }
+            else {
+                double value = number_arg(actual_args[0]);
+                is_add ? kernels::AddScalar(_values.data(), value, _values.size())
+                       : kernels::MulScalar(_values.data(), value, _values.size());
+            }
+            return ObjectHolder::None();
+        }
+        else if (method == __FILL_METHOD__ && actual_args.size() == 1) {
+            kernels::Fill(_values.data(), number_arg(actual_args[0]), _values.size());
+            return ObjectHolder::None();
+        }
+        else if (method == __APPEND_METHOD__ && actual_args.size() == 1) {
+            _values.push_back(number_arg(actual_args[0]));
+            return ObjectHolder::None();
+        }
+        else {
+            // Если метод не найден выбрасываем исключение
+            throw std::runtime_error("FloatArray has no method \""s + method.Name() + "\""s);
+        }
+    }
+
+    size_t FloatArray::Size() const {
+        return _values.size();
+    }
+
+    double& FloatArray::At(int64_t index) {
+        // отрицательный индекс отсчитываем от конца массива
+        int64_t position = index < 0 ? static_cast<int64_t>(_values.size()) + index : index;
+        if (position < 0 || position >= static_cast<int64_t>(_values.size())) {
+            throw std::runtime_error("FloatArray index out of range"s);
+        }
+        return _values[static_cast<size_t>(position)];
+    }
+
+    std::vector<double>& FloatArray::Values() {
+        return _values;
+    }
+
+    const std::vector<double>& FloatArray::Values() const {
+        return _values;
+    }
+
+    bool Equal(const ObjectHolder& lhs, const ObjectHolder& rhs, Context& сontext) {
+
+        // если оба вернули nullptr, то это по сути означает что там объекты типа None
+        if (!lhs.Get() && !rhs.Get()) {
+            return true;
+        }
+        else {
+            // пытаемся привести к типу runtime::ClassInstance
+            if (lhs.TryAs<runtime::ClassInstance>()) {
+                runtime::ClassInstance* lhs_instanse = lhs.TryAs<runtime::ClassInstance>();
+                // проверяем наличие метода "__eq__"
+                if (lhs_instanse->HasMethod(__EQUAL_METHOD__, 1)) {
+                    // вызываем метод
+                    return lhs_instanse->Call(__EQUAL_METHOD__, {
+                        ObjectHolder().Share(*rhs.Get()) }, сontext).TryAs<Bool>()->GetValue();
+                }
+                else {
+                    // в противном случае кидаем исключение
+                    throw std::runtime_error("Cannot compare objects for equality"s);
+                }
+            }
+            // пытаемся привести к типу runtime::Bool
+            else if (lhs.TryAs<runtime::Bool>() && rhs.TryAs<runtime::Bool>()) {
+                return lhs.TryAs<runtime::Bool>()->GetValue() == rhs.TryAs<runtime::Bool>()->GetValue();
+            }
+            // пытаемся привести к типу runtime::Number
+            else if (lhs.TryAs<runtime::Number>() && rhs.TryAs<runtime::Number>()) {
+                return lhs.TryAs<runtime::Number>()->GetValue() == rhs.TryAs<runtime::Number>()->GetValue();
+            }
+            // если хотя бы одно из чисел длинное, сравниваем с произвольной точностью
+            else if (IsInteger(lhs) && IsInteger(rhs)) {
+                return ToBigInt(lhs) == ToBigInt(rhs);
+            }
+            // если одно из чисел с плавающей точкой, сравниваем как double
+            else if (IsNumeric(lhs) && IsNumeric(rhs)) {
+                return ToDouble(lhs) == ToDouble(rhs);
+            }
+            // пытаемся привести к типу runtime::String
+            else if (lhs.TryAs<runtime::String>() && rhs.TryAs<runtime::String>()) {
+                return lhs.TryAs<runtime::String>()->Equals(*rhs.TryAs<runtime::String>());
+            }
+            // если касты не удаются то кидаем исключение
+            else {
+                throw std::runtime_error("Cannot compare objects for equality"s);
+            }
+        }
+    }
+
+    bool Less(const ObjectHolder& lhs, const ObjectHolder& rhs, Context& context) {
+
+        // если оба вернули nullptr, сравнивать нечего
+        if (!lhs.Get() && !rhs.Get()) {
+            throw std::runtime_error("Cannot compare objects for equality"s);
         }
         else {
             // пытаемся привести к типу runtime::ClassInstance
@@ -231,9 +1558,12 @@ namespace runtime {
                 runtime::ClassInstance* lhs_instanse = lhs.TryAs<runtime::ClassInstance>();
                 // проверяем наличие метода "__lt__"
                 if (lhs_instanse->HasMethod(__LESS_METHOD__, 1)) {
-                    // вызываем метод
-                    return lhs_instanse->Call(__LESS_METHOD__, {
-                        ObjectHolder().Share(*rhs.Get()) }, context).TryAs<Bool>()->GetValue();
+                    // вызываем метод, результат должен быть значением типа Bool
+                    ObjectHolder result = lhs_instanse->Call(__LESS_METHOD__, { rhs }, context);
+                    if (!result.TryAs<Bool>()) {
+                        throw std::runtime_error("Method __lt__ must return Bool"s);
+                    }
+                    return result.TryAs<Bool>()->GetValue();
                 }
                 else {
                     // в противном случае кидаем исключение
@@ -248,9 +1578,17 @@ namespace runtime {
             else if (lhs.TryAs<runtime::Number>() && rhs.TryAs<runtime::Number>()) {
                 return lhs.TryAs<runtime::Number>()->GetValue() < rhs.TryAs<runtime::Number>()->GetValue();
             }
+            // если хотя бы одно из чисел длинное, сравниваем с произвольной точностью
+            else if (IsInteger(lhs) && IsInteger(rhs)) {
+                return ToBigInt(lhs) < ToBigInt(rhs);
+            }
+            // если одно из чисел с плавающей точкой, сравниваем как double
+            else if (IsNumeric(lhs) && IsNumeric(rhs)) {
+                return ToDouble(lhs) < ToDouble(rhs);
+            }
             // пытаемся привести к типу runtime::String
             else if (lhs.TryAs<runtime::String>() && rhs.TryAs<runtime::String>()) {
-                return lhs.TryAs<runtime::String>()->GetValue() < rhs.TryAs<runtime::String>()->GetValue();
+                return lhs.TryAs<runtime::String>()->Less(*rhs.TryAs<runtime::String>());
             }
             // если касты не удаются то кидаем исключение
             else {
@@ -259,24 +1597,503 @@ namespace runtime {
         }
     }
 
+    size_t Hash(const ObjectHolder& object, Context& context) {
+
+        // у None фиксированный хеш
+        if (!object) {
+            return MixHash(0x4E6F6E65);
+        }
+        else if (const Bool* value = object.TryAs<Bool>()) {
+            return MixHash(value->GetValue() ? 1 : 0);
+        }
+        else if (const Number* value = object.TryAs<Number>()) {
+            return MixHash(static_cast<uint64_t>(value->GetValue()));
+        }
+        else if (const BigNumber* value = object.TryAs<BigNumber>()) {
+            // хеш длинного числа, помещающегося в 64 бита, совпадает с хешем Number
+            if (std::optional<int64_t> small = value->GetValue().ToInt64()) {
+                return MixHash(static_cast<uint64_t>(*small));
+            }
+            return MixHash(value->GetValue().Hash());
+        }
+        else if (const Float* value = object.TryAs<Float>()) {
+            // целое значение хешируется как Number, так как 1.0 и 1 - один и тот же ключ
+            double number = value->GetValue();
+            if (number == std::trunc(number) && number >= -9223372036854775808.0 && number < 9223372036854775808.0) {
+                return MixHash(static_cast<uint64_t>(static_cast<int64_t>(number)));
+            }
+            uint64_t bits = 0;
+            std::memcpy(&bits, &number, sizeof(bits));
+            return MixHash(bits);
+        }
+        else if (const String* value = object.TryAs<String>()) {
+            return MixHash(value->Hash());
+        }
+        else if (ClassInstance* instance = object.TryAs<ClassInstance>()) {
+            // если у класса есть метод "__hash__", используем его результат
+            if (instance->HasMethod(__HASH_METHOD__, 0)) {
+                ObjectHolder hash = instance->Call(__HASH_METHOD__, {}, context);
+                const Number* result = hash.TryAs<Number>();
+                if (!result) {
+                    throw std::runtime_error("__hash__ must return a number"s);
+                }
+                return MixHash(static_cast<uint64_t>(result->GetValue()));
+            }
+            // объекты со своим сравнением без своего хеша хешировать нельзя
+            else if (instance->HasMethod(__EQUAL_METHOD__, 1)) {
+                throw std::runtime_error("Unhashable object: class defines __eq__ without __hash__"s);
+            }
+            return MixHash(reinterpret_cast<uintptr_t>(instance));
+        }
+        else {
+            throw std::runtime_error("Unhashable type"s);
+        }
+    }
+
+    bool EqualKeys(const ObjectHolder& lhs, const ObjectHolder& rhs, Context& context) {
+
+        // один и тот же объект (в том числе оба None) всегда равен сам себе
+        if (lhs.Get() == rhs.Get()) {
+            return true;
+        }
+        else if (!lhs || !rhs) {
+            return false;
+        }
+        else if (const ClassInstance* instance = lhs.TryAs<ClassInstance>()) {
+            // экземпляры без "__eq__" равны только самим себе
+            return instance->HasMethod(__EQUAL_METHOD__, 1) ? Equal(lhs, rhs, context) : false;
+        }
+        else if (lhs.TryAs<Bool>() && rhs.TryAs<Bool>()) {
+            return lhs.TryAs<Bool>()->GetValue() == rhs.TryAs<Bool>()->GetValue();
+        }
+        else if (lhs.TryAs<Number>() && rhs.TryAs<Number>()) {
+            return lhs.TryAs<Number>()->GetValue() == rhs.TryAs<Number>()->GetValue();
+        }
+        else if (IsInteger(lhs) && IsInteger(rhs)) {
+            return ToBigInt(lhs) == ToBigInt(rhs);
+        }
+        else if (IsNumeric(lhs) && IsNumeric(rhs)) {
+            return ToDouble(lhs) == ToDouble(rhs);
+        }
+        else if (lhs.TryAs<String>() && rhs.TryAs<String>()) {
+            return lhs.TryAs<String>()->Equals(*rhs.TryAs<String>());
+        }
+        return false;
+    }
+
+    bool IsInteger(const ObjectHolder& object) {
+        return object.TryAs<Number>() != nullptr || object.TryAs<BigNumber>() != nullptr;
+    }
+
+    bool IsNumeric(const ObjectHolder& object) {
+        return IsInteger(object) || object.TryAs<Float>() != nullptr;
+    }
+
+    double ToDouble(const ObjectHolder& object) {
+        if (const Float* value = object.TryAs<Float>()) {
+            return value->GetValue();
+        }
+        else if (const Number* value = object.TryAs<Number>()) {
+            return static_cast<double>(value->GetValue());
+        }
+        return object.TryAs<BigNumber>()->GetValue().ToDouble();
+    }
+
+    ObjectHolder MakeBool(bool value) {
+        // объекты создаются при первом обращении и не уничтожаются до конца программы
+        static Bool true_value(true);
+        static Bool false_value(false);
+        static const ObjectHolder true_holder = ObjectHolder::Immortal(true_value);
+        static const ObjectHolder false_holder = ObjectHolder::Immortal(false_value);
+        return value ? true_holder : false_holder;
+    }
+
+    ObjectHolder MakeNumber(int64_t value) {
+        static const std::vector<ObjectHolder> small_numbers = []() {
+            static std::vector<Number> numbers;
+            numbers.reserve(__SMALL_INT_MAX__ - __SMALL_INT_MIN__ + 1);
+            std::vector<ObjectHolder> holders;
+            holders.reserve(__SMALL_INT_MAX__ - __SMALL_INT_MIN__ + 1);
+            for (int64_t i = __SMALL_INT_MIN__; i <= __SMALL_INT_MAX__; ++i) {
+                holders.push_back(ObjectHolder::Immortal(numbers.emplace_back(i)));
+            }
+            return holders;
+        }();
+        if (value >= __SMALL_INT_MIN__ && value <= __SMALL_INT_MAX__) {
+            return small_numbers[static_cast<size_t>(value - __SMALL_INT_MIN__)];
+        }
+        return ObjectHolder::Own(Number(value));
+    }
+
+    ObjectHolder MakeInteger(const BigInt& value) {
+        if (std::optional<int64_t> small = value.ToInt64()) {
+            return MakeNumber(*small);
+        }
+        return ObjectHolder::Own(BigNumber(value));
+    }
+
+    ObjectHolder Arithmetic(ArithmeticOp op, const ObjectHolder& lhs, const ObjectHolder& rhs, Context& context) {
+        // пытаемся оба преобразовать в число, при переполнении результат становится длинным числом
+        if (IsInteger(lhs) && IsInteger(rhs)) {
+            switch (op) {
+            case ArithmeticOp::Add:
+                return IntegerAdd(lhs, rhs);
+            case ArithmeticOp::Sub:
+                return IntegerSub(lhs, rhs);
+            case ArithmeticOp::Mult:
+                return IntegerMul(lhs, rhs);
+            case ArithmeticOp::Div:
+                // деление на ноль выбрасывает исключение
+                return IntegerDiv(lhs, rhs);
+            }
+        }
+        // если одно из чисел с плавающей точкой, вычисляем как double
+        else if (IsNumeric(lhs) && IsNumeric(rhs)) {
+            double lhs_value = ToDouble(lhs);
+            double rhs_value = ToDouble(rhs);
+            switch (op) {
+            case ArithmeticOp::Add:
+                return ObjectHolder::Own(Float(lhs_value + rhs_value));
+            case ArithmeticOp::Sub:
+                return ObjectHolder::Own(Float(lhs_value - rhs_value));
+            case ArithmeticOp::Mult:
+                return ObjectHolder::Own(Float(lhs_value * rhs_value));
+            case ArithmeticOp::Div:
+                // деление не отбрасывает дробную часть
+                if (rhs_value == 0.0) {
+                    throw std::runtime_error("Division by zero");
+                }
+                return ObjectHolder::Own(Float(lhs_value / rhs_value));
+            }
+        }
+        else if (op == ArithmeticOp::Add) {
+            // пытаемся оба преобразовать в строку
+            if (lhs.TryAs<String>() && rhs.TryAs<String>()) {
+                // строки склеиваются без копирования левой части, если она владеет концом своего буфера
+                return ObjectHolder::Own(String::Concat(*lhs.TryAs<String>(), *rhs.TryAs<String>()));
+            }
+            // пытаемся левое привести к объекту класса, а правое к объекту
+            else if (lhs.TryAs<ClassInstance>() && rhs.TryAs<Object>()) {
+                ClassInstance* lhs_class = lhs.TryAs<ClassInstance>();
+
+                // првоеряем наличие метода сложения в классе
+                if (lhs_class->HasMethod(__ADD_OPERATOR_METHOD__, 1)) {
+                    return lhs_class->Call(__ADD_OPERATOR_METHOD__, { rhs }, context);
+                }
+            }
+            throw std::runtime_error("lhs and rhs arguments can't be added");
+        }
+        throw std::runtime_error("lhs and rhs arguments cant be added");
+    }
+
+    ObjectHolder NumberAdd(int64_t lhs, int64_t rhs) {
+        int64_t result = 0;
+        if (!AddOverflow(lhs, rhs, result)) {
+            return MakeNumber(result);
+        }
+        return MakeInteger(BigInt(lhs) + BigInt(rhs));
+    }
+
+    ObjectHolder NumberSub(int64_t lhs, int64_t rhs) {
+        int64_t result = 0;
+        if (!SubOverflow(lhs, rhs, result)) {
+            return MakeNumber(result);
+        }
+        return MakeInteger(BigInt(lhs) - BigInt(rhs));
+    }
+
+    ObjectHolder NumberMul(int64_t lhs, int64_t rhs) {
+        int64_t result = 0;
+        if (!MulOverflow(lhs, rhs, result)) {
+            return MakeNumber(result);
+        }
+        return MakeInteger(BigInt(lhs) * BigInt(rhs));
+    }
+
+    ObjectHolder NumberDiv(int64_t lhs, int64_t rhs) {
+        if (rhs == 0) {
+            throw std::runtime_error("Division by zero"s);
+        }
+        // единственное переполнение при делении - минимальное значение на -1
+        if (lhs == std::numeric_limits<int64_t>::min() && rhs == -1) {
+            return MakeInteger(BigInt(lhs) / BigInt(rhs));
+        }
+        return MakeNumber(lhs / rhs);
+    }
+
+    ObjectHolder IntegerAdd(const ObjectHolder& lhs, const ObjectHolder& rhs) {
+        const Number* lhs_number = lhs.TryAs<Number>();
+        const Number* rhs_number = rhs.TryAs<Number>();
+        if (lhs_number && rhs_number) {
+            return NumberAdd(lhs_number->GetValue(), rhs_number->GetValue());
+        }
+        return MakeInteger(ToBigInt(lhs) + ToBigInt(rhs));
+    }
+
+    ObjectHolder IntegerSub(const ObjectHolder& lhs, const ObjectHolder& rhs) {
+        const Number* lhs_number = lhs.TryAs<Number>();
+        const Number* rhs_number = rhs.TryAs<Number>();
+        if (lhs_number && rhs_number) {
+            return NumberSub(lhs_number->GetValue(), rhs_number->GetValue());
+        }
+        return MakeInteger(ToBigInt(lhs) - ToBigInt(rhs));
+    }
+
+    ObjectHolder IntegerMul(const ObjectHolder& lhs, const ObjectHolder& rhs) {
+        const Number* lhs_number = lhs.TryAs<Number>();
+        const Number* rhs_number = rhs.TryAs<Number>();
+        if (lhs_number && rhs_number) {
+            return NumberMul(lhs_number->GetValue(), rhs_number->GetValue());
+        }
+        return MakeInteger(ToBigInt(lhs) * ToBigInt(rhs));
+    }
+
+    ObjectHolder IntegerDiv(const ObjectHolder& lhs, const ObjectHolder& rhs) {
+        const Number* lhs_number = lhs.TryAs<Number>();
+        const Number* rhs_number = rhs.TryAs<Number>();
+        if (lhs_number && rhs_number) {
+            return NumberDiv(lhs_number->GetValue(), rhs_number->GetValue());
+        }
+        if (rhs_number ? rhs_number->GetValue() == 0 : rhs.TryAs<BigNumber>()->GetValue().IsZero()) {
+            throw std::runtime_error("Division by zero"s);
+        }
+        return MakeInteger(ToBigInt(lhs) / ToBigInt(rhs));
+    }
+
+    namespace {
+
+        // Результат сравнения двух значений. Unordered получается при сравнении с NaN
+        enum class Ordering : uint8_t {
+            Less,
+            Equal,
+            Greater,
+            Unordered,
+        };
+
+        template <typename T>
+        Ordering OrderOf(const T& lhs, const T& rhs) {
+            if (lhs < rhs) {
+                return Ordering::Less;
+            }
+            if (rhs < lhs) {
+                return Ordering::Greater;
+            }
+            // для чисел с плавающей точкой равенство не следует из несравнимости
+            return lhs == rhs ? Ordering::Equal : Ordering::Unordered;
+        }
+
+        // Возвращает целое число object типа Number или BigNumber в виде BigInt
+        BigInt AsBigInt(const Object& object) {
+            if (object.Kind() == ObjectKind::Number) {
+                return BigInt(static_cast<const Number&>(object).GetValue());
+            }
+            return static_cast<const BigNumber&>(object).GetValue();
+        }
+
+        // Возвращает число object типа Number, BigNumber или Float в виде double
+        double AsDouble(const Object& object) {
+            switch (object.Kind()) {
+            case ObjectKind::Float:
+                return static_cast<const Float&>(object).GetValue();
+            case ObjectKind::Number:
+                return static_cast<double>(static_cast<const Number&>(object).GetValue());
+            default:
+                return static_cast<const BigNumber&>(object).GetValue().ToDouble();
+            }
+        }
+
+        Ordering OrderBools(const Object& lhs, const Object& rhs) {
+            return OrderOf(static_cast<const Bool&>(lhs).GetValue(), static_cast<const Bool&>(rhs).GetValue());
+        }
+
+        Ordering OrderNumbers(const Object& lhs, const Object& rhs) {
+            return OrderOf(static_cast<const Number&>(lhs).GetValue(), static_cast<const Number&>(rhs).GetValue());
+        }
+
+        // хотя бы одно из чисел длинное, сравниваем с произвольной точностью
+        Ordering OrderIntegers(const Object& lhs, const Object& rhs) {
+            int result = AsBigInt(lhs).Compare(AsBigInt(rhs));
+            return result < 0 ? Ordering::Less : result > 0 ? Ordering::Greater : Ordering::Equal;
+        }
+
+        // хотя бы одно из чисел с плавающей точкой, сравниваем как double
+        Ordering OrderFloats(const Object& lhs, const Object& rhs) {
+            return OrderOf(AsDouble(lhs), AsDouble(rhs));
+        }
+
+        Ordering OrderStrings(const Object& lhs, const Object& rhs) {
+            const auto& lhs_string = static_cast<const String&>(lhs);
+            const auto& rhs_string = static_cast<const String&>(rhs);
+            if (lhs_string.Equals(rhs_string)) {
+                return Ordering::Equal;
+            }
+            return lhs_string.Less(rhs_string) ? Ordering::Less : Ordering::Greater;
+        }
+
+        using OrderFunction = Ordering (*)(const Object& lhs, const Object& rhs);
+        using OrderTable = std::array<std::array<OrderFunction, __OBJECT_KIND_COUNT__>, __OBJECT_KIND_COUNT__>;
+
+        // Функции сравнения для пар типов аргументов, nullptr - пара сравнивается через Less и Equal
+        constexpr OrderTable MakeOrderTable() {
+            OrderTable table{};
+            auto set = [&table](ObjectKind lhs, ObjectKind rhs, OrderFunction order) {
+                table[static_cast<size_t>(lhs)][static_cast<size_t>(rhs)] = order;
+            };
+            const ObjectKind numbers[] = { ObjectKind::Number, ObjectKind::BigNumber, ObjectKind::Float };
+            for (ObjectKind lhs : numbers) {
+                for (ObjectKind rhs : numbers) {
+                    bool is_float = lhs == ObjectKind::Float || rhs == ObjectKind::Float;
+                    set(lhs, rhs, is_float ? OrderFloats : OrderIntegers);
+                }
+            }
+            set(ObjectKind::Number, ObjectKind::Number, OrderNumbers);
+            set(ObjectKind::Bool, ObjectKind::Bool, OrderBools);
+            set(ObjectKind::String, ObjectKind::String, OrderStrings);
+            return table;
+        }
+
+        constexpr OrderTable __ORDER_TABLE__ = MakeOrderTable();
+
+        // Проверяет, выполняется ли оператор op для значений, находящихся в отношении order
+        bool Satisfies(CompareOp op, Ordering order) {
+            switch (op) {
+            case CompareOp::Less:
+                return order == Ordering::Less;
+            case CompareOp::LessOrEqual:
+                return order == Ordering::Less || order == Ordering::Equal;
+            case CompareOp::Greater:
+                return order == Ordering::Greater;
+            case CompareOp::GreaterOrEqual:
+                return order == Ordering::Greater || order == Ordering::Equal;
+            case CompareOp::Equal:
+                return order == Ordering::Equal;
+            case CompareOp::NotEqual:
+                return order != Ordering::Equal;
+            }
+            return false;
+        }
+
+    }  // namespace
+
+    bool Compare(CompareOp op, const ObjectHolder& lhs, const ObjectHolder& rhs, Context& context) {
+        OrderFunction order = __ORDER_TABLE__[static_cast<size_t>(lhs.Kind())][static_cast<size_t>(rhs.Kind())];
+        if (order != nullptr) {
+            return Satisfies(op, order(*lhs.Get(), *rhs.Get()));
+        }
+
+        // None, экземпляры классов и несравнимые пары, для которых Less и Equal выбрасывают исключение
+        switch (op) {
+        case CompareOp::Less:
+            return Less(lhs, rhs, context);
+        case CompareOp::LessOrEqual:
+            return Less(lhs, rhs, context) || Equal(lhs, rhs, context);
+        case CompareOp::Greater:
+            return !Less(lhs, rhs, context) && !Equal(lhs, rhs, context);
+        case CompareOp::GreaterOrEqual:
+            return !Less(lhs, rhs, context);
+        case CompareOp::Equal:
+            return Equal(lhs, rhs, context);
+        case CompareOp::NotEqual:
+            return !Equal(lhs, rhs, context);
+        }
+        return false;
+    }
+
     bool NotEqual(const ObjectHolder& lhs, const ObjectHolder& rhs, Context& context) {
-        // возвращаем что левая часть НЕ равна правой
-        return !Equal(lhs, rhs, context);
+        return Compare(CompareOp::NotEqual, lhs, rhs, context);
     }
 
     bool Greater(const ObjectHolder& lhs, const ObjectHolder& rhs, Context& context) {
-        // возвращаем что левая часть НЕ меньше и НЕ равна правой
-        return !Less(lhs, rhs, context) && !Equal(lhs, rhs, context);
+        return Compare(CompareOp::Greater, lhs, rhs, context);
     }
 
     bool LessOrEqual(const ObjectHolder& lhs, const ObjectHolder& rhs, Context& context) {
-        // возвращаем что левая часть НЕ больше чем правая
-        return !Greater(lhs, rhs, context);
+        return Compare(CompareOp::LessOrEqual, lhs, rhs, context);
     }
 
     bool GreaterOrEqual(const ObjectHolder& lhs, const ObjectHolder& rhs, Context& context) {
-        // возвращаем что левая часть НЕ меньше чем правая
-        return !Less(lhs, rhs, context);
+        return Compare(CompareOp::GreaterOrEqual, lhs, rhs, context);
+    }
+
+    namespace {
+
+        // Копирует граф объектов, запоминая уже скопированные объекты, чтобы сохранить разделение и циклы
+        class GraphCopier {
+        public:
+            explicit GraphCopier(Context& context)
+                : _context(context) {
+            }
+
+            ObjectHolder Copy(const ObjectHolder& object) {
+                // общие объекты живут до конца программы, их не копируем
+                if (!object || object.IsImmortal()) {
+                    return object;
+                }
+                if (auto it = _copies.find(object.Get()); it != _copies.end()) {
+                    return it->second;
+                }
+                if (auto* number = object.TryAs<Number>()) {
+                    return ObjectHolder::Own(Number(*number));
+                }
+                if (auto* big = object.TryAs<BigNumber>()) {
+                    return ObjectHolder::Own(BigNumber(*big));
+                }
+                if (auto* boolean = object.TryAs<Bool>()) {
+                    return ObjectHolder::Own(Bool(*boolean));
+                }
+                if (auto* real = object.TryAs<Float>()) {
+                    return ObjectHolder::Own(Float(*real));
+                }
+                if (auto* str = object.TryAs<String>()) {
+                    return ObjectHolder::Own(String(*str));
+                }
+                if (auto* array = object.TryAs<IntArray>()) {
+                    return ObjectHolder::Own(IntArray(*array));
+                }
+                if (auto* array = object.TryAs<FloatArray>()) {
+                    return ObjectHolder::Own(FloatArray(*array));
+                }
+                // контейнеры запоминаем до копирования содержимого: оно может ссылаться на сам контейнер
+                if (auto* instance = object.TryAs<ClassInstance>()) {
+                    ObjectHolder copy = Remember(object, ObjectHolder::Own(ClassInstance(*instance)));
+                    for (auto& [name, field] : copy.TryAs<ClassInstance>()->Fields()) {
+                        field = Copy(field);
+                    }
+                    return copy;
+                }
+                if (auto* list = object.TryAs<List>()) {
+                    ObjectHolder copy = Remember(object, ObjectHolder::Own(List(*list)));
+                    for (ObjectHolder& item : copy.TryAs<List>()->Values()) {
+                        item = Copy(item);
+                    }
+                    return copy;
+                }
+                if (auto* dict = object.TryAs<Dict>()) {
+                    ObjectHolder copy = Remember(object, ObjectHolder::Own(Dict()));
+                    for (const Dict::Entry& entry : dict->Entries()) {
+                        copy.TryAs<Dict>()->Set(Copy(entry.key), Copy(entry.value), _context);
+                    }
+                    return copy;
+                }
+                // классы живут вне арены
+                return object;
+            }
+
+        private:
+            ObjectHolder Remember(const ObjectHolder& original, ObjectHolder copy) {
+                _copies.emplace(original.Get(), copy);
+                return copy;
+            }
+
+            Context& _context;
+            std::unordered_map<const Object*, ObjectHolder> _copies;
+        };
+
+    }  // namespace
+
+    ObjectHolder CopyOut(const ObjectHolder& object, const ExecutionArena& arena, Context& context) {
+        HeapModeScope outer(arena.OuterMode());
+        return GraphCopier(context).Copy(object);
     }
 
 }  // namespace runtime
@@ -1,9 +1,23 @@
 #pragma once
 
+#include "bigint.h"
+#include "collector.h"
+#include "heap.h"
+#include "symbol.h"
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
 #include <memory>
 #include <sstream>
+#include <stdexcept>
 #include <string>
+#include <string_view>
+#include <type_traits>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 namespace runtime {
@@ -18,12 +32,108 @@ namespace runtime {
         ~Context() = default;
     };
 
+    class ObjectHolder;
+
+    // Тип значения для выбора реализации операции по паре типов аргументов без dynamic_cast
+    enum class ObjectKind : uint8_t {
+        None,           // пустой ObjectHolder
+        Bool,
+        Number,
+        BigNumber,
+        Float,
+        String,
+        Instance,       // экземпляр класса
+        Other,          // классы, контейнеры и прочие объекты
+    };
+    constexpr size_t __OBJECT_KIND_COUNT__ = 8;
+
+    struct NativeLayout;
+    // Возвращает расположение служебных полей объектов, см. NativeLayout
+    [[nodiscard]] const NativeLayout& GetNativeLayout();
+
     // Базовый класс для всех объектов языка Mython
     class Object {
     public:
         virtual ~Object() = default;
         // выводит в os своё представление в виде строки
         virtual void Print(std::ostream& os, Context& context) = 0;
+        // возвращает тип значения, переопределяется значениями, строками и экземплярами классов
+        [[nodiscard]] virtual ObjectKind Kind() const {
+            return ObjectKind::Other;
+        }
+
+    protected:
+        // Отмечает объект как контейнер, способный хранить ссылки на другие объекты и участвовать в циклах.
+        // Вызывается из конструкторов контейнеров
+        void EnableCycleTracking() {
+            _header.traceable = true;
+        }
+
+        // Передаёт visit каждый ObjectHolder, хранящийся в объекте. Переопределяется контейнерами
+        virtual void ForEachReference(const std::function<void(const ObjectHolder&)>& visit);
+        // Отпускает все ObjectHolder объекта. Сборщик вызывает его, чтобы разорвать мусорный цикл
+        virtual void ClearReferences();
+
+    private:
+        friend class ObjectHolder;
+        friend class CycleCollector;
+        friend const NativeLayout& GetNativeLayout();
+
+        // Число владеющих ObjectHolder и служебные поля сборщика циклов. Копия объекта - новый объект,
+        // поэтому при копировании переносится только признак контейнера. Счётчик не атомарный: для передачи
+        // объекта в другой поток служит ObjectHandoff
+        struct Header {
+            Header() = default;
+            Header(const Header& other) noexcept
+                : traceable(other.traceable) {
+            }
+            Header& operator=(const Header& /*other*/) noexcept {
+                return *this;
+            }
+
+            uint32_t count = 0;
+            uint32_t root_index = __GC_NOT_BUFFERED__;     // позиция в буфере кандидатов сборщика
+            int32_t trial = 0;                              // счётчик пробного вычитания ссылок
+            GcColor color = GcColor::Black;
+            bool pinned = false;                            // объект закреплён текущим циклом сборки
+            bool dirty = false;                             // объект получил новую ссылку во время цикла
+            bool traceable = false;                         // объект может ссылаться на другие объекты
+            bool immortal = false;                          // общий объект, см. ObjectHolder::Immortal
+        };
+
+        Header _header;
+    };
+
+    /*
+     * Объект, передаваемый в другой поток. Создаётся из единственного владеющего ObjectHolder
+     * и превращается обратно в ObjectHolder вызовом ObjectHolder::Adopt уже в принимающем потоке.
+     * Пока объект в пути, ни один поток не держит на него ссылок, поэтому неатомарный счётчик безопасен.
+     * Объекты, достижимые из передаваемого (элементы списка, поля экземпляра), тоже не должны
+     * разделяться с отправляющим потоком
+     */
+    class ObjectHandoff {
+    public:
+        ObjectHandoff(ObjectHandoff&& other) noexcept
+            : _object(std::exchange(other._object, nullptr))
+            , _owning(other._owning) {
+        }
+        ObjectHandoff& operator=(ObjectHandoff&& other) noexcept;
+        ObjectHandoff(const ObjectHandoff&) = delete;
+        ObjectHandoff& operator=(const ObjectHandoff&) = delete;
+
+        // Уничтожает объект, если его так и не приняли
+        ~ObjectHandoff();
+
+    private:
+        friend class ObjectHolder;
+
+        ObjectHandoff(Object* object, bool owning)
+            : _object(object)
+            , _owning(owning) {
+        }
+
+        Object* _object = nullptr;
+        bool _owning = true;    // неизменяемые общие объекты передаются без владения
     };
 
     // Специальный класс-обёртка, предназначенный для хранения объекта в Mython-программе
@@ -37,14 +147,53 @@ namespace runtime {
         // object копируется или перемещается в кучу
         template <typename T>
         [[nodiscard]] static ObjectHolder Own(T&& object) {
-            return ObjectHolder(std::make_shared<T>(std::forward<T>(object)));
+            // создание объекта - точка, в которой безопасно запустить сборку циклов
+            CycleCollector::MaybeCollect();
+            return ObjectHolder(new std::decay_t<T>(std::forward<T>(object)), true);
         }
 
-        // Создаёт ObjectHolder, не владеющий объектом (аналог слабой ссылки)
+        // Создаёт ObjectHolder на существующий объект. Если объект уже принадлежит владеющим ObjectHolder,
+        // новая ссылка тоже учитывается в его счётчике. Иначе (объект на стеке или в константе программы)
+        // ObjectHolder не владеет объектом и служит аналогом слабой ссылки
         [[nodiscard]] static ObjectHolder Share(Object& object);
         // Создаёт пустой ObjectHolder, соответствующий значению None
         [[nodiscard]] static ObjectHolder None();
 
+        // Создаёт невладеющий ObjectHolder на неизменяемый объект, живущий до конца программы.
+        // Такие объекты разделяются всеми потоками: их счётчик ссылок никогда не меняется
+        [[nodiscard]] static ObjectHolder Immortal(Object& object);
+
+        // Забирает объект единственного владеющего ObjectHolder для передачи в другой поток.
+        // Неизменяемый общий объект передаётся как есть.
+        // Выбрасывает runtime_error, если ObjectHolder не владеет объектом или объект разделён с другими
+        [[nodiscard]] ObjectHandoff Handoff() &&;
+        // Принимает переданный объект в текущем потоке
+        [[nodiscard]] static ObjectHolder Adopt(ObjectHandoff handoff);
+
+        // Копирование владеющего ObjectHolder увеличивает счётчик ссылок объекта
+        ObjectHolder(const ObjectHolder& other) noexcept
+            : data_(other.data_), owning_(other.owning_) {
+            Retain();
+        }
+        ObjectHolder(ObjectHolder&& other) noexcept
+            : data_(std::exchange(other.data_, nullptr)), owning_(std::exchange(other.owning_, false)) {
+        }
+        ObjectHolder& operator=(const ObjectHolder& other) noexcept {
+            // сначала захватываем новый объект и только потом отпускаем старый: освобождение старого
+            // объекта может уничтожить и сам other, если он хранится внутри
+            ObjectHolder copy(other);
+            Swap(copy);
+            return *this;
+        }
+        ObjectHolder& operator=(ObjectHolder&& other) noexcept {
+            ObjectHolder moved(std::move(other));
+            Swap(moved);
+            return *this;
+        }
+        ~ObjectHolder() {
+            Release();
+        }
+
         // Возвращает ссылку на Object внутри ObjectHolder.
         // ObjectHolder должен быть непустым
         Object& operator*() const;
@@ -63,16 +212,65 @@ namespace runtime {
         // Возвращает true, если ObjectHolder не пуст
         explicit operator bool() const;
 
+        // Возвращает тип хранимого значения, для пустого ObjectHolder - ObjectKind::None
+        [[nodiscard]] ObjectKind Kind() const {
+            return data_ != nullptr ? data_->Kind() : ObjectKind::None;
+        }
+
+        // Возвращает true, если ObjectHolder учитывается в счётчике ссылок объекта
+        [[nodiscard]] bool IsOwning() const {
+            return owning_;
+        }
+        // Возвращает true, если ObjectHolder ссылается на неизменяемый общий объект
+        [[nodiscard]] bool IsImmortal() const {
+            return data_ && data_->_header.immortal;
+        }
+
     private:
-        explicit ObjectHolder(std::shared_ptr<Object> data);
+        friend const NativeLayout& GetNativeLayout();
+
+        ObjectHolder(Object* data, bool owning) noexcept;
         void AssertIsValid() const;
 
-        std::shared_ptr<Object> data_;
+        void Retain() const noexcept {
+            if (owning_) {
+                ++data_->_header.count;
+            }
+        }
+        void Release() noexcept {
+            if (!owning_) {
+                return;
+            }
+            if (--data_->_header.count == 0) {
+                if (data_->_header.traceable) {
+                    // контейнер может повлечь цепочку удалений, её разворачивает Destroy
+                    Destroy(data_);
+                }
+                else {
+                    delete data_;
+                }
+            }
+            else if (data_->_header.traceable) {
+                // оставшиеся ссылки могут идти только из цикла
+                CycleCollector::PossibleRoot(*data_);
+            }
+        }
+        // Удаляет контейнер без рекурсии: объекты, освобождённые во время удаления, откладываются
+        // в очередь потока, поэтому длинная цепочка ссылок не переполняет стек
+        static void Destroy(Object* object) noexcept;
+        void Swap(ObjectHolder& other) noexcept {
+            std::swap(data_, other.data_);
+            std::swap(owning_, other.owning_);
+        }
+
+        Object* data_ = nullptr;
+        bool owning_ = false;   // невладеющий ObjectHolder не трогает счётчик ссылок
     };
 
-    // Объект-значение, хранящий значение типа T
+    // Объект-значение, хранящий значение типа T. Размещается через Heap, поэтому в поколенческом
+    // режиме временные значения выделяются в молодом поколении
     template <typename T>
-    class ValueObject : public Object {
+    class ValueObject : public Object, public HeapAllocated {
     public:
         ValueObject(T v)  // NOLINT(google-explicit-constructor,hicpp-explicit-conversions)
             : value_(v) {
@@ -82,6 +280,24 @@ namespace runtime {
             os << value_;
         }
 
+        [[nodiscard]] ObjectKind Kind() const override {
+            if constexpr (std::is_same_v<T, bool>) {
+                return ObjectKind::Bool;
+            }
+            else if constexpr (std::is_same_v<T, int64_t>) {
+                return ObjectKind::Number;
+            }
+            else if constexpr (std::is_same_v<T, double>) {
+                return ObjectKind::Float;
+            }
+            else if constexpr (std::is_same_v<T, BigInt>) {
+                return ObjectKind::BigNumber;
+            }
+            else {
+                return ObjectKind::Other;
+            }
+        }
+
         [[nodiscard]] const T& GetValue() const {
             return value_;
         }
@@ -90,11 +306,219 @@ namespace runtime {
         T value_;
     };
 
-    // Таблица символов, связывающая имя объекта с его значением
-    using Closure = std::unordered_map<std::string, ObjectHolder>;
+    // Число переменных, которые таблица символов хранит внутри себя без выделения памяти
+    constexpr size_t __CLOSURE_INLINE_SLOTS__ = 6;
+    // Размер таблицы, начиная с которого поиск имени идёт по хеш-индексу, а не перебором
+    constexpr size_t __CLOSURE_INDEX_THRESHOLD__ = 16;
+
+    /*
+     * Таблица символов, связывающая имя объекта с его значением. Служит и кадром вызова метода.
+     * Первые __CLOSURE_INLINE_SLOTS__ переменных лежат непрерывно внутри самой таблицы, поэтому кадр
+     * метода с небольшим числом параметров и локальных переменных размещается на стеке без выделения
+     * памяти: self занимает нулевую ячейку, параметры - следующие по порядку. Остальные переменные
+     * хранятся в std::deque. Имена - интернированные символы, поэтому небольшая таблица ищет имя
+     * перебором сравнений указателей, а крупная строит хеш-индекс.
+     * Ссылки на значения остаются действительными при добавлении новых переменных.
+     * Интерфейс повторяет используемую часть std::unordered_map
+     */
+    class Closure {
+    public:
+        using value_type = std::pair<const Symbol, ObjectHolder>;
+
+        template <bool IsConst>
+        class Iterator {
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = Closure::value_type;
+            using difference_type = std::ptrdiff_t;
+            using pointer = std::conditional_t<IsConst, const value_type*, value_type*>;
+            using reference = std::conditional_t<IsConst, const value_type&, value_type&>;
+            using Owner = std::conditional_t<IsConst, const Closure*, Closure*>;
+
+            Iterator() = default;
+            Iterator(Owner owner, size_t index)
+                : _owner(owner), _index(index) {
+            }
+            // неконстантный итератор приводится к константному
+            operator Iterator<true>() const {  // NOLINT(google-explicit-constructor,hicpp-explicit-conversions)
+                return Iterator<true>(_owner, _index);
+            }
+
+            reference operator*() const {
+                return _owner->Slot(_index);
+            }
+            pointer operator->() const {
+                return &_owner->Slot(_index);
+            }
+            Iterator& operator++() {
+                ++_index;
+                return *this;
+            }
+            Iterator operator++(int) {
+                Iterator previous = *this;
+                ++_index;
+                return previous;
+            }
+            bool operator==(const Iterator& other) const {
+                return _index == other._index && _owner == other._owner;
+            }
+            bool operator!=(const Iterator& other) const {
+                return !(*this == other);
+            }
+
+        private:
+            Owner _owner = nullptr;
+            size_t _index = 0;
+        };
+
+        using iterator = Iterator<false>;
+        using const_iterator = Iterator<true>;
+
+        Closure() = default;
+        Closure(std::initializer_list<value_type> items);
+        Closure(const Closure& other);
+        Closure(Closure&& other) noexcept;
+        Closure& operator=(const Closure& other);
+        Closure& operator=(Closure&& other) noexcept;
+        ~Closure();
+
+        // Возвращает значение переменной name, добавляя её со значением None при отсутствии
+        ObjectHolder& operator[](Symbol name);
+        // Возвращает значение переменной name. Если переменной нет, выбрасывает out_of_range
+        ObjectHolder& at(Symbol name);
+        const ObjectHolder& at(Symbol name) const;
+
+        [[nodiscard]] iterator find(Symbol name);
+        [[nodiscard]] const_iterator find(Symbol name) const;
+        [[nodiscard]] size_t count(Symbol name) const;
+        // Ищет переменную name, проверяя сначала ячейку hint, в которой она нашлась в прошлый раз.
+        // Возвращает указатель на значение либо nullptr и запоминает в hint найденную ячейку.
+        // Ячейки не переставляются, поэтому у кадров одного метода подсказка обычно верна с первой проверки
+        [[nodiscard]] ObjectHolder* FindHinted(Symbol name, uint32_t& hint) {
+            if (hint < _size && Slot(hint).first == name) {
+                return &Slot(hint).second;
+            }
+            const size_t index = IndexOf(name);
+            if (index == _size) {
+                return nullptr;
+            }
+            hint = static_cast<uint32_t>(index);
+            return &Slot(index).second;
+        }
+        // Добавляет переменную, если её ещё нет. Возвращает итератор на переменную и признак добавления
+        std::pair<iterator, bool> insert(value_type item);
+
+        // Добавляет переменную без поиска. Переменной с именем name в таблице быть не должно
+        void Append(Symbol name, ObjectHolder value);
+
+        [[nodiscard]] iterator begin() {
+            return { this, 0 };
+        }
+        [[nodiscard]] iterator end() {
+            return { this, _size };
+        }
+        [[nodiscard]] const_iterator begin() const {
+            return { this, 0 };
+        }
+        [[nodiscard]] const_iterator end() const {
+            return { this, _size };
+        }
+
+        [[nodiscard]] size_t size() const {
+            return _size;
+        }
+        [[nodiscard]] bool empty() const {
+            return _size == 0;
+        }
+        void clear() noexcept;
+        void swap(Closure& other) noexcept;
+
+        // Запоминает результат инструкции return. Составные инструкции и циклы прекращают выполнение,
+        // пока результат не заберёт тело метода
+        void SetReturnValue(ObjectHolder value) {
+            _return_value = std::move(value);
+            _returning = true;
+        }
+        // Возвращает true, если в этом кадре выполнена инструкция return
+        [[nodiscard]] bool IsReturning() const {
+            return _returning;
+        }
+        // Забирает результат инструкции return
+        ObjectHolder TakeReturnValue() {
+            _returning = false;
+            return std::move(_return_value);
+        }
+
+    private:
+        friend const NativeLayout& GetNativeLayout();
+
+        value_type& Slot(size_t index) {
+            return index < __CLOSURE_INLINE_SLOTS__
+                ? reinterpret_cast<value_type*>(_inline)[index]
+                : (*_overflow)[index - __CLOSURE_INLINE_SLOTS__];
+        }
+        const value_type& Slot(size_t index) const {
+            return const_cast<Closure*>(this)->Slot(index);
+        }
+        // Возвращает индекс переменной name либо _size, если её нет
+        size_t IndexOf(Symbol name) const;
+        // Забирает содержимое other. Таблица должна быть пустой
+        void StealFrom(Closure& other) noexcept;
+
+        alignas(value_type) unsigned char _inline[__CLOSURE_INLINE_SLOTS__ * sizeof(value_type)];
+        size_t _size = 0;
+        std::unique_ptr<std::deque<value_type>> _overflow;                  // переменные после встроенных
+        std::unique_ptr<std::unordered_map<Symbol, size_t>> _index;         // индекс крупной таблицы
+        ObjectHolder _return_value;
+        bool _returning = false;
+    };
+
+    /*
+     * Смещения служебных полей в байтах. По ним машинный код jit читает и переписывает ObjectHolder,
+     * счётчик ссылок объекта и встроенные ячейки таблицы символов без вызова функций
+     */
+    struct NativeLayout {
+        size_t holder_data = 0;         // Object* внутри ObjectHolder
+        size_t holder_owning = 0;       // признак владения внутри ObjectHolder
+        size_t object_count = 0;        // поля заголовка от начала Object
+        size_t object_pinned = 0;
+        size_t object_traceable = 0;
+        size_t closure_slots = 0;       // первая встроенная ячейка от начала Closure
+        size_t closure_size = 0;        // число переменных Closure
+        size_t slot_name = 0;           // Symbol внутри ячейки Closure::value_type
+        size_t slot_value = 0;          // ObjectHolder внутри ячейки
+    };
+
+    // Сообщение об обращении к отсутствующей переменной или полю. Общее для всех способов выполнения
+    constexpr const char* __UNDEFINED_VARIABLE_ERROR__ = "here is not a variable whit current name";
+    // Сообщение об изменении размера словаря, по которому идёт цикл for
+    constexpr const char* __DICT_CHANGED_SIZE_ERROR__ = "dictionary changed size during iteration";
+
+    // Глубина вложенных вызовов методов по умолчанию
+    constexpr size_t __DEFAULT_RECURSION_LIMIT__ = 1000;
+
+    // Исключение при превышении глубины вложенных вызовов методов
+    class RecursionError : public std::runtime_error {
+    public:
+        using std::runtime_error::runtime_error;
+    };
+
+    // Задаёт наибольшую глубину вложенных вызовов методов Mython в текущем потоке. Более глубокий вызов
+    // выбрасывает RecursionError вместо переполнения стека
+    void SetRecursionLimit(size_t limit);
+    [[nodiscard]] size_t GetRecursionLimit();
+
+    struct Method;
+
+    // Обработчик горячего метода. Вызывается при каждом вызове метода, число вызовов которого не меньше порога,
+    // поэтому должен быстро пропускать уже обработанные методы
+    using TierUpHandler = void (*)(const Method& method);
+
+    // Задаёт в текущем потоке обработчик горячих методов и порог числа вызовов. nullptr отключает обработчик
+    void SetTierUp(TierUpHandler handler, uint64_t threshold);
 
     // Проверяет, содержится ли в object значение, приводимое к True
-    // Для отличных от нуля чисел, True и непустых строк возвращается true. В остальных случаях - false.
+    // Для отличных от нуля чисел, True, непустых строк, списков и словарей возвращается true. В остальных случаях - false.
     bool IsTrue(const ObjectHolder& object);
 
     // Интерфейс для выполнения действий над объектами Mython
@@ -106,10 +530,73 @@ namespace runtime {
         virtual ObjectHolder Execute(Closure& closure, Context& context) = 0;
     };
 
-    // Строковое значение
-    using String = ValueObject<std::string>;
-    // Числовое значение
-    using Number = ValueObject<int>;
+    /*
+     * Строковое значение. Строка - префикс длины _size общего буфера, поэтому значение никогда не меняется.
+     * Конкатенация строки, владеющей концом буфера, дописывает правую часть в тот же буфер на месте,
+     * так что накопление s = s + x стоит амортизированно O(|x|), а не O(|s|).
+     * Копия нужна только для строки, чей буфер уже продолжен другой строкой.
+     * Интернированные строки с равным текстом разделяют один неизменяемый буфер и заранее вычисленный хеш,
+     * поэтому сравниваются по адресу буфера
+     */
+    class String : public Object, public HeapAllocated {
+    public:
+        String(std::string value = {});  // NOLINT(google-explicit-constructor,hicpp-explicit-conversions)
+
+        // Возвращает интернированную строку с текстом value. Таблица интернирования живёт до конца программы,
+        // поэтому в неё попадают только литералы программы и односимвольные строки, получаемые при исполнении
+        [[nodiscard]] static String Intern(std::string_view value);
+
+        // Возвращает строку lhs + rhs. Если буфер lhs не разделён с другими строками и его значение
+        // не выдавалось через GetValue, rhs дописывается в этот буфер без копирования lhs
+        [[nodiscard]] static String Concat(const String& lhs, const String& rhs);
+
+        // Выводит в os содержимое строки без копирования
+        void Print(std::ostream& os, Context& context) override;
+
+        [[nodiscard]] ObjectKind Kind() const override {
+            return ObjectKind::String;
+        }
+
+        // Возвращает значение строки. Если буфер уже продолжен другой строкой, сначала отделяет
+        // собственную копию. После вызова буфер строки больше не дописывается, и ссылка действительна,
+        // пока жива строка
+        [[nodiscard]] const std::string& GetValue() const;
+
+        // Возвращает представление строки без копирования, действительное до следующей конкатенации
+        // с этой строкой слева
+        [[nodiscard]] std::string_view View() const;
+
+        // Возвращает длину строки
+        [[nodiscard]] size_t Size() const;
+
+        // Возвращает true, если строка взята из таблицы интернирования
+        [[nodiscard]] bool IsInterned() const;
+
+        // Возвращает хеш строки, вычисляемый один раз при первом обращении
+        [[nodiscard]] size_t Hash() const;
+
+        // Сравнивает строки. Общий буфер, разная длина и разные хеши решают сравнение без просмотра символов
+        [[nodiscard]] bool Equals(const String& other) const;
+        [[nodiscard]] bool Less(const String& other) const;
+
+    private:
+        String(std::shared_ptr<std::string> buffer, size_t size);
+
+        // Находит или добавляет строку в таблицу интернирования
+        static String InternTable(std::string_view value);
+
+        mutable std::shared_ptr<std::string> _buffer;   // общий буфер, значение строки - его префикс
+        size_t _size = 0;                                // длина строки
+        mutable size_t _hash = 0;                        // хеш значения, если _has_hash
+        mutable bool _has_hash = false;
+        bool _interned = false;                          // буфер принадлежит таблице и никогда не дописывается
+        mutable bool _pinned = false;                    // GetValue выдал ссылку на буфер, его нельзя дописывать
+    };
+    // Числовое значение, помещающееся в 64 бита
+    using Number = ValueObject<int64_t>;
+    // Целое значение произвольной точности. Создаётся только при выходе результата за пределы int64_t,
+    // поэтому число, помещающееся в Number, всегда хранится как Number
+    using BigNumber = ValueObject<BigInt>;
 
     // Логическое значение
     class Bool : public ValueObject<bool> {
@@ -119,14 +606,32 @@ namespace runtime {
         void Print(std::ostream& os, Context& context) override;
     };
 
+    // Число с плавающей точкой двойной точности
+    class Float : public ValueObject<double> {
+    public:
+        using ValueObject<double>::ValueObject;
+
+        // Выводит кратчайшую запись, однозначно восстанавливающую значение, например "0.1" или "1e+100".
+        // Целые значения выводятся с ".0", чтобы отличаться от Number
+        void Print(std::ostream& os, Context& context) override;
+    };
+
+    // Имя, под которым метод видит вызвавший его объект. Общее для всех способов выполнения
+    extern const Symbol __SELF_NAME__;
+    // Имя конструктора экземпляров класса
+    extern const Symbol __INIT_METHOD__;
+
     // Метод класса
     struct Method {
         // Имя метода
-        std::string name;
+        Symbol name;
         // Имена формальных параметров метода
-        std::vector<std::string> formal_params;
+        std::vector<Symbol> formal_params;
         // Тело метода
         std::unique_ptr<Executable> body;
+        // Число вызовов метода, по которому он признаётся горячим. Неатомарный счётчик в общем описании
+        // класса: методы класса вызываются из одного потока
+        mutable uint64_t calls = 0;
     };
 
     // Класс
@@ -142,17 +647,25 @@ namespace runtime {
         explicit Class(std::string name, std::vector<Method> methods, const Class* parent);
 
         // Возвращает указатель на метод name или nullptr, если метод с таким именем отсутствует
-        [[nodiscard]] const Method* GetMethod(const std::string& name) const;
+        [[nodiscard]] const Method* GetMethod(Symbol name) const;
 
         // Возвращает имя класса
         [[nodiscard]] const std::string& GetName() const;
 
+        // Возвращает собственные методы класса для замены их тел. Класс общий для дерева программы
+        // и всех способов выполнения: bytecode::CompileProgram и regvm::CompileProgram заменяют тела
+        // скомпилированными на месте, и после этого методы выполняет машина, в том числе при вызове из дерева
+        [[nodiscard]] std::vector<Method>& GetMethods();
+
+        // Возвращает родительский класс или nullptr, если класс базовый
+        [[nodiscard]] const Class* GetParent() const;
+
         // Выводит в os строку "Class <имя класса>", например "Class cat"
         void Print(std::ostream& os, [[maybe_unused]] Context& context) override;
     };
 
-    // Экземпляр класса
-    class ClassInstance : public Object {
+    // Экземпляр класса. Размещается через Heap, как и объекты-значения
+    class ClassInstance : public Object, public HeapAllocated {
     private:
         const Class& _base_class;
         Closure _instance_closure;
@@ -165,22 +678,223 @@ namespace runtime {
          */
         void Print(std::ostream& os, Context& context) override;
 
+        [[nodiscard]] ObjectKind Kind() const override {
+            return ObjectKind::Instance;
+        }
+
         /*
          * Вызывает у объекта метод method, передавая ему actual_args параметров.
          * Параметр context задаёт контекст для выполнения метода.
          * Если ни сам класс, ни его родители не содержат метод method, метод выбрасывает исключение
          * runtime_error
          */
-        ObjectHolder Call(const std::string& method, const std::vector<ObjectHolder>& actual_args,
+        ObjectHolder Call(Symbol method, const std::vector<ObjectHolder>& actual_args,
                           Context& context);
+        // То же, но count аргументов лежат подряд начиная с args, например на стеке виртуальной машины
+        ObjectHolder Call(Symbol method, const ObjectHolder* args, size_t count, Context& context);
+        /*
+         * То же, но аргументы - выражения args, которые вычисляются в таблице символов caller
+         * прямо в ячейки параметров кадра метода. Кадр с self и параметрами размещается на стеке,
+         * поэтому сам вызов не выделяет память
+         */
+        ObjectHolder Call(Symbol method, const std::vector<std::unique_ptr<Executable>>& args,
+                          Closure& caller, Context& context);
 
         // Возвращает true, если объект имеет метод method, принимающий argument_count параметров
-        [[nodiscard]] bool HasMethod(const std::string& method, size_t argument_count) const;
+        [[nodiscard]] bool HasMethod(Symbol method, size_t argument_count) const;
 
         // Возвращает ссылку на Closure, содержащий поля объекта
         [[nodiscard]] Closure& Fields();
         // Возвращает константную ссылку на Closure, содержащую поля объекта
         [[nodiscard]] const Closure& Fields() const;
+
+    protected:
+        void ForEachReference(const std::function<void(const ObjectHolder&)>& visit) override;
+        void ClearReferences() override;
+    };
+
+    // Список значений, элементы хранятся в непрерывном массиве
+    class List : public Object, public HeapAllocated {
+    private:
+        std::vector<ObjectHolder> _items = {};
+    public:
+        List();
+        explicit List(std::vector<ObjectHolder> items);
+
+        // Выводит в os элементы списка в виде "[1, 2, 3]"
+        void Print(std::ostream& os, Context& context) override;
+
+        /*
+         * Вызывает встроенный метод списка method, передавая ему actual_args параметров.
+         * Поддерживается метод append(item), добавляющий элемент в конец списка.
+         * Для остальных методов выбрасывается исключение runtime_error
+         */
+        ObjectHolder Call(Symbol method, const std::vector<ObjectHolder>& actual_args,
+                          Context& context);
+
+        // Добавляет элемент в конец списка, амортизированно за O(1)
+        void Append(ObjectHolder item);
+
+        // Возвращает количество элементов списка
+        [[nodiscard]] size_t Size() const;
+
+        // Возвращает ссылку на элемент по индексу, отрицательный индекс отсчитывается с конца.
+        // При выходе за границы списка выбрасывает исключение runtime_error
+        ObjectHolder& At(int64_t index);
+
+        /*
+         * Сортирует список на месте по возрастанию интроспективной сортировкой, сортировка не стабильна.
+         * Если задано имя key, элементы сравниваются по результату одноимённого метода без параметров
+         * либо по значению одноимённого поля. Ключи только из чисел или только из строк сравниваются
+         * напрямую, остальные - через Less с вызовом __lt__
+         */
+        void Sort(Context& context, Symbol key = {});
+
+        // Возвращает ссылку на массив элементов списка
+        [[nodiscard]] std::vector<ObjectHolder>& Values();
+        // Возвращает константную ссылку на массив элементов списка
+        [[nodiscard]] const std::vector<ObjectHolder>& Values() const;
+    protected:
+        void ForEachReference(const std::function<void(const ObjectHolder&)>& visit) override;
+        void ClearReferences() override;
+    };
+
+    /*
+     * Словарь - хеш-таблица с открытой адресацией.
+     * Управляющие байты таблицы хранят 7 бит хеша и просматриваются группами по 16 за одно сравнение,
+     * сами пары ключ-значение лежат в отдельном массиве в порядке вставки.
+     * Ключами могут быть числа, строки, значения Bool, None и экземпляры классов
+     */
+    class Dict : public Object, public HeapAllocated {
+    public:
+        // Запись словаря вместе с полным хешем ключа
+        struct Entry {
+            size_t hash = 0;
+            ObjectHolder key;
+            ObjectHolder value;
+        };
+
+        Dict();
+
+        // Выводит в os содержимое словаря в виде "{key: value, ...}" в порядке вставки
+        void Print(std::ostream& os, Context& context) override;
+
+        /*
+         * Вызывает встроенный метод словаря method, передавая ему actual_args параметров.
+         * Поддерживаются методы keys(), values() и get(key[, default]).
+         * Для остальных методов выбрасывается исключение runtime_error
+         */
+        ObjectHolder Call(Symbol method, const std::vector<ObjectHolder>& actual_args,
+                          Context& context);
+
+        // Возвращает указатель на значение по ключу key либо nullptr, если ключ отсутствует
+        [[nodiscard]] ObjectHolder* Find(const ObjectHolder& key, Context& context);
+
+        // Возвращает true, если словарь содержит ключ key
+        [[nodiscard]] bool Contains(const ObjectHolder& key, Context& context);
+
+        // Возвращает ссылку на значение по ключу key. Если ключ отсутствует, выбрасывает runtime_error
+        ObjectHolder& At(const ObjectHolder& key, Context& context);
+
+        // Записывает значение value по ключу key, добавляя ключ при необходимости
+        void Set(ObjectHolder key, ObjectHolder value, Context& context);
+
+        // Возвращает количество записей словаря
+        [[nodiscard]] size_t Size() const;
+
+        // Возвращает записи словаря в порядке вставки
+        [[nodiscard]] const std::vector<Entry>& Entries() const;
+
+    protected:
+        void ForEachReference(const std::function<void(const ObjectHolder&)>& visit) override;
+        void ClearReferences() override;
+
+    private:
+        // Возвращает индекс записи с ключом key в _entries либо _entries.size(), если ключ отсутствует
+        size_t FindEntry(const ObjectHolder& key, size_t hash, Context& context) const;
+        // Заносит индекс записи entry_index в первый свободный слот последовательности проб хеша hash
+        void InsertSlot(size_t hash, uint32_t entry_index);
+        // Перестраивает таблицу на group_count групп управляющих байтов
+        void Rehash(size_t group_count);
+
+        std::vector<int8_t> _control = {};        // управляющие байты, по одному на слот
+        std::vector<uint32_t> _slots = {};        // индексы записей в _entries
+        std::vector<Entry> _entries = {};         // записи в порядке вставки
+    };
+
+    /*
+     * Типизированный массив целых чисел. Значения хранятся непрерывно как int64_t без упаковки в объекты,
+     * поэтому массовые операции (sum, min, max, dot, add, mul, fill) выполняются векторными ядрами
+     */
+    class IntArray : public Object, public HeapAllocated {
+    private:
+        std::vector<int64_t> _values = {};
+    public:
+        IntArray() = default;
+        explicit IntArray(std::vector<int64_t> values);
+
+        // Выводит в os элементы массива в виде "[1, 2, 3]"
+        void Print(std::ostream& os, Context& context) override;
+
+        /*
+         * Вызывает встроенный метод массива method, передавая ему actual_args параметров.
+         * Поддерживаются методы sum(), min(), max(), dot(other), add(other), mul(other), fill(value)
+         * и append(value). Методы add и mul изменяют массив на месте и принимают либо массив той же длины,
+         * либо число. sum и dot, как и арифметика Number, при выходе за 64 бита возвращают BigNumber,
+         * а add и mul в этом случае выбрасывают исключение runtime_error, не изменяя массив.
+         * Для остальных методов и неверных аргументов выбрасывается исключение runtime_error
+         */
+        ObjectHolder Call(Symbol method, const std::vector<ObjectHolder>& actual_args,
+                          Context& context);
+
+        // Возвращает количество элементов массива
+        [[nodiscard]] size_t Size() const;
+
+        // Возвращает ссылку на элемент по индексу, отрицательный индекс отсчитывается с конца.
+        // При выходе за границы массива выбрасывает исключение runtime_error
+        int64_t& At(int64_t index);
+
+        // Возвращает ссылку на массив значений
+        [[nodiscard]] std::vector<int64_t>& Values();
+        // Возвращает константную ссылку на массив значений
+        [[nodiscard]] const std::vector<int64_t>& Values() const;
+    };
+
+    /*
+     * Типизированный массив чисел с плавающей точкой. Значения хранятся непрерывно как double и
+     * поддерживают те же массовые операции, что и IntArray. Элементы читаются как Float, а записываются
+     * из любого числа
+     */
+    class FloatArray : public Object, public HeapAllocated {
+    private:
+        std::vector<double> _values = {};
+    public:
+        FloatArray() = default;
+        explicit FloatArray(std::vector<double> values);
+
+        // Выводит в os элементы массива в виде "[1.0, 2.5]"
+        void Print(std::ostream& os, Context& context) override;
+
+        /*
+         * Вызывает встроенный метод массива method, передавая ему actual_args параметров.
+         * Поддерживаются методы sum(), min(), max(), dot(other), add(other), mul(other), fill(value)
+         * и append(value). Методы add и mul изменяют массив на месте и принимают либо FloatArray той же
+         * длины, либо число. Для остальных методов и неверных аргументов выбрасывается исключение runtime_error
+         */
+        ObjectHolder Call(Symbol method, const std::vector<ObjectHolder>& actual_args,
+                          Context& context);
+
+        // Возвращает количество элементов массива
+        [[nodiscard]] size_t Size() const;
+
+        // Возвращает ссылку на элемент по индексу, отрицательный индекс отсчитывается с конца.
+        // При выходе за границы массива выбрасывает исключение runtime_error
+        double& At(int64_t index);
+
+        // Возвращает ссылку на массив значений
+        [[nodiscard]] std::vector<double>& Values();
+        // Возвращает константную ссылку на массив значений
+        [[nodiscard]] const std::vector<double>& Values() const;
     };
 
     /*
@@ -202,15 +916,108 @@ namespace runtime {
      * Параметр context задаёт контекст для выполнения метода __lt__
      */
     bool Less(const ObjectHolder& lhs, const ObjectHolder& rhs, Context& context);
+    /*
+     * Возвращает хеш значения object для использования в качестве ключа словаря.
+     * Для экземпляров классов вызывается метод __hash__, результат которого должен быть числом.
+     * Экземпляры без методов __hash__ и __eq__ хешируются по адресу.
+     * Для остальных значений (списки, словари, экземпляры с __eq__ без __hash__)
+     * выбрасывается исключение runtime_error
+     */
+    size_t Hash(const ObjectHolder& object, Context& context);
+
+    /*
+     * Возвращает true, если lhs и rhs равны как ключи словаря.
+     * В отличие от Equal, не выбрасывает исключение для значений разных типов, а считает их различными.
+     * Экземпляры классов без метода __eq__ равны только самим себе
+     */
+    bool EqualKeys(const ObjectHolder& lhs, const ObjectHolder& rhs, Context& context);
+
+    // Возвращает true, если object хранит целое число (Number или BigNumber)
+    bool IsInteger(const ObjectHolder& object);
+
+    // Возвращает true, если object хранит число: Number, BigNumber или Float
+    bool IsNumeric(const ObjectHolder& object);
+
+    // Возвращает значение числа object в виде double, object должен хранить Number, BigNumber или Float
+    double ToDouble(const ObjectHolder& object);
+
+    // Наименьшее и наибольшее значения Number, объекты которых созданы заранее и разделяются
+    constexpr int64_t __SMALL_INT_MIN__ = -256;
+    constexpr int64_t __SMALL_INT_MAX__ = 1024;
+
+    // Возвращает общий объект True или False. Объект неизменяем и не требует выделения памяти
+    [[nodiscard]] ObjectHolder MakeBool(bool value);
+    // Возвращает Number со значением value. Значения из [__SMALL_INT_MIN__, __SMALL_INT_MAX__]
+    // берутся из кеша общих объектов, остальные выделяются в куче
+    [[nodiscard]] ObjectHolder MakeNumber(int64_t value);
+    // Упаковывает value в Number, если оно помещается в 64 бита, иначе в BigNumber
+    ObjectHolder MakeInteger(const BigInt& value);
+
+    /*
+     * Целочисленная арифметика над Number и BigNumber. Если оба аргумента - Number, результат вычисляется
+     * в int64_t с проверкой переполнения, при переполнении вычисление повторяется с произвольной точностью.
+     * Аргументы должны быть целыми числами. IntegerDiv отбрасывает дробную часть и выбрасывает
+     * исключение runtime_error при делении на ноль
+     */
+    ObjectHolder IntegerAdd(const ObjectHolder& lhs, const ObjectHolder& rhs);
+    ObjectHolder IntegerSub(const ObjectHolder& lhs, const ObjectHolder& rhs);
+    ObjectHolder IntegerMul(const ObjectHolder& lhs, const ObjectHolder& rhs);
+    ObjectHolder IntegerDiv(const ObjectHolder& lhs, const ObjectHolder& rhs);
+
+    // Арифметическая операция
+    enum class ArithmeticOp : uint8_t {
+        Add,
+        Sub,
+        Mult,
+        Div,
+    };
+
+    /*
+     * Возвращает значение lhs op rhs. Числа складываются, вычитаются, умножаются и делятся, целые - без
+     * потери точности, деление на ноль выбрасывает исключение. Сложение также склеивает строки и вызывает
+     * метод __add__ экземпляра класса lhs. Для остальных аргументов выбрасывается исключение runtime_error
+     */
+    ObjectHolder Arithmetic(ArithmeticOp op, const ObjectHolder& lhs, const ObjectHolder& rhs, Context& context);
+
+    // То же над значениями двух Number, для узлов, уже проверивших типы аргументов
+    ObjectHolder NumberAdd(int64_t lhs, int64_t rhs);
+    ObjectHolder NumberSub(int64_t lhs, int64_t rhs);
+    ObjectHolder NumberMul(int64_t lhs, int64_t rhs);
+    ObjectHolder NumberDiv(int64_t lhs, int64_t rhs);
+
+    // Оператор сравнения
+    enum class CompareOp : uint8_t {
+        Less,
+        LessOrEqual,
+        Greater,
+        GreaterOrEqual,
+        Equal,
+        NotEqual,
+    };
+
+    /*
+     * Возвращает значение lhs op rhs. Пары значений Bool, Number, BigNumber, Float и String сравниваются
+     * за один шаг функцией, выбранной из таблицы по паре типов аргументов. Остальные пары, в том числе
+     * экземпляры классов с методами __lt__ и __eq__, сравниваются через Less и Equal
+     */
+    bool Compare(CompareOp op, const ObjectHolder& lhs, const ObjectHolder& rhs, Context& context);
+
     // Возвращает значение, противоположное Equal(lhs, rhs, context)
     bool NotEqual(const ObjectHolder& lhs, const ObjectHolder& rhs, Context& context);
-    // Возвращает значение lhs>rhs, используя функции Equal и Less
+    // Возвращает значение lhs>rhs, для экземпляров классов используя функции Equal и Less
     bool Greater(const ObjectHolder& lhs, const ObjectHolder& rhs, Context& context);
-    // Возвращает значение lhs<=rhs, используя функции Equal и Less
+    // Возвращает значение lhs<=rhs, для экземпляров классов используя функции Equal и Less
     bool LessOrEqual(const ObjectHolder& lhs, const ObjectHolder& rhs, Context& context);
     // Возвращает значение, противоположное Less(lhs, rhs, context)
     bool GreaterOrEqual(const ObjectHolder& lhs, const ObjectHolder& rhs, Context& context);
 
+    /*
+     * Копирует граф объектов object в кучу режима arena.OuterMode(), чтобы он пережил арену выполнения.
+     * Значения, экземпляры классов, списки, словари и массивы копируются, в том числе вместе с циклами
+     * между ними; классы и None не копируются. Параметр context нужен для хеширования ключей словарей
+     */
+    [[nodiscard]] ObjectHolder CopyOut(const ObjectHolder& object, const ExecutionArena& arena, Context& context);
+
     // Контекст-заглушка, применяется в тестах.
     // В этом контексте весь вывод перенаправляется в строковый поток вывода output
     struct DummyContext : Context {
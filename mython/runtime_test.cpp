@@ -1,7 +1,10 @@
 ﻿#include "runtime.h"
 #include "test_runner_p.h"
 
+#include <algorithm>
 #include <functional>
+#include <limits>
+#include <thread>
 
 using namespace std;
 
@@ -121,24 +124,24 @@ void TestMethodInvocation() {
     };
     vector<Method> base_methods;
     base_methods.push_back(
-        {"test"s, {"arg1"s, "arg2"s}, make_unique<TestMethodBody>(base_method_1)});
-    base_methods.push_back({"test_2"s, {"arg1"s}, make_unique<TestMethodBody>(base_method_2)});
+        {Symbol("test"), {Symbol("arg1"), Symbol("arg2")}, make_unique<TestMethodBody>(base_method_1)});
+    base_methods.push_back({Symbol("test_2"), {Symbol("arg1")}, make_unique<TestMethodBody>(base_method_2)});
     Class base_class{"Base"s, std::move(base_methods), nullptr};
     ClassInstance base_inst{base_class};
-    base_inst.Fields()["base_field"s] = ObjectHolder::Own(String{"hello"s});
-    ASSERT(base_inst.HasMethod("test"s, 2U));
+    base_inst.Fields()[Symbol("base_field")] = ObjectHolder::Own(String{"hello"s});
+    ASSERT(base_inst.HasMethod(Symbol("test"), 2U));
     auto res = base_inst.Call(
-        "test"s, {ObjectHolder::Own(Number{1}), ObjectHolder::Own(String{"abc"s})}, context);
+        Symbol("test"), {ObjectHolder::Own(Number{1}), ObjectHolder::Own(String{"abc"s})}, context);
     ASSERT(Equal(res, ObjectHolder::Own(Number{123}), context));
     ASSERT_EQUAL(base_closure.size(), 3U);
-    ASSERT_EQUAL(base_closure.count("self"s), 1U);
-    ASSERT_EQUAL(base_closure.at("self"s).Get(), &base_inst);
-    ASSERT_EQUAL(base_closure.count("self"s), 1U);
-    ASSERT_EQUAL(base_closure.count("arg1"s), 1U);
-    ASSERT(Equal(base_closure.at("arg1"s), ObjectHolder::Own(Number{1}), context));
-    ASSERT_EQUAL(base_closure.count("arg2"s), 1U);
-    ASSERT(Equal(base_closure.at("arg2"s), ObjectHolder::Own(String{"abc"s}), context));
-    ASSERT_EQUAL(base_closure.count("base_field"s), 0U);
+    ASSERT_EQUAL(base_closure.count(Symbol("self")), 1U);
+    ASSERT_EQUAL(base_closure.at(Symbol("self")).Get(), &base_inst);
+    ASSERT_EQUAL(base_closure.count(Symbol("self")), 1U);
+    ASSERT_EQUAL(base_closure.count(Symbol("arg1")), 1U);
+    ASSERT(Equal(base_closure.at(Symbol("arg1")), ObjectHolder::Own(Number{1}), context));
+    ASSERT_EQUAL(base_closure.count(Symbol("arg2")), 1U);
+    ASSERT(Equal(base_closure.at(Symbol("arg2")), ObjectHolder::Own(String{"abc"s}), context));
+    ASSERT_EQUAL(base_closure.count(Symbol("base_field")), 0U);
 
     Closure child_closure;
     auto child_method_1 = [&child_closure, &context](Closure& closure, Context& ctx) {
@@ -148,36 +151,36 @@ void TestMethodInvocation() {
     };
     vector<Method> child_methods;
     child_methods.push_back(
-        {"test"s, {"arg1_child"s, "arg2_child"s}, make_unique<TestMethodBody>(child_method_1)});
+        {Symbol("test"), {Symbol("arg1_child"), Symbol("arg2_child")}, make_unique<TestMethodBody>(child_method_1)});
     Class child_class{"Child"s, std::move(child_methods), &base_class};
     ClassInstance child_inst{child_class};
-    ASSERT(child_inst.HasMethod("test"s, 2U));
+    ASSERT(child_inst.HasMethod(Symbol("test"), 2U));
     base_closure.clear();
     res = child_inst.Call(
-        "test"s, {ObjectHolder::Own(String{"value1"s}), ObjectHolder::Own(String{"value2"s})},
+        Symbol("test"), {ObjectHolder::Own(String{"value1"s}), ObjectHolder::Own(String{"value2"s})},
         context);
     ASSERT(Equal(res, ObjectHolder::Own(String{"child"s}), context));
     ASSERT(base_closure.empty());
     ASSERT_EQUAL(child_closure.size(), 3U);
-    ASSERT_EQUAL(child_closure.count("self"s), 1U);
-    ASSERT_EQUAL(child_closure.at("self"s).Get(), &child_inst);
-    ASSERT_EQUAL(child_closure.count("arg1_child"s), 1U);
-    ASSERT(Equal(child_closure.at("arg1_child"s), (ObjectHolder::Own(String{"value1"s})), context));
-    ASSERT_EQUAL(child_closure.count("arg2_child"s), 1U);
-    ASSERT(Equal(child_closure.at("arg2_child"s), (ObjectHolder::Own(String{"value2"s})), context));
-
-    ASSERT(child_inst.HasMethod("test_2"s, 1U));
+    ASSERT_EQUAL(child_closure.count(Symbol("self")), 1U);
+    ASSERT_EQUAL(child_closure.at(Symbol("self")).Get(), &child_inst);
+    ASSERT_EQUAL(child_closure.count(Symbol("arg1_child")), 1U);
+    ASSERT(Equal(child_closure.at(Symbol("arg1_child")), (ObjectHolder::Own(String{"value1"s})), context));
+    ASSERT_EQUAL(child_closure.count(Symbol("arg2_child")), 1U);
+    ASSERT(Equal(child_closure.at(Symbol("arg2_child")), (ObjectHolder::Own(String{"value2"s})), context));
+
+    ASSERT(child_inst.HasMethod(Symbol("test_2"), 1U));
     child_closure.clear();
-    res = child_inst.Call("test_2"s, {ObjectHolder::Own(String{":)"s})}, context);
+    res = child_inst.Call(Symbol("test_2"), {ObjectHolder::Own(String{":)"s})}, context);
     ASSERT(Equal(res, ObjectHolder::Own(Number{456}), context));
     ASSERT_EQUAL(base_closure.size(), 2U);
-    ASSERT_EQUAL(base_closure.count("self"s), 1U);
-    ASSERT_EQUAL(base_closure.at("self"s).Get(), &child_inst);
-    ASSERT_EQUAL(base_closure.count("arg1"s), 1U);
-    ASSERT(Equal(base_closure.at("arg1"s), (ObjectHolder::Own(String{":)"s})), context));
+    ASSERT_EQUAL(base_closure.count(Symbol("self")), 1U);
+    ASSERT_EQUAL(base_closure.at(Symbol("self")).Get(), &child_inst);
+    ASSERT_EQUAL(base_closure.count(Symbol("arg1")), 1U);
+    ASSERT(Equal(base_closure.at(Symbol("arg1")), (ObjectHolder::Own(String{":)"s})), context));
 
-    ASSERT(!child_inst.HasMethod("test"s, 1U));
-    ASSERT_THROWS(child_inst.Call("test"s, {ObjectHolder::None()}, context), runtime_error);
+    ASSERT(!child_inst.HasMethod(Symbol("test"), 1U));
+    ASSERT_THROWS(child_inst.Call(Symbol("test"), {ObjectHolder::None()}, context), runtime_error);
 }
 
 void TestNonowning() {
@@ -248,6 +251,374 @@ void TestNullptr() {
     ASSERT(!oh.Get());
 }
 
+void TestCopies() {
+    ASSERT_EQUAL(Logger::instance_count, 0);
+    {
+        auto one = ObjectHolder::Own(Logger(5));
+        ObjectHolder two = one;
+        ObjectHolder three;
+        three = two;
+        // присваивание самому себе не уничтожает объект
+        three = *&three;
+        ASSERT_EQUAL(Logger::instance_count, 1);
+        ASSERT(one.Get() == three.Get());
+
+        one = ObjectHolder::None();
+        two = ObjectHolder::Own(Logger(6));
+        ASSERT_EQUAL(Logger::instance_count, 2);
+        three = two;
+        ASSERT_EQUAL(Logger::instance_count, 1);
+
+        // копия объекта не наследует счётчик ссылок оригинала
+        auto copy = ObjectHolder::Own(Logger(*three.TryAs<Logger>()));
+        ASSERT_EQUAL(Logger::instance_count, 2);
+    }
+    ASSERT_EQUAL(Logger::instance_count, 0);
+}
+
+void TestCycleCollector() {
+    ASSERT_EQUAL(Logger::instance_count, 0);
+    CycleCollector::Collect();
+    Class cls{"Node"s, {}, nullptr};
+    {
+        // пара экземпляров, ссылающихся друг на друга, и список, содержащий сам себя
+        auto a = ObjectHolder::Own(ClassInstance(cls));
+        auto b = ObjectHolder::Own(ClassInstance(cls));
+        a.TryAs<ClassInstance>()->Fields()[Symbol("next")] = b;
+        b.TryAs<ClassInstance>()->Fields()[Symbol("next")] = a;
+        a.TryAs<ClassInstance>()->Fields()[Symbol("payload")] = ObjectHolder::Own(Logger(1));
+
+        auto list = ObjectHolder::Own(List());
+        list.TryAs<List>()->Append(list);
+        list.TryAs<List>()->Append(ObjectHolder::Own(Logger(2)));
+    }
+    // счётчики ссылок циклы не освобождают
+    ASSERT_EQUAL(Logger::instance_count, 2);
+    ASSERT(CycleCollector::CandidateCount() > 0);
+    // вместе с циклами удаляются объекты, достижимые только из них
+    ASSERT_EQUAL(CycleCollector::Collect(), 5U);
+    ASSERT_EQUAL(Logger::instance_count, 0);
+    ASSERT_EQUAL(CycleCollector::CandidateCount(), 0U);
+
+    // цикл, на который есть внешняя ссылка, остаётся живым
+    auto root = ObjectHolder::Own(ClassInstance(cls));
+    {
+        auto peer = ObjectHolder::Own(ClassInstance(cls));
+        peer.TryAs<ClassInstance>()->Fields()[Symbol("peer")] = root;
+        root.TryAs<ClassInstance>()->Fields()[Symbol("peer")] = peer;
+        root.TryAs<ClassInstance>()->Fields()[Symbol("payload")] = ObjectHolder::Own(Logger(3));
+    }
+    ASSERT_EQUAL(CycleCollector::Collect(), 0U);
+    ASSERT_EQUAL(Logger::instance_count, 1);
+    ASSERT_EQUAL(root.TryAs<ClassInstance>()->Fields().size(), 2U);
+    root = ObjectHolder::None();
+    ASSERT_EQUAL(CycleCollector::Collect(), 3U);
+    ASSERT_EQUAL(Logger::instance_count, 0);
+
+    // при достижении порога сборка запускается при создании объекта
+    CycleCollector::SetThreshold(2);
+    {
+        auto dict = ObjectHolder::Own(Dict());
+        DummyContext context;
+        dict.TryAs<Dict>()->Set(ObjectHolder::Own(Number(1)), dict, context);
+        dict.TryAs<Dict>()->Set(ObjectHolder::Own(Number(2)), ObjectHolder::Own(Logger(4)), context);
+        auto other = ObjectHolder::Own(List());
+        other.TryAs<List>()->Append(other);
+    }
+    ASSERT_EQUAL(CycleCollector::CandidateCount(), 2U);
+    auto trigger = ObjectHolder::Own(Number(0));
+    ASSERT_EQUAL(CycleCollector::CandidateCount(), 0U);
+    ASSERT_EQUAL(Logger::instance_count, 0);
+    CycleCollector::SetThreshold(__GC_DEFAULT_THRESHOLD__);
+}
+
+void TestIncrementalCollector() {
+    ASSERT_EQUAL(Logger::instance_count, 0);
+    CycleCollector::Collect();
+    CycleCollector::ResetStats();
+    Class cls{"Node"s, {}, nullptr};
+    // кольцо из экземпляров, которое сборщик проходит маленькими шагами
+    auto make_ring = [&cls](size_t size, int logger_id) {
+        auto first = ObjectHolder::Own(ClassInstance(cls));
+        first.TryAs<ClassInstance>()->Fields()[Symbol("payload")] = ObjectHolder::Own(Logger(logger_id));
+        ObjectHolder last = first;
+        for (size_t i = 1; i < size; ++i) {
+            auto node = ObjectHolder::Own(ClassInstance(cls));
+            last.TryAs<ClassInstance>()->Fields()[Symbol("next")] = node;
+            last = node;
+        }
+        last.TryAs<ClassInstance>()->Fields()[Symbol("next")] = first;
+        return first;
+    };
+
+    auto ring = make_ring(50, 1);
+    auto survivor = make_ring(50, 2);
+    ring = ObjectHolder::None();
+    ASSERT(CycleCollector::CandidateCount() > 0);
+
+    // цикл начинается при создании объекта и не укладывается в один шаг
+    CycleCollector::SetSliceBudget(4);
+    CycleCollector::SetThreshold(1);
+    auto trigger = ObjectHolder::Own(Number(0));
+    CycleCollector::SetThreshold(__GC_DEFAULT_THRESHOLD__);
+    ASSERT(CycleCollector::InProgress());
+    ASSERT_EQUAL(Logger::instance_count, 2);
+
+    // пока цикл идёт, программа забирает узел второго кольца в новую переменную и отпускает старую
+    auto stolen = survivor;
+    CycleCollector::WriteBarrier(stolen);
+    survivor = ObjectHolder::None();
+
+    // шаги выполняются между созданиями объектов, пока цикл не завершится
+    for (size_t i = 0; i < 100000 && CycleCollector::InProgress(); ++i) {
+        auto value = ObjectHolder::Own(Number(static_cast<int>(i)));
+    }
+    ASSERT(!CycleCollector::InProgress());
+    // первое кольцо собрано, второе удерживает stolen
+    ASSERT_EQUAL(Logger::instance_count, 1);
+    ASSERT(stolen.TryAs<ClassInstance>()->Fields().count(Symbol("next")));
+
+    auto stats = CycleCollector::GetStats();
+    ASSERT(stats.slices > 1);
+    ASSERT_EQUAL(stats.collections, 1U);
+    ASSERT_EQUAL(stats.freed_objects, 51U);
+    ASSERT(stats.max_pause <= stats.total_time);
+
+    // нулевой бюджет выполняет цикл целиком за один шаг
+    CycleCollector::SetSliceBudget(0);
+    stolen = ObjectHolder::None();
+    ASSERT_EQUAL(CycleCollector::Collect(), 51U);
+    ASSERT_EQUAL(Logger::instance_count, 0);
+    ASSERT_EQUAL(CycleCollector::GetStats().collections, 2U);
+    CycleCollector::SetSliceBudget(__GC_DEFAULT_SLICE_BUDGET__);
+}
+
+void TestHeap() {
+    HeapModeScope scope(HeapMode::Generational);
+    auto before = Heap::GetStats();
+    {
+        // короткоживущие значения: блок целиком переиспользуется
+        for (int i = 0; i < 10000; ++i) {
+            auto value = ObjectHolder::Own(Number(i));
+            ASSERT_EQUAL(value.TryAs<Number>()->GetValue(), i);
+        }
+        auto stats = Heap::GetStats();
+        ASSERT_EQUAL(stats.nursery_allocations - before.nursery_allocations, 10000U);
+        ASSERT(stats.nursery_resets > before.nursery_resets);
+    }
+    {
+        // выжившие значения остаются на месте, их блоки переходят в старое поколение
+        std::vector<ObjectHolder> survivors;
+        for (int i = 0; i < 10000; ++i) {
+            survivors.push_back(ObjectHolder::Own(String(std::to_string(i))));
+        }
+        ASSERT(Heap::GetStats().promoted_blocks > before.promoted_blocks);
+        ASSERT_EQUAL(survivors[1234].TryAs<String>()->GetValue(), "1234"s);
+
+        // объект молодого поколения освобождается и после смены режима, и в другом потоке
+        HeapModeScope refcount(HeapMode::RefCounting);
+        auto plain = ObjectHolder::Own(Number(1));
+        ObjectHandoff handoff = std::move(survivors.back()).Handoff();
+        survivors.pop_back();
+        std::thread worker([handoff = std::move(handoff)]() mutable {
+            ObjectHolder received = ObjectHolder::Adopt(std::move(handoff));
+            ASSERT_EQUAL(received.TryAs<String>()->GetValue(), "9999"s);
+        });
+        worker.join();
+    }
+    ASSERT(Heap::GetMode() == HeapMode::Generational);
+}
+
+void TestPools() {
+    HeapModeScope scope(HeapMode::Pooled);
+    auto before = Heap::GetPoolStats(sizeof(Number));
+    ASSERT(before.chunk_size >= sizeof(Number));
+    {
+        // временные значения занимают один и тот же блок пула
+        for (int i = 0; i < 10000; ++i) {
+            auto value = ObjectHolder::Own(Number(i));
+            ASSERT_EQUAL(value.TryAs<Number>()->GetValue(), i);
+        }
+        auto stats = Heap::GetPoolStats(sizeof(Number));
+        ASSERT_EQUAL(stats.live, before.live);
+        ASSERT(stats.recycled - before.recycled >= 9999U);
+        ASSERT(stats.slabs - before.slabs <= 1U);
+    }
+    {
+        // живые объекты набирают пик, после освобождения их блоки уходят в список свободных
+        std::vector<ObjectHolder> values;
+        Class cls{"Point"s, {}, nullptr};
+        for (int i = 0; i < 1000; ++i) {
+            values.push_back(ObjectHolder::Own(Number(i)));
+            values.push_back(ObjectHolder::Own(ClassInstance(cls)));
+        }
+        ASSERT_EQUAL(Heap::GetPoolStats(sizeof(Number)).live, before.live + 1000);
+        ASSERT(Heap::GetPoolStats(sizeof(Number)).peak >= before.live + 1000);
+        ASSERT(Heap::GetPoolStats(sizeof(ClassInstance)).live >= 1000U);
+
+        // блок пула освобождается и в другом потоке
+        ObjectHandoff handoff = std::move(values.front()).Handoff();
+        std::thread worker([handoff = std::move(handoff)]() mutable {
+            ObjectHolder received = ObjectHolder::Adopt(std::move(handoff));
+            ASSERT_EQUAL(received.TryAs<Number>()->GetValue(), 0);
+        });
+        worker.join();
+        values.clear();
+        auto recycled = Heap::GetPoolStats(sizeof(Number)).recycled;
+        auto value = ObjectHolder::Own(Number(1));
+        ASSERT_EQUAL(Heap::GetPoolStats(sizeof(Number)).recycled, recycled + 1);
+    }
+    // объекты крупнее пулов выделяются обычным operator new
+    ASSERT_EQUAL(Heap::GetPoolStats(4096).chunk_size, 0U);
+}
+
+void TestHandoff() {
+    ASSERT_EQUAL(Logger::instance_count, 0);
+    {
+        auto oh = ObjectHolder::Own(Logger(42));
+        ObjectHolder copy = oh;
+        // разделённый объект передать нельзя
+        ASSERT_THROWS((void)std::move(copy).Handoff(), std::runtime_error);
+        copy = ObjectHolder::None();
+        Logger local;
+        ASSERT_THROWS((void)ObjectHolder::Share(local).Handoff(), std::runtime_error);
+
+        ObjectHandoff handoff = std::move(oh).Handoff();
+        ASSERT(!oh);  // NOLINT
+
+        ObjectHolder received;
+        std::thread worker([&received, handoff = std::move(handoff)]() mutable {
+            received = ObjectHolder::Adopt(std::move(handoff));
+        });
+        worker.join();
+        ASSERT_EQUAL(Logger::instance_count, 2);
+
+        DummyContext context;
+        received->Print(context.output, context);
+        ASSERT_EQUAL(context.output.str(), "42"sv);
+    }
+    ASSERT_EQUAL(Logger::instance_count, 0);
+
+    // непринятый объект уничтожается вместе с ObjectHandoff
+    {
+        ObjectHandoff lost = ObjectHolder::Own(Logger()).Handoff();
+        ASSERT_EQUAL(Logger::instance_count, 1);
+    }
+    ASSERT_EQUAL(Logger::instance_count, 0);
+}
+
+void TestClosure() {
+    Closure closure;
+    ASSERT(closure.empty());
+    closure[Symbol("a")] = ObjectHolder::Own(Number(1));
+    ObjectHolder& first = closure[Symbol("a")];
+    // значения переносятся из встроенных ячеек в std::deque и в хеш-индекс, ссылки при этом не меняются
+    for (int i = 0; i < 40; ++i) {
+        closure[Symbol("v"s + std::to_string(i))] = MakeNumber(i);
+        ASSERT_EQUAL(&closure[Symbol("a")], &first);
+    }
+    ASSERT_EQUAL(closure.size(), 41U);
+    ASSERT_EQUAL(closure.at(Symbol("v37")).TryAs<Number>()->GetValue(), 37);
+    ASSERT_EQUAL(closure.count(Symbol("v3")), 1U);
+    ASSERT_EQUAL(closure.count(Symbol("missing")), 0U);
+    ASSERT(closure.find(Symbol("missing")) == closure.end());
+    ASSERT_THROWS((void)closure.at(Symbol("missing")), std::out_of_range);
+
+    auto [it, inserted] = closure.insert({ Symbol("a"), ObjectHolder::None() });
+    ASSERT(!inserted);
+    ASSERT_EQUAL(it->second.TryAs<Number>()->GetValue(), 1);
+
+    // перебор идёт в порядке добавления
+    size_t visited = 0;
+    for (const auto& [name, value] : closure) {
+        ASSERT_EQUAL(name == Symbol("a"), visited == 0);
+        ++visited;
+    }
+    ASSERT_EQUAL(visited, 41U);
+
+    // копия независима, перемещение и обмен сохраняют содержимое
+    Closure copy = closure;
+    copy[Symbol("a")] = MakeNumber(2);
+    ASSERT_EQUAL(closure.at(Symbol("a")).TryAs<Number>()->GetValue(), 1);
+    Closure small = { { Symbol("x"), MakeNumber(5) } };
+    small.swap(copy);
+    ASSERT_EQUAL(small.size(), 41U);
+    ASSERT_EQUAL(copy.size(), 1U);
+    ASSERT_EQUAL(small.at(Symbol("v20")).TryAs<Number>()->GetValue(), 20);
+    Closure moved = std::move(small);
+    ASSERT_EQUAL(moved.at(Symbol("a")).TryAs<Number>()->GetValue(), 2);
+    ASSERT_EQUAL(moved.at(Symbol("v39")).TryAs<Number>()->GetValue(), 39);
+    copy = moved;
+    ASSERT_EQUAL(copy.size(), 41U);
+
+    // подсказка ячейки проверяется первой, неверная подсказка исправляется поиском
+    uint32_t hint = 0;
+    ASSERT_EQUAL(closure.FindHinted(Symbol("v20"), hint), &closure.at(Symbol("v20")));
+    ASSERT_EQUAL(hint, 21U);
+    ASSERT_EQUAL(closure.FindHinted(Symbol("v20"), hint), &closure.at(Symbol("v20")));
+    ASSERT_EQUAL(closure.FindHinted(Symbol("a"), hint), &first);
+    ASSERT_EQUAL(hint, 0U);
+    ASSERT(closure.FindHinted(Symbol("missing"), hint) == nullptr);
+    ASSERT_EQUAL(hint, 0U);
+
+    // результат return хранится в кадре до тех пор, пока его не заберут
+    ASSERT(!closure.IsReturning());
+    closure.SetReturnValue(MakeNumber(7));
+    ASSERT(closure.IsReturning());
+    ASSERT_EQUAL(closure.TakeReturnValue().TryAs<Number>()->GetValue(), 7);
+    ASSERT(!closure.IsReturning());
+
+    closure.clear();
+    ASSERT(closure.empty());
+    ASSERT(closure.find(Symbol("a")) == closure.end());
+}
+
+void TestSharedValues() {
+    // True, False и малые числа - общие объекты без учёта ссылок
+    ASSERT_EQUAL(MakeBool(true).Get(), MakeBool(true).Get());
+    ASSERT(MakeBool(true).Get() != MakeBool(false).Get());
+    ASSERT(MakeBool(true).TryAs<Bool>()->GetValue());
+    ASSERT(!MakeBool(false).TryAs<Bool>()->GetValue());
+    ASSERT(MakeBool(false).IsImmortal());
+    ASSERT(!MakeBool(false).IsOwning());
+
+    ASSERT_EQUAL(MakeNumber(__SMALL_INT_MIN__).Get(), MakeNumber(__SMALL_INT_MIN__).Get());
+    ASSERT_EQUAL(MakeNumber(__SMALL_INT_MAX__).TryAs<Number>()->GetValue(), __SMALL_INT_MAX__);
+    ASSERT_EQUAL(MakeNumber(-7).TryAs<Number>()->GetValue(), -7);
+    ASSERT(MakeNumber(0).IsImmortal());
+    // значения вне кеша выделяются заново
+    ASSERT(MakeNumber(__SMALL_INT_MAX__ + 1).Get() != MakeNumber(__SMALL_INT_MAX__ + 1).Get());
+    ASSERT(MakeNumber(__SMALL_INT_MIN__ - 1).IsOwning());
+    ASSERT_EQUAL(MakeInteger(BigInt(42)).Get(), MakeNumber(42).Get());
+
+    // Share и копии общего объекта тоже не владеют им, счётчик не меняется
+    ObjectHolder shared = ObjectHolder::Share(*MakeNumber(3));
+    ASSERT(!shared.IsOwning());
+    ASSERT(shared.IsImmortal());
+
+    // общий объект передаётся в другой поток без владения и не уничтожается там
+    ObjectHandoff handoff = MakeBool(true).Handoff();
+    std::thread worker([handoff = std::move(handoff)]() mutable {
+        ObjectHolder received = ObjectHolder::Adopt(std::move(handoff));
+        ASSERT(!received.IsOwning());
+        ASSERT_EQUAL(received.Get(), MakeBool(true).Get());
+    });
+    worker.join();
+    {
+        ObjectHandoff dropped = MakeNumber(1).Handoff();
+    }
+    ASSERT_EQUAL(MakeNumber(1).TryAs<Number>()->GetValue(), 1);
+
+    // при выносе из арены общий объект не копируется
+    DummyContext context;
+    ObjectHolder copy;
+    {
+        ExecutionArena arena;
+        copy = CopyOut(MakeNumber(9), arena, context);
+    }
+    ASSERT_EQUAL(copy.Get(), MakeNumber(9).Get());
+}
+
 void TestIsTrue() {
     {
         ASSERT(!IsTrue(ObjectHolder::Own(Bool{false})));
@@ -428,8 +799,8 @@ void TestComparison() {
         };
 
         std::vector<Method> cls1_methods;
-        cls1_methods.push_back({"__eq__"s, {"rhs"s}, std::make_unique<TestMethodBody>(eq_body)});
-        cls1_methods.push_back({"__lt__"s, {"rhs"s}, std::make_unique<TestMethodBody>(lt_body)});
+        cls1_methods.push_back({Symbol("__eq__"), {Symbol("rhs")}, std::make_unique<TestMethodBody>(eq_body)});
+        cls1_methods.push_back({Symbol("__lt__"), {Symbol("rhs")}, std::make_unique<TestMethodBody>(lt_body)});
         Class cls1{"Class1"s, std::move(cls1_methods), nullptr};
         ClassInstance lhs{cls1};
 
@@ -439,8 +810,8 @@ void TestComparison() {
         // Equal / NotEqual
         eq_result = ObjectHolder::Own(Bool{true});
         test_equal(ObjectHolder::Share(lhs), ObjectHolder::Share(rhs), true);
-        ASSERT(eq_closure.at("self"s).TryAs<ClassInstance>() == &lhs);
-        ASSERT(eq_closure.at("rhs"s).TryAs<ClassInstance>() == &rhs);
+        ASSERT(eq_closure.at(Symbol("self")).TryAs<ClassInstance>() == &lhs);
+        ASSERT(eq_closure.at(Symbol("rhs")).TryAs<ClassInstance>() == &rhs);
         ASSERT(lt_closure.empty());
         eq_result = ObjectHolder::Own(Bool{false});
         test_equal(ObjectHolder::Share(lhs), ObjectHolder::Share(rhs), false);
@@ -451,8 +822,8 @@ void TestComparison() {
         eq_result = ObjectHolder::Own(Bool{false});
         lt_result = ObjectHolder::Own(Bool{true});
         test_less(ObjectHolder::Share(lhs), ObjectHolder::Share(rhs), true);
-        ASSERT(lt_closure.at("self"s).TryAs<ClassInstance>() == &lhs);
-        ASSERT(lt_closure.at("rhs"s).TryAs<ClassInstance>() == &rhs);
+        ASSERT(lt_closure.at(Symbol("self")).TryAs<ClassInstance>() == &lhs);
+        ASSERT(lt_closure.at(Symbol("rhs")).TryAs<ClassInstance>() == &rhs);
         ASSERT(eq_closure.empty());
         eq_result = ObjectHolder::Own(Bool{true});
         lt_result = ObjectHolder::Own(Bool{false});
@@ -464,10 +835,10 @@ void TestComparison() {
         eq_result = ObjectHolder::Own(Bool{false});
         lt_result = ObjectHolder::Own(Bool{false});
         test_greater(ObjectHolder::Share(lhs), ObjectHolder::Share(rhs), true);
-        ASSERT(eq_closure.at("self"s).TryAs<ClassInstance>() == &lhs);
-        ASSERT(eq_closure.at("rhs"s).TryAs<ClassInstance>() == &rhs);
-        ASSERT(lt_closure.at("self"s).TryAs<ClassInstance>() == &lhs);
-        ASSERT(lt_closure.at("rhs"s).TryAs<ClassInstance>() == &rhs);
+        ASSERT(eq_closure.at(Symbol("self")).TryAs<ClassInstance>() == &lhs);
+        ASSERT(eq_closure.at(Symbol("rhs")).TryAs<ClassInstance>() == &rhs);
+        ASSERT(lt_closure.at(Symbol("self")).TryAs<ClassInstance>() == &lhs);
+        ASSERT(lt_closure.at(Symbol("rhs")).TryAs<ClassInstance>() == &rhs);
         eq_result = ObjectHolder::Own(Bool{true});
         lt_result = ObjectHolder::Own(Bool{true});
         test_greater(ObjectHolder::Share(lhs), ObjectHolder::Share(rhs), false);
@@ -483,12 +854,12 @@ void TestClass() {
         passed_context = &ctx;
         return ObjectHolder::Own(Number{42});
     };
-    methods.push_back({"method"s, {"arg1"s, "arg2"s}, make_unique<TestMethodBody>(body)});
+    methods.push_back({Symbol("method"), {Symbol("arg1"), Symbol("arg2")}, make_unique<TestMethodBody>(body)});
     Class cls{"Test"s, move(methods), nullptr};
     ASSERT_EQUAL(cls.GetName(), "Test"s);
-    ASSERT_EQUAL(cls.GetMethod("missing_method"s), nullptr);
+    ASSERT_EQUAL(cls.GetMethod(Symbol("missing_method")), nullptr);
 
-    const Method* method = cls.GetMethod("method"s);
+    const Method* method = cls.GetMethod(Symbol("method"));
     ASSERT(method != nullptr);
     DummyContext ctx;
     Closure closure;
@@ -513,20 +884,516 @@ void TestClassInstance() {
         return ObjectHolder::Own(String{"result"s});
     };
 
-    methods.push_back({"__str__", {}, make_unique<TestMethodBody>(str_body)});
+    methods.push_back({Symbol("__str__"), {}, make_unique<TestMethodBody>(str_body)});
 
     Class cls{"Test"s, move(methods), nullptr};
     ClassInstance instance{cls};
 
     ASSERT_EQUAL(&instance.Fields(), &const_cast<const ClassInstance&>(instance).Fields());
-    ASSERT(instance.HasMethod("__str__"s, 0));
+    ASSERT(instance.HasMethod(Symbol("__str__"), 0));
 
     ostringstream out;
     DummyContext ctx;
     instance.Print(out, ctx);
     ASSERT_EQUAL(out.str(), "result"s);
 
-    ASSERT_THROWS(instance.Call("missing_method"s, {}, ctx), runtime_error);
+    ASSERT_THROWS(instance.Call(Symbol("missing_method"), {}, ctx), runtime_error);
+}
+
+void TestBigNumbers() {
+    DummyContext ctx;
+
+    // результат, помещающийся в 64 бита, остаётся Number
+    ObjectHolder sum = IntegerAdd(ObjectHolder::Own(Number{2147483647}), ObjectHolder::Own(Number{1}));
+    ASSERT_EQUAL(sum.TryAs<Number>()->GetValue(), int64_t{2147483648});
+
+    // переполнение int64_t переводит результат в BigNumber
+    const int64_t max = std::numeric_limits<int64_t>::max();
+    const int64_t min = std::numeric_limits<int64_t>::min();
+    ObjectHolder big = IntegerMul(ObjectHolder::Own(Number{max}), ObjectHolder::Own(Number{max}));
+    ASSERT(big.TryAs<BigNumber>() != nullptr);
+    ASSERT_EQUAL(big.TryAs<BigNumber>()->GetValue().ToString(), "85070591730234615847396907784232501249"s);
+    ASSERT_EQUAL(IntegerAdd(ObjectHolder::Own(Number{max}), ObjectHolder::Own(Number{1}))
+                     .TryAs<BigNumber>()->GetValue().ToString(), "9223372036854775808"s);
+    ASSERT_EQUAL(IntegerSub(ObjectHolder::Own(Number{min}), ObjectHolder::Own(Number{1}))
+                     .TryAs<BigNumber>()->GetValue().ToString(), "-9223372036854775809"s);
+    ASSERT_EQUAL(IntegerDiv(ObjectHolder::Own(Number{min}), ObjectHolder::Own(Number{-1}))
+                     .TryAs<BigNumber>()->GetValue().ToString(), "9223372036854775808"s);
+
+    // длинное деление возвращает результат в Number, когда он снова помещается в 64 бита
+    ObjectHolder back = IntegerDiv(big, ObjectHolder::Own(Number{max}));
+    ASSERT_EQUAL(back.TryAs<Number>()->GetValue(), max);
+    ObjectHolder zero = IntegerSub(big, big);
+    ASSERT_EQUAL(zero.TryAs<Number>()->GetValue(), 0);
+    ASSERT_EQUAL(IntegerDiv(IntegerMul(big, ObjectHolder::Own(Number{-3})), big).TryAs<Number>()->GetValue(), -3);
+    ASSERT_THROWS(IntegerDiv(big, ObjectHolder::Own(Number{0})), runtime_error);
+
+    // сравнение и хеширование согласованы между Number и BigNumber
+    ObjectHolder small_big = ObjectHolder::Own(BigNumber{BigInt{5}});
+    ASSERT(Equal(small_big, ObjectHolder::Own(Number{5}), ctx));
+    ASSERT(Less(ObjectHolder::Own(Number{max}), big, ctx));
+    ASSERT(Less(IntegerMul(big, ObjectHolder::Own(Number{-1})), ObjectHolder::Own(Number{min}), ctx));
+    ASSERT_EQUAL(Hash(small_big, ctx), Hash(ObjectHolder::Own(Number{5}), ctx));
+    ASSERT(IsTrue(big));
+
+    ostringstream out;
+    big->Print(out, ctx);
+    ASSERT_EQUAL(out.str(), "85070591730234615847396907784232501249"s);
+}
+
+void TestFloat() {
+    DummyContext ctx;
+
+    auto print = [&ctx](double value) {
+        ostringstream out;
+        Float(value).Print(out, ctx);
+        return out.str();
+    };
+    ASSERT_EQUAL(print(0.1), "0.1"s);
+    ASSERT_EQUAL(print(1.0), "1.0"s);
+    ASSERT_EQUAL(print(-2.5), "-2.5"s);
+    ASSERT_EQUAL(print(100000.0), "100000.0"s);
+    ASSERT_EQUAL(print(0.1 + 0.2), "0.30000000000000004"s);
+    ASSERT_EQUAL(print(0.0001), "0.0001"s);
+    ASSERT_EQUAL(print(0.00001), "1e-05"s);
+    ASSERT_EQUAL(print(1e16), "1e+16"s);
+    ASSERT_EQUAL(print(1.5e300), "1.5e+300"s);
+
+    // числа разных типов сравниваются по значению
+    ObjectHolder one = ObjectHolder::Own(Number{1});
+    ObjectHolder one_float = ObjectHolder::Own(Float{1.0});
+    ObjectHolder half = ObjectHolder::Own(Float{0.5});
+    ASSERT(Equal(one, one_float, ctx));
+    ASSERT(Less(half, one, ctx));
+    ASSERT(!Less(one_float, half, ctx));
+    ASSERT(EqualKeys(one_float, one, ctx));
+    ASSERT_EQUAL(Hash(one_float, ctx), Hash(one, ctx));
+    ASSERT(IsTrue(half));
+    ASSERT(!IsTrue(ObjectHolder::Own(Float{0.0})));
+    ASSERT_EQUAL(ToDouble(ObjectHolder::Own(BigNumber{BigInt{1} * BigInt{int64_t{1} << 62} * BigInt{4}})), 0x1p64);
+}
+
+void TestSymbol() {
+    // одинаковые имена дают один и тот же символ независимо от источника строки
+    Symbol name{"value"s};
+    string text = "val"s;
+    text += "ue"s;
+    ASSERT(name == Symbol(text));
+    ASSERT(&name.Name() == &Symbol("value"sv).Name());
+    ASSERT(name != Symbol("values"));
+    ASSERT_EQUAL(name.Name(), "value"s);
+    ASSERT_EQUAL(std::hash<Symbol>{}(name), std::hash<Symbol>{}(Symbol(text)));
+    ASSERT(Symbol().Empty());
+    ASSERT(Symbol() == Symbol(""s));
+
+    // таблица символов объекта ищет поле по символу, построенному из другой строки
+    Closure closure;
+    closure[Symbol("x"s)] = ObjectHolder::Own(Number{1});
+    ASSERT(closure.count(Symbol(string(1, 'x'))) == 1);
+
+    ostringstream out;
+    out << name;
+    ASSERT_EQUAL(out.str(), "value"s);
+}
+
+void TestStringIntern() {
+    DummyContext ctx;
+
+    // равные интернированные строки разделяют буфер и хеш
+    String tag = String::Intern("circle"sv);
+    String same = String::Intern("circ"s + "le"s);
+    ASSERT(tag.IsInterned());
+    ASSERT(tag.View().data() == same.View().data());
+    ASSERT(tag.Equals(same));
+    ASSERT(!tag.Equals(String::Intern("square"sv)));
+    ASSERT(!String{"circle"s}.IsInterned());
+    ASSERT(tag.Equals(String{"circle"s}));
+    ASSERT_EQUAL(tag.Hash(), String{"circle"s}.Hash());
+    ASSERT(Equal(ObjectHolder::Own(String{tag}), ObjectHolder::Own(String{"circle"s}), ctx));
+    ASSERT(Less(ObjectHolder::Own(String::Intern("a"sv)), ObjectHolder::Own(String::Intern("b"sv)), ctx));
+    ASSERT(!Less(ObjectHolder::Own(String{tag}), ObjectHolder::Own(String{same}), ctx));
+
+    // односимвольные строки берутся из общей таблицы
+    ASSERT(String::Intern("x"sv).View().data() == String::Intern(string(1, 'x')).View().data());
+
+    // конкатенация не дописывает буфер интернированной строки
+    String longer = String::Concat(tag, String{"s"s});
+    ASSERT_EQUAL(longer.GetValue(), "circles"s);
+    ASSERT(!longer.IsInterned());
+    ASSERT_EQUAL(String::Intern("circle"sv).GetValue(), "circle"s);
+    ASSERT_EQUAL(tag.View(), "circle"sv);
+}
+
+void TestStringConcat() {
+    DummyContext ctx;
+
+    // накопление в одну строку дописывает общий буфер
+    String acc{"a"s};
+    for (int i = 0; i < 1000; ++i) {
+        acc = String::Concat(acc, String{"b"s});
+    }
+    ASSERT_EQUAL(acc.Size(), 1001U);
+    ASSERT_EQUAL(acc.View().substr(0, 3), "abb"sv);
+
+    // строка, чей буфер продолжен другой строкой, сохраняет своё значение
+    String base{"base"s};
+    String left = String::Concat(base, String{"-left"s});
+    String right = String::Concat(base, String{"-right"s});
+    ASSERT_EQUAL(base.GetValue(), "base"s);
+    ASSERT_EQUAL(left.GetValue(), "base-left"s);
+    ASSERT_EQUAL(right.GetValue(), "base-right"s);
+    ASSERT_EQUAL(String::Concat(left, String{"!"s}).GetValue(), "base-left!"s);
+    ASSERT_EQUAL(left.View(), "base-left"sv);
+
+    // буфер, разделённый с другой строкой или выданный через GetValue, не дописывается
+    String shared{"sha"s};
+    String copy = shared;
+    const std::string& copy_value = copy.GetValue();
+    String extended = String::Concat(shared, String{"red"s});
+    ASSERT_EQUAL(copy_value, "sha"s);
+    ASSERT_EQUAL(extended.View(), "shared"sv);
+    String pinned{"pin"s};
+    const std::string& pinned_value = pinned.GetValue();
+    ASSERT_EQUAL(String::Concat(pinned, String{"ned"s}).View(), "pinned"sv);
+    ASSERT_EQUAL(pinned_value, "pin"s);
+
+    // конкатенация строки с самой собой
+    String twice = String::Concat(right, right);
+    ASSERT_EQUAL(twice.GetValue(), "base-rightbase-right"s);
+
+    ostringstream out;
+    twice.Print(out, ctx);
+    ASSERT_EQUAL(out.str(), "base-rightbase-right"s);
+    ASSERT(Equal(ObjectHolder::Own(String::Concat(String{"ab"s}, String{"c"s})), ObjectHolder::Own(String{"abc"s}), ctx));
+    ASSERT_EQUAL(Hash(ObjectHolder::Own(String::Concat(base, String{"!"s})), ctx), Hash(ObjectHolder::Own(String{"base!"s}), ctx));
+}
+
+void TestList() {
+    DummyContext ctx;
+
+    List list;
+    ASSERT_EQUAL(list.Size(), 0U);
+    ASSERT(!IsTrue(ObjectHolder::Share(list)));
+
+    list.Append(ObjectHolder::Own(Number{1}));
+    list.Call(Symbol("append"), {ObjectHolder::Own(String{"two"s})}, ctx);
+    list.Append(ObjectHolder::None());
+    ASSERT_EQUAL(list.Size(), 3U);
+    ASSERT(IsTrue(ObjectHolder::Share(list)));
+
+    ASSERT_EQUAL(list.At(0).TryAs<Number>()->GetValue(), 1);
+    ASSERT_EQUAL(list.At(-2).TryAs<String>()->GetValue(), "two"s);
+    ASSERT_THROWS(list.At(3), runtime_error);
+    ASSERT_THROWS(list.At(-4), runtime_error);
+    ASSERT_THROWS(list.Call(Symbol("pop"), {}, ctx), runtime_error);
+
+    ostringstream out;
+    list.Print(out, ctx);
+    ASSERT_EQUAL(out.str(), "[1, two, None]"s);
+    ASSERT(ctx.output.str().empty());
+}
+
+void TestListSort() {
+    DummyContext ctx;
+
+    // числа: случайные, упорядоченные, убывающие и с повторами - больше порога сортировки вставками
+    for (int pattern = 0; pattern < 4; ++pattern) {
+        List list;
+        vector<int> expected;
+        for (int i = 0; i < 500; ++i) {
+            int value = pattern == 0 ? (i * 7919) % 503 : pattern == 1 ? i : pattern == 2 ? -i : i % 3;
+            list.Append(ObjectHolder::Own(Number{value}));
+            expected.push_back(value);
+        }
+        std::sort(expected.begin(), expected.end());
+        list.Sort(ctx);
+        ASSERT_EQUAL(list.Size(), expected.size());
+        for (size_t i = 0; i < expected.size(); ++i) {
+            ASSERT_EQUAL(list.Values()[i].TryAs<Number>()->GetValue(), expected[i]);
+        }
+    }
+
+    List words{{ObjectHolder::Own(String{"pear"s}), ObjectHolder::Own(String{"apple"s}),
+                ObjectHolder::Own(String{"fig"s})}};
+    words.Sort(ctx);
+    ostringstream out;
+    words.Print(out, ctx);
+    ASSERT_EQUAL(out.str(), "[apple, fig, pear]"s);
+
+    // сортировка экземпляров по полю и через __lt__
+    vector<Method> methods;
+    methods.push_back({Symbol("__lt__"), {Symbol("rhs")}, make_unique<TestMethodBody>([](Closure& closure, Context&) {
+        ObjectHolder& self = closure.at(Symbol("self"));
+        ObjectHolder& rhs = closure.at(Symbol("rhs"));
+        return ObjectHolder::Own(Bool{self.TryAs<ClassInstance>()->Fields().at(Symbol("w")).TryAs<Number>()->GetValue()
+            > rhs.TryAs<ClassInstance>()->Fields().at(Symbol("w")).TryAs<Number>()->GetValue()});
+    })});
+    Class item_class{"Item"s, move(methods), nullptr};
+    List items;
+    for (int w : {3, 1, 2}) {
+        ObjectHolder item = ObjectHolder::Own(ClassInstance{item_class});
+        item.TryAs<ClassInstance>()->Fields()[Symbol("w")] = ObjectHolder::Own(Number{w});
+        items.Append(item);
+    }
+    items.Sort(ctx, Symbol("w"));
+    ASSERT_EQUAL(items.At(0).TryAs<ClassInstance>()->Fields().at(Symbol("w")).TryAs<Number>()->GetValue(), 1);
+    items.Sort(ctx);
+    ASSERT_EQUAL(items.At(0).TryAs<ClassInstance>()->Fields().at(Symbol("w")).TryAs<Number>()->GetValue(), 3);
+    ASSERT_THROWS(items.Sort(ctx, Symbol("missing")), runtime_error);
+
+    // при ошибке сравнения элементы списка не теряются
+    List mixed{{ObjectHolder::Own(Number{1}), ObjectHolder::Own(String{"a"s}), ObjectHolder::Own(Number{0})}};
+    ASSERT_THROWS(mixed.Sort(ctx), runtime_error);
+    ASSERT_EQUAL(mixed.Size(), 3U);
+    for (const auto& item : mixed.Values()) {
+        ASSERT(item);
+    }
+}
+
+void TestDict() {
+    DummyContext ctx;
+
+    Dict dict;
+    ASSERT_EQUAL(dict.Size(), 0U);
+    ASSERT(!IsTrue(ObjectHolder::Share(dict)));
+    ASSERT(dict.Find(ObjectHolder::Own(Number{1}), ctx) == nullptr);
+
+    // заполняем словарь так, чтобы таблица несколько раз перестроилась
+    for (int i = 0; i < 1000; ++i) {
+        dict.Set(ObjectHolder::Own(Number{i}), ObjectHolder::Own(Number{i * i}), ctx);
+    }
+    dict.Set(ObjectHolder::Own(String{"key"s}), ObjectHolder::Own(String{"value"s}), ctx);
+    dict.Set(ObjectHolder::Own(Bool{true}), ObjectHolder::None(), ctx);
+    dict.Set(ObjectHolder::None(), ObjectHolder::Own(Number{-1}), ctx);
+    dict.Set(ObjectHolder::Own(Number{7}), ObjectHolder::Own(Number{70}), ctx);
+    ASSERT_EQUAL(dict.Size(), 1003U);
+    ASSERT(IsTrue(ObjectHolder::Share(dict)));
+
+    for (int i = 0; i < 1000; ++i) {
+        ObjectHolder* value = dict.Find(ObjectHolder::Own(Number{i}), ctx);
+        ASSERT(value != nullptr);
+        ASSERT_EQUAL(value->TryAs<Number>()->GetValue(), i == 7 ? 70 : i * i);
+    }
+    ASSERT_EQUAL(dict.At(ObjectHolder::Own(String{"key"s}), ctx).TryAs<String>()->GetValue(), "value"s);
+    ASSERT(dict.Contains(ObjectHolder::Own(Bool{true}), ctx));
+    ASSERT(!dict.Contains(ObjectHolder::Own(Bool{false}), ctx));
+    ASSERT(!dict.Contains(ObjectHolder::Own(String{"1"s}), ctx));
+    ASSERT_EQUAL(dict.At(ObjectHolder::None(), ctx).TryAs<Number>()->GetValue(), -1);
+    ASSERT_THROWS(dict.At(ObjectHolder::Own(Number{1000}), ctx), runtime_error);
+    ASSERT_THROWS(dict.Set(ObjectHolder::Own(List{}), ObjectHolder::None(), ctx), runtime_error);
+
+    // ключи хранятся в порядке вставки
+    ASSERT_EQUAL(dict.Entries().front().key.TryAs<Number>()->GetValue(), 0);
+    ASSERT(!dict.Entries().back().key);
+
+    Dict small;
+    small.Set(ObjectHolder::Own(String{"a"s}), ObjectHolder::Own(Number{1}), ctx);
+    small.Set(ObjectHolder::Own(Number{2}), ObjectHolder::None(), ctx);
+    ostringstream out;
+    small.Print(out, ctx);
+    ASSERT_EQUAL(out.str(), "{a: 1, 2: None}"s);
+    ASSERT_EQUAL(small.Call(Symbol("get"), {ObjectHolder::Own(String{"b"s}), ObjectHolder::Own(Number{5})}, ctx)
+                     .TryAs<Number>()->GetValue(), 5);
+    ASSERT_EQUAL(small.Call(Symbol("keys"), {}, ctx).TryAs<List>()->Size(), 2U);
+    ASSERT_THROWS(small.Call(Symbol("pop"), {}, ctx), runtime_error);
+    ASSERT(ctx.output.str().empty());
+}
+
+void TestIntArray() {
+    DummyContext ctx;
+
+    IntArray empty;
+    ASSERT(!IsTrue(ObjectHolder::Share(empty)));
+    ASSERT_EQUAL(empty.Call(Symbol("sum"), {}, ctx).TryAs<Number>()->GetValue(), 0);
+    ASSERT_THROWS(empty.Call(Symbol("min"), {}, ctx), runtime_error);
+
+    // длины подобраны так, чтобы проверить и векторную часть ядер, и хвост
+    for (int size : {1, 3, 4, 7, 8, 9, 33}) {
+        vector<int64_t> values;
+        int64_t sum = 0, min = 0, max = 0, dot = 0;
+        for (int i = 0; i < size; ++i) {
+            int64_t value = (i * 7919) % 23 - 11;
+            values.push_back(value);
+            sum += value;
+            dot += value * value;
+            min = i == 0 ? value : std::min(min, value);
+            max = i == 0 ? value : std::max(max, value);
+        }
+        IntArray array{values};
+        ObjectHolder same = ObjectHolder::Own(IntArray{values});
+        ASSERT_EQUAL(array.Call(Symbol("sum"), {}, ctx).TryAs<Number>()->GetValue(), sum);
+        ASSERT_EQUAL(array.Call(Symbol("min"), {}, ctx).TryAs<Number>()->GetValue(), min);
+        ASSERT_EQUAL(array.Call(Symbol("max"), {}, ctx).TryAs<Number>()->GetValue(), max);
+        ASSERT_EQUAL(array.Call(Symbol("dot"), {same}, ctx).TryAs<Number>()->GetValue(), dot);
+
+        array.Call(Symbol("add"), {same}, ctx);
+        array.Call(Symbol("mul"), {ObjectHolder::Own(Number{3})}, ctx);
+        array.Call(Symbol("add"), {ObjectHolder::Own(Number{-1})}, ctx);
+        ASSERT_EQUAL(array.Call(Symbol("sum"), {}, ctx).TryAs<Number>()->GetValue(), sum * 6 - size);
+        array.Call(Symbol("mul"), {same}, ctx);
+        ASSERT_EQUAL(array.At(-1), (values.back() * 6 - 1) * values.back());
+
+        array.Call(Symbol("fill"), {ObjectHolder::Own(Number{2})}, ctx);
+        ASSERT_EQUAL(array.Call(Symbol("sum"), {}, ctx).TryAs<Number>()->GetValue(), 2 * size);
+    }
+
+    IntArray array{{1, 2, 3}};
+    array.Call(Symbol("append"), {ObjectHolder::Own(Number{4})}, ctx);
+    ASSERT_EQUAL(array.Size(), 4U);
+    ASSERT_EQUAL(array.At(0), 1);
+    ASSERT_THROWS(array.At(4), runtime_error);
+    ASSERT_THROWS(array.Call(Symbol("dot"), {ObjectHolder::Own(IntArray{{1}})}, ctx), runtime_error);
+    ASSERT_THROWS(array.Call(Symbol("add"), {ObjectHolder::Own(String{"1"s})}, ctx), runtime_error);
+    ASSERT_THROWS(array.Call(Symbol("sort"), {}, ctx), runtime_error);
+
+    ostringstream out;
+    array.Print(out, ctx);
+    ASSERT_EQUAL(out.str(), "[1, 2, 3, 4]"s);
+
+    // sum и dot за пределами int64_t дают BigNumber, как и скалярная арифметика
+    constexpr int64_t max = std::numeric_limits<int64_t>::max();
+    IntArray huge{vector<int64_t>(9, max)};
+    ASSERT(huge.Call(Symbol("sum"), {}, ctx).TryAs<BigNumber>()->GetValue() == BigInt(max) * BigInt(9));
+    ObjectHolder twos = ObjectHolder::Own(IntArray{vector<int64_t>(9, 2)});
+    ASSERT(huge.Call(Symbol("dot"), {twos}, ctx).TryAs<BigNumber>()->GetValue() == BigInt(max) * BigInt(18));
+    // переполнение одной дорожки при сумме, которая помещается в int64_t, даёт Number
+    vector<int64_t> lanes(16, 0);
+    lanes[0] = max;
+    lanes[1] = -1;
+    lanes[8] = 1;
+    ASSERT_EQUAL(IntArray{lanes}.Call(Symbol("sum"), {}, ctx).TryAs<Number>()->GetValue(), max);
+    // add и mul не могут сохранить такой результат и не изменяют массив
+    ASSERT_THROWS(huge.Call(Symbol("add"), {twos}, ctx), runtime_error);
+    ASSERT_THROWS(huge.Call(Symbol("mul"), {ObjectHolder::Own(Number{2})}, ctx), runtime_error);
+    ASSERT_EQUAL(huge.At(8), max);
+}
+
+void TestFloatArray() {
+    DummyContext ctx;
+
+    // целые значения складываются без округления, поэтому порядок сложения в ядрах не важен
+    for (int size : {1, 3, 4, 7, 8, 9, 33}) {
+        vector<double> values;
+        double sum = 0.0, min = 0.0, max = 0.0, dot = 0.0;
+        for (int i = 0; i < size; ++i) {
+            double value = (i * 7919) % 23 - 11;
+            values.push_back(value);
+            sum += value;
+            dot += value * value;
+            min = i == 0 ? value : std::min(min, value);
+            max = i == 0 ? value : std::max(max, value);
+        }
+        FloatArray array{values};
+        ObjectHolder same = ObjectHolder::Own(FloatArray{values});
+        ASSERT_EQUAL(array.Call(Symbol("sum"), {}, ctx).TryAs<Float>()->GetValue(), sum);
+        ASSERT_EQUAL(array.Call(Symbol("min"), {}, ctx).TryAs<Float>()->GetValue(), min);
+        ASSERT_EQUAL(array.Call(Symbol("max"), {}, ctx).TryAs<Float>()->GetValue(), max);
+        ASSERT_EQUAL(array.Call(Symbol("dot"), {same}, ctx).TryAs<Float>()->GetValue(), dot);
+
+        array.Call(Symbol("add"), {same}, ctx);
+        array.Call(Symbol("mul"), {ObjectHolder::Own(Float{0.5})}, ctx);
+        ASSERT_EQUAL(array.Call(Symbol("sum"), {}, ctx).TryAs<Float>()->GetValue(), sum);
+    }
+
+    FloatArray array{{0.25}};
+    array.Call(Symbol("append"), {ObjectHolder::Own(Number{2})}, ctx);
+    ASSERT_EQUAL(array.At(-1), 2.0);
+    ASSERT_THROWS(array.Call(Symbol("dot"), {ObjectHolder::Own(IntArray{{1, 2}})}, ctx), runtime_error);
+    ASSERT_THROWS(array.Call(Symbol("min"), {ObjectHolder::Own(Number{1})}, ctx), runtime_error);
+
+    ostringstream out;
+    array.Print(out, ctx);
+    ASSERT_EQUAL(out.str(), "[0.25, 2.0]"s);
+}
+
+void TestCompareTable() {
+    DummyContext ctx;
+    const CompareOp ops[] = { CompareOp::Less, CompareOp::LessOrEqual, CompareOp::Greater,
+                              CompareOp::GreaterOrEqual, CompareOp::Equal, CompareOp::NotEqual };
+    auto check = [&](const ObjectHolder& lhs, const ObjectHolder& rhs, const string& expected) {
+        string result;
+        for (CompareOp op : ops) {
+            result += Compare(op, lhs, rhs, ctx) ? '1' : '0';
+        }
+        ASSERT_EQUAL(result, expected);
+    };
+
+    // числа разных типов сравниваются по значению: < <= > >= == !=
+    ObjectHolder big = IntegerMul(MakeNumber(numeric_limits<int64_t>::max()), MakeNumber(2));
+    check(MakeNumber(3), ObjectHolder::Own(Float{3.5}), "110001"s);
+    check(ObjectHolder::Own(Float{3.0}), MakeNumber(3), "010110"s);
+    check(big, MakeNumber(-1), "001101"s);
+    check(MakeNumber(5), big, "110001"s);
+    check(big, ObjectHolder::Own(Float{1e300}), "110001"s);
+    check(ObjectHolder::Own(String{"b"s}), ObjectHolder::Own(String{"a"s}), "001101"s);
+    check(MakeBool(true), MakeBool(true), "010110"s);
+
+    // NaN не меньше, не больше и не равен ни одному числу
+    ObjectHolder nan = ObjectHolder::Own(Float{numeric_limits<double>::quiet_NaN()});
+    check(nan, MakeNumber(1), "000001"s);
+    check(nan, nan, "000001"s);
+
+    // несравнимые пары по-прежнему выбрасывают исключение
+    ASSERT_THROWS(Compare(CompareOp::Less, MakeNumber(1), ObjectHolder::Own(String{"1"s}), ctx), runtime_error);
+    ASSERT_THROWS(Compare(CompareOp::GreaterOrEqual, ObjectHolder::None(), ObjectHolder::None(), ctx), runtime_error);
+    ASSERT(Compare(CompareOp::Equal, ObjectHolder::None(), ObjectHolder::None(), ctx));
+    ASSERT(ObjectHolder::None().Kind() == ObjectKind::None);
+    ASSERT(big.Kind() == ObjectKind::BigNumber);
+}
+
+void TestHash() {
+    DummyContext ctx;
+
+    // экземпляры без __hash__ и __eq__ хешируются и сравниваются по адресу
+    Class plain{"Plain"s, {}, nullptr};
+    ObjectHolder first = ObjectHolder::Own(ClassInstance{plain});
+    ObjectHolder second = ObjectHolder::Own(ClassInstance{plain});
+    ASSERT_EQUAL(Hash(first, ctx), Hash(first, ctx));
+    ASSERT(EqualKeys(first, first, ctx));
+    ASSERT(!EqualKeys(first, second, ctx));
+
+    // экземпляры с __hash__ и __eq__ равны как ключи по значению
+    vector<Method> methods;
+    methods.push_back({Symbol("__hash__"), {}, make_unique<TestMethodBody>([](Closure&, Context&) {
+        return ObjectHolder::Own(Number{42});
+    })});
+    methods.push_back({Symbol("__eq__"), {Symbol("rhs")}, make_unique<TestMethodBody>([](Closure&, Context&) {
+        return ObjectHolder::Own(Bool{true});
+    })});
+    Class hashable{"Hashable"s, move(methods), nullptr};
+    ObjectHolder lhs = ObjectHolder::Own(ClassInstance{hashable});
+    ObjectHolder rhs = ObjectHolder::Own(ClassInstance{hashable});
+    ASSERT_EQUAL(Hash(lhs, ctx), Hash(ObjectHolder::Own(Number{42}), ctx));
+
+    Dict dict;
+    dict.Set(lhs, ObjectHolder::Own(Number{1}), ctx);
+    ASSERT(dict.Contains(rhs, ctx));
+
+    // __eq__ без __hash__ делает объект нехешируемым
+    methods.clear();
+    methods.push_back({Symbol("__eq__"), {Symbol("rhs")}, make_unique<TestMethodBody>([](Closure&, Context&) {
+        return ObjectHolder::Own(Bool{true});
+    })});
+    Class unhashable{"Unhashable"s, move(methods), nullptr};
+    ASSERT_THROWS(Hash(ObjectHolder::Own(ClassInstance{unhashable}), ctx), runtime_error);
+
+    // значения разных типов различны как ключи
+    ASSERT(!EqualKeys(ObjectHolder::Own(Number{1}), ObjectHolder::Own(String{"1"s}), ctx));
+    ASSERT(!EqualKeys(ObjectHolder::Own(Number{1}), ObjectHolder::None(), ctx));
+    ASSERT(EqualKeys(ObjectHolder::None(), ObjectHolder::None(), ctx));
+}
+
+void TestLongChainRelease() {
+    // удаление длинной цепочки объектов не углубляет стек на каждое звено
+    Class cls{"Link"s, {}, nullptr};
+    ObjectHolder head = ObjectHolder::None();
+    for (int i = 0; i < 200000; ++i) {
+        auto link = ObjectHolder::Own(ClassInstance(cls));
+        link.TryAs<ClassInstance>()->Fields()[Symbol("next")] = move(head);
+        head = move(link);
+    }
+    head = ObjectHolder::None();
+    ASSERT_EQUAL(CycleCollector::Collect(), 0U);
 }
 
 }  // namespace
@@ -540,6 +1407,18 @@ void RunObjectsTests(TestRunner& tr) {
     RUN_TEST(tr, runtime::TestComparison);
     RUN_TEST(tr, runtime::TestClass);
     RUN_TEST(tr, runtime::TestClassInstance);
+    RUN_TEST(tr, runtime::TestBigNumbers);
+    RUN_TEST(tr, runtime::TestFloat);
+    RUN_TEST(tr, runtime::TestStringConcat);
+    RUN_TEST(tr, runtime::TestSymbol);
+    RUN_TEST(tr, runtime::TestStringIntern);
+    RUN_TEST(tr, runtime::TestList);
+    RUN_TEST(tr, runtime::TestListSort);
+    RUN_TEST(tr, runtime::TestDict);
+    RUN_TEST(tr, runtime::TestIntArray);
+    RUN_TEST(tr, runtime::TestFloatArray);
+    RUN_TEST(tr, runtime::TestCompareTable);
+    RUN_TEST(tr, runtime::TestHash);
 }
 
 void RunObjectHolderTests(TestRunner& tr) {
@@ -547,6 +1426,15 @@ void RunObjectHolderTests(TestRunner& tr) {
     RUN_TEST(tr, runtime::TestOwning);
     RUN_TEST(tr, runtime::TestMove);
     RUN_TEST(tr, runtime::TestNullptr);
+    RUN_TEST(tr, runtime::TestCopies);
+    RUN_TEST(tr, runtime::TestHandoff);
+    RUN_TEST(tr, runtime::TestSharedValues);
+    RUN_TEST(tr, runtime::TestClosure);
+    RUN_TEST(tr, runtime::TestHeap);
+    RUN_TEST(tr, runtime::TestPools);
+    RUN_TEST(tr, runtime::TestCycleCollector);
+    RUN_TEST(tr, runtime::TestIncrementalCollector);
+    RUN_TEST(tr, runtime::TestLongChainRelease);
 }
 
 }  // namespace runtime
\ No newline at end of file
@@ -1,468 +1,899 @@
-﻿#include "statement.h"
-
-#include <iostream>
-#include <sstream>
-
-using namespace std;
-
-namespace ast {
-
-    using runtime::Closure;
-    using runtime::Context;
-    using runtime::ObjectHolder;
-
-    namespace {
-        const string __ADD_METHOD__ = "__add__"s;
-        const string __INIT_METHOD__ = "__init__"s;
-    }  // namespace
-
-    ObjectHolder Assignment::Execute(Closure& closure, [[maybe_unused]] Context& context) {
-        // вычисления сразуже вносим в таблицу символов согласно имени переменной
-        closure[_var] = _rv.get()->Execute(closure, context);
-        // возвращаем уже из таблицы символов
-        return closure.at(_var);
-    }
-
-    Assignment::Assignment(std::string var, std::unique_ptr<Statement> rv) 
-        : _var(var), _rv(std::move(rv)) {
-    }
-
-    VariableValue::VariableValue(const std::string& var_name) {
-        _dotted_ids.push_back(var_name);
-    }
-
-    VariableValue::VariableValue(std::vector<std::string> dotted_ids) 
-        : _dotted_ids(std::move(dotted_ids)) {
-    }
-
-    ObjectHolder VariableValue::Execute(Closure& closure, [[maybe_unused]] Context& context) {
-
-        if (closure.count(_dotted_ids[0])) {
-            // сюда будем перезаписывать таблицу символов
-            Closure inner_closure = closure; 
-            // возвращаемое значение
-            ObjectHolder result = inner_closure.at(_dotted_ids[0]);
-            // бежим по циклу начиная со второго элемента
-            for (size_t i = 1; i != _dotted_ids.size(); ++i) {
-                // проверяем наличие нужного поля в таблице символов
-                if (inner_closure.count(_dotted_ids[i - 1])) {
-                    // приводим первый элемент к объекту класса
-                    runtime::ClassInstance* item = inner_closure.at(_dotted_ids[i - 1]).TryAs<runtime::ClassInstance>();
-                    // перезаписываем таблицу символов
-                    inner_closure = item->Fields();
-                    // если в таблице символовм полученного элемента есть нужное нам поле
-                    if (inner_closure.count(_dotted_ids[i])) {
-                        // перезаписываем результат
-                        result = inner_closure.at(_dotted_ids[i]);
-                    }
-                    else {
-                        throw std::runtime_error("here is not a variable whit current name");
-                    }
-                }
-                else {
-                    throw std::runtime_error("here is not a variable whit current name");
-                }
-            }
-            return result;
-        }
-        else {
-            throw std::runtime_error("here is not a variable whit current name");
-        }
-    }
-
-    unique_ptr<Print> Print::Variable(const std::string& name) {
-        return std::make_unique<ast::Print>(make_unique<VariableValue>(name));
-    }
-
-    Print::Print(unique_ptr<Statement> argument) {
-        _args.push_back(std::move(argument));
-    }
-
-    Print::Print(vector<unique_ptr<Statement>> args) 
-        : _args(std::move(args)){
-    }
-
-    ObjectHolder Print::Execute(Closure& closure, Context& context) {
-        // берем поток вывода куда будем отправлять данные
-        std::ostream& out = context.GetOutputStream();
-        // флаг первого элемента для выставления пробела
-        bool IsFirst = true;
-        // перебираем аргументы
-        for (auto& arg : _args) {
-            // подготавливаем элемент к печати
-            runtime::ObjectHolder item = arg->Execute(closure, context);
-
-            if (IsFirst) {
-                // если в элементе есть что печатать
-                if (item) {
-                    item.Get()->Print(out, context);
-                }
-                else {
-                    // если в элементе нечего печатать
-                    out << "None";
-                }
-                IsFirst = false;
-            }
-            else {
-                if (item) {
-                    out << ' ';
-                    item.Get()->Print(out, context);
-                }
-                else {
-                    out << " None";
-                }
-            }
-        }
-        out << '\n';
-
-        return ObjectHolder::None();
-    }
-
-    MethodCall::MethodCall(std::unique_ptr<Statement> object, std::string method,
-        std::vector<std::unique_ptr<Statement>> args) 
-        : _object(std::move(object)), _method(std::move(method)), _args(std::move(args)) {
-    }
-
-    ObjectHolder MethodCall::Execute(Closure& closure, Context& context) {
-        // подготавливаем объект
-        runtime::ClassInstance* obj = _object->Execute(closure, context).TryAs<runtime::ClassInstance>();
-        // ищем требуемый метод
-        if (obj->HasMethod(_method, _args.size())) {
-            // подготавливаем аргументы для вызова
-            std::vector<ObjectHolder> obj_args;
-            for (auto& arg : _args) {
-                obj_args.push_back(arg->Execute(closure, context));
-            }
-            // возвращаем результат вызова метода
-            return obj->Call(_method, obj_args, context);
-        }
-        return ObjectHolder::None();
-    }
-
-    ObjectHolder Stringify::Execute(Closure& closure, Context& context) {
-        // выполняем основную инструкию из Stringify
-        runtime::ObjectHolder result = _argument->Execute(closure, context);
-        // смотрим что получилось после Execute
-        if (!result) {
-            return ObjectHolder::Own(runtime::String("None"));
-        }
-        else {
-            // загружаем представление в поток
-            std::ostringstream str;
-            result->Print(str, context);
-            // на основе полученной строки создаём runtime::ObjectHolder
-            return ObjectHolder::Own(runtime::String(str.str()));
-        }
-    }
-
-    ObjectHolder Add::Execute(Closure& closure, Context& context) {
-        
-        // выполняем левое и правое выражение
-        runtime::ObjectHolder lhs = _lhs->Execute(closure, context);
-        runtime::ObjectHolder rhs = _rhs->Execute(closure, context);
-        
-        // пытаемся оба преобразовать в число
-        if (lhs.TryAs<runtime::Number>() && rhs.TryAs<runtime::Number>()) {
-            // получаем результат сложения чисел
-            int add_result = lhs.TryAs<runtime::Number>()->GetValue() + rhs.TryAs<runtime::Number>()->GetValue();
-            // возвращаем runtime::ObjectHolder с результатом вычисления
-            return ObjectHolder().Own(std::move(runtime::Number(add_result)));
-        }
-        // пытаемся оба преобразовать в строку
-        else if (lhs.TryAs<runtime::String>() && rhs.TryAs<runtime::String>()) {
-            // получаем результат сложения строк
-            std::string add_result = lhs.TryAs<runtime::String>()->GetValue() + rhs.TryAs<runtime::String>()->GetValue();
-            // возвращаем runtime::ObjectHolder с результатом вычисления
-            return ObjectHolder().Own(std::move(runtime::String(add_result)));
-        }
-        // пытаемся левое привести к объекту класса, а правое к объекту
-        else if (lhs.TryAs<runtime::ClassInstance>() && rhs.TryAs<runtime::Object>()) {
-            runtime::ClassInstance* lhs_class = lhs.TryAs<runtime::ClassInstance>();
-
-            // првоеряем наличие метода сложения в классе
-            if (lhs_class->HasMethod(__ADD_METHOD__, 1)) {
-                return lhs_class->Call(__ADD_METHOD__, { rhs }, context);
-            }
-            else {
-                throw std::runtime_error("lhs and rhs arguments can't be added");
-            }
-        }
-        else {
-            throw std::runtime_error("lhs and rhs arguments can't be added");
-        }
-    }
-
-    ObjectHolder Sub::Execute(Closure& closure, Context& context) {
-
-        // выполняем левое и правое выражение
-        runtime::ObjectHolder lhs = _lhs->Execute(closure, context);
-        runtime::ObjectHolder rhs = _rhs->Execute(closure, context);
-
-        // пытаемся оба преобразовать в число
-        if (lhs.TryAs<runtime::Number>() && rhs.TryAs<runtime::Number>()) {
-            // получаем результат вычитания чисел
-            int add_result = lhs.TryAs<runtime::Number>()->GetValue() - rhs.TryAs<runtime::Number>()->GetValue();
-            // возвращаем runtime::ObjectHolder с результатом вычисления
-            return ObjectHolder().Own(std::move(runtime::Number(add_result)));
-        }
-        else {
-            throw std::runtime_error("lhs and rhs arguments cant be added");
-        }
-    }
-
-    ObjectHolder Mult::Execute(Closure& closure, Context& context) {
-
-        // выполняем левое и правое выражение
-        runtime::ObjectHolder lhs = _lhs->Execute(closure, context);
-        runtime::ObjectHolder rhs = _rhs->Execute(closure, context);
-
-        // пытаемся оба преобразовать в число
-        if (lhs.TryAs<runtime::Number>() && rhs.TryAs<runtime::Number>()) {
-            // получаем результат умножения чисел
-            int add_result = lhs.TryAs<runtime::Number>()->GetValue() * rhs.TryAs<runtime::Number>()->GetValue();
-            // возвращаем runtime::ObjectHolder с результатом вычисления
-            return ObjectHolder().Own(std::move(runtime::Number(add_result)));
-        }
-        else {
-            throw std::runtime_error("lhs and rhs arguments cant be added");
-        }
-    }
-
-    ObjectHolder Div::Execute(Closure& closure, Context& context) {
-
-        // выполняем левое и правое выражение
-        runtime::ObjectHolder lhs = _lhs->Execute(closure, context);
-        runtime::ObjectHolder rhs = _rhs->Execute(closure, context);
-
-        // пытаемся оба преобразовать в число
-        if (lhs.TryAs<runtime::Number>() && rhs.TryAs<runtime::Number>()) {
-
-            // смотрим не равно ли нулю
-            if (rhs.TryAs<runtime::Number>()->GetValue() != 0) {
-                // получаем результат деления чисел
-                int add_result = lhs.TryAs<runtime::Number>()->GetValue() / rhs.TryAs<runtime::Number>()->GetValue();
-                // возвращаем runtime::ObjectHolder с результатом вычисления
-                return ObjectHolder().Own(std::move(runtime::Number(add_result)));
-            }
-            else {
-                throw std::runtime_error("lhs and rhs arguments cant be added");
-            }
-        }
-        else {
-            throw std::runtime_error("lhs and rhs arguments cant be added");
-        }
-    }
-
-    ObjectHolder Compound::Execute(Closure& closure, Context& сontext) {
-        
-        // последовательно выполняем инструкции
-        for (auto& arg : _args) {
-            try
-            {
-                // если инструкция выполняет условие if/elst или вызов метода
-                if (dynamic_cast<IfElse*>(arg.get()) || dynamic_cast<MethodCall*>(arg.get()))
-                {
-                    // получаем результат вызова
-                    runtime::ObjectHolder result = arg->Execute(closure, сontext);
-
-                    if (result) {
-                        // если результат получен то возвращаем его в ретурн
-                        return result;
-                    }
-                }
-
-                // в противном случае просто выполняем инструкцию
-                // например инструкции инициализации класса, объекта, поля и т.п.
-                else {
-                    arg->Execute(closure, сontext);
-                }
-
-            }
-            catch (const ast::return_data_exp& result)
-            {
-                // ловим кетч от ретурна и останавливаем выполнение команды
-                return ObjectHolder::Own(runtime::String(result.what()));
-                break;
-            }
-        }
-        return ObjectHolder().None();
-    }
-
-    ObjectHolder Return::Execute(Closure& closure, Context& context) {
-
-        // подготавливаем результат вычислений того что в ретурне написано
-        runtime::ObjectHolder pre_result = _stmt->Execute(closure, context);
-        std::stringstream stream;
-
-        // выводим результат вычислений ретурна в строку
-        pre_result->Print(stream, context);
-        std::string to_string_result = stream.str();
-
-        // бросаем исключение для дальнейшего отлова в Compound::Execute
-        throw ast::return_data_exp(std::move(to_string_result));
-    }
-
-    ClassDefinition::ClassDefinition(ObjectHolder cls) 
-        : _cls(std::move(cls)) {
-    }
-
-    ObjectHolder ClassDefinition::Execute(Closure& closure, [[maybe_unused]] Context& context) {
-        closure[_cls.TryAs<runtime::Class>()->GetName()] = _cls;
-        return runtime::ObjectHolder::None();
-    }
-
-    FieldAssignment::FieldAssignment(VariableValue object, std::string field_name,
-        std::unique_ptr<Statement> rv) : _object(std::move(object)), _field_name(std::move(field_name)), _rv(std::move(rv)) {
-    }
-
-    ObjectHolder FieldAssignment::Execute(Closure& closure, [[maybe_unused]] Context& context) {
-
-        // приводимся к экземпляру класса
-        runtime::ClassInstance* item = _object.Execute(closure, context).TryAs<runtime::ClassInstance>();
-        // присваиваем или создаем новое поле из _field_name
-        item->Fields()[_field_name] = _rv->Execute(closure, context);
-        // возвращаем уже из таблицы экземпляра
-        return item->Fields().at(_field_name);
-    }
-
-    IfElse::IfElse(std::unique_ptr<Statement> condition, std::unique_ptr<Statement> if_body,
-        std::unique_ptr<Statement> else_body) 
-        : _condition(std::move(condition))
-        , _if_body(std::move(if_body))
-        , _else_body(std::move(else_body)) {
-    }
-
-    ObjectHolder IfElse::Execute(Closure& closure, Context& context) {
-        if (_condition->Execute(closure, context).TryAs<runtime::Bool>()->GetValue()) {
-            return _if_body->Execute(closure, context);
-        }
-        else {
-            if (_else_body) {
-                return _else_body->Execute(closure, context);
-            }
-            else {
-                return ObjectHolder::None();
-            }
-        }
-    }
-
-    ObjectHolder Or::Execute(Closure& closure, Context& context) {
-        // выполняем левое и правое выражение
-        runtime::ObjectHolder lhs = _lhs->Execute(closure, context);
-        runtime::ObjectHolder rhs = _rhs->Execute(closure, context);
-
-        // пытаемся оба преобразовать в булеан
-        if (lhs.TryAs<runtime::Bool>() && rhs.TryAs<runtime::Bool>()) {
-
-            // если левое True
-            if (lhs.TryAs<runtime::Bool>()->GetValue()) {
-
-                return ObjectHolder().Own(std::move(runtime::Bool(true)));
-            }
-            // если левое False, но правое True
-            else if (rhs.TryAs<runtime::Bool>()->GetValue()) {
-                return ObjectHolder().Own(std::move(runtime::Bool(true)));
-            }
-            else {
-                // оба False
-                return ObjectHolder().Own(std::move(runtime::Bool(false)));
-            }
-        }
-        else {
-            throw std::runtime_error("unknow lhs and rhs arguments");
-        }
-    }
-
-    ObjectHolder And::Execute(Closure& closure, Context& context) {
-        
-        // выполняем левое и правое выражение
-        runtime::ObjectHolder lhs = _lhs->Execute(closure, context);
-        runtime::ObjectHolder rhs = _rhs->Execute(closure, context);
-
-        // пытаемся оба преобразовать в булеан
-        if (lhs.TryAs<runtime::Bool>() && rhs.TryAs<runtime::Bool>()) {
-
-            // если левое и првое True
-            if (lhs.TryAs<runtime::Bool>()->GetValue() && rhs.TryAs<runtime::Bool>()->GetValue()) {
-
-                return ObjectHolder().Own(std::move(runtime::Bool(true)));
-            }
-
-            else {
-                return ObjectHolder().Own(std::move(runtime::Bool(false)));
-            }
-        }
-        else {
-            throw std::runtime_error("unknow lhs and rhs arguments");
-        }
-    }
-
-    ObjectHolder Not::Execute(Closure& closure, Context& context) {
-        
-        // выполняем выражение
-        runtime::ObjectHolder arg = _argument->Execute(closure, context);
-        
-        // пытаемся преобразовать в булеан
-        if (arg.TryAs<runtime::Bool>()) {
-
-            // если полученное значение True
-            if (arg.TryAs<runtime::Bool>()->GetValue()) {
-                // инвертируем в False
-                return ObjectHolder().Own(std::move(runtime::Bool(false)));
-            }
-            else {
-                return ObjectHolder().Own(std::move(runtime::Bool(true)));
-            }
-        }
-        else {
-            throw std::runtime_error("unknow argument");
-        }
-    }
-
-    Comparison::Comparison(Comparator cmp, unique_ptr<Statement> lhs, unique_ptr<Statement> rhs)
-        : BinaryOperation(std::move(lhs), std::move(rhs)), _cmp(cmp) {
-    }
-
-    ObjectHolder Comparison::Execute(Closure& closure, Context& context) {
-        bool result = _cmp(_lhs->Execute(closure, context), _rhs->Execute(closure, context), context);
-        return ObjectHolder().Own<runtime::Bool>(std::move(result));
-    }
-
-    NewInstance::NewInstance(const runtime::Class& class_, std::vector<std::unique_ptr<Statement>> args) 
-        : _class(class_), _args(std::move(args)) {
-    }
-
-    NewInstance::NewInstance(const runtime::Class& class_) 
-        : _class(class_){
-    }
-
-    ObjectHolder NewInstance::Execute(Closure& closure, Context& context) {
-
-        // создаём объект экземпляра класса в куче с помощью ObjectHolder::Own
-        runtime::ObjectHolder new_instance = ObjectHolder::Own(runtime::ClassInstance(_class));
-        // кастуем приведение к экземпляру для последующей инициализации полей
-        runtime::ClassInstance* inst = new_instance.TryAs<runtime::ClassInstance>();
-        
-        // если есть метод инициализации и количество аргументов совпадает
-        if (inst->HasMethod(__INIT_METHOD__, _args.size())) {
-            // подготавливаем вектор аргументов
-            std::vector<ObjectHolder> actual_args;
-            for (const auto& arg : _args) {
-                actual_args.push_back(arg->Execute(closure, context));
-            }
-            // отправляем в функцию инициализации полей
-            inst->Call(__INIT_METHOD__, actual_args, context);
-        }
-        
-        return new_instance;         // возвращаем созданный объект
-    }
-
-    MethodBody::MethodBody(std::unique_ptr<Statement>&& body) 
-        : _body(std::move(body)) {
-    }
-
-    ObjectHolder MethodBody::Execute(Closure& closure, Context& context) {
-        return _body->Execute(closure, context);
-    }
-
+﻿#include "statement.h"
+
+#include <algorithm>
+#include <functional>
+#include <iostream>
+#include <sstream>
+
+using namespace std;
+
+namespace ast {
+
+    using runtime::Closure;
+    using runtime::Context;
+    using runtime::ObjectHolder;
+
+    namespace {
+        const runtime::Symbol __ADD_METHOD__("__add__");
+
+        bool AreNumbers(const ObjectHolder& lhs, const ObjectHolder& rhs) {
+            return lhs.Kind() == runtime::ObjectKind::Number && rhs.Kind() == runtime::ObjectKind::Number;
+        }
+
+        bool AreStrings(const ObjectHolder& lhs, const ObjectHolder& rhs) {
+            return lhs.Kind() == runtime::ObjectKind::String && rhs.Kind() == runtime::ObjectKind::String;
+        }
+
+        // Сложение вызывает метод __add__ экземпляра lhs. С None, как и в общей ветке, экземпляр не складывается
+        bool IsInstanceAddition(const ObjectHolder& lhs, const ObjectHolder& rhs) {
+            return lhs.Kind() == runtime::ObjectKind::Instance && static_cast<bool>(rhs);
+        }
+
+        // Значение object, тип которого уже проверен через Kind
+        int64_t NumberValue(const ObjectHolder& object) {
+            return static_cast<const runtime::Number*>(object.Get())->GetValue();
+        }
+
+        const runtime::String& StringValue(const ObjectHolder& object) {
+            return *static_cast<const runtime::String*>(object.Get());
+        }
+
+        // Вариант специализации арифметической операции над числами
+        Quickened ObserveNumbers(const ObjectHolder& lhs, const ObjectHolder& rhs) {
+            return AreNumbers(lhs, rhs) ? Quickened::Numbers : Quickened::Warmup;
+        }
+
+        // Вариант специализации сложения: числа, строки или экземпляр с методом __add__
+        Quickened ObserveAdd(const ObjectHolder& lhs, const ObjectHolder& rhs) {
+            if (AreNumbers(lhs, rhs)) {
+                return Quickened::Numbers;
+            }
+            if (AreStrings(lhs, rhs)) {
+                return Quickened::Strings;
+            }
+            return IsInstanceAddition(lhs, rhs) ? Quickened::Instance : Quickened::Warmup;
+        }
+
+        // Вариант специализации сравнения: числа или строки
+        Quickened ObserveComparison(const ObjectHolder& lhs, const ObjectHolder& rhs) {
+            if (AreNumbers(lhs, rhs)) {
+                return Quickened::Numbers;
+            }
+            return AreStrings(lhs, rhs) ? Quickened::Strings : Quickened::Warmup;
+        }
+
+        // Вычисляет lhs op rhs через функции сравнения less и equal значений одного типа
+        template <runtime::CompareOp op, typename Value, typename LessThan, typename EqualTo>
+        bool Satisfies(const Value& lhs, const Value& rhs, LessThan less, EqualTo equal) {
+            if constexpr (op == runtime::CompareOp::Less) {
+                return less(lhs, rhs);
+            }
+            else if constexpr (op == runtime::CompareOp::LessOrEqual) {
+                return !less(rhs, lhs);
+            }
+            else if constexpr (op == runtime::CompareOp::Greater) {
+                return less(rhs, lhs);
+            }
+            else if constexpr (op == runtime::CompareOp::GreaterOrEqual) {
+                return !less(lhs, rhs);
+            }
+            else if constexpr (op == runtime::CompareOp::Equal) {
+                return equal(lhs, rhs);
+            }
+            else {
+                return !equal(lhs, rhs);
+            }
+        }
+
+        ObjectHolder AddInstance(runtime::ClassInstance& lhs, const ObjectHolder& rhs, Context& context) {
+            // првоеряем наличие метода сложения в классе
+            if (lhs.HasMethod(__ADD_METHOD__, 1)) {
+                return lhs.Call(__ADD_METHOD__, { rhs }, context);
+            }
+            throw std::runtime_error("lhs and rhs arguments can't be added");
+        }
+    }  // namespace
+
+    void TypeFeedback::Record(Quickened observed) {
+        if (observed != _candidate) {
+            _candidate = observed;
+            _hits = 0;
+        }
+        if (observed != Quickened::Warmup && ++_hits >= __QUICKEN_THRESHOLD__) {
+            _state = observed;
+        }
+    }
+
+    void TypeFeedback::Deoptimize() {
+        // узел, типы аргументов которого постоянно меняются, перестаёт специализироваться
+        _state = ++_deopts >= __QUICKEN_MAX_DEOPTS__ ? Quickened::Generic : Quickened::Warmup;
+        _candidate = Quickened::Warmup;
+        _hits = 0;
+    }
+
+    ObjectHolder Assignment::Execute(Closure& closure, [[maybe_unused]] Context& context) {
+        // вычисления сразуже вносим в таблицу символов согласно имени переменной
+        ObjectHolder value = _rv.get()->Execute(closure, context);
+        // значение получает новую ссылку, сообщаем об этом идущему циклу сборки
+        runtime::CycleCollector::WriteBarrier(value);
+        // возвращаем уже из таблицы символов
+        return closure[_var] = std::move(value);
+    }
+
+    Assignment::Assignment(std::string var, std::unique_ptr<Statement> rv) 
+        : _var(std::move(var)), _rv(std::move(rv)) {
+    }
+
+    VariableValue::VariableValue(const std::string& var_name) {
+        _dotted_ids.emplace_back(var_name);
+    }
+
+    VariableValue::VariableValue(std::vector<std::string> dotted_ids) 
+        : _dotted_ids(dotted_ids.begin(), dotted_ids.end()) {
+    }
+
+    ObjectHolder VariableValue::Execute(Closure& closure, [[maybe_unused]] Context& context) {
+        // таблица символов, в которой ищем очередное имя цепочки
+        const Closure* scope = &closure;
+        ObjectHolder result;
+        for (size_t i = 0; i != _dotted_ids.size(); ++i) {
+            // начиная со второго имени ищем среди полей объекта, полученного на предыдущем шаге
+            if (i != 0) {
+                runtime::ClassInstance* item = result.TryAs<runtime::ClassInstance>();
+                if (!item) {
+                    throw std::runtime_error(runtime::__UNDEFINED_VARIABLE_ERROR__);
+                }
+                scope = &item->Fields();
+            }
+            auto found = scope->find(_dotted_ids[i]);
+            if (found == scope->end()) {
+                throw std::runtime_error(runtime::__UNDEFINED_VARIABLE_ERROR__);
+            }
+            result = found->second;
+        }
+        return result;
+    }
+
+    unique_ptr<Print> Print::Variable(const std::string& name) {
+        return std::make_unique<ast::Print>(make_unique<VariableValue>(name));
+    }
+
+    Print::Print(unique_ptr<Statement> argument) {
+        _args.push_back(std::move(argument));
+    }
+
+    Print::Print(vector<unique_ptr<Statement>> args) 
+        : _args(std::move(args)){
+    }
+
+    ObjectHolder Print::Execute(Closure& closure, Context& context) {
+        // берем поток вывода куда будем отправлять данные
+        std::ostream& out = context.GetOutputStream();
+        // флаг первого элемента для выставления пробела
+        bool IsFirst = true;
+        // перебираем аргументы
+        for (auto& arg : _args) {
+            // подготавливаем элемент к печати
+            runtime::ObjectHolder item = arg->Execute(closure, context);
+
+            if (IsFirst) {
+                // если в элементе есть что печатать
+                if (item) {
+                    item.Get()->Print(out, context);
+                }
+                else {
+                    // если в элементе нечего печатать
+                    out << "None";
+                }
+                IsFirst = false;
+            }
+            else {
+                if (item) {
+                    out << ' ';
+                    item.Get()->Print(out, context);
+                }
+                else {
+                    out << " None";
+                }
+            }
+        }
+        out << '\n';
+
+        return ObjectHolder::None();
+    }
+
+    MethodCall::MethodCall(std::unique_ptr<Statement> object, std::string method,
+        std::vector<std::unique_ptr<Statement>> args) 
+        : _object(std::move(object)), _method(std::move(method)), _args(std::move(args)) {
+    }
+
+    ObjectHolder MethodCall::Execute(Closure& closure, Context& context) {
+        // подготавливаем объект, держим его до конца вызова
+        runtime::ObjectHolder object = _object->Execute(closure, context);
+
+        // встроенные методы списков, словарей и числовых массивов
+        if (object.TryAs<runtime::List>() || object.TryAs<runtime::Dict>() || object.TryAs<runtime::IntArray>()
+            || object.TryAs<runtime::FloatArray>()) {
+            std::vector<ObjectHolder> builtin_args;
+            for (auto& arg : _args) {
+                builtin_args.push_back(arg->Execute(closure, context));
+            }
+            if (runtime::List* list = object.TryAs<runtime::List>()) {
+                return list->Call(_method, builtin_args, context);
+            }
+            else if (runtime::Dict* dict = object.TryAs<runtime::Dict>()) {
+                return dict->Call(_method, builtin_args, context);
+            }
+            else if (runtime::IntArray* array = object.TryAs<runtime::IntArray>()) {
+                return array->Call(_method, builtin_args, context);
+            }
+            return object.TryAs<runtime::FloatArray>()->Call(_method, builtin_args, context);
+        }
+
+        runtime::ClassInstance* obj = object.TryAs<runtime::ClassInstance>();
+        if (!obj) {
+            throw std::runtime_error("Method \""s + _method.Name() + "\" called on non-object value"s);
+        }
+        // ищем требуемый метод
+        if (obj->HasMethod(_method, _args.size())) {
+            // аргументы вычисляются прямо в кадр вызываемого метода
+            return obj->Call(_method, _args, closure, context);
+        }
+        return ObjectHolder::None();
+    }
+
+    ObjectHolder Stringify::Execute(Closure& closure, Context& context) {
+        // выполняем основную инструкию из Stringify
+        return Evaluate(_argument->Execute(closure, context), context);
+    }
+
+    ObjectHolder Stringify::Evaluate(const ObjectHolder& result, Context& context) {
+        // смотрим что получилось после Execute
+        if (!result) {
+            return ObjectHolder::Own(runtime::String("None"));
+        }
+        // строка уже является своим строковым представлением, копия разделяет с ней буфер без копирования символов
+        else if (const runtime::String* value = result.TryAs<runtime::String>()) {
+            return ObjectHolder::Own(runtime::String(*value));
+        }
+        else {
+            // загружаем представление в поток
+            std::ostringstream str;
+            result->Print(str, context);
+            // на основе полученной строки создаём runtime::ObjectHolder
+            return ObjectHolder::Own(runtime::String(str.str()));
+        }
+    }
+
+    ObjectHolder Length::Execute(Closure& closure, Context& context) {
+        // выполняем аргумент
+        return Evaluate(_argument->Execute(closure, context));
+    }
+
+    ObjectHolder Length::Evaluate(const ObjectHolder& arg) {
+        if (runtime::List* list = arg.TryAs<runtime::List>()) {
+            return runtime::MakeNumber(static_cast<int64_t>(list->Size()));
+        }
+        else if (runtime::Dict* dict = arg.TryAs<runtime::Dict>()) {
+            return runtime::MakeNumber(static_cast<int64_t>(dict->Size()));
+        }
+        else if (runtime::IntArray* array = arg.TryAs<runtime::IntArray>()) {
+            return runtime::MakeNumber(static_cast<int64_t>(array->Size()));
+        }
+        else if (runtime::FloatArray* array = arg.TryAs<runtime::FloatArray>()) {
+            return runtime::MakeNumber(static_cast<int64_t>(array->Size()));
+        }
+        else if (runtime::String* str = arg.TryAs<runtime::String>()) {
+            return runtime::MakeNumber(static_cast<int64_t>(str->Size()));
+        }
+        else {
+            throw std::runtime_error("Object has no len()");
+        }
+    }
+
+    ObjectHolder Add::Execute(Closure& closure, Context& context) {
+        
+        // выполняем левое и правое выражение
+        runtime::ObjectHolder lhs = _lhs->Execute(closure, context);
+        runtime::ObjectHolder rhs = _rhs->Execute(closure, context);
+
+        // специализированная ветка только сверяет типы аргументов
+        switch (_feedback.State()) {
+        case Quickened::Numbers:
+            if (AreNumbers(lhs, rhs)) {
+                return runtime::NumberAdd(NumberValue(lhs), NumberValue(rhs));
+            }
+            break;
+        case Quickened::Strings:
+            if (AreStrings(lhs, rhs)) {
+                return ObjectHolder::Own(runtime::String::Concat(StringValue(lhs), StringValue(rhs)));
+            }
+            break;
+        case Quickened::Instance:
+            if (IsInstanceAddition(lhs, rhs)) {
+                return AddInstance(*static_cast<runtime::ClassInstance*>(lhs.Get()), rhs, context);
+            }
+            break;
+        case Quickened::Warmup:
+            _feedback.Record(ObserveAdd(lhs, rhs));
+            return runtime::Arithmetic(runtime::ArithmeticOp::Add, lhs, rhs, context);
+        case Quickened::Generic:
+            return runtime::Arithmetic(runtime::ArithmeticOp::Add, lhs, rhs, context);
+        }
+        // промах: типы аргументов изменились
+        _feedback.Deoptimize();
+        return runtime::Arithmetic(runtime::ArithmeticOp::Add, lhs, rhs, context);
+    }
+
+    ObjectHolder Sub::Execute(Closure& closure, Context& context) {
+
+        // выполняем левое и правое выражение
+        runtime::ObjectHolder lhs = _lhs->Execute(closure, context);
+        runtime::ObjectHolder rhs = _rhs->Execute(closure, context);
+
+        if (_feedback.State() == Quickened::Numbers) {
+            if (AreNumbers(lhs, rhs)) {
+                return runtime::NumberSub(NumberValue(lhs), NumberValue(rhs));
+            }
+            _feedback.Deoptimize();
+        }
+        else if (_feedback.State() == Quickened::Warmup) {
+            _feedback.Record(ObserveNumbers(lhs, rhs));
+        }
+        return runtime::Arithmetic(runtime::ArithmeticOp::Sub, lhs, rhs, context);
+    }
+
+    ObjectHolder Mult::Execute(Closure& closure, Context& context) {
+
+        // выполняем левое и правое выражение
+        runtime::ObjectHolder lhs = _lhs->Execute(closure, context);
+        runtime::ObjectHolder rhs = _rhs->Execute(closure, context);
+
+        if (_feedback.State() == Quickened::Numbers) {
+            if (AreNumbers(lhs, rhs)) {
+                return runtime::NumberMul(NumberValue(lhs), NumberValue(rhs));
+            }
+            _feedback.Deoptimize();
+        }
+        else if (_feedback.State() == Quickened::Warmup) {
+            _feedback.Record(ObserveNumbers(lhs, rhs));
+        }
+        return runtime::Arithmetic(runtime::ArithmeticOp::Mult, lhs, rhs, context);
+    }
+
+    ObjectHolder Div::Execute(Closure& closure, Context& context) {
+
+        // выполняем левое и правое выражение
+        runtime::ObjectHolder lhs = _lhs->Execute(closure, context);
+        runtime::ObjectHolder rhs = _rhs->Execute(closure, context);
+
+        if (_feedback.State() == Quickened::Numbers) {
+            if (AreNumbers(lhs, rhs)) {
+                return runtime::NumberDiv(NumberValue(lhs), NumberValue(rhs));
+            }
+            _feedback.Deoptimize();
+        }
+        else if (_feedback.State() == Quickened::Warmup) {
+            _feedback.Record(ObserveNumbers(lhs, rhs));
+        }
+        return runtime::Arithmetic(runtime::ArithmeticOp::Div, lhs, rhs, context);
+    }
+
+    ObjectHolder Index::Execute(Closure& closure, Context& context) {
+
+        // выполняем выражение объекта и индекса
+        runtime::ObjectHolder object = _lhs->Execute(closure, context);
+        runtime::ObjectHolder index = _rhs->Execute(closure, context);
+        return Evaluate(object, index, context);
+    }
+
+    ObjectHolder Index::Evaluate(const ObjectHolder& object, const ObjectHolder& index, Context& context) {
+        // в словаре ключом может быть любое хешируемое значение
+        if (runtime::Dict* dict = object.TryAs<runtime::Dict>()) {
+            return dict->At(index, context);
+        }
+
+        runtime::Number* position = index.TryAs<runtime::Number>();
+        if (!position) {
+            throw std::runtime_error("Index must be a number");
+        }
+
+        // индексирование списка
+        if (runtime::List* list = object.TryAs<runtime::List>()) {
+            return list->At(position->GetValue());
+        }
+        // элемент числового массива упаковывается в Number при чтении
+        else if (runtime::IntArray* array = object.TryAs<runtime::IntArray>()) {
+            return runtime::MakeNumber(array->At(position->GetValue()));
+        }
+        else if (runtime::FloatArray* array = object.TryAs<runtime::FloatArray>()) {
+            return ObjectHolder::Own(runtime::Float(array->At(position->GetValue())));
+        }
+        // индексирование строки возвращает строку из одного символа
+        else if (runtime::String* str = object.TryAs<runtime::String>()) {
+            std::string_view value = str->View();
+            int64_t i = position->GetValue() < 0 ? static_cast<int64_t>(value.size()) + position->GetValue() : position->GetValue();
+            if (i < 0 || i >= static_cast<int64_t>(value.size())) {
+                throw std::runtime_error("String index out of range");
+            }
+            // односимвольные строки интернированы и сравниваются по адресу буфера
+            return ObjectHolder::Own(runtime::String::Intern(value.substr(static_cast<size_t>(i), 1)));
+        }
+        else {
+            throw std::runtime_error("Object is not subscriptable");
+        }
+    }
+
+    ObjectHolder Membership::Execute(Closure& closure, Context& context) {
+
+        // выполняем левое и правое выражение
+        runtime::ObjectHolder item = _lhs->Execute(closure, context);
+        runtime::ObjectHolder container = _rhs->Execute(closure, context);
+        return runtime::MakeBool(Contains(item, container, context));
+    }
+
+    bool Membership::Contains(const ObjectHolder& item, const ObjectHolder& container, Context& context) {
+        bool result = false;
+        // ищем ключ в хеш-таблице словаря
+        if (runtime::Dict* dict = container.TryAs<runtime::Dict>()) {
+            result = dict->Contains(item, context);
+        }
+        // в списке ищем равный элемент перебором
+        else if (runtime::List* list = container.TryAs<runtime::List>()) {
+            for (const auto& value : list->Values()) {
+                if (runtime::EqualKeys(value, item, context)) {
+                    result = true;
+                    break;
+                }
+            }
+        }
+        // в числовом массиве ищем число прямо в непрерывном хранилище
+        else if (runtime::IntArray* array = container.TryAs<runtime::IntArray>()) {
+            if (runtime::Number* number = item.TryAs<runtime::Number>()) {
+                const std::vector<int64_t>& values = array->Values();
+                result = std::find(values.begin(), values.end(), number->GetValue()) != values.end();
+            }
+        }
+        else if (runtime::FloatArray* array = container.TryAs<runtime::FloatArray>()) {
+            if (runtime::IsNumeric(item)) {
+                const std::vector<double>& values = array->Values();
+                result = std::find(values.begin(), values.end(), runtime::ToDouble(item)) != values.end();
+            }
+        }
+        // в строке ищем подстроку
+        else if (container.TryAs<runtime::String>() && item.TryAs<runtime::String>()) {
+            result = container.TryAs<runtime::String>()->View().find(
+                item.TryAs<runtime::String>()->View()) != std::string_view::npos;
+        }
+        else {
+            throw std::runtime_error("Object does not support membership test");
+        }
+        return result;
+    }
+
+    ObjectHolder Compound::Execute(Closure& closure, Context& сontext) {
+        
+        // последовательно выполняем инструкции,
+        // после инструкции return остальные не выполняются, результат забирает MethodBody
+        for (auto& arg : _args) {
+            arg->Execute(closure, сontext);
+            if (closure.IsReturning()) {
+                break;
+            }
+        }
+        return ObjectHolder().None();
+    }
+
+    ObjectHolder Return::Execute(Closure& closure, Context& context) {
+        // запоминаем результат в кадре метода, составные инструкции и циклы на этом остановятся
+        closure.SetReturnValue(_stmt->Execute(closure, context));
+        return ObjectHolder::None();
+    }
+
+    ClassDefinition::ClassDefinition(ObjectHolder cls) 
+        : _cls(std::move(cls))
+        , _name(_cls.TryAs<runtime::Class>()->GetName()) {
+    }
+
+    ObjectHolder ClassDefinition::Execute(Closure& closure, [[maybe_unused]] Context& context) {
+        closure[_name] = _cls;
+        return runtime::ObjectHolder::None();
+    }
+
+    FieldAssignment::FieldAssignment(VariableValue object, std::string field_name,
+        std::unique_ptr<Statement> rv) : _object(std::move(object)), _field_name(std::move(field_name)), _rv(std::move(rv)) {
+    }
+
+    ObjectHolder FieldAssignment::Execute(Closure& closure, [[maybe_unused]] Context& context) {
+
+        // приводимся к экземпляру класса
+        runtime::ClassInstance* item = _object.Execute(closure, context).TryAs<runtime::ClassInstance>();
+        ObjectHolder value = _rv->Execute(closure, context);
+        runtime::CycleCollector::WriteBarrier(value);
+        // присваиваем или создаем новое поле из _field_name
+        item->Fields()[_field_name] = std::move(value);
+        // возвращаем уже из таблицы экземпляра
+        return item->Fields().at(_field_name);
+    }
+
+    IfElse::IfElse(std::unique_ptr<Statement> condition, std::unique_ptr<Statement> if_body,
+        std::unique_ptr<Statement> else_body) 
+        : _condition(std::move(condition))
+        , _if_body(std::move(if_body))
+        , _else_body(std::move(else_body)) {
+    }
+
+    ObjectHolder IfElse::Execute(Closure& closure, Context& context) {
+        if (runtime::IsTrue(_condition->Execute(closure, context))) {
+            return _if_body->Execute(closure, context);
+        }
+        else {
+            if (_else_body) {
+                return _else_body->Execute(closure, context);
+            }
+            else {
+                return ObjectHolder::None();
+            }
+        }
+    }
+
+    ForEach::ForEach(std::string var, std::unique_ptr<Statement> iterable, std::unique_ptr<Statement> body)
+        : _var(std::move(var))
+        , _iterable(std::move(iterable))
+        , _body(std::move(body)) {
+    }
+
+    ObjectHolder ForEach::Execute(Closure& closure, Context& context) {
+        // держим итерируемый объект до конца цикла
+        runtime::ObjectHolder iterable = _iterable->Execute(closure, context);
+
+        if (runtime::List* list = iterable.TryAs<runtime::List>()) {
+            // идём по индексу, так как тело цикла может дописывать элементы в список
+            for (size_t i = 0; i < list->Size() && !closure.IsReturning(); ++i) {
+                closure[_var] = list->Values()[i];
+                _body->Execute(closure, context);
+            }
+        }
+        else if (runtime::Dict* dict = iterable.TryAs<runtime::Dict>()) {
+            // словарь обходим по ключам в порядке вставки. Как и в Python, тело цикла не может менять его размер
+            const size_t size = dict->Size();
+            for (size_t i = 0; i < size && !closure.IsReturning(); ++i) {
+                closure[_var] = dict->Entries()[i].key;
+                _body->Execute(closure, context);
+                if (!closure.IsReturning() && dict->Size() != size) {
+                    throw std::runtime_error(runtime::__DICT_CHANGED_SIZE_ERROR__);
+                }
+            }
+        }
+        else if (runtime::IntArray* array = iterable.TryAs<runtime::IntArray>()) {
+            // элементы массива упаковываются в Number по одному на итерацию
+            for (size_t i = 0; i < array->Size() && !closure.IsReturning(); ++i) {
+                closure[_var] = runtime::MakeNumber(array->Values()[i]);
+                _body->Execute(closure, context);
+            }
+        }
+        else if (runtime::FloatArray* array = iterable.TryAs<runtime::FloatArray>()) {
+            for (size_t i = 0; i < array->Size() && !closure.IsReturning(); ++i) {
+                closure[_var] = ObjectHolder::Own(runtime::Float(array->Values()[i]));
+                _body->Execute(closure, context);
+            }
+        }
+        else if (runtime::String* str = iterable.TryAs<runtime::String>()) {
+            // строку обходим посимвольно
+            const std::string value(str->View());
+            for (char c : value) {
+                closure[_var] = ObjectHolder::Own(runtime::String::Intern(std::string_view(&c, 1)));
+                _body->Execute(closure, context);
+                if (closure.IsReturning()) {
+                    break;
+                }
+            }
+        }
+        else {
+            throw std::runtime_error("Object is not iterable");
+        }
+        return ObjectHolder::None();
+    }
+
+    ObjectHolder Or::Execute(Closure& closure, Context& context) {
+        // истинное левое значение и есть результат, правое выражение не выполняем
+        runtime::ObjectHolder lhs = _lhs->Execute(closure, context);
+        if (runtime::IsTrue(lhs)) {
+            return lhs;
+        }
+        return _rhs->Execute(closure, context);
+    }
+
+    ObjectHolder And::Execute(Closure& closure, Context& context) {
+        // ложное левое значение и есть результат, правое выражение не выполняем
+        runtime::ObjectHolder lhs = _lhs->Execute(closure, context);
+        if (!runtime::IsTrue(lhs)) {
+            return lhs;
+        }
+        return _rhs->Execute(closure, context);
+    }
+
+    ObjectHolder Not::Execute(Closure& closure, Context& context) {
+        // or и and возвращают сами операнды, поэтому not приводит к Bool значение любого типа
+        return runtime::MakeBool(!runtime::IsTrue(_argument->Execute(closure, context)));
+    }
+
+    template <runtime::CompareOp op>
+    ObjectHolder Comparison<op>::Execute(Closure& closure, Context& context) {
+        runtime::ObjectHolder lhs = _lhs->Execute(closure, context);
+        runtime::ObjectHolder rhs = _rhs->Execute(closure, context);
+
+        switch (_feedback.State()) {
+        case Quickened::Numbers:
+            if (AreNumbers(lhs, rhs)) {
+                return runtime::MakeBool(Satisfies<op>(NumberValue(lhs), NumberValue(rhs),
+                    std::less<>{}, std::equal_to<>{}));
+            }
+            _feedback.Deoptimize();
+            break;
+        case Quickened::Strings:
+            if (AreStrings(lhs, rhs)) {
+                return runtime::MakeBool(Satisfies<op>(StringValue(lhs), StringValue(rhs),
+                    [](const runtime::String& l, const runtime::String& r) { return l.Less(r); },
+                    [](const runtime::String& l, const runtime::String& r) { return l.Equals(r); }));
+            }
+            _feedback.Deoptimize();
+            break;
+        case Quickened::Warmup:
+            _feedback.Record(ObserveComparison(lhs, rhs));
+            break;
+        default:
+            break;
+        }
+        return runtime::MakeBool(runtime::Compare(op, lhs, rhs, context));
+    }
+
+    template class Comparison<runtime::CompareOp::Less>;
+    template class Comparison<runtime::CompareOp::LessOrEqual>;
+    template class Comparison<runtime::CompareOp::Greater>;
+    template class Comparison<runtime::CompareOp::GreaterOrEqual>;
+    template class Comparison<runtime::CompareOp::Equal>;
+    template class Comparison<runtime::CompareOp::NotEqual>;
+
+    NewInstance::NewInstance(const runtime::Class& class_, std::vector<std::unique_ptr<Statement>> args) 
+        : _class(class_), _args(std::move(args)) {
+    }
+
+    NewInstance::NewInstance(const runtime::Class& class_) 
+        : _class(class_){
+    }
+
+    ObjectHolder NewInstance::Execute(Closure& closure, Context& context) {
+
+        // создаём объект экземпляра класса в куче с помощью ObjectHolder::Own
+        runtime::ObjectHolder new_instance = ObjectHolder::Own(runtime::ClassInstance(_class));
+        // кастуем приведение к экземпляру для последующей инициализации полей
+        runtime::ClassInstance* inst = new_instance.TryAs<runtime::ClassInstance>();
+        
+        // если есть метод инициализации и количество аргументов совпадает
+        if (inst->HasMethod(runtime::__INIT_METHOD__, _args.size())) {
+            // аргументы вычисляются прямо в кадр метода инициализации полей
+            inst->Call(runtime::__INIT_METHOD__, _args, closure, context);
+        }
+        
+        return new_instance;         // возвращаем созданный объект
+    }
+
+    NewList::NewList(std::vector<std::unique_ptr<Statement>> items)
+        : _items(std::move(items)) {
+    }
+
+    ObjectHolder NewList::Execute(Closure& closure, Context& context) {
+        // вычисляем элементы сразу в массив будущего списка
+        std::vector<ObjectHolder> items;
+        items.reserve(_items.size());
+        for (const auto& item : _items) {
+            items.push_back(item->Execute(closure, context));
+        }
+        return ObjectHolder::Own(runtime::List(std::move(items)));
+    }
+
+    ObjectHolder NewIntArray::Execute(Closure& closure, Context& context) {
+        return Evaluate(_argument->Execute(closure, context));
+    }
+
+    ObjectHolder NewIntArray::Evaluate(const ObjectHolder& arg) {
+        // intarray(n) создаёт массив из n нулей
+        if (runtime::Number* size = arg.TryAs<runtime::Number>()) {
+            if (size->GetValue() < 0) {
+                throw std::runtime_error("IntArray size must be non-negative");
+            }
+            return ObjectHolder::Own(runtime::IntArray(std::vector<int64_t>(static_cast<size_t>(size->GetValue()))));
+        }
+        // intarray(list) копирует числа из списка
+        else if (runtime::List* list = arg.TryAs<runtime::List>()) {
+            std::vector<int64_t> values;
+            values.reserve(list->Size());
+            for (const auto& item : list->Values()) {
+                runtime::Number* number = item.TryAs<runtime::Number>();
+                if (!number) {
+                    throw std::runtime_error("IntArray item must be a number");
+                }
+                values.push_back(number->GetValue());
+            }
+            return ObjectHolder::Own(runtime::IntArray(std::move(values)));
+        }
+        // intarray(array) создаёт копию массива
+        else if (runtime::IntArray* array = arg.TryAs<runtime::IntArray>()) {
+            return ObjectHolder::Own(runtime::IntArray(array->Values()));
+        }
+        else {
+            throw std::runtime_error("intarray() expects a size, a list or an array");
+        }
+    }
+
+    ObjectHolder NewFloatArray::Execute(Closure& closure, Context& context) {
+        return Evaluate(_argument->Execute(closure, context));
+    }
+
+    ObjectHolder NewFloatArray::Evaluate(const ObjectHolder& arg) {
+        // floatarray(n) создаёт массив из n нулей
+        if (runtime::Number* size = arg.TryAs<runtime::Number>()) {
+            if (size->GetValue() < 0) {
+                throw std::runtime_error("FloatArray size must be non-negative");
+            }
+            return ObjectHolder::Own(runtime::FloatArray(std::vector<double>(static_cast<size_t>(size->GetValue()))));
+        }
+        // floatarray(list) переводит в double числа любого типа
+        else if (runtime::List* list = arg.TryAs<runtime::List>()) {
+            std::vector<double> values;
+            values.reserve(list->Size());
+            for (const auto& item : list->Values()) {
+                if (!runtime::IsNumeric(item)) {
+                    throw std::runtime_error("FloatArray item must be a number");
+                }
+                values.push_back(runtime::ToDouble(item));
+            }
+            return ObjectHolder::Own(runtime::FloatArray(std::move(values)));
+        }
+        // floatarray(array) копирует массив double или переводит в double целочисленный массив
+        else if (runtime::FloatArray* array = arg.TryAs<runtime::FloatArray>()) {
+            return ObjectHolder::Own(runtime::FloatArray(array->Values()));
+        }
+        else if (runtime::IntArray* array = arg.TryAs<runtime::IntArray>()) {
+            return ObjectHolder::Own(runtime::FloatArray(std::vector<double>(array->Values().begin(), array->Values().end())));
+        }
+        else {
+            throw std::runtime_error("floatarray() expects a size, a list or an array");
+        }
+    }
+
+    NewDict::NewDict(std::vector<Item> items)
+        : _items(std::move(items)) {
+    }
+
+    ObjectHolder NewDict::Execute(Closure& closure, Context& context) {
+        runtime::ObjectHolder result = ObjectHolder::Own(runtime::Dict());
+        runtime::Dict* dict = result.TryAs<runtime::Dict>();
+        // пары вычисляем слева направо, повторный ключ перезаписывает значение
+        for (const auto& [key, value] : _items) {
+            runtime::ObjectHolder key_object = key->Execute(closure, context);
+            dict->Set(std::move(key_object), value->Execute(closure, context), context);
+        }
+        return result;
+    }
+
+    IndexAssignment::IndexAssignment(std::unique_ptr<Statement> object, std::unique_ptr<Statement> index,
+        std::unique_ptr<Statement> rv)
+        : _object(std::move(object))
+        , _index(std::move(index))
+        , _rv(std::move(rv)) {
+    }
+
+    ObjectHolder IndexAssignment::Execute(Closure& closure, Context& context) {
+        // выполняем выражение объекта и индекса
+        runtime::ObjectHolder object = _object->Execute(closure, context);
+        runtime::ObjectHolder index = _index->Execute(closure, context);
+        CheckTarget(object, index);
+
+        // значение вычисляем до обращения к элементу, так как rv может изменить размер списка
+        runtime::ObjectHolder value = _rv->Execute(closure, context);
+        return Assign(object, std::move(index), std::move(value), context);
+    }
+
+    void IndexAssignment::CheckTarget(const ObjectHolder& object, const ObjectHolder& index) {
+        // в словарь значение записывается по любому хешируемому ключу
+        if (object.TryAs<runtime::Dict>()) {
+            return;
+        }
+        if (!index.TryAs<runtime::Number>()) {
+            throw std::runtime_error("Index must be a number");
+        }
+        if (!object.TryAs<runtime::IntArray>() && !object.TryAs<runtime::FloatArray>()
+            && !object.TryAs<runtime::List>()) {
+            throw std::runtime_error("Object does not support item assignment");
+        }
+    }
+
+    ObjectHolder IndexAssignment::Assign(const ObjectHolder& object, ObjectHolder index, ObjectHolder value,
+        Context& context) {
+        // в словарь значение записывается по любому хешируемому ключу
+        if (runtime::Dict* dict = object.TryAs<runtime::Dict>()) {
+            dict->Set(std::move(index), value, context);
+            return value;
+        }
+
+        runtime::Number* position = index.TryAs<runtime::Number>();
+        if (!position) {
+            throw std::runtime_error("Index must be a number");
+        }
+
+        // в числовой массив записываются только числа
+        if (runtime::IntArray* array = object.TryAs<runtime::IntArray>()) {
+            runtime::Number* number = value.TryAs<runtime::Number>();
+            if (!number) {
+                throw std::runtime_error("IntArray item must be a number");
+            }
+            array->At(position->GetValue()) = number->GetValue();
+            return value;
+        }
+        if (runtime::FloatArray* array = object.TryAs<runtime::FloatArray>()) {
+            if (!runtime::IsNumeric(value)) {
+                throw std::runtime_error("FloatArray item must be a number");
+            }
+            array->At(position->GetValue()) = runtime::ToDouble(value);
+            return value;
+        }
+
+        runtime::List* list = object.TryAs<runtime::List>();
+        if (!list) {
+            throw std::runtime_error("Object does not support item assignment");
+        }
+        list->At(position->GetValue()) = value;
+        return value;
+    }
+
+    SortList::SortList(std::unique_ptr<Statement> list, std::unique_ptr<Statement> key)
+        : _list(std::move(list))
+        , _key(std::move(key)) {
+    }
+
+    ObjectHolder SortList::Execute(Closure& closure, Context& context) {
+        runtime::ObjectHolder object = _list->Execute(closure, context);
+        if (!_key) {
+            Sort(object, nullptr, context);
+        }
+        else {
+            runtime::ObjectHolder key = _key->Execute(closure, context);
+            Sort(object, &key, context);
+        }
+        return ObjectHolder::None();
+    }
+
+    void SortList::Sort(const ObjectHolder& object, const ObjectHolder* key, Context& context) {
+        runtime::List* list = object.TryAs<runtime::List>();
+        if (!list) {
+            throw std::runtime_error("sort() expects a list");
+        }
+
+        // без ключа элементы сравниваются сами по себе
+        if (!key) {
+            list->Sort(context);
+            return;
+        }
+        runtime::String* key_name = key->TryAs<runtime::String>();
+        if (!key_name) {
+            throw std::runtime_error("sort() key must be a field or method name");
+        }
+        list->Sort(context, runtime::Symbol(key_name->View()));
+    }
+
+    MethodBody::MethodBody(std::unique_ptr<Statement>&& body) 
+        : _body(std::move(body)) {
+    }
+
+    ObjectHolder MethodBody::Execute(Closure& closure, Context& context) {
+        _body->Execute(closure, context);
+        // если была выполнена инструкция return, забираем её результат
+        if (closure.IsReturning()) {
+            return closure.TakeReturnValue();
+        }
+        return ObjectHolder::None();
+    }
+
 }  // namespace ast
\ No newline at end of file
@@ -1,332 +1,629 @@
-﻿#pragma once
-
-#include "runtime.h"
-
-#include <functional>
-
-namespace ast {
-
-    using Statement = runtime::Executable;
-
-    // Выражение, возвращающее значение типа T,
-    // используется как основа для создания констант
-    template <typename T>
-    class ValueStatement : public Statement {
-    public:
-        explicit ValueStatement(T v)
-            : value_(std::move(v)) {
-        }
-
-        runtime::ObjectHolder Execute(runtime::Closure& /*closure*/,
-            runtime::Context& /*context*/) override {
-            return runtime::ObjectHolder::Share(value_);
-        }
-
-    private:
-        T value_;
-    };
-
-    using NumericConst = ValueStatement<runtime::Number>;
-    using StringConst = ValueStatement<runtime::String>;
-    using BoolConst = ValueStatement<runtime::Bool>;
-
-    /*
-    Вычисляет значение переменной либо цепочки вызовов полей объектов id1.id2.id3.
-    Например, выражение circle.center.x - цепочка вызовов полей объектов в инструкции:
-    x = circle.center.x
-    */
-    class VariableValue : public Statement {
-    public:
-        explicit VariableValue(const std::string& var_name);
-        explicit VariableValue(std::vector<std::string> dotted_ids);
-
-        runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
-    private:
-        std::vector<std::string> _dotted_ids;
-    };
-
-    // Присваивает переменной, имя которой задано в параметре var, значение выражения rv
-    class Assignment : public Statement {
-    public:
-        Assignment(std::string var, std::unique_ptr<Statement> rv);
-
-        runtime::ObjectHolder Execute(runtime::Closure& closure, [[maybe_unused]] runtime::Context& context) override;
-    private:
-        std::string _var;
-        std::unique_ptr<Statement> _rv;
-    };
-
-    // Присваивает полю object.field_name значение выражения rv
-    class FieldAssignment : public Statement {
-    public:
-        FieldAssignment(VariableValue object, std::string field_name, std::unique_ptr<Statement> rv);
-
-        runtime::ObjectHolder Execute(runtime::Closure& closure, [[maybe_unused]] runtime::Context& context) override;
-
-    private:
-        VariableValue _object;
-        std::string _field_name;
-        std::unique_ptr<Statement> _rv;
-    };
-
-    // Значение None
-    class None : public Statement {
-    public:
-        runtime::ObjectHolder Execute([[maybe_unused]] runtime::Closure& closure,
-            [[maybe_unused]] runtime::Context& context) override {
-            return {};
-        }
-    };
-
-    // Команда print
-    class Print : public Statement {
-    public:
-        // Инициализирует команду print для вывода значения выражения argument
-        explicit Print(std::unique_ptr<Statement> argument);
-        // Инициализирует команду print для вывода списка значений args
-        explicit Print(std::vector<std::unique_ptr<Statement>> args);
-
-        // Инициализирует команду print для вывода значения переменной name
-        static std::unique_ptr<Print> Variable(const std::string& name);
-
-        // Во время выполнения команды print вывод должен осуществляться в поток, возвращаемый из
-        // context.GetOutputStream()
-        runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
-    private:
-        std::vector<std::unique_ptr<Statement>> _args;
-    };
-
-    // Вызывает метод object.method со списком параметров args
-    class MethodCall : public Statement {
-    public:
-        MethodCall(std::unique_ptr<Statement> object, std::string method,
-            std::vector<std::unique_ptr<Statement>> args);
-
-        runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
-    private:
-        std::unique_ptr<Statement> _object;
-        std::string _method;
-        std::vector<std::unique_ptr<Statement>> _args;
-    };
-
-    /*
-    Создаёт новый экземпляр класса class_, передавая его конструктору набор параметров args.
-    Если в классе отсутствует метод __init__ с заданным количеством аргументов,
-    то экземпляр класса создаётся без вызова конструктора (поля объекта не будут проинициализированы):
-
-    class Person:
-      def set_name(name):
-        self.name = name
-
-    p = Person()
-    # Поле name будет иметь значение только после вызова метода set_name
-    p.set_name("Ivan")
-    */
-    class NewInstance : public Statement {
-    public:
-        explicit NewInstance(const runtime::Class& class_);
-        NewInstance(const runtime::Class& class_, std::vector<std::unique_ptr<Statement>> args);
-        // Возвращает объект, содержащий значение типа ClassInstance
-        runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
-    private:
-        const runtime::Class& _class;
-        std::vector<std::unique_ptr<Statement>> _args;
-    };
-
-    // Базовый класс для унарных операций
-    class UnaryOperation : public Statement {
-    public:
-        explicit UnaryOperation(std::unique_ptr<Statement> argument) 
-            : _argument(std::move(argument)) {
-        }
-        std::unique_ptr<Statement> _argument;
-    };
-
-    // Операция str, возвращающая строковое значение своего аргумента
-    class Stringify : public UnaryOperation {
-    public:
-        using UnaryOperation::UnaryOperation;
-        runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
-    };
-
-    // Родительский класс Бинарная операция с аргументами lhs и rhs
-    class BinaryOperation : public Statement {
-    public:
-        BinaryOperation(std::unique_ptr<Statement> lhs, std::unique_ptr<Statement> rhs)
-            : _lhs(std::move(lhs)), _rhs(std::move(rhs)) {
-        }
-        std::unique_ptr<Statement> _lhs;
-        std::unique_ptr<Statement> _rhs;
-    };
-
-    // Возвращает результат операции + над аргументами lhs и rhs
-    class Add : public BinaryOperation {
-    public:
-        using BinaryOperation::BinaryOperation;
-
-        // Поддерживается сложение:
-        //  число + число
-        //  строка + строка
-        //  объект1 + объект2, если у объект1 - пользовательский класс с методом _add__(rhs)
-        // В противном случае при вычислении выбрасывается runtime_error
-        runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
-    };
-
-    // Возвращает результат вычитания аргументов lhs и rhs
-    class Sub : public BinaryOperation {
-    public:
-        using BinaryOperation::BinaryOperation;
-
-        // Поддерживается вычитание:
-        //  число - число
-        // Если lhs и rhs - не числа, выбрасывается исключение runtime_error
-        runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
-    };
-
-    // Возвращает результат умножения аргументов lhs и rhs
-    class Mult : public BinaryOperation {
-    public:
-        using BinaryOperation::BinaryOperation;
-
-        // Поддерживается умножение:
-        //  число * число
-        // Если lhs и rhs - не числа, выбрасывается исключение runtime_error
-        runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
-    };
-
-    // Возвращает результат деления lhs и rhs
-    class Div : public BinaryOperation {
-    public:
-        using BinaryOperation::BinaryOperation;
-
-        // Поддерживается деление:
-        //  число / число
-        // Если lhs и rhs - не числа, выбрасывается исключение runtime_error
-        // Если rhs равен 0, выбрасывается исключение runtime_error
-        runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
-    };
-
-    // Возвращает результат вычисления логической операции or над lhs и rhs
-    class Or : public BinaryOperation {
-    public:
-        using BinaryOperation::BinaryOperation;
-        // Значение аргумента rhs вычисляется, только если значение lhs
-        // после приведения к Bool равно False
-        runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
-    };
-
-    // Возвращает результат вычисления логической операции and над lhs и rhs
-    class And : public BinaryOperation {
-    public:
-        using BinaryOperation::BinaryOperation;
-        // Значение аргумента rhs вычисляется, только если значение lhs
-        // после приведения к Bool равно True
-        runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
-    };
-
-    // Возвращает результат вычисления логической операции not над единственным аргументом операции
-    class Not : public UnaryOperation {
-    public:
-        using UnaryOperation::UnaryOperation;
-        runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
-    };
-
-    // Составная инструкция (например: тело метода, содержимое ветки if, либо else)
-    class Compound : public Statement {
-    public:
-        // Конструирует Compound из нескольких инструкций типа unique_ptr<Statement>
-        template <typename... Args>
-        explicit Compound(Args&&... args)  {
-            (_args.push_back(std::forward<Args>(args)), ...);
-        }
-
-        // Добавляет очередную инструкцию в конец составной инструкции
-        void AddStatement(std::unique_ptr<Statement> stmt) {
-            _args.push_back(std::move(stmt));
-        }
-
-        // Последовательно выполняет добавленные инструкции. Возвращает None
-        runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
-    private:
-        std::vector<std::unique_ptr<Statement>> _args;
-    };
-
-    // Тело метода. Как правило, содержит составную инструкцию
-    class MethodBody : public Statement {
-    public:
-        explicit MethodBody(std::unique_ptr<Statement>&& body);
-
-        // Вычисляет инструкцию, переданную в качестве body.
-        // Если внутри body была выполнена инструкция return, возвращает результат return
-        // В противном случае возвращает None
-        runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
-    private:
-        std::unique_ptr<Statement> _body;
-    };
-
-    // Класс-исключение для возврата из Return
-    class return_data_exp : public ::std::runtime_error {
-    public:
-        return_data_exp(std::string&& line) 
-            : std::runtime_error(std::move(line))  {
-        };
-    };
-
-    // Выполняет инструкцию return с выражением statement
-    class Return : public Statement {
-    public:
-        explicit Return(std::unique_ptr<Statement> statement) 
-            : _stmt(std::move(statement)) {
-        }
-
-        // Останавливает выполнение текущего метода. После выполнения инструкции return метод,
-        // внутри которого она была исполнена, должен вернуть результат вычисления выражения statement.
-        runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
-    private:
-        std::unique_ptr<Statement> _stmt;
-    };
-
-    // Объявляет класс
-    class ClassDefinition : public Statement {
-    public:
-        // Гарантируется, что ObjectHolder содержит объект типа runtime::Class
-        explicit ClassDefinition(runtime::ObjectHolder cls);
-
-        // Создаёт внутри closure новый объект, совпадающий с именем класса и значением, переданным в
-        // конструктор
-        runtime::ObjectHolder Execute(runtime::Closure& closure, [[maybe_unused]] runtime::Context& context) override;
-    private:
-        runtime::ObjectHolder _cls;
-    };
-
-    // Инструкция if <condition> <if_body> else <else_body>
-    class IfElse : public Statement {
-    public:
-        // Параметр else_body может быть равен nullptr
-        IfElse(std::unique_ptr<Statement> condition, std::unique_ptr<Statement> if_body,
-            std::unique_ptr<Statement> else_body);
-
-        runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
-    private:
-        std::unique_ptr<Statement> _condition;
-        std::unique_ptr<Statement> _if_body;
-        std::unique_ptr<Statement> _else_body;
-    };
-
-    // Операция сравнения
-    class Comparison : public BinaryOperation {
-    public:
-        // Comparator задаёт функцию, выполняющую сравнение значений аргументов
-        using Comparator = std::function<bool(const runtime::ObjectHolder&,
-            const runtime::ObjectHolder&, runtime::Context&)>;
-
-        Comparison(Comparator cmp, std::unique_ptr<Statement> lhs, std::unique_ptr<Statement> rhs);
-
-        // Вычисляет значение выражений lhs и rhs и возвращает результат работы comparator,
-        // приведённый к типу runtime::Bool
-        runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
-    private:
-        Comparator _cmp;
-    };
-
+﻿#pragma once
+
+#include "runtime.h"
+
+namespace ast {
+
+    using Statement = runtime::Executable;
+
+    // Выражение, возвращающее значение типа T,
+    // используется как основа для создания констант
+    template <typename T>
+    class ValueStatement : public Statement {
+    public:
+        explicit ValueStatement(T v)
+            : value_(std::move(v)) {
+        }
+
+        runtime::ObjectHolder Execute(runtime::Closure& /*closure*/,
+            runtime::Context& /*context*/) override {
+            return runtime::ObjectHolder::Share(value_);
+        }
+
+        [[nodiscard]] const T& GetValue() const {
+            return value_;
+        }
+        [[nodiscard]] T& GetValue() {
+            return value_;
+        }
+
+    private:
+        T value_;
+    };
+
+    using NumericConst = ValueStatement<runtime::Number>;
+    using FloatConst = ValueStatement<runtime::Float>;
+    using StringConst = ValueStatement<runtime::String>;
+    using BoolConst = ValueStatement<runtime::Bool>;
+
+    /*
+    Вычисляет значение переменной либо цепочки вызовов полей объектов id1.id2.id3.
+    Например, выражение circle.center.x - цепочка вызовов полей объектов в инструкции:
+    x = circle.center.x
+    */
+    class VariableValue : public Statement {
+    public:
+        explicit VariableValue(const std::string& var_name);
+        explicit VariableValue(std::vector<std::string> dotted_ids);
+
+        runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+
+        [[nodiscard]] const std::vector<runtime::Symbol>& GetDottedIds() const {
+            return _dotted_ids;
+        }
+    private:
+        std::vector<runtime::Symbol> _dotted_ids;
+    };
+
+    // Присваивает переменной, имя которой задано в параметре var, значение выражения rv
+    class Assignment : public Statement {
+    public:
+        Assignment(std::string var, std::unique_ptr<Statement> rv);
+
+        runtime::ObjectHolder Execute(runtime::Closure& closure, [[maybe_unused]] runtime::Context& context) override;
+
+        [[nodiscard]] runtime::Symbol GetVar() const {
+            return _var;
+        }
+        [[nodiscard]] Statement& GetValue() const {
+            return *_rv;
+        }
+    private:
+        runtime::Symbol _var;
+        std::unique_ptr<Statement> _rv;
+    };
+
+    // Присваивает полю object.field_name значение выражения rv
+    class FieldAssignment : public Statement {
+    public:
+        FieldAssignment(VariableValue object, std::string field_name, std::unique_ptr<Statement> rv);
+
+        runtime::ObjectHolder Execute(runtime::Closure& closure, [[maybe_unused]] runtime::Context& context) override;
+
+        [[nodiscard]] const VariableValue& GetObject() const {
+            return _object;
+        }
+        [[nodiscard]] runtime::Symbol GetField() const {
+            return _field_name;
+        }
+        [[nodiscard]] Statement& GetValue() const {
+            return *_rv;
+        }
+
+    private:
+        VariableValue _object;
+        runtime::Symbol _field_name;
+        std::unique_ptr<Statement> _rv;
+    };
+
+    // Значение None
+    class None : public Statement {
+    public:
+        runtime::ObjectHolder Execute([[maybe_unused]] runtime::Closure& closure,
+            [[maybe_unused]] runtime::Context& context) override {
+            return {};
+        }
+    };
+
+    // Команда print
+    class Print : public Statement {
+    public:
+        // Инициализирует команду print для вывода значения выражения argument
+        explicit Print(std::unique_ptr<Statement> argument);
+        // Инициализирует команду print для вывода списка значений args
+        explicit Print(std::vector<std::unique_ptr<Statement>> args);
+
+        // Инициализирует команду print для вывода значения переменной name
+        static std::unique_ptr<Print> Variable(const std::string& name);
+
+        // Во время выполнения команды print вывод должен осуществляться в поток, возвращаемый из
+        // context.GetOutputStream()
+        runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+
+        [[nodiscard]] const std::vector<std::unique_ptr<Statement>>& GetArgs() const {
+            return _args;
+        }
+    private:
+        std::vector<std::unique_ptr<Statement>> _args;
+    };
+
+    // Вызывает метод object.method со списком параметров args
+    class MethodCall : public Statement {
+    public:
+        MethodCall(std::unique_ptr<Statement> object, std::string method,
+            std::vector<std::unique_ptr<Statement>> args);
+
+        runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+
+        [[nodiscard]] Statement& GetObject() const {
+            return *_object;
+        }
+        [[nodiscard]] runtime::Symbol GetMethod() const {
+            return _method;
+        }
+        [[nodiscard]] const std::vector<std::unique_ptr<Statement>>& GetArgs() const {
+            return _args;
+        }
+    private:
+        std::unique_ptr<Statement> _object;
+        runtime::Symbol _method;
+        std::vector<std::unique_ptr<Statement>> _args;
+    };
+
+    /*
+    Создаёт новый экземпляр класса class_, передавая его конструктору набор параметров args.
+    Если в классе отсутствует метод __init__ с заданным количеством аргументов,
+    то экземпляр класса создаётся без вызова конструктора (поля объекта не будут проинициализированы):
+
+    class Person:
+      def set_name(name):
+        self.name = name
+
+    p = Person()
+    # Поле name будет иметь значение только после вызова метода set_name
+    p.set_name("Ivan")
+    */
+    class NewInstance : public Statement {
+    public:
+        explicit NewInstance(const runtime::Class& class_);
+        NewInstance(const runtime::Class& class_, std::vector<std::unique_ptr<Statement>> args);
+        // Возвращает объект, содержащий значение типа ClassInstance
+        runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+
+        [[nodiscard]] const runtime::Class& GetClass() const {
+            return _class;
+        }
+        [[nodiscard]] const std::vector<std::unique_ptr<Statement>>& GetArgs() const {
+            return _args;
+        }
+    private:
+        const runtime::Class& _class;
+        std::vector<std::unique_ptr<Statement>> _args;
+    };
+
+    // Создаёт новый список из значений выражений items, например [1, 'two', x]
+    class NewList : public Statement {
+    public:
+        explicit NewList(std::vector<std::unique_ptr<Statement>> items);
+        // Возвращает объект, содержащий значение типа List
+        runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+
+        [[nodiscard]] const std::vector<std::unique_ptr<Statement>>& GetItems() const {
+            return _items;
+        }
+    private:
+        std::vector<std::unique_ptr<Statement>> _items;
+    };
+
+    // Создаёт новый словарь из пар выражений ключ-значение, например {'one': 1, x: y}
+    class NewDict : public Statement {
+    public:
+        using Item = std::pair<std::unique_ptr<Statement>, std::unique_ptr<Statement>>;
+
+        explicit NewDict(std::vector<Item> items);
+        // Возвращает объект, содержащий значение типа Dict
+        runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+
+        [[nodiscard]] const std::vector<Item>& GetItems() const {
+            return _items;
+        }
+    private:
+        std::vector<Item> _items;
+    };
+
+    // Присваивает элементу object[index] значение выражения rv
+    class IndexAssignment : public Statement {
+    public:
+        IndexAssignment(std::unique_ptr<Statement> object, std::unique_ptr<Statement> index,
+            std::unique_ptr<Statement> rv);
+
+        runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+
+        // Проверяет, что элементу object[index] можно присвоить значение. Выполняется до вычисления значения,
+        // чтобы неподходящий объект не запускал побочные эффекты rv
+        static void CheckTarget(const runtime::ObjectHolder& object, const runtime::ObjectHolder& index);
+        // Записывает value в object[index] и возвращает value
+        static runtime::ObjectHolder Assign(const runtime::ObjectHolder& object, runtime::ObjectHolder index,
+            runtime::ObjectHolder value, runtime::Context& context);
+
+        [[nodiscard]] Statement& GetObject() const {
+            return *_object;
+        }
+        [[nodiscard]] Statement& GetIndex() const {
+            return *_index;
+        }
+        [[nodiscard]] Statement& GetValue() const {
+            return *_rv;
+        }
+    private:
+        std::unique_ptr<Statement> _object;
+        std::unique_ptr<Statement> _index;
+        std::unique_ptr<Statement> _rv;
+    };
+
+    // Операция sort(list[, key]), сортирующая список на месте. key - выражение, дающее имя поля или метода
+    class SortList : public Statement {
+    public:
+        SortList(std::unique_ptr<Statement> list, std::unique_ptr<Statement> key);
+
+        runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+
+        // Сортирует список object. key равен nullptr, если ключ не задан
+        static void Sort(const runtime::ObjectHolder& object, const runtime::ObjectHolder* key,
+            runtime::Context& context);
+
+        [[nodiscard]] Statement& GetList() const {
+            return *_list;
+        }
+        // Возвращает nullptr, если ключ не задан
+        [[nodiscard]] Statement* GetKey() const {
+            return _key.get();
+        }
+    private:
+        std::unique_ptr<Statement> _list;
+        std::unique_ptr<Statement> _key;
+    };
+
+    // Базовый класс для унарных операций
+    class UnaryOperation : public Statement {
+    public:
+        explicit UnaryOperation(std::unique_ptr<Statement> argument) 
+            : _argument(std::move(argument)) {
+        }
+        std::unique_ptr<Statement> _argument;
+    };
+
+    // Операция str, возвращающая строковое значение своего аргумента
+    class Stringify : public UnaryOperation {
+    public:
+        using UnaryOperation::UnaryOperation;
+        runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+
+        // Возвращает строковое представление value
+        static runtime::ObjectHolder Evaluate(const runtime::ObjectHolder& value, runtime::Context& context);
+    };
+
+    // Операция len, возвращающая количество элементов списка, словаря или массива, либо длину строки
+    class Length : public UnaryOperation {
+    public:
+        using UnaryOperation::UnaryOperation;
+        runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+
+        static runtime::ObjectHolder Evaluate(const runtime::ObjectHolder& value);
+    };
+
+    // Операция intarray, создающая числовой массив из размера, списка чисел или другого массива
+    class NewIntArray : public UnaryOperation {
+    public:
+        using UnaryOperation::UnaryOperation;
+        runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+
+        static runtime::ObjectHolder Evaluate(const runtime::ObjectHolder& value);
+    };
+
+    // Операция floatarray, создающая массив double из размера, списка чисел или числового массива
+    class NewFloatArray : public UnaryOperation {
+    public:
+        using UnaryOperation::UnaryOperation;
+        runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+
+        static runtime::ObjectHolder Evaluate(const runtime::ObjectHolder& value);
+    };
+
+    // Родительский класс Бинарная операция с аргументами lhs и rhs
+    class BinaryOperation : public Statement {
+    public:
+        BinaryOperation(std::unique_ptr<Statement> lhs, std::unique_ptr<Statement> rhs)
+            : _lhs(std::move(lhs)), _rhs(std::move(rhs)) {
+        }
+        std::unique_ptr<Statement> _lhs;
+        std::unique_ptr<Statement> _rhs;
+    };
+
+    // Вариант, в который специализировался узел операции
+    enum class Quickened : uint8_t {
+        Warmup,     // узел выполняет общую ветку и собирает типы аргументов
+        Numbers,    // оба аргумента - Number
+        Strings,    // оба аргумента - String
+        Instance,   // lhs - экземпляр класса, операция вызывает его метод
+        Generic,    // типы аргументов менялись слишком часто, узел больше не специализируется
+    };
+
+    // Число выполнений подряд с одним вариантом типов, после которого узел специализируется
+    constexpr uint8_t __QUICKEN_THRESHOLD__ = 8;
+    // Число промахов специализированной ветки, после которого узел остаётся общим
+    constexpr uint8_t __QUICKEN_MAX_DEOPTS__ = 4;
+
+    /*
+     * Сведения о типах аргументов, накопленные узлом операции. В состоянии Warmup узел выполняет общую ветку,
+     * перебирающую типы, и записывает наблюдаемый вариант. После __QUICKEN_THRESHOLD__ одинаковых вариантов
+     * подряд узел переключается на ветку для этих типов, которая лишь сверяет типы аргументов.
+     * Промах возвращает узел в Warmup.
+     * Сведения хранятся в самом узле и меняются при выполнении без синхронизации, поэтому дерево программы
+     * выполняется одним потоком. Чтобы выполнять программу в нескольких потоках, каждый разбирает свою копию
+     */
+    class TypeFeedback {
+    public:
+        [[nodiscard]] Quickened State() const {
+            return _state;
+        }
+        [[nodiscard]] size_t Deopts() const {
+            return _deopts;
+        }
+
+        // Учитывает вариант типов очередного выполнения. Warmup означает, что специализировать нечего
+        void Record(Quickened observed);
+        // Отменяет специализацию после промаха
+        void Deoptimize();
+
+    private:
+        Quickened _state = Quickened::Warmup;
+        Quickened _candidate = Quickened::Warmup;
+        uint8_t _hits = 0;
+        uint8_t _deopts = 0;
+    };
+
+    // Бинарная операция, специализирующаяся по типам аргументов
+    class QuickenedOperation : public BinaryOperation {
+    public:
+        using BinaryOperation::BinaryOperation;
+
+        [[nodiscard]] const TypeFeedback& Feedback() const {
+            return _feedback;
+        }
+
+    protected:
+        TypeFeedback _feedback;
+    };
+
+    // Возвращает результат операции + над аргументами lhs и rhs
+    class Add : public QuickenedOperation {
+    public:
+        using QuickenedOperation::QuickenedOperation;
+
+        // Поддерживается сложение:
+        //  число + число
+        //  строка + строка
+        //  объект1 + объект2, если у объект1 - пользовательский класс с методом _add__(rhs)
+        // В противном случае при вычислении выбрасывается runtime_error
+        runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+    };
+
+    // Возвращает результат вычитания аргументов lhs и rhs
+    class Sub : public QuickenedOperation {
+    public:
+        using QuickenedOperation::QuickenedOperation;
+
+        // Поддерживается вычитание:
+        //  число - число
+        // Если lhs и rhs - не числа, выбрасывается исключение runtime_error
+        runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+    };
+
+    // Возвращает результат умножения аргументов lhs и rhs
+    class Mult : public QuickenedOperation {
+    public:
+        using QuickenedOperation::QuickenedOperation;
+
+        // Поддерживается умножение:
+        //  число * число
+        // Если lhs и rhs - не числа, выбрасывается исключение runtime_error
+        runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+    };
+
+    // Возвращает результат деления lhs и rhs
+    class Div : public QuickenedOperation {
+    public:
+        using QuickenedOperation::QuickenedOperation;
+
+        // Поддерживается деление:
+        //  число / число
+        // Если lhs и rhs - не числа, выбрасывается исключение runtime_error
+        // Если rhs равен 0, выбрасывается исключение runtime_error
+        runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+    };
+
+    // Возвращает элемент lhs[rhs]
+    class Index : public BinaryOperation {
+    public:
+        using BinaryOperation::BinaryOperation;
+
+        // Поддерживается индексирование:
+        //  список[число] - элемент списка, отрицательный индекс отсчитывается с конца
+        //  строка[число] - строка из одного символа
+        //  словарь[ключ] - значение по ключу
+        // В противном случае, а также при выходе за границы или отсутствии ключа выбрасывается runtime_error
+        runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+
+        static runtime::ObjectHolder Evaluate(const runtime::ObjectHolder& object, const runtime::ObjectHolder& index,
+            runtime::Context& context);
+    };
+
+    // Возвращает результат проверки lhs in rhs
+    class Membership : public BinaryOperation {
+    public:
+        using BinaryOperation::BinaryOperation;
+
+        // Поддерживается проверка:
+        //  ключ in словарь - наличие ключа в словаре
+        //  значение in список - наличие равного элемента в списке
+        //  строка in строка - наличие подстроки
+        // В противном случае выбрасывается runtime_error
+        runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+
+        // Возвращает результат проверки item in container
+        static bool Contains(const runtime::ObjectHolder& item, const runtime::ObjectHolder& container,
+            runtime::Context& context);
+    };
+
+    // Возвращает результат вычисления логической операции or над lhs и rhs
+    class Or : public BinaryOperation {
+    public:
+        using BinaryOperation::BinaryOperation;
+        // Значение аргумента rhs вычисляется, только если значение lhs
+        // после приведения к Bool равно False. Результат - значение lhs либо rhs без приведения к Bool
+        runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+    };
+
+    // Возвращает результат вычисления логической операции and над lhs и rhs
+    class And : public BinaryOperation {
+    public:
+        using BinaryOperation::BinaryOperation;
+        // Значение аргумента rhs вычисляется, только если значение lhs
+        // после приведения к Bool равно True. Результат - значение lhs либо rhs без приведения к Bool
+        runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+    };
+
+    // Возвращает результат вычисления логической операции not над единственным аргументом операции
+    class Not : public UnaryOperation {
+    public:
+        using UnaryOperation::UnaryOperation;
+        runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+    };
+
+    // Составная инструкция (например: тело метода, содержимое ветки if, либо else)
+    class Compound : public Statement {
+    public:
+        // Конструирует Compound из нескольких инструкций типа unique_ptr<Statement>
+        template <typename... Args>
+        explicit Compound(Args&&... args)  {
+            (_args.push_back(std::forward<Args>(args)), ...);
+        }
+
+        // Добавляет очередную инструкцию в конец составной инструкции
+        void AddStatement(std::unique_ptr<Statement> stmt) {
+            _args.push_back(std::move(stmt));
+        }
+
+        // Последовательно выполняет добавленные инструкции. Возвращает None
+        runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+
+        [[nodiscard]] const std::vector<std::unique_ptr<Statement>>& GetStatements() const {
+            return _args;
+        }
+    private:
+        std::vector<std::unique_ptr<Statement>> _args;
+    };
+
+    // Тело метода. Как правило, содержит составную инструкцию
+    class MethodBody : public Statement {
+    public:
+        explicit MethodBody(std::unique_ptr<Statement>&& body);
+
+        // Вычисляет инструкцию, переданную в качестве body.
+        // Если внутри body была выполнена инструкция return, возвращает результат return
+        // В противном случае возвращает None
+        runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+
+        [[nodiscard]] Statement& GetBody() const {
+            return *_body;
+        }
+    private:
+        std::unique_ptr<Statement> _body;
+    };
+
+    // Выполняет инструкцию return с выражением statement
+    class Return : public Statement {
+    public:
+        explicit Return(std::unique_ptr<Statement> statement) 
+            : _stmt(std::move(statement)) {
+        }
+
+        // Останавливает выполнение текущего метода. После выполнения инструкции return метод,
+        // внутри которого она была исполнена, должен вернуть результат вычисления выражения statement.
+        // Результат сохраняется в кадре метода (Closure::SetReturnValue), исключения не используются
+        runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+
+        [[nodiscard]] Statement& GetValue() const {
+            return *_stmt;
+        }
+    private:
+        std::unique_ptr<Statement> _stmt;
+    };
+
+    // Объявляет класс
+    class ClassDefinition : public Statement {
+    public:
+        // Гарантируется, что ObjectHolder содержит объект типа runtime::Class
+        explicit ClassDefinition(runtime::ObjectHolder cls);
+
+        // Создаёт внутри closure новый объект, совпадающий с именем класса и значением, переданным в
+        // конструктор
+        runtime::ObjectHolder Execute(runtime::Closure& closure, [[maybe_unused]] runtime::Context& context) override;
+
+        [[nodiscard]] runtime::Class& GetClass() const {
+            return *_cls.TryAs<runtime::Class>();
+        }
+    private:
+        runtime::ObjectHolder _cls;
+        runtime::Symbol _name;      // имя класса, интернированное при разборе
+    };
+
+    // Инструкция if <condition> <if_body> else <else_body>
+    class IfElse : public Statement {
+    public:
+        // Параметр else_body может быть равен nullptr
+        IfElse(std::unique_ptr<Statement> condition, std::unique_ptr<Statement> if_body,
+            std::unique_ptr<Statement> else_body);
+
+        runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+
+        [[nodiscard]] Statement& GetCondition() const {
+            return *_condition;
+        }
+        [[nodiscard]] Statement& GetIfBody() const {
+            return *_if_body;
+        }
+        // Возвращает nullptr, если ветки else нет
+        [[nodiscard]] Statement* GetElseBody() const {
+            return _else_body.get();
+        }
+    private:
+        std::unique_ptr<Statement> _condition;
+        std::unique_ptr<Statement> _if_body;
+        std::unique_ptr<Statement> _else_body;
+    };
+
+    // Инструкция for <var> in <iterable>: <body>
+    class ForEach : public Statement {
+    public:
+        ForEach(std::string var, std::unique_ptr<Statement> iterable, std::unique_ptr<Statement> body);
+
+        // Поочерёдно присваивает переменной var элементы списка (ключи словаря, символы строки) и выполняет body.
+        // Элементы, добавленные в список телом цикла, также будут пройдены. Возвращает None
+        runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+
+        [[nodiscard]] runtime::Symbol GetVar() const {
+            return _var;
+        }
+        [[nodiscard]] Statement& GetIterable() const {
+            return *_iterable;
+        }
+        [[nodiscard]] Statement& GetBody() const {
+            return *_body;
+        }
+    private:
+        runtime::Symbol _var;
+        std::unique_ptr<Statement> _iterable;
+        std::unique_ptr<Statement> _body;
+    };
+
+    // Операция сравнения op. У каждого оператора свой узел, поэтому выбор оператора не стоит времени
+    // при выполнении
+    template <runtime::CompareOp op>
+    class Comparison : public QuickenedOperation {
+    public:
+        using QuickenedOperation::QuickenedOperation;
+
+        // Вычисляет значение выражений lhs и rhs и возвращает результат сравнения в виде runtime::Bool
+        runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+    };
+
+    using Less = Comparison<runtime::CompareOp::Less>;
+    using LessOrEqual = Comparison<runtime::CompareOp::LessOrEqual>;
+    using Greater = Comparison<runtime::CompareOp::Greater>;
+    using GreaterOrEqual = Comparison<runtime::CompareOp::GreaterOrEqual>;
+    using Equal = Comparison<runtime::CompareOp::Equal>;
+    using NotEqual = Comparison<runtime::CompareOp::NotEqual>;
+
 }  // namespace ast
\ No newline at end of file
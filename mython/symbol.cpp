@@ -0,0 +1,42 @@
+#include "symbol.h"
+
+#include <mutex>
+#include <unordered_set>
+
+namespace runtime {
+
+    namespace {
+
+        // Таблица интернированных имён. Создаётся при первом обращении, чтобы символы
+        // можно было объявлять глобальными константами в любой единице трансляции
+        const std::string* Intern(std::string_view name) {
+            static std::mutex mutex;
+            static std::unordered_set<std::string> table;
+
+            std::lock_guard guard(mutex);
+            return &*table.emplace(name).first;
+        }
+
+    }  // namespace
+
+    Symbol::Symbol()
+        : _name(Intern({})) {
+    }
+
+    Symbol::Symbol(std::string_view name)
+        : _name(Intern(name)) {
+    }
+
+    Symbol::Symbol(const std::string& name)
+        : _name(Intern(name)) {
+    }
+
+    Symbol::Symbol(const char* name)
+        : _name(Intern(name)) {
+    }
+
+    std::ostream& operator<<(std::ostream& os, Symbol symbol) {
+        return os << symbol.Name();
+    }
+
+}  // namespace runtime
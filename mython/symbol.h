@@ -0,0 +1,69 @@
+#pragma once
+
+#include <functional>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+namespace runtime {
+
+    /*
+     * Интернированное имя: идентификатор, имя поля или метода.
+     * Все символы с одинаковым текстом указывают на одну строку глобальной таблицы, поэтому сравнение
+     * и хеширование символа - операции над указателем. Строки таблицы живут до конца программы
+     */
+    class Symbol {
+    public:
+        // Создаёт символ пустого имени
+        Symbol();
+        // Создаёт символ с текстом name, добавляя его в таблицу при первом обращении. Обращение к таблице
+        // берёт глобальную блокировку, поэтому конструкторы явные: имена, известные заранее, создаются
+        // один раз как константы, а не при каждом сравнении
+        explicit Symbol(std::string_view name);
+        explicit Symbol(const std::string& name);
+        explicit Symbol(const char* name);
+
+        // Возвращает текст символа
+        [[nodiscard]] const std::string& Name() const {
+            return *_name;
+        }
+
+        operator const std::string&() const {  // NOLINT(google-explicit-constructor,hicpp-explicit-conversions)
+            return *_name;
+        }
+
+        [[nodiscard]] bool Empty() const {
+            return _name->empty();
+        }
+
+        // Сравнение символов - сравнение адресов
+        friend bool operator==(Symbol lhs, Symbol rhs) {
+            return lhs._name == rhs._name;
+        }
+        friend bool operator!=(Symbol lhs, Symbol rhs) {
+            return lhs._name != rhs._name;
+        }
+
+        // Возвращает хеш символа, вычисляемый по адресу строки в таблице
+        [[nodiscard]] size_t Hash() const {
+            return std::hash<const void*>{}(_name);
+        }
+
+    private:
+        const std::string* _name;
+    };
+
+    std::ostream& operator<<(std::ostream& os, Symbol symbol);
+
+}  // namespace runtime
+
+namespace std {
+
+    template <>
+    struct hash<runtime::Symbol> {
+        size_t operator()(runtime::Symbol symbol) const {
+            return symbol.Hash();
+        }
+    };
+
+}  // namespace std